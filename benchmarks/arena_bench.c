@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/arena.h"
+#include "myclib/array.h"
+#include "myclib/map.h"
+#include "myclib/string.h"
+#include "myclib/time.h"
+
+/*
+ * One synthetic request: parse 32 header strings, collect 200 ids in an
+ * array and index 64 of them in a map, then tear everything down. With the
+ * arena the teardown is a single reset.
+ */
+
+enum { HEADERS = 32, IDS = 200, INDEXED = 64 };
+
+static size_t handle_request(struct mc_allocator const *allocator,
+                             bool cleanup)
+{
+    struct mc_string headers[HEADERS];
+    for (int i = 0; i < HEADERS; i++) {
+        mc_string_init_with_allocator(&headers[i], allocator);
+        mc_string_append_format(&headers[i], "x-header-%d: value-%d", i,
+                                i * 7);
+    }
+
+    struct mc_array ids;
+    mc_array_init_with_allocator(&ids, int_get_mc_type(), allocator);
+    for (int i = 0; i < IDS; i++)
+        mc_array_push(&ids, &(int){i * 31});
+
+    struct mc_map index;
+    mc_map_init_with_allocator(&index, int_get_mc_type(), int_get_mc_type(),
+                               allocator);
+    for (int i = 0; i < INDEXED; i++)
+        mc_map_insert(&index, mc_array_get(&ids, (size_t)i), &(int){i});
+
+    size_t result = mc_string_len(&headers[HEADERS - 1]) + mc_map_len(&index);
+
+    if (cleanup) {
+        for (int i = 0; i < HEADERS; i++)
+            mc_string_cleanup(&headers[i]);
+        mc_array_cleanup(&ids);
+        mc_map_cleanup(&index);
+    }
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    size_t requests = argc > 1 ? strtoul(argv[1], NULL, 10) : 200000;
+    size_t check = 0;
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < requests; i++)
+        check += handle_request(&mc_default_allocator, true);
+    double heap_ms = mc_get_current_time_ms() - start;
+
+    struct mc_arena arena;
+    mc_arena_init(&arena, 0);
+    start = mc_get_current_time_ms();
+    for (size_t i = 0; i < requests; i++) {
+        check -= handle_request(mc_arena_allocator(&arena), false);
+        mc_arena_reset(&arena);
+    }
+    double arena_ms = mc_get_current_time_ms() - start;
+    mc_arena_cleanup(&arena);
+
+    if (check != 0) {
+        fprintf(stderr, "result mismatch\n");
+        return 1;
+    }
+
+    printf("%zu requests\n", requests);
+    printf("%-10s %12s %14s\n", "allocator", "total (ms)", "per req (us)");
+    printf("%-10s %12.2f %14.3f\n", "heap", heap_ms,
+           heap_ms * 1000 / (double)requests);
+    printf("%-10s %12.2f %14.3f\n", "arena", arena_ms,
+           arena_ms * 1000 / (double)requests);
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/array.h"
+#include "myclib/time.h"
+
+/* Drops every element whose value is divisible by 3 (about a third). */
+
+static bool keep(void const *elem, void const *user_data)
+{
+    (void)user_data;
+    return *(int const *)elem % 3 != 0;
+}
+
+static void fill(struct mc_array *array, size_t n)
+{
+    mc_array_init(array, int_get_mc_type());
+    int *slots = mc_array_extend_uninit(array, n);
+    for (size_t i = 0; i < n; i++)
+        slots[i] = (int)(i * 2654435761u >> 8);
+}
+
+static double bench_remove(size_t n)
+{
+    struct mc_array array;
+    fill(&array, n);
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < mc_array_len(&array);) {
+        if (keep(mc_array_get_unchecked(&array, i), NULL))
+            ++i;
+        else
+            mc_array_remove(&array, i, NULL);
+    }
+    double elapsed = mc_get_current_time_ms() - start;
+
+    mc_array_cleanup(&array);
+    return elapsed;
+}
+
+static double bench_swap_remove(size_t n)
+{
+    struct mc_array array;
+    fill(&array, n);
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < mc_array_len(&array);) {
+        if (keep(mc_array_get_unchecked(&array, i), NULL))
+            ++i;
+        else
+            mc_array_swap_remove(&array, i, NULL);
+    }
+    double elapsed = mc_get_current_time_ms() - start;
+
+    mc_array_cleanup(&array);
+    return elapsed;
+}
+
+static double bench_retain(size_t n)
+{
+    struct mc_array array;
+    fill(&array, n);
+
+    double start = mc_get_current_time_ms();
+    mc_array_retain(&array, keep, NULL);
+    double elapsed = mc_get_current_time_ms() - start;
+
+    mc_array_cleanup(&array);
+    return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    /* Repeated ordered remove is quadratic; keep it to sizes that finish. */
+    size_t max_remove_n = 200000;
+
+    printf("%10s %16s %16s %16s\n", "n", "remove (ms)", "swap_remove (ms)",
+           "retain (ms)");
+    for (size_t n = 10000; n <= max_n; n *= 10) {
+        if (n <= max_remove_n)
+            printf("%10zu %16.2f", n, bench_remove(n));
+        else
+            printf("%10zu %16s", n, "-");
+        printf(" %16.2f %16.2f\n", bench_swap_remove(n), bench_retain(n));
+    }
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/array.h"
+#include "myclib/time.h"
+
+/* Same per-element callback cost the generic search path pays. */
+static bool equals_needle(void const *elem, void const *needle)
+{
+    return int_get_mc_type()->equal(elem, needle);
+}
+
+static double bench(struct mc_array const *array, int needle, int rounds,
+                    bool vectorized)
+{
+    size_t volatile sink = 0;
+
+    double start = mc_get_current_time_ms();
+    for (int r = 0; r < rounds; r++) {
+        void *found = vectorized
+                          ? mc_array_find(array, &needle)
+                          : mc_array_find_if(array, equals_needle, &needle);
+        sink += found != NULL;
+    }
+    (void)sink;
+    return mc_get_current_time_ms() - start;
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_len = argc > 1 ? strtoul(argv[1], NULL, 10) : 1 << 24;
+
+    printf("%12s %14s %14s %10s\n", "len", "scalar (ms)", "simd (ms)",
+           "speedup");
+    for (size_t len = 64; len <= max_len; len *= 8) {
+        struct mc_array array;
+        mc_array_with_capacity(&array, int_get_mc_type(), len);
+        for (size_t i = 0; i < len; i++)
+            mc_array_push(&array, &(int){(int)i});
+
+        /* The needle is missing so every search scans the whole array. */
+        int rounds = (int)((1 << 26) / len) + 1;
+        double scalar = bench(&array, -1, rounds, false);
+        double simd = bench(&array, -1, rounds, true);
+        printf("%12zu %14.2f %14.2f %9.2fx\n", len, scalar, simd,
+               scalar / simd);
+
+        mc_array_cleanup(&array);
+    }
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/array.h"
+#include "myclib/eytzinger.h"
+#include "myclib/time.h"
+
+#define LOOKUPS (1 << 22)
+
+static unsigned int bench_rand(unsigned int *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 4;
+}
+
+static double bench_binary_search(struct mc_array const *array, size_t len,
+                                  bool branchless)
+{
+    unsigned int seed = 7;
+    size_t volatile sink = 0;
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < LOOKUPS; i++) {
+        int key = (int)(bench_rand(&seed) % (2 * len));
+        size_t index = 0;
+        if (branchless)
+            sink += mc_array_binary_search_branchless(array, &key, &index);
+        else
+            sink += mc_array_binary_search(array, &key, &index);
+    }
+    (void)sink;
+    return mc_get_current_time_ms() - start;
+}
+
+static double bench_eytzinger(struct mc_eytzinger const *index, size_t len)
+{
+    unsigned int seed = 7;
+    size_t volatile sink = 0;
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < LOOKUPS; i++) {
+        int key = (int)(bench_rand(&seed) % (2 * len));
+        sink += mc_eytzinger_find(index, &key) != NULL;
+    }
+    (void)sink;
+    return mc_get_current_time_ms() - start;
+}
+
+static void print_rate(double ms)
+{
+    printf(" %12.2f", LOOKUPS / ms / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    /* Up to 1G elements can be requested, e.g. 1073741824 (needs ~8 GiB). */
+    size_t max_len = argc > 1 ? strtoul(argv[1], NULL, 10) : 1 << 24;
+
+    printf("lookups per second (millions)\n");
+    printf("%12s %12s %12s %12s\n", "len", "classic", "branchless",
+           "eytzinger");
+    for (size_t len = 1024; len <= max_len; len *= 4) {
+        struct mc_array array;
+        mc_array_with_capacity(&array, int_get_mc_type(), len);
+        for (size_t i = 0; i < len; i++)
+            mc_array_push(&array, &(int){(int)(i * 2)});
+
+        struct mc_eytzinger index;
+        mc_eytzinger_init(&index, &array);
+
+        printf("%12zu", len);
+        print_rate(bench_binary_search(&array, len, false));
+        print_rate(bench_binary_search(&array, len, true));
+        print_rate(bench_eytzinger(&index, len));
+        printf("\n");
+
+        mc_eytzinger_cleanup(&index);
+        mc_array_cleanup(&array);
+    }
+
+    return 0;
+}
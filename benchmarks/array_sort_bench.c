@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/array.h"
+#include "myclib/time.h"
+
+struct record {
+    int primary;
+    int secondary;
+    int payload[2];
+};
+
+static int record_compare_secondary(void const *a, void const *b)
+{
+    struct record const *ra = a;
+    struct record const *rb = b;
+    return ra->secondary > rb->secondary ? 1
+                                         : (ra->secondary < rb->secondary ? -1
+                                                                          : 0);
+}
+
+static int record_compare_composite(void const *a, void const *b)
+{
+    struct record const *ra = a;
+    struct record const *rb = b;
+    int res = record_compare_secondary(a, b);
+    if (res != 0)
+        return res;
+    return ra->primary > rb->primary ? 1
+                                     : (ra->primary < rb->primary ? -1 : 0);
+}
+
+MC_DEFINE_POD_TYPE(record, struct record, record_compare_secondary, NULL, NULL)
+
+enum pattern {
+    PATTERN_RANDOM,
+    PATTERN_PARTIALLY_SORTED,
+    PATTERN_SORTED_RUNS,
+    PATTERN_REVERSED,
+};
+
+static char const *const pattern_names[] = {
+    "random",
+    "partially sorted",
+    "sorted runs",
+    "reversed",
+};
+
+static unsigned int bench_rand(unsigned int *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+static void fill(struct mc_array *array, size_t n, enum pattern pattern)
+{
+    unsigned int seed = 42;
+
+    mc_array_clear(array);
+    for (size_t i = 0; i < n; i++) {
+        struct record r = {.primary = (int)i, .payload = {0, 0}};
+        switch (pattern) {
+        case PATTERN_RANDOM:
+            r.secondary = (int)(bench_rand(&seed) % (n / 4 + 1));
+            break;
+        case PATTERN_PARTIALLY_SORTED:
+            /* Sorted with roughly 1% of the elements displaced. */
+            r.secondary = bench_rand(&seed) % 100 == 0
+                              ? (int)(bench_rand(&seed) % n)
+                              : (int)i;
+            break;
+        case PATTERN_SORTED_RUNS:
+            r.secondary = (int)(i % 4096 + (i / 4096) * 7);
+            break;
+        case PATTERN_REVERSED:
+            r.secondary = (int)(n - i);
+            break;
+        }
+        mc_array_push(array, &r);
+    }
+}
+
+static double time_sort(struct mc_array *array, size_t n, enum pattern pattern,
+                        int stable)
+{
+    fill(array, n, pattern);
+
+    double start = mc_get_current_time_ms();
+    if (stable)
+        mc_array_stable_sort_with(array, record_compare_secondary);
+    else
+        mc_array_sort_with(array, record_compare_composite);
+    return mc_get_current_time_ms() - start;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+
+    struct mc_array array;
+    mc_array_with_capacity(&array, record_get_mc_type(), n);
+
+    printf("%zu records\n", n);
+    printf("%-18s %16s %16s\n", "pattern", "qsort composite", "stable sort");
+    for (int p = PATTERN_RANDOM; p <= PATTERN_REVERSED; p++) {
+        double unstable = time_sort(&array, n, p, 0);
+        double stable = time_sort(&array, n, p, 1);
+        printf("%-18s %13.2f ms %13.2f ms\n", pattern_names[p], unstable,
+               stable);
+    }
+
+    mc_array_cleanup(&array);
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/array.h"
+#include "myclib/deque.h"
+#include "myclib/list.h"
+#include "myclib/time.h"
+
+/* Each round keeps `depth` items queued, then cycles `ops` items through. */
+
+static double bench_array(size_t depth, size_t ops)
+{
+    struct mc_array queue;
+    mc_array_init(&queue, int_get_mc_type());
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < depth; i++)
+        mc_array_push(&queue, &(int){(int)i});
+    for (size_t i = 0; i < ops; i++) {
+        int out;
+        mc_array_remove(&queue, 0, &out);
+        mc_array_push(&queue, &out);
+    }
+    double elapsed = mc_get_current_time_ms() - start;
+
+    mc_array_cleanup(&queue);
+    return elapsed;
+}
+
+static double bench_list(size_t depth, size_t ops)
+{
+    struct mc_list queue;
+    mc_list_init(&queue, int_get_mc_type());
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < depth; i++)
+        mc_list_push_back(&queue, &(int){(int)i});
+    for (size_t i = 0; i < ops; i++) {
+        int out;
+        mc_list_pop_front(&queue, &out);
+        mc_list_push_back(&queue, &out);
+    }
+    double elapsed = mc_get_current_time_ms() - start;
+
+    mc_list_cleanup(&queue);
+    return elapsed;
+}
+
+static double bench_deque(size_t depth, size_t ops)
+{
+    struct mc_deque queue;
+    mc_deque_init(&queue, int_get_mc_type());
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < depth; i++)
+        mc_deque_push_back(&queue, &(int){(int)i});
+    for (size_t i = 0; i < ops; i++) {
+        int out;
+        mc_deque_pop_front(&queue, &out);
+        mc_deque_push_back(&queue, &out);
+    }
+    double elapsed = mc_get_current_time_ms() - start;
+
+    mc_deque_cleanup(&queue);
+    return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    size_t ops = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+
+    printf("%zu queue rotations\n", ops);
+    printf("%10s %14s %14s %14s\n", "depth", "mc_array (ms)", "mc_list (ms)",
+           "mc_deque (ms)");
+    for (size_t depth = 16; depth <= 65536; depth *= 16) {
+        printf("%10zu %14.2f %14.2f %14.2f\n", depth, bench_array(depth, ops),
+               bench_list(depth, ops), bench_deque(depth, ops));
+    }
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/array.h"
+#include "myclib/heap.h"
+#include "myclib/time.h"
+
+/* n random pushes followed by n pops in priority order. */
+
+static int *make_keys(size_t n)
+{
+    int *keys = malloc(n * sizeof(*keys));
+    if (!keys)
+        abort();
+    srand(1);
+    for (size_t i = 0; i < n; i++)
+        keys[i] = rand();
+    return keys;
+}
+
+static int int_compare_desc(void const *a, void const *b)
+{
+    int ia = *(int const *)a;
+    int ib = *(int const *)b;
+    return (ib > ia) - (ib < ia);
+}
+
+/* Kept sorted in descending order so the minimum pops off the end. */
+static double bench_sorted_array(int const *keys, size_t n)
+{
+    struct mc_array array;
+    mc_array_init(&array, int_get_mc_type());
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < n; i++) {
+        size_t lo = 0;
+        size_t hi = mc_array_len(&array);
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (int_compare_desc(mc_array_get_unchecked(&array, mid),
+                                 &keys[i]) <= 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        mc_array_insert(&array, lo, &(int){keys[i]});
+    }
+    int out;
+    while (mc_array_pop(&array, &out))
+        ;
+    double elapsed = mc_get_current_time_ms() - start;
+
+    mc_array_cleanup(&array);
+    return elapsed;
+}
+
+static double bench_heap(int const *keys, size_t n, size_t arity)
+{
+    struct mc_heap heap;
+    mc_heap_init_with(&heap, int_get_mc_type(), arity,
+                      int_get_mc_type()->compare);
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < n; i++)
+        mc_heap_push(&heap, &(int){keys[i]});
+    int out;
+    while (mc_heap_pop(&heap, &out))
+        ;
+    double elapsed = mc_get_current_time_ms() - start;
+
+    mc_heap_cleanup(&heap);
+    return elapsed;
+}
+
+static double bench_heapify(int const *keys, size_t n)
+{
+    struct mc_array array;
+    mc_array_from(&array, int_get_mc_type(), (void *)keys, n);
+
+    double start = mc_get_current_time_ms();
+    struct mc_heap heap;
+    mc_heap_from_array(&heap, &array, MC_HEAP_DEFAULT_ARITY,
+                       int_get_mc_type()->compare);
+    int out;
+    while (mc_heap_pop(&heap, &out))
+        ;
+    double elapsed = mc_get_current_time_ms() - start;
+
+    mc_heap_cleanup(&heap);
+    mc_array_cleanup(&array);
+    return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    /* Sorted insertion is quadratic; keep it to sizes that finish. */
+    size_t max_sorted_n = 100000;
+
+    printf("%10s %12s %12s %12s %12s %14s\n", "n", "sorted (ms)",
+           "2-ary (ms)", "4-ary (ms)", "8-ary (ms)", "heapify (ms)");
+    for (size_t n = 1000; n <= max_n; n *= 10) {
+        int *keys = make_keys(n);
+        if (n <= max_sorted_n)
+            printf("%10zu %12.2f", n, bench_sorted_array(keys, n));
+        else
+            printf("%10zu %12s", n, "-");
+        printf(" %12.2f %12.2f %12.2f %14.2f\n", bench_heap(keys, n, 2),
+               bench_heap(keys, n, 4), bench_heap(keys, n, 8),
+               bench_heapify(keys, n));
+        free(keys);
+    }
+
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/allocator.h"
+#include "myclib/array.h"
+#include "myclib/interner.h"
+#include "myclib/map.h"
+#include "myclib/string.h"
+#include "myclib/time.h"
+
+/*
+ * Symbol tables: a stream of TOKENS identifiers drawn from DISTINCT of them
+ * (6 to 40 bytes, so most do not fit inline in mc_string) with a skewed
+ * distribution, as in source code. The baseline maps mc_string to a
+ * uint32_t symbol; the interner assigns the same dense IDs. Memory counts
+ * what the map's allocator hands out and what the interner takes from its
+ * arena. The last row is a downstream map keyed by the ID, which is what
+ * the string-keyed lookup turns into once the symbols are interned.
+ */
+
+enum { DISTINCT = 200000, TOKENS = 4000000 };
+
+static uint64_t state = 88172645463325252ull;
+
+static uint64_t next_random(void)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/* Counts live bytes and forwards to the default allocator. */
+static size_t live_bytes;
+
+static void *counting_alloc(void *ctx, size_t alignment, size_t size)
+{
+    (void)ctx;
+    live_bytes += size;
+    return mc_allocator_alloc(&mc_default_allocator, alignment, size);
+}
+
+static void *counting_realloc(void *ctx, void *ptr, size_t alignment,
+                              size_t old_size, size_t new_size)
+{
+    (void)ctx;
+    live_bytes += new_size - old_size;
+    return mc_allocator_realloc(&mc_default_allocator, ptr, alignment,
+                                old_size, new_size);
+}
+
+static void counting_free(void *ctx, void *ptr, size_t size)
+{
+    (void)ctx;
+    live_bytes -= size;
+    mc_allocator_free(&mc_default_allocator, ptr, size);
+}
+
+static struct mc_allocator const counting_allocator = {
+    .alloc = counting_alloc,
+    .realloc = counting_realloc,
+    .free = counting_free,
+    .ctx = NULL,
+};
+
+static void report(char const *name, size_t ops, double ms)
+{
+    printf("%-28s %10.1f %10.1f\n", name, ms, (double)ops / ms / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+    size_t const tokens = argc > 1 ? strtoul(argv[1], NULL, 10) : TOKENS;
+
+    struct mc_array names;
+    mc_array_init(&names, mc_string_get_mc_type());
+    for (size_t i = 0; i < DISTINCT; i++) {
+        struct mc_string name;
+        mc_string_init(&name);
+        size_t const len = 6 + next_random() % 35;
+        for (size_t c = 0; c < len; c++) {
+            char const ch = (char)('a' + next_random() % 26);
+            mc_string_append_bytes(&name, &ch, 1);
+        }
+        mc_array_push(&names, &name);
+    }
+    /* Squaring a uniform draw favours the low indexes */
+    uint32_t *stream = malloc(tokens * sizeof(*stream));
+    for (size_t i = 0; i < tokens; i++) {
+        double const u = (double)(next_random() >> 11) / 9007199254740992.0;
+        stream[i] = (uint32_t)(u * u * DISTINCT);
+    }
+
+    printf("%zu tokens, %d distinct\n", tokens, DISTINCT);
+    printf("%-28s %10s %10s\n", "operation", "ms", "Mops/s");
+
+    /* Build: each token is looked up and added if new */
+    struct mc_map map;
+    mc_map_init_with_allocator(&map, mc_string_get_mc_type(),
+                               uint32_get_mc_type(), &counting_allocator);
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < tokens; i++) {
+        struct mc_string const *name =
+            mc_array_get_unchecked(&names, stream[i]);
+        if (!mc_map_get(&map, name)) {
+            struct mc_string key;
+            uint32_t symbol = (uint32_t)mc_map_len(&map);
+            mc_string_init_with_allocator(&key, &counting_allocator);
+            mc_string_append_view(&key, mc_string_view(name));
+            mc_map_insert(&map, &key, &symbol);
+        }
+    }
+    report("map<string, id> build", tokens, mc_get_current_time_ms() - start);
+    size_t const map_bytes = live_bytes;
+
+    struct mc_interner interner;
+    mc_interner_init(&interner);
+    start = mc_get_current_time_ms();
+    for (size_t i = 0; i < tokens; i++) {
+        struct mc_string const *name =
+            mc_array_get_unchecked(&names, stream[i]);
+        mc_interner_intern(&interner, mc_string_view(name));
+    }
+    report("interner build", tokens, mc_get_current_time_ms() - start);
+
+    /* Lookup of strings that are all present */
+    size_t check = 0;
+    start = mc_get_current_time_ms();
+    for (size_t i = 0; i < tokens; i++) {
+        struct mc_string const *name =
+            mc_array_get_unchecked(&names, stream[i]);
+        check += *(uint32_t *)mc_map_get(&map, name);
+    }
+    report("map<string, id> lookup", tokens, mc_get_current_time_ms() - start);
+
+    start = mc_get_current_time_ms();
+    for (size_t i = 0; i < tokens; i++) {
+        struct mc_string const *name =
+            mc_array_get_unchecked(&names, stream[i]);
+        uint32_t id;
+        mc_interner_find(&interner, mc_string_view(name), &id);
+        check -= id;
+    }
+    report("interner find", tokens, mc_get_current_time_ms() - start);
+
+    /* Downstream: later stages hold IDs and key their maps by them */
+    struct mc_map by_id;
+    mc_map_init(&by_id, uint32_get_mc_type(), uint32_get_mc_type());
+    for (uint32_t id = 0; id < mc_interner_len(&interner); id++) {
+        uint32_t value = id;
+        mc_map_insert(&by_id, &id, &value);
+    }
+    for (size_t i = 0; i < tokens; i++) {
+        struct mc_string const *name =
+            mc_array_get_unchecked(&names, stream[i]);
+        mc_interner_find(&interner, mc_string_view(name), &stream[i]);
+    }
+    start = mc_get_current_time_ms();
+    for (size_t i = 0; i < tokens; i++)
+        check += *(uint32_t *)mc_map_get(&by_id, &stream[i]) - stream[i];
+    report("map<id, id> lookup", tokens, mc_get_current_time_ms() - start);
+
+    printf("%-28s %10zu bytes\n", "map<string, id> memory", map_bytes);
+    printf("%-28s %10zu bytes\n", "interner memory",
+           mc_interner_memory(&interner));
+
+    mc_map_cleanup(&by_id);
+    mc_interner_cleanup(&interner);
+    mc_map_cleanup(&map);
+    free(stream);
+    mc_array_cleanup(&names);
+
+    if (check != 0) {
+        fprintf(stderr, "result mismatch\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/aligned_malloc.h"
+#include "myclib/array.h"
+#include "myclib/time.h"
+
+/* Random 8-byte reads over one big mc_array, with the large allocation
+ * policy off (plain malloc) and on (2 MiB aligned, huge-page advised). */
+
+static double bench(size_t n, size_t reads, bool mapped)
+{
+    struct mc_large_alloc_policy policy = MC_LARGE_ALLOC_POLICY_DEFAULT();
+    if (!mapped)
+        policy.threshold = 0;
+    mc_set_large_alloc_policy(&policy);
+
+    struct mc_array array;
+    mc_array_with_capacity(&array, uint64_get_mc_type(), n);
+    uint64_t *data = mc_array_extend_uninit(&array, n);
+    for (size_t i = 0; i < n; i++)
+        data[i] = i;
+
+    uint64_t state = 88172645463325252ull;
+    uint64_t sum = 0;
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < reads; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        sum += data[state % n];
+    }
+    double elapsed = mc_get_current_time_ms() - start;
+
+    if (sum == 42)
+        printf("\n");
+    mc_array_cleanup(&array);
+    return elapsed * 1e6 / (double)reads;
+}
+
+int main(int argc, char **argv)
+{
+    size_t mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 4096;
+    size_t reads = 20000000;
+    size_t n = (mib << 20) / sizeof(uint64_t);
+
+    printf("%zu MiB array, %zu random reads\n", mib, reads);
+    printf("%-12s %12s\n", "policy", "ns/read");
+    printf("%-12s %12.2f\n", "malloc", bench(n, reads, false));
+    printf("%-12s %12.2f\n", "huge pages", bench(n, reads, true));
+
+    return 0;
+}
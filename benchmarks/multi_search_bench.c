@@ -0,0 +1,167 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/array.h"
+#include "myclib/multi_search.h"
+#include "myclib/str_view.h"
+#include "myclib/string.h"
+#include "myclib/time.h"
+
+/*
+ * Log scrubbing: PATTERNS keywords of 8 to 16 letters, and lines of random
+ * lowercase words of which about one in a hundred carries a keyword. The
+ * baseline calls mc_str_view_contains once per keyword per line, so it
+ * only runs over a prefix of the text; the automaton checks every line
+ * with one pass and then collects all matches of the whole text at once.
+ */
+
+enum { PATTERNS = 1000, BASELINE_MIB = 8 };
+
+static uint64_t state = 88172645463325252ull;
+
+static uint64_t next_random(void)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static void append_word(struct mc_string *str, size_t len)
+{
+    char word[32];
+    for (size_t i = 0; i < len; i++)
+        word[i] = (char)('a' + next_random() % 26);
+    mc_string_append_bytes(str, word, len);
+}
+
+static void generate(struct mc_string *text, struct mc_array *patterns,
+                     size_t bytes)
+{
+    mc_array_init(patterns, mc_string_get_mc_type());
+    for (size_t i = 0; i < PATTERNS; i++) {
+        struct mc_string pattern;
+        mc_string_init(&pattern);
+        append_word(&pattern, 8 + next_random() % 9);
+        mc_array_push(patterns, &pattern);
+    }
+
+    mc_string_init(text);
+    mc_string_reserve_exact(text, bytes + 256);
+    while (mc_string_len(text) < bytes) {
+        size_t const words = 8 + next_random() % 16;
+        size_t const keyword_at =
+            next_random() % 100 == 0 ? next_random() % words : words;
+        for (size_t w = 0; w < words; w++) {
+            if (w == keyword_at) {
+                struct mc_string *pattern = mc_array_get_unchecked(
+                    patterns, next_random() % PATTERNS);
+                mc_string_append_view(text, mc_string_view(pattern));
+            } else {
+                append_word(text, 2 + next_random() % 7);
+            }
+            mc_string_append_bytes(text, w + 1 < words ? " " : "\n", 1);
+        }
+    }
+}
+
+static void report(char const *name, size_t bytes, size_t hits, double ms)
+{
+    printf("%-22s %10zu %10zu %10.1f %8.3f\n", name, bytes >> 20, hits, ms,
+           (double)bytes / ms / 1e6);
+}
+
+static size_t per_pattern(struct mc_str_view text,
+                          struct mc_array const *patterns)
+{
+    struct mc_str_split split;
+    struct mc_str_view line;
+    size_t hits = 0;
+
+    mc_str_split_init(&split, text, "\n");
+    while (mc_str_split_next(&split, &line)) {
+        for (size_t p = 0; p < mc_array_len(patterns); p++) {
+            struct mc_string const *pattern =
+                mc_array_get_unchecked(patterns, p);
+            if (mc_str_view_contains(line, mc_string_view(pattern))) {
+                ++hits;
+                break;
+            }
+        }
+    }
+    return hits;
+}
+
+static size_t per_line(struct mc_str_view text,
+                       struct mc_multi_search const *search)
+{
+    struct mc_str_split split;
+    struct mc_str_view line;
+    size_t hits = 0;
+
+    mc_str_split_init(&split, text, "\n");
+    while (mc_str_split_next(&split, &line))
+        hits += mc_multi_search_contains(search, line);
+    return hits;
+}
+
+int main(int argc, char **argv)
+{
+    size_t const mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 1024;
+
+    struct mc_string text;
+    struct mc_array patterns;
+    generate(&text, &patterns, mib << 20);
+    struct mc_str_view const all = mc_string_view(&text);
+
+    double start = mc_get_current_time_ms();
+    struct mc_multi_search search;
+    mc_multi_search_init(&search, &patterns);
+    double build_ms = mc_get_current_time_ms() - start;
+    printf("%d patterns, %zu states x %zu classes, built in %.2f ms\n",
+           PATTERNS, search.state_count, search.class_count, build_ms);
+    printf("%-22s %10s %10s %10s %8s\n", "method", "MiB", "hits", "ms",
+           "GB/s");
+
+    /* The prefix ends on a line break so both sides see the same lines. */
+    size_t prefix_len = (size_t)BASELINE_MIB << 20;
+    if (prefix_len > all.len)
+        prefix_len = all.len;
+    size_t newline;
+    if (mc_str_view_rfind_ch(mc_str_view_substr(all, 0, prefix_len), '\n',
+                             &newline))
+        prefix_len = newline + 1;
+    struct mc_str_view const prefix = mc_str_view_substr(all, 0, prefix_len);
+
+    start = mc_get_current_time_ms();
+    size_t const baseline_hits = per_pattern(prefix, &patterns);
+    report("contains per pattern", prefix.len, baseline_hits,
+           mc_get_current_time_ms() - start);
+
+    start = mc_get_current_time_ms();
+    size_t const prefix_hits = per_line(prefix, &search);
+    report("automaton per line", prefix.len, prefix_hits,
+           mc_get_current_time_ms() - start);
+
+    start = mc_get_current_time_ms();
+    size_t const line_hits = per_line(all, &search);
+    report("automaton per line", all.len, line_hits,
+           mc_get_current_time_ms() - start);
+
+    start = mc_get_current_time_ms();
+    struct mc_array matches;
+    mc_multi_search_find_all(&search, all, &matches);
+    report("automaton all matches", all.len, mc_array_len(&matches),
+           mc_get_current_time_ms() - start);
+
+    mc_array_cleanup(&matches);
+    mc_multi_search_cleanup(&search);
+    mc_array_cleanup(&patterns);
+    mc_string_cleanup(&text);
+
+    if (baseline_hits != prefix_hits) {
+        fprintf(stderr, "result mismatch\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/aligned_malloc.h"
+#include "myclib/list.h"
+#include "myclib/map.h"
+#include "myclib/pool.h"
+#include "myclib/time.h"
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+/*
+ * Push/pop churn: a queue of WINDOW elements slides forward by one element
+ * per operation, so every push allocates a node and every pop frees one.
+ * The map variant fills WINDOW entries and clears them again, which keeps
+ * the table free of tombstones so that only entry allocation differs.
+ */
+
+enum { WINDOW = 1024, THREADS = 4, BATCH = 64 };
+
+static double list_churn(size_t ops, bool use_pool, long long *check)
+{
+    struct mc_list list;
+    mc_list_init(&list, llong_get_mc_type());
+    if (use_pool)
+        mc_list_use_pool(&list, NULL);
+
+    double start = mc_get_current_time_ms();
+    for (long long i = 0; i < WINDOW; i++)
+        mc_list_push_back(&list, &i);
+    for (long long i = WINDOW; i < (long long)ops; i++) {
+        long long out;
+        mc_list_pop_front(&list, &out);
+        *check += out;
+        mc_list_push_back(&list, &i);
+    }
+    double elapsed = mc_get_current_time_ms() - start;
+
+    mc_list_cleanup(&list);
+    return elapsed;
+}
+
+static double map_churn(size_t ops, bool use_pool, long long *check)
+{
+    struct mc_map map;
+    mc_map_init(&map, llong_get_mc_type(), llong_get_mc_type());
+    if (use_pool)
+        mc_map_use_pool(&map, NULL);
+
+    double start = mc_get_current_time_ms();
+    for (size_t round = 0; round < ops / WINDOW; round++) {
+        for (long long i = 0; i < WINDOW; i++)
+            mc_map_insert(&map, &i, &(long long){i + (long long)round});
+        *check += *(long long *)mc_map_get(&map, &(long long){WINDOW / 2});
+        mc_map_clear(&map);
+    }
+    double elapsed = mc_get_current_time_ms() - start;
+
+    mc_map_cleanup(&map);
+    return elapsed;
+}
+
+#if !defined(_WIN32)
+struct worker {
+    struct mc_pool *pool;
+    size_t rounds;
+};
+
+static void *worker_run(void *arg)
+{
+    struct worker *worker = arg;
+    void *blocks[BATCH];
+
+    for (size_t round = 0; round < worker->rounds; round++) {
+        for (size_t i = 0; i < BATCH; i++) {
+            blocks[i] = worker->pool ? mc_pool_alloc(worker->pool)
+                                     : mc_aligned_malloc(16, 48);
+            *(volatile size_t *)blocks[i] = i;
+        }
+        for (size_t i = 0; i < BATCH; i++) {
+            if (worker->pool)
+                mc_pool_free(worker->pool, blocks[i]);
+            else
+                mc_aligned_free(blocks[i]);
+        }
+    }
+    return NULL;
+}
+
+static double threaded_churn(size_t ops, struct mc_pool *pool)
+{
+    pthread_t threads[THREADS];
+    struct worker workers[THREADS];
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < THREADS; i++) {
+        workers[i].pool = pool;
+        workers[i].rounds = ops / BATCH / THREADS;
+        pthread_create(&threads[i], NULL, worker_run, &workers[i]);
+    }
+    for (size_t i = 0; i < THREADS; i++)
+        pthread_join(threads[i], NULL);
+    return mc_get_current_time_ms() - start;
+}
+#endif
+
+static void report(char const *name, size_t ops, double ms)
+{
+    printf("%-24s %12.2f %12.2f\n", name, ms, ms * 1e6 / (double)ops);
+}
+
+int main(int argc, char **argv)
+{
+    size_t ops = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+    long long check_heap = 0;
+    long long check_pool = 0;
+
+    printf("%zu operations\n", ops);
+    printf("%-24s %12s %12s\n", "case", "total (ms)", "per op (ns)");
+
+    report("list heap", ops, list_churn(ops, false, &check_heap));
+    report("list pool", ops, list_churn(ops, true, &check_pool));
+    report("map heap", ops, map_churn(ops, false, &check_heap));
+    report("map pool", ops, map_churn(ops, true, &check_pool));
+
+    if (check_heap != check_pool) {
+        fprintf(stderr, "result mismatch\n");
+        return 1;
+    }
+
+#if !defined(_WIN32)
+    struct mc_pool pool;
+    mc_pool_init(&pool, 48, 16, MC_POOL_OPTION_THREAD_CACHE);
+    report("4 threads heap", ops, threaded_churn(ops, NULL));
+    report("4 threads pool+cache", ops, threaded_churn(ops, &pool));
+    mc_pool_cleanup(&pool);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/rope.h"
+#include "myclib/string.h"
+#include "myclib/time.h"
+
+/*
+ * Random edits on a large document: each edit either inserts 1 to 64 bytes
+ * or removes as many at a uniformly random position. mc_string moves the
+ * tail on every edit, so it only gets a few hundred; the rope gets many
+ * more. Both then replay the same edits on a smaller copy and must agree.
+ */
+
+enum { STRING_EDITS = 200, ROPE_EDITS = 1000000, READS = 1000000 };
+
+static uint64_t state = 88172645463325252ull;
+
+static uint64_t next_random(void)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/* What mc_string_remove does once it has found the bytes to drop. */
+static void string_erase(struct mc_string *str, size_t pos, size_t len)
+{
+    char *const data = mc_string_data(str);
+    size_t const str_len = mc_string_len(str);
+    memmove(data + pos, data + pos + len, str_len - pos - len + 1);
+    mc_string_set_len(str, str_len - len);
+}
+
+struct edit {
+    size_t pos;
+    size_t len;
+    bool insert;
+};
+
+static void next_edit(struct edit *edit, size_t doc_len)
+{
+    edit->insert = next_random() % 2 == 0 || doc_len < 64;
+    edit->len = 1 + next_random() % 64;
+    edit->pos = next_random() % (doc_len + 1);
+    if (!edit->insert && edit->pos + edit->len > doc_len)
+        edit->pos = doc_len - edit->len;
+}
+
+static void run_string(struct mc_string *str, size_t edits, char const *text)
+{
+    char piece[65];
+    for (size_t e = 0; e < edits; e++) {
+        struct edit edit;
+        next_edit(&edit, mc_string_len(str));
+        if (edit.insert) {
+            memcpy(piece, text, edit.len);
+            piece[edit.len] = '\0';
+            mc_string_insert(str, edit.pos, piece);
+        } else {
+            string_erase(str, edit.pos, edit.len);
+        }
+    }
+}
+
+static void run_rope(struct mc_rope *rope, size_t edits, char const *text)
+{
+    for (size_t e = 0; e < edits; e++) {
+        struct edit edit;
+        next_edit(&edit, mc_rope_len(rope));
+        if (edit.insert)
+            mc_rope_insert(rope, edit.pos, mc_str_view_make(text, edit.len));
+        else
+            mc_rope_remove(rope, edit.pos, edit.len);
+    }
+}
+
+static void report(char const *name, size_t count, double ms)
+{
+    printf("%-26s %10zu %10.1f %12.3f\n", name, count, ms,
+           ms * 1000.0 / (double)count);
+}
+
+int main(int argc, char **argv)
+{
+    size_t const mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 100;
+    size_t const size = mib << 20;
+
+    char *text = malloc(size);
+    for (size_t i = 0; i < size; i++)
+        text[i] = (char)('a' + next_random() % 26);
+    struct mc_str_view const doc = mc_str_view_make(text, size);
+
+    printf("%zu MiB document\n", mib);
+    printf("%-26s %10s %10s %12s\n", "operation", "count", "ms", "us each");
+
+    struct mc_string str;
+    mc_string_init(&str);
+    mc_string_append_view(&str, doc);
+    double start = mc_get_current_time_ms();
+    run_string(&str, STRING_EDITS, text);
+    report("string random edit", STRING_EDITS,
+           mc_get_current_time_ms() - start);
+    mc_string_cleanup(&str);
+
+    start = mc_get_current_time_ms();
+    struct mc_rope rope;
+    mc_rope_from_view(&rope, doc);
+    report("rope build", 1, mc_get_current_time_ms() - start);
+
+    start = mc_get_current_time_ms();
+    run_rope(&rope, ROPE_EDITS, text);
+    report("rope random edit", ROPE_EDITS, mc_get_current_time_ms() - start);
+
+    struct mc_string part;
+    mc_string_init(&part);
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < READS; r++) {
+        size_t const pos = next_random() % (mc_rope_len(&rope) - 64);
+        mc_string_clear(&part);
+        mc_rope_substr(&rope, pos, 64, &part);
+    }
+    report("rope 64-byte substr", READS, mc_get_current_time_ms() - start);
+    mc_string_cleanup(&part);
+
+    struct mc_string flat;
+    mc_string_init(&flat);
+    start = mc_get_current_time_ms();
+    mc_rope_flatten(&rope, &flat);
+    report("rope flatten", 1, mc_get_current_time_ms() - start);
+    mc_string_cleanup(&flat);
+    mc_rope_cleanup(&rope);
+
+    /* The same edits on a 1 MiB prefix, checked against each other */
+    uint64_t const seed = state;
+    struct mc_str_view const small = mc_str_view_substr(doc, 0, 1 << 20);
+    mc_string_init(&str);
+    mc_string_append_view(&str, small);
+    run_string(&str, 10000, text);
+    state = seed;
+    mc_rope_from_view(&rope, small);
+    run_rope(&rope, 10000, text);
+    mc_string_init(&flat);
+    mc_rope_flatten(&rope, &flat);
+    int const failed = !mc_string_equal(&str, &flat);
+    if (failed)
+        fprintf(stderr, "result mismatch\n");
+
+    mc_string_cleanup(&flat);
+    mc_rope_cleanup(&rope);
+    mc_string_cleanup(&str);
+    free(text);
+    return failed;
+}
@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/array.h"
+#include "myclib/segmented_array.h"
+#include "myclib/time.h"
+
+/* Reports total push time, the slowest single push (the reallocation spike
+ * for mc_array) and one full indexed read pass. */
+
+struct result {
+    double push_ms;
+    double worst_push_us;
+    double read_ms;
+};
+
+static struct result bench_array(size_t n)
+{
+    struct result res = {0};
+    struct mc_array array;
+    mc_array_init(&array, long_get_mc_type());
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < n; i++) {
+        double t = mc_get_current_time_us();
+        mc_array_push(&array, &(long){(long)i});
+        t = mc_get_current_time_us() - t;
+        if (t > res.worst_push_us)
+            res.worst_push_us = t;
+    }
+    res.push_ms = mc_get_current_time_ms() - start;
+
+    start = mc_get_current_time_ms();
+    long sum = 0;
+    for (size_t i = 0; i < n; i++)
+        sum += *(long *)mc_array_get_unchecked(&array, i);
+    res.read_ms = mc_get_current_time_ms() - start;
+    if (sum != (long)(n * (n - 1) / 2))
+        abort();
+
+    mc_array_cleanup(&array);
+    return res;
+}
+
+static struct result bench_segmented(size_t n)
+{
+    struct result res = {0};
+    struct mc_segmented_array array;
+    mc_segmented_array_init(&array, long_get_mc_type());
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < n; i++) {
+        double t = mc_get_current_time_us();
+        mc_segmented_array_push(&array, &(long){(long)i});
+        t = mc_get_current_time_us() - t;
+        if (t > res.worst_push_us)
+            res.worst_push_us = t;
+    }
+    res.push_ms = mc_get_current_time_ms() - start;
+
+    start = mc_get_current_time_ms();
+    long sum = 0;
+    for (size_t i = 0; i < n; i++)
+        sum += *(long *)mc_segmented_array_get_unchecked(&array, i);
+    res.read_ms = mc_get_current_time_ms() - start;
+    if (sum != (long)(n * (n - 1) / 2))
+        abort();
+
+    mc_segmented_array_cleanup(&array);
+    return res;
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_n = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000000;
+
+    printf("%10s %-10s %12s %16s %12s\n", "n", "container", "push (ms)",
+           "worst push (us)", "read (ms)");
+    for (size_t n = 1000000; n <= max_n; n *= 10) {
+        struct result a = bench_array(n);
+        struct result s = bench_segmented(n);
+        printf("%10zu %-10s %12.2f %16.1f %12.2f\n", n, "mc_array", a.push_ms,
+               a.worst_push_us, a.read_ms);
+        printf("%10zu %-10s %12.2f %16.1f %12.2f\n", n, "segmented",
+               s.push_ms, s.worst_push_us, s.read_ms);
+    }
+
+    return 0;
+}
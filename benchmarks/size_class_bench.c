@@ -0,0 +1,150 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/aligned_malloc.h"
+#include "myclib/time.h"
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Heap backend against the size-class backend of mc_aligned_malloc.
+ * Throughput: every thread keeps WINDOW live blocks of 8..1024 bytes and
+ * replaces a random one per operation. Overhead: resident memory gained
+ * while LIVE blocks of the same sizes are held, relative to the bytes
+ * requested, measured first so that neither run reuses memory released
+ * by the other.
+ */
+
+enum { WINDOW = 4096, LIVE = 1000000, MAX_THREADS = 8 };
+
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static size_t random_size(uint64_t *state)
+{
+    return 8 + next_random(state) % 1017;
+}
+
+struct worker {
+    size_t ops;
+    uint64_t seed;
+};
+
+static void *worker_run(void *arg)
+{
+    struct worker *worker = arg;
+    void **blocks = calloc(WINDOW, sizeof(*blocks));
+    uint64_t state = worker->seed;
+
+    for (size_t i = 0; i < worker->ops; i++) {
+        size_t slot = next_random(&state) % WINDOW;
+        mc_aligned_free(blocks[slot]);
+        size_t size = random_size(&state);
+        blocks[slot] = mc_aligned_malloc(16, size);
+        memset(blocks[slot], 0, 8);
+    }
+
+    for (size_t i = 0; i < WINDOW; i++)
+        mc_aligned_free(blocks[i]);
+    free(blocks);
+    return NULL;
+}
+
+static double throughput(size_t threads, size_t ops)
+{
+    struct worker workers[MAX_THREADS];
+    double start = mc_get_current_time_ms();
+#if !defined(_WIN32)
+    pthread_t ids[MAX_THREADS];
+    for (size_t i = 0; i < threads; i++) {
+        workers[i].ops = ops;
+        workers[i].seed = 88172645463325252ull + i;
+        pthread_create(&ids[i], NULL, worker_run, &workers[i]);
+    }
+    for (size_t i = 0; i < threads; i++)
+        pthread_join(ids[i], NULL);
+#else
+    threads = 1;
+    workers[0].ops = ops;
+    workers[0].seed = 88172645463325252ull;
+    worker_run(&workers[0]);
+#endif
+    double elapsed = mc_get_current_time_ms() - start;
+    return (double)(threads * ops) / elapsed / 1e3;
+}
+
+static size_t resident_bytes(void)
+{
+#if defined(__linux__)
+    FILE *file = fopen("/proc/self/statm", "r");
+    unsigned long pages = 0;
+    unsigned long resident = 0;
+    if (file) {
+        if (fscanf(file, "%lu %lu", &pages, &resident) != 2)
+            resident = 0;
+        fclose(file);
+    }
+    return resident * (size_t)sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+static double overhead(void)
+{
+    void **blocks = malloc(LIVE * sizeof(*blocks));
+    memset(blocks, 0, LIVE * sizeof(*blocks));
+    uint64_t state = 2463534242ull;
+    size_t requested = 0;
+
+    size_t before = resident_bytes();
+    for (size_t i = 0; i < LIVE; i++) {
+        size_t size = random_size(&state);
+        blocks[i] = mc_aligned_malloc(16, size);
+        memset(blocks[i], 1, size);
+        requested += size;
+    }
+    size_t after = resident_bytes();
+
+    for (size_t i = 0; i < LIVE; i++)
+        mc_aligned_free(blocks[i]);
+    free(blocks);
+
+    if (!before || after < before)
+        return 0;
+    return 100.0 * ((double)(after - before) - (double)requested) /
+           (double)requested;
+}
+
+int main(int argc, char **argv)
+{
+    size_t ops = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000000;
+    enum mc_aligned_malloc_backend backends[] = {
+        MC_ALIGNED_MALLOC_BACKEND_HEAP, MC_ALIGNED_MALLOC_BACKEND_SIZE_CLASS};
+    char const *names[] = {"heap", "size class"};
+
+    printf("%zu ops per thread, %d live blocks for overhead\n", ops, LIVE);
+    printf("%-12s %10s %10s %10s %10s %12s\n", "backend", "1 thr", "2 thr",
+           "4 thr", "8 thr", "overhead");
+    for (size_t b = 0; b < 2; b++) {
+        mc_set_aligned_malloc_backend(backends[b]);
+        double extra = overhead();
+        printf("%-12s", names[b]);
+        for (size_t threads = 1; threads <= MAX_THREADS; threads *= 2)
+            printf(" %10.2f", throughput(threads, ops));
+        printf(" %11.1f%%\n", extra);
+    }
+    printf("(throughput in Mops/s)\n");
+
+    mc_set_aligned_malloc_backend(MC_ALIGNED_MALLOC_BACKEND_HEAP);
+    return 0;
+}
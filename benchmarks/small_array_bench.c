@@ -0,0 +1,54 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/array.h"
+#include "myclib/small_array.h"
+#include "myclib/time.h"
+
+static double bench_array(size_t count, size_t elems)
+{
+    size_t volatile sink = 0;
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < count; i++) {
+        struct mc_array array;
+        mc_array_init(&array, int64_get_mc_type());
+        for (size_t j = 0; j < elems; j++)
+            mc_array_push(&array, &(int64_t){(int64_t)j});
+        sink += mc_array_len(&array);
+        mc_array_cleanup(&array);
+    }
+    (void)sink;
+    return mc_get_current_time_ms() - start;
+}
+
+static double bench_small_array(size_t count, size_t elems)
+{
+    size_t volatile sink = 0;
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < count; i++) {
+        struct mc_small_array array;
+        mc_small_array_init(&array, int64_get_mc_type());
+        for (size_t j = 0; j < elems; j++)
+            mc_small_array_push(&array, &(int64_t){(int64_t)j});
+        sink += mc_small_array_len(&array);
+        mc_small_array_cleanup(&array);
+    }
+    (void)sink;
+    return mc_get_current_time_ms() - start;
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 5000000;
+
+    printf("%zu short arrays of int64\n", count);
+    printf("%6s %14s %18s\n", "elems", "mc_array (ms)", "mc_small_array (ms)");
+    for (size_t elems = 0; elems <= 12; elems += 2) {
+        double array = bench_array(count, elems);
+        double small = bench_small_array(count, elems);
+        printf("%6zu %14.2f %18.2f\n", elems, array, small);
+    }
+
+    return 0;
+}
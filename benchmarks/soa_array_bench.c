@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/array.h"
+#include "myclib/soa_array.h"
+#include "myclib/time.h"
+
+/* A 64-byte record of which the scan only reads `price`. */
+struct order {
+    long id;
+    double price;
+    double quantity;
+    long timestamp;
+    char symbol[32];
+};
+
+static int order_compare(void const *a, void const *b)
+{
+    long ia = ((struct order const *)a)->id;
+    long ib = ((struct order const *)b)->id;
+    return (ia > ib) - (ia < ib);
+}
+
+MC_DEFINE_POD_TYPE(order, struct order, order_compare, NULL, NULL)
+
+enum { ROUNDS = 10 };
+
+static double bench_array(size_t n, double *sum)
+{
+    struct mc_array orders;
+    mc_array_init(&orders, order_get_mc_type());
+    struct order *slots = mc_array_extend_uninit(&orders, n);
+    for (size_t i = 0; i < n; i++)
+        slots[i] = (struct order){.id = (long)i, .price = (double)(i % 100)};
+
+    double start = mc_get_current_time_ms();
+    double total = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+        struct order const *data = mc_array_get_unchecked(&orders, 0);
+        for (size_t i = 0; i < n; i++)
+            total += data[i].price;
+    }
+    double elapsed = mc_get_current_time_ms() - start;
+
+    *sum = total;
+    mc_array_cleanup(&orders);
+    return elapsed / ROUNDS;
+}
+
+static double bench_soa(size_t n, double *sum)
+{
+    struct mc_type const *types[] = {long_get_mc_type(), double_get_mc_type(),
+                                     double_get_mc_type(), long_get_mc_type()};
+    struct mc_soa_array orders;
+    mc_soa_array_with_capacity(&orders, types, 4, n);
+    for (size_t i = 0; i < n; i++) {
+        long id = (long)i;
+        double price = (double)(i % 100);
+        double quantity = 0;
+        long timestamp = 0;
+        void *fields[] = {&id, &price, &quantity, &timestamp};
+        mc_soa_array_push(&orders, fields);
+    }
+
+    double start = mc_get_current_time_ms();
+    double total = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+        double const *prices = mc_soa_array_column(&orders, 1);
+        for (size_t i = 0; i < n; i++)
+            total += prices[i];
+    }
+    double elapsed = mc_get_current_time_ms() - start;
+
+    *sum = total;
+    mc_soa_array_cleanup(&orders);
+    return elapsed / ROUNDS;
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+
+    printf("sum of one double field per %zu-byte record\n",
+           sizeof(struct order));
+    printf("%10s %16s %16s\n", "n", "mc_array (ms)", "mc_soa (ms)");
+    for (size_t n = 10000; n <= max_n; n *= 10) {
+        double array_sum, soa_sum;
+        double array_ms = bench_array(n, &array_sum);
+        double soa_ms = bench_soa(n, &soa_sum);
+        if (array_sum != soa_sum) {
+            fprintf(stderr, "sum mismatch\n");
+            return 1;
+        }
+        printf("%10zu %16.3f %16.3f\n", n, array_ms, soa_ms);
+    }
+
+    return 0;
+}
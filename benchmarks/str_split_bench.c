@@ -0,0 +1,91 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/array.h"
+#include "myclib/str_view.h"
+#include "myclib/string.h"
+#include "myclib/time.h"
+
+/*
+ * Tokenizes a generated text of space and newline separated words, first
+ * with mc_string_split, which copies every token into its own mc_string,
+ * then with mc_string_split_views and with the lazy mc_str_split iterator,
+ * which only hand out pointers into the text.
+ */
+
+static void generate(struct mc_string *text, size_t bytes)
+{
+    uint64_t state = 88172645463325252ull;
+    mc_string_init(text);
+    mc_string_reserve_exact(text, bytes + 64);
+    while (mc_string_len(text) < bytes) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        char word[40];
+        size_t len = 1 + state % 31;
+        for (size_t i = 0; i < len; i++)
+            word[i] = (char)('a' + (state >> (i % 16 * 4)) % 26);
+        word[len] = state % 8 == 0 ? '\n' : ' ';
+        mc_string_append_bytes(text, word, len + 1);
+    }
+}
+
+static void report(char const *name, size_t bytes, size_t tokens, double ms)
+{
+    printf("%-12s %12zu %12.2f %10.2f\n", name, tokens, ms,
+           (double)bytes / ms / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    size_t mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 64;
+    size_t bytes = mib << 20;
+
+    struct mc_string text;
+    generate(&text, bytes);
+    bytes = mc_string_len(&text);
+
+    printf("%zu MiB of text\n", mib);
+    printf("%-12s %12s %12s %10s\n", "method", "tokens", "time (ms)",
+           "GB/s");
+
+    struct mc_array parts;
+    double start = mc_get_current_time_ms();
+    mc_string_split(&text, " \n", &parts);
+    size_t copied = mc_array_len(&parts);
+    mc_array_cleanup(&parts);
+    report("copy", bytes, copied, mc_get_current_time_ms() - start);
+
+    start = mc_get_current_time_ms();
+    mc_string_split_views(&text, " \n", &parts);
+    size_t viewed = mc_array_len(&parts);
+    mc_array_cleanup(&parts);
+    report("views", bytes, viewed, mc_get_current_time_ms() - start);
+
+    struct mc_str_split split;
+    struct mc_str_view token;
+    size_t lazy = 0;
+    size_t total_len = 0;
+    start = mc_get_current_time_ms();
+    mc_string_split_iter(&split, &text, " \n");
+    while (mc_str_split_next(&split, &token)) {
+        ++lazy;
+        total_len += token.len;
+    }
+    report("lazy", bytes, lazy, mc_get_current_time_ms() - start);
+
+    size_t lines = 0;
+    start = mc_get_current_time_ms();
+    mc_string_split_iter(&split, &text, "\n");
+    while (mc_str_split_next(&split, &token))
+        ++lines;
+    report("lazy lines", bytes, lines, mc_get_current_time_ms() - start);
+
+    mc_string_cleanup(&text);
+    if (copied != viewed || viewed != lazy || total_len == 0) {
+        fprintf(stderr, "token count mismatch\n");
+        return 1;
+    }
+    return 0;
+}
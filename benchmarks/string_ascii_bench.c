@@ -0,0 +1,171 @@
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "myclib/hash.h"
+#include "myclib/string.h"
+#include "myclib/time.h"
+
+/*
+ * ASCII kernels over a buffer of mixed-case words, in GB/s. The baselines
+ * are what mc_string did before: a toupper/tolower or isspace call per
+ * byte, strncasecmp, and a lowercase copy hashed afterwards. The trims run
+ * over whitespace padding as long as the text. A last pair converts text
+ * with one accented letter in every 256 bytes, which sends those vectors
+ * through the per-byte fallback.
+ */
+
+static uint64_t state = 88172645463325252ull;
+
+static uint64_t next_random(void)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static void fill_words(char *text, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        uint64_t const r = next_random();
+        text[i] = r % 7 == 0 ? ' ' : (char)((r % 2 ? 'a' : 'A') + r % 26);
+    }
+}
+
+static void report(char const *name, size_t bytes, size_t reps, double ms)
+{
+    printf("%-30s %10.1f %8.2f\n", name, ms,
+           (double)bytes * (double)reps / ms / 1e6);
+}
+
+static void byte_loop_upper(char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+        data[i] = (char)toupper((unsigned char)data[i]);
+}
+
+static size_t byte_loop_trim(char const *data, size_t len)
+{
+    size_t i = 0;
+    while (i < len && isspace((unsigned char)data[i]))
+        ++i;
+    while (len > i && isspace((unsigned char)data[len - 1]))
+        --len;
+    return len - i;
+}
+
+static size_t copy_lower_hash(char const *data, size_t len)
+{
+    char folded[256];
+    size_t hash = MC_HASH_INIT;
+    for (size_t pos = 0; pos < len; pos += sizeof(folded)) {
+        size_t const n = len - pos < sizeof(folded) ? len - pos : 256;
+        for (size_t i = 0; i < n; i++)
+            folded[i] = (char)tolower((unsigned char)data[pos + i]);
+        hash = MC_HASH_UPDATE(hash, folded, n);
+    }
+    return hash;
+}
+
+int main(int argc, char **argv)
+{
+    size_t const mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 4;
+    size_t const len = mib << 20;
+    size_t const reps = 1 + ((size_t)1 << 30) / len;
+
+    struct mc_string str, other;
+    mc_string_init(&str);
+    char *const text = malloc(len);
+    fill_words(text, len);
+    mc_string_append_bytes(&str, text, len);
+    mc_string_copy(&other, &str);
+    mc_string_to_upper(&other);
+
+    printf("%zu MiB of text, %zu passes each\n", mib, reps);
+    printf("%-30s %10s %8s\n", "operation", "ms", "GB/s");
+
+    int failed = 0;
+    double start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        byte_loop_upper(mc_string_data(&str), len);
+    report("toupper byte loop", len, reps, mc_get_current_time_ms() - start);
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        mc_string_to_upper(&str);
+    report("mc_string_to_upper", len, reps, mc_get_current_time_ms() - start);
+    failed |= !mc_string_equal(&str, &other);
+
+    mc_string_to_lower(&str);
+    int order = 0;
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        order |= strncasecmp(mc_string_c_str(&str), mc_string_c_str(&other),
+                             len);
+    report("strncasecmp", len, reps, mc_get_current_time_ms() - start);
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        order |= mc_string_compare_ignore_case(&str, &other);
+    report("mc_string_compare_ignore_case", len, reps,
+           mc_get_current_time_ms() - start);
+    failed |= order != 0;
+
+    size_t hash = 0;
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        hash ^= copy_lower_hash(mc_string_c_str(&other), len);
+    report("tolower copy + hash", len, reps, mc_get_current_time_ms() - start);
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        hash ^= mc_string_hash_ignore_case(&other);
+    report("mc_string_hash_ignore_case", len, reps,
+           mc_get_current_time_ms() - start);
+    failed |= hash != 0 ||
+              mc_string_hash_ignore_case(&other) != mc_string_hash(&str);
+
+    /* Padding on both sides, as long as the text in total */
+    struct mc_string padded;
+    mc_string_init(&padded);
+    for (size_t i = 0; i < len / 2; i++)
+        mc_string_append_bytes(&padded, i % 5 ? " " : "\t", 1);
+    mc_string_append(&padded, "x");
+    for (size_t i = 0; i < len / 2; i++)
+        mc_string_append_bytes(&padded, i % 3 ? " " : "\n", 1);
+    size_t kept = 0;
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        kept += byte_loop_trim(mc_string_c_str(&padded), len + 1);
+    report("isspace trim", len, reps, mc_get_current_time_ms() - start);
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        kept += mc_str_view_trim(mc_string_view(&padded)).len;
+    report("mc_str_view_trim", len, reps, mc_get_current_time_ms() - start);
+    failed |= kept != 2 * reps;
+    mc_string_cleanup(&padded);
+
+    /* An accented letter, in UTF-8, every 256 bytes */
+    for (size_t i = 0; i + 2 <= len; i += 256)
+        memcpy(mc_string_data(&str) + i, "\xc3\xa9", 2);
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        byte_loop_upper(mc_string_data(&str), len);
+    report("toupper byte loop, non-ASCII", len, reps,
+           mc_get_current_time_ms() - start);
+    mc_string_cleanup(&other);
+    mc_string_copy(&other, &str);
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        mc_string_to_upper(&str);
+    report("mc_string_to_upper, non-ASCII", len, reps,
+           mc_get_current_time_ms() - start);
+    failed |= !mc_string_equal(&str, &other);
+
+    if (failed)
+        fprintf(stderr, "result mismatch\n");
+    free(text);
+    mc_string_cleanup(&other);
+    mc_string_cleanup(&str);
+    return failed;
+}
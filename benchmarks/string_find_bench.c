@@ -0,0 +1,123 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/simd.h"
+#include "myclib/time.h"
+
+/*
+ * Substring search over random text in 'a'..'y'. Needles are drawn from the
+ * same letters with a 'z' in the middle, so they cannot match early but
+ * still pass the first and last byte filter now and then. The needle sits
+ * at both ends of the haystack, so a forward search runs to the last copy
+ * and a reverse search back to the first. The baselines are what mc_string_find
+ * and mc_string_rfind used before: strstr (strchr for one byte) and a byte
+ * loop with memcmp.
+ */
+
+static uint64_t state = 88172645463325252ull;
+
+static char random_letter(void)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (char)('a' + state % 25);
+}
+
+static size_t byte_loop_rfind(char const *data, size_t len,
+                              char const *needle, size_t needle_len)
+{
+    for (size_t i = len - needle_len + 1; i-- > 0;) {
+        if (data[i] == needle[0] && memcmp(data + i, needle, needle_len) == 0)
+            return i;
+    }
+    return len;
+}
+
+static double gbps(size_t bytes, size_t reps, double ms)
+{
+    return (double)bytes * (double)reps / ms / 1e6;
+}
+
+static void run(char *text, size_t len, size_t needle_len)
+{
+    char needle[64];
+    for (size_t i = 0; i < needle_len; i++)
+        needle[i] = random_letter();
+    needle[needle_len / 2] = 'z';
+    for (size_t i = 0; i < len; i++)
+        text[i] = random_letter();
+    memcpy(text, needle, needle_len);
+    memcpy(text + len - needle_len, needle, needle_len);
+    text[len] = '\0';
+
+    char cneedle[65];
+    memcpy(cneedle, needle, needle_len);
+    cneedle[needle_len] = '\0';
+    size_t const reps = 1 + ((size_t)256 << 20) / len;
+    /*
+     * Searches start one byte in, so the copy at offset 0 is skipped. The
+     * volatile read keeps the compiler from hoisting the pure strstr out
+     * of the loop.
+     */
+    char const *volatile hay_ref = text + 1;
+    size_t const hay_len = len - 1;
+    size_t check = 0;
+
+    double start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++) {
+        char const *hay = hay_ref;
+        char const *p = needle_len == 1 ? strchr(hay, needle[0])
+                                        : strstr(hay, cneedle);
+        check += (size_t)(p - hay);
+    }
+    double libc_ms = mc_get_current_time_ms() - start;
+
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        check -= mc_simd_find_bytes(hay_ref, hay_len, needle, needle_len);
+    double find_ms = mc_get_current_time_ms() - start;
+
+    size_t const r_len = len - 1;
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        check += byte_loop_rfind(text, r_len, needle, needle_len);
+    double loop_ms = mc_get_current_time_ms() - start;
+
+    start = mc_get_current_time_ms();
+    for (size_t r = 0; r < reps; r++)
+        check -= mc_simd_rfind_bytes(text, r_len, needle, needle_len);
+    double rfind_ms = mc_get_current_time_ms() - start;
+
+    if (check != 0)
+        fprintf(stderr, "result mismatch\n");
+
+    printf("%12zu %6zu %10.2f %10.2f %10.2f %10.2f\n", len, needle_len,
+           gbps(len, reps, libc_ms), gbps(len, reps, find_ms),
+           gbps(len, reps, loop_ms), gbps(len, reps, rfind_ms));
+}
+
+int main(int argc, char **argv)
+{
+    size_t max_mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 100;
+    size_t const max_len = max_mib << 20;
+    size_t const sizes[] = {64, 4096, 256 << 10, 16 << 20, 100 << 20};
+    size_t const needles[] = {1, 4, 16, 64};
+
+    char *text = malloc(max_len + 1);
+    printf("%12s %6s %10s %10s %10s %10s\n", "haystack", "needle",
+           "libc", "find", "byte loop", "rfind");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        if (sizes[s] > max_len)
+            break;
+        for (size_t n = 0; n < sizeof(needles) / sizeof(needles[0]); n++) {
+            if (2 * needles[n] < sizes[s])
+                run(text, sizes[s], needles[n]);
+        }
+    }
+    printf("(GB/s; libc and byte loop are the old find and rfind)\n");
+
+    free(text);
+    return 0;
+}
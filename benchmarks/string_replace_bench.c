@@ -0,0 +1,210 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/array.h"
+#include "myclib/multi_search.h"
+#include "myclib/str_view.h"
+#include "myclib/string.h"
+#include "myclib/time.h"
+
+/*
+ * Template expansion over lines of random lowercase words with a {key}
+ * placeholder every few words. The baseline is what mc_string_replace used
+ * to be: strstr to find each match and mc_string_append_bytes to build the
+ * result, growing it as it goes. The single pair cases grow ("{key}" to a
+ * longer value, or every space to two) and shrink (to a shorter value,
+ * done in place), over the whole text at once and over each line as its
+ * own string. The batch case expands KEYS placeholders either by KEYS
+ * calls of mc_string_replace or by one mc_string_replace_many.
+ */
+
+enum { KEYS = 100 };
+
+static uint64_t state = 88172645463325252ull;
+
+static uint64_t next_random(void)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static void generate(struct mc_string *text, size_t bytes)
+{
+    mc_string_init(text);
+    mc_string_reserve_exact(text, bytes + 64);
+    while (mc_string_len(text) < bytes) {
+        char word[16];
+        size_t const len = 2 + next_random() % 8;
+        for (size_t i = 0; i < len; i++)
+            word[i] = (char)('a' + next_random() % 26);
+        mc_string_append_bytes(text, word, len);
+        if (next_random() % 4 == 0)
+            mc_string_append_format(text, " {key%02u}",
+                                    (unsigned)(next_random() % KEYS));
+        mc_string_append_bytes(text, next_random() % 12 ? " " : "\n", 1);
+    }
+}
+
+static void old_replace(struct mc_string *str, char const *from,
+                        char const *to)
+{
+    size_t const from_len = strlen(from);
+    size_t const to_len = strlen(to);
+
+    struct mc_string new_str;
+    mc_string_init(&new_str);
+
+    char *const data = (char *)mc_string_c_str(str);
+    char *start = data;
+    char *index = NULL;
+    while ((index = strstr(start, from))) {
+        mc_string_append_bytes(&new_str, start, index - start);
+        mc_string_append_bytes(&new_str, to, to_len);
+        start = index + from_len;
+    }
+    mc_string_append_bytes(&new_str, start,
+                           mc_string_len(str) - (size_t)(start - data));
+
+    mc_string_cleanup(str);
+    mc_string_move(str, &new_str);
+}
+
+static void report(char const *name, size_t bytes, double ms)
+{
+    printf("%-28s %10.1f %8.3f\n", name, ms, (double)bytes / ms / 1e6);
+}
+
+typedef void (*replace_fn)(struct mc_string *, char const *, char const *);
+
+static void time_pair(char const *name, struct mc_string const *text,
+                      replace_fn replace, char const *from, char const *to,
+                      struct mc_string *out)
+{
+    mc_string_copy(out, text);
+    double const start = mc_get_current_time_ms();
+    replace(out, from, to);
+    report(name, mc_string_len(text), mc_get_current_time_ms() - start);
+}
+
+static void time_lines(char const *name, struct mc_string const *text,
+                       replace_fn replace, char const *from, char const *to,
+                       size_t *total)
+{
+    struct mc_str_split split;
+    struct mc_str_view line;
+    double const start = mc_get_current_time_ms();
+    *total = 0;
+    mc_str_split_init(&split, mc_string_view(text), "\n");
+    while (mc_str_split_next(&split, &line)) {
+        struct mc_string str;
+        mc_string_from_view(&str, line);
+        replace(&str, from, to);
+        *total += mc_string_len(&str);
+        mc_string_cleanup(&str);
+    }
+    report(name, mc_string_len(text), mc_get_current_time_ms() - start);
+}
+
+static void time_keys(char const *name, struct mc_string const *text,
+                      replace_fn replace, struct mc_array const *keys,
+                      struct mc_array const *values, struct mc_string *out)
+{
+    mc_string_copy(out, text);
+    double const start = mc_get_current_time_ms();
+    for (size_t k = 0; k < KEYS; k++)
+        replace(out, mc_string_c_str(mc_array_get_unchecked(keys, k)),
+                mc_string_c_str(mc_array_get_unchecked(values, k)));
+    report(name, mc_string_len(text), mc_get_current_time_ms() - start);
+}
+
+/* Compares against the expected result and drops the one being checked. */
+static int check(struct mc_string const *expected, struct mc_string *out)
+{
+    int const same = mc_string_equal(expected, out);
+    if (!same)
+        fprintf(stderr, "result mismatch\n");
+    mc_string_cleanup(out);
+    return same ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    size_t const mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 64;
+    int failed = 0;
+
+    struct mc_string text;
+    generate(&text, mib << 20);
+    printf("%zu MiB of text\n", mib);
+    printf("%-28s %10s %8s\n", "method", "ms", "GB/s");
+
+    struct mc_string old;
+    struct mc_string now;
+    time_pair("old, grow", &text, old_replace, "{key07}", "<seventh value>",
+              &old);
+    time_pair("replace, grow", &text, mc_string_replace, "{key07}",
+              "<seventh value>", &now);
+    failed |= check(&old, &now);
+    mc_string_cleanup(&old);
+    time_pair("old, grow spaces", &text, old_replace, " ", "  ", &old);
+    time_pair("replace, grow spaces", &text, mc_string_replace, " ", "  ",
+              &now);
+    failed |= check(&old, &now);
+    mc_string_cleanup(&old);
+    time_pair("old, shrink", &text, old_replace, "{key07}", "7", &old);
+    time_pair("replace, shrink", &text, mc_string_replace, "{key07}", "7",
+              &now);
+    failed |= check(&old, &now);
+    mc_string_cleanup(&old);
+
+    size_t old_total;
+    size_t now_total;
+    time_lines("old, grow per line", &text, old_replace, " ", "  ",
+               &old_total);
+    time_lines("replace, grow per line", &text, mc_string_replace, " ", "  ",
+               &now_total);
+    failed |= old_total != now_total;
+    time_lines("old, shrink per line", &text, old_replace, " ", "",
+               &old_total);
+    time_lines("replace, shrink per line", &text, mc_string_replace, " ", "",
+               &now_total);
+    failed |= old_total != now_total;
+
+    struct mc_array keys;
+    struct mc_array values;
+    mc_array_init(&keys, mc_string_get_mc_type());
+    mc_array_init(&values, mc_string_get_mc_type());
+    for (unsigned k = 0; k < KEYS; k++) {
+        struct mc_string word;
+        mc_string_init(&word);
+        mc_string_append_format(&word, "{key%02u}", k);
+        mc_array_push(&keys, &word);
+        mc_string_init(&word);
+        mc_string_append_format(&word, "value number %u", k);
+        mc_array_push(&values, &word);
+    }
+
+    time_keys("old, 100 keys one by one", &text, old_replace, &keys, &values,
+              &old);
+    time_keys("replace, 100 keys one by one", &text, mc_string_replace,
+              &keys, &values, &now);
+    failed |= check(&old, &now);
+
+    mc_string_copy(&now, &text);
+    double start = mc_get_current_time_ms();
+    struct mc_multi_search search;
+    mc_multi_search_init(&search, &keys);
+    mc_string_replace_many(&now, &search, &values);
+    report("replace_many, 100 keys", mc_string_len(&text),
+           mc_get_current_time_ms() - start);
+    failed |= check(&old, &now);
+
+    mc_string_cleanup(&old);
+    mc_multi_search_cleanup(&search);
+    mc_array_cleanup(&values);
+    mc_array_cleanup(&keys);
+    mc_string_cleanup(&text);
+    return failed;
+}
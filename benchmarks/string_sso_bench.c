@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/array.h"
+#include "myclib/map.h"
+#include "myclib/string.h"
+#include "myclib/time.h"
+
+/*
+ * Millions of short keys ("user:<n>", at most 15 bytes) built, hashed and
+ * used as mc_map keys. The "heap" rows reserve one byte past the inline
+ * capacity before appending, which is what every non-empty string cost
+ * before small strings were stored inline.
+ */
+
+static void build_key(struct mc_string *str, size_t i, bool force_heap)
+{
+    mc_string_init(str);
+    if (force_heap)
+        mc_string_reserve_exact(str, MC_STRING_INLINE_CAPACITY + 1);
+    mc_string_append(str, "user:");
+    char digits[24];
+    int n = snprintf(digits, sizeof(digits), "%zu", i);
+    mc_string_append_bytes(str, digits, (size_t)n);
+}
+
+static void run(size_t n, bool force_heap)
+{
+    struct mc_array keys;
+    mc_array_with_capacity(&keys, mc_string_get_mc_type(), n);
+
+    double start = mc_get_current_time_ms();
+    for (size_t i = 0; i < n; i++) {
+        struct mc_string key;
+        build_key(&key, i, force_heap);
+        mc_array_push(&keys, &key);
+    }
+    double build_ms = mc_get_current_time_ms() - start;
+
+    size_t hash_sum = 0;
+    start = mc_get_current_time_ms();
+    for (size_t i = 0; i < n; i++)
+        hash_sum += mc_string_hash(mc_array_get_unchecked(&keys, i));
+    double hash_ms = mc_get_current_time_ms() - start;
+
+    struct mc_map map;
+    mc_map_init(&map, mc_string_get_mc_type(), size_get_mc_type());
+    mc_map_reserve(&map, n);
+    start = mc_get_current_time_ms();
+    for (size_t i = 0; i < n; i++) {
+        struct mc_string key;
+        build_key(&key, i, force_heap);
+        mc_map_insert(&map, &key, &i);
+    }
+    double insert_ms = mc_get_current_time_ms() - start;
+
+    size_t found = 0;
+    start = mc_get_current_time_ms();
+    for (size_t i = 0; i < n; i++) {
+        size_t *value = mc_map_get(&map, mc_array_get_unchecked(&keys, i));
+        found += value && *value == i;
+    }
+    double lookup_ms = mc_get_current_time_ms() - start;
+
+    start = mc_get_current_time_ms();
+    mc_map_cleanup(&map);
+    mc_array_cleanup(&keys);
+    double cleanup_ms = mc_get_current_time_ms() - start;
+
+    if (found != n || hash_sum == 42)
+        fprintf(stderr, "unexpected result\n");
+
+    printf("%-8s %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+           force_heap ? "heap" : "inline", build_ms, hash_ms, insert_ms,
+           lookup_ms, cleanup_ms);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000000;
+
+    printf("%zu short keys, times in ms\n", n);
+    printf("%-8s %10s %10s %10s %10s %10s\n", "storage", "build", "hash",
+           "map insert", "lookup", "cleanup");
+    run(n, false);
+    run(n, true);
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/str_view.h"
+#include "myclib/time.h"
+
+/*
+ * UTF-8 validation, counting and decoding in GB/s, on text built from
+ * words of one script: English, French, Russian, Chinese, and a mix of
+ * those with emoji. The baseline is the kind of byte loop we validated
+ * client input with: decode each sequence, then check its range.
+ */
+
+static uint64_t state = 88172645463325252ull;
+
+static uint64_t next_random(void)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static char const *const english[] = {"the", "quick", "brown", "fox",
+                                      "jumps", "over", "lazy", "dog"};
+static char const *const french[] = {"\xc3\xa9t\xc3\xa9", "d\xc3\xa9j\xc3\xa0",
+                                     "for\xc3\xaat", "gar\xc3\xa7on", "le",
+                                     "na\xc3\xafve", "o\xc3\xb9", "tr\xc3\xa8s"};
+static char const *const russian[] = {
+    "\xd0\xbc\xd0\xb8\xd1\x80", "\xd0\xb4\xd0\xbe\xd0\xbc",
+    "\xd1\x81\xd0\xbb\xd0\xbe\xd0\xb2\xd0\xbe",
+    "\xd0\xb2\xd0\xbe\xd0\xb4\xd0\xb0", "\xd0\xb8",
+    "\xd0\xbd\xd0\xbe\xd1\x87\xd1\x8c", "\xd0\xb3\xd0\xbe\xd0\xb4",
+    "\xd0\xb4\xd0\xb5\xd0\xbd\xd1\x8c"};
+static char const *const chinese[] = {
+    "\xe4\xb8\xad\xe6\x96\x87", "\xe4\xbd\xa0\xe5\xa5\xbd",
+    "\xe4\xb8\x96\xe7\x95\x8c", "\xe6\x96\x87\xe6\x9c\xac",
+    "\xe6\xb5\x8b\xe8\xaf\x95", "\xe6\x95\xb0\xe6\x8d\xae",
+    "\xe5\xad\x97\xe7\xac\xa6", "\xe7\xbc\x96\xe7\xa0\x81"};
+static char const *const emoji[] = {"\xf0\x9f\x98\x80", "\xf0\x9f\x9a\x80",
+                                    "\xf0\x9f\x8e\x89", "\xf0\x9f\x91\x8d"};
+
+static void fill(char *text, size_t len, int script)
+{
+    size_t i = 0;
+    while (i < len) {
+        uint64_t const r = next_random();
+        int const pick = script < 4 ? script : (int)(r % 5);
+        char const *word = pick == 0   ? english[r >> 8 & 7]
+                           : pick == 1 ? french[r >> 8 & 7]
+                           : pick == 2 ? russian[r >> 8 & 7]
+                           : pick == 3 ? chinese[r >> 8 & 7]
+                                       : emoji[r >> 8 & 3];
+        size_t const n = strlen(word);
+        if (i + n + 1 > len)
+            break;
+        memcpy(text + i, word, n);
+        text[i + n] = ' ';
+        i += n + 1;
+    }
+    memset(text + i, ' ', len - i);
+}
+
+/* Offset of the first bad sequence, or len. */
+static size_t byte_loop_validate(unsigned char const *p, size_t len)
+{
+    size_t i = 0;
+    while (i < len) {
+        unsigned char const c = p[i];
+        size_t const size = c < 0x80 ? 1 : c < 0xc0 ? 0 : c < 0xe0 ? 2
+                                       : c < 0xf0   ? 3 : c < 0xf8 ? 4 : 0;
+        if (size == 0 || size > len - i)
+            return i;
+        uint32_t v = size == 1 ? c : c & (0x7fu >> size);
+        for (size_t k = 1; k < size; k++) {
+            if ((p[i + k] & 0xc0) != 0x80)
+                return i;
+            v = v << 6 | (p[i + k] & 0x3fu);
+        }
+        static uint32_t const min[] = {0, 0, 0x80, 0x800, 0x10000};
+        if (v < min[size] || v > 0x10ffff || (v >= 0xd800 && v <= 0xdfff))
+            return i;
+        i += size;
+    }
+    return len;
+}
+
+static void report(char const *name, size_t bytes, size_t reps, double ms)
+{
+    printf("  %-26s %10.1f %8.2f\n", name, ms,
+           (double)bytes * (double)reps / ms / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    size_t const mib = argc > 1 ? strtoul(argv[1], NULL, 10) : 4;
+    size_t const len = mib << 20;
+    size_t const reps = 1 + ((size_t)512 << 20) / len;
+    static char const *const names[] = {"English", "French", "Russian",
+                                        "Chinese", "mixed with emoji"};
+
+    char *const text = malloc(len);
+    struct mc_str_view const view = mc_str_view_make(text, len);
+    printf("%zu MiB of text, %zu passes each\n", mib, reps);
+    printf("  %-26s %10s %8s\n", "operation", "ms", "GB/s");
+
+    int failed = 0;
+    for (int script = 0; script < 5; script++) {
+        fill(text, len, script);
+        printf("%s\n", names[script]);
+
+        size_t errors = 0;
+        double start = mc_get_current_time_ms();
+        for (size_t r = 0; r < reps; r++)
+            errors += byte_loop_validate((unsigned char const *)text, len);
+        report("byte loop validate", len, reps,
+               mc_get_current_time_ms() - start);
+        start = mc_get_current_time_ms();
+        for (size_t r = 0; r < reps; r++) {
+            size_t error = len;
+            mc_str_view_utf8_validate(view, &error);
+            errors -= error;
+        }
+        report("mc_str_view_utf8_validate", len, reps,
+               mc_get_current_time_ms() - start);
+
+        size_t count = 0;
+        start = mc_get_current_time_ms();
+        for (size_t r = 0; r < reps; r++)
+            count += mc_str_view_utf8_len(view);
+        report("mc_str_view_utf8_len", len, reps,
+               mc_get_current_time_ms() - start);
+
+        size_t decoded = 0;
+        uint32_t sum = 0;
+        start = mc_get_current_time_ms();
+        for (size_t r = 0; r < reps; r++) {
+            struct mc_str_code_points code_points;
+            mc_str_code_points_init(&code_points, view);
+            uint32_t code_point;
+            while (mc_str_code_points_next(&code_points, &code_point)) {
+                sum += code_point;
+                ++decoded;
+            }
+        }
+        report("mc_str_code_points_next", len, reps,
+               mc_get_current_time_ms() - start);
+        printf("  %-26s %10.3f\n", "bytes per code point",
+               (double)len / (double)(count / reps));
+        failed |= errors != 0 || count != decoded || sum == 0;
+    }
+
+    if (failed)
+        fprintf(stderr, "result mismatch\n");
+    free(text);
+    return failed;
+}
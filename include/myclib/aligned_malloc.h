@@ -1,9 +1,59 @@
 #ifndef MYCLIB_ALIGNED_MALLOC_H
 #define MYCLIB_ALIGNED_MALLOC_H
 
+#include <stdbool.h>
 #include <stddef.h>
 
+/*
+ * Allocations of at least `threshold` bytes bypass malloc and are mapped
+ * directly at a 2 MiB boundary, advised for transparent huge pages and
+ * optionally bound to one NUMA node, which cuts TLB misses when large
+ * containers are accessed randomly. A threshold of 0 turns this off. Only
+ * Linux honours the policy; elsewhere everything goes through malloc.
+ */
+struct mc_large_alloc_policy {
+    size_t threshold;
+    bool huge_pages;
+    int numa_node;
+};
+
+#define MC_LARGE_ALLOC_DEFAULT_THRESHOLD ((size_t)32 << 20)
+
+#define MC_LARGE_ALLOC_POLICY_DEFAULT()                                        \
+    {.threshold = MC_LARGE_ALLOC_DEFAULT_THRESHOLD, .huge_pages = true,        \
+     .numa_node = -1}
+
+/*
+ * MC_ALIGNED_MALLOC_BACKEND_SIZE_CLASS serves blocks of up to
+ * MC_SIZE_CLASS_MAX bytes from 40 size classes carved out of one reserved
+ * address range. Blocks carry no header and are naturally aligned to their
+ * class (up to a page), and every thread caches a batch of free blocks per
+ * class so most calls never take a lock. A thread's caches go back to the
+ * shared classes when it exits. Freed blocks stay with their class for the
+ * life of the process. Larger blocks and alignments no class can
+ * satisfy fall through to the heap backend. Linux only, like the large
+ * allocation policy.
+ */
+enum mc_aligned_malloc_backend {
+    MC_ALIGNED_MALLOC_BACKEND_HEAP,
+    MC_ALIGNED_MALLOC_BACKEND_SIZE_CLASS,
+};
+
+#define MC_SIZE_CLASS_MAX ((size_t)32 << 10)
+
 void *mc_aligned_malloc(size_t alignment, size_t size);
+/* Contents up to min(old_size, new_size) are preserved. */
+void *mc_aligned_realloc(void *ptr, size_t alignment, size_t old_size,
+                         size_t new_size);
 void mc_aligned_free(void *ptr);
 
+/* Not synchronized: set the policy before other threads allocate. */
+void mc_set_large_alloc_policy(struct mc_large_alloc_policy const *policy);
+void mc_get_large_alloc_policy(struct mc_large_alloc_policy *policy);
+
+/* Not synchronized either. Blocks from either backend may be freed or
+ * reallocated after switching. */
+void mc_set_aligned_malloc_backend(enum mc_aligned_malloc_backend backend);
+enum mc_aligned_malloc_backend mc_get_aligned_malloc_backend(void);
+
 #endif
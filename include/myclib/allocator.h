@@ -0,0 +1,32 @@
+#ifndef MYCLIB_ALLOCATOR_H
+#define MYCLIB_ALLOCATOR_H
+
+#include <stddef.h>
+
+/*
+ * Memory source for container buffers. Every callback receives ctx, and
+ * free/realloc are told the size the block was allocated with so arenas
+ * and pools need no per-block header. realloc may be NULL, in which case
+ * alloc, copy and free are used instead. Returning NULL reports failure;
+ * containers abort on it as they do for the default allocator.
+ */
+struct mc_allocator {
+    void *(*alloc)(void *ctx, size_t alignment, size_t size);
+    void *(*realloc)(void *ctx, void *ptr, size_t alignment, size_t old_size,
+                     size_t new_size);
+    void (*free)(void *ctx, void *ptr, size_t size);
+    void *ctx;
+};
+
+/* Backed by mc_aligned_malloc, including its large allocation policy. */
+extern struct mc_allocator const mc_default_allocator;
+
+void *mc_allocator_alloc(struct mc_allocator const *allocator,
+                         size_t alignment, size_t size);
+void *mc_allocator_realloc(struct mc_allocator const *allocator, void *ptr,
+                           size_t alignment, size_t old_size,
+                           size_t new_size);
+void mc_allocator_free(struct mc_allocator const *allocator, void *ptr,
+                       size_t size);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef MYCLIB_ARENA_H
+#define MYCLIB_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "myclib/allocator.h"
+
+#define MC_ARENA_DEFAULT_CHUNK_SIZE ((size_t)64 << 10)
+#define MC_ARENA_MAX_CHUNK_GROWTH ((size_t)64 << 20)
+
+struct mc_arena_chunk;
+
+/*
+ * Bump allocator over a chain of chunks. Individual frees are ignored
+ * except for the most recent block, which makes growing the last container
+ * buffer cheap. Memory comes back in bulk through rewind or reset, both of
+ * which keep the chunks for reuse; only cleanup returns them to the heap.
+ * Containers use it through mc_arena_allocator and may skip their own
+ * cleanup when the arena is reset, as long as their elements own nothing
+ * outside the arena. The allocator points back at the arena, so an
+ * initialized arena must not be moved.
+ */
+struct mc_arena {
+    struct mc_arena_chunk *first;
+    struct mc_arena_chunk *current;
+    char *ptr;
+    char *end;
+    size_t chunk_size;
+    struct mc_allocator allocator;
+};
+
+struct mc_arena_mark {
+    struct mc_arena_chunk *chunk;
+    char *ptr;
+};
+
+void mc_arena_init(struct mc_arena *arena, size_t chunk_size);
+void mc_arena_cleanup(struct mc_arena *arena);
+
+/* Same contract as mc_aligned_malloc: NULL for a zero size, a zero or
+ * non power-of-two alignment, or when the heap is exhausted. */
+void *mc_arena_alloc(struct mc_arena *arena, size_t alignment, size_t size);
+void *mc_arena_realloc(struct mc_arena *arena, void *ptr, size_t alignment,
+                       size_t old_size, size_t new_size);
+void mc_arena_free(struct mc_arena *arena, void *ptr, size_t size);
+
+struct mc_arena_mark mc_arena_mark(struct mc_arena const *arena);
+void mc_arena_rewind(struct mc_arena *arena, struct mc_arena_mark mark);
+void mc_arena_reset(struct mc_arena *arena);
+
+size_t mc_arena_used(struct mc_arena const *arena);
+
+static inline struct mc_allocator const *
+mc_arena_allocator(struct mc_arena const *arena)
+{
+    return &arena->allocator;
+}
+
+#endif
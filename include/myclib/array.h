@@ -3,20 +3,26 @@
 
 #include "myclib/type.h"
 #include "myclib/iter.h"
+#include "myclib/allocator.h"
 
 struct mc_array {
     struct mc_type const *elem_type;
     void *data;
     size_t len;
     size_t capacity;
+    struct mc_allocator const *allocator;
 };
 
 #define MC_ARRAY_INITIALIZER(type)                                             \
-    {.elem_type = type, .data = NULL, .len = 0, .capacity = 0}
+    {.elem_type = type, .data = NULL, .len = 0, .capacity = 0,                 \
+     .allocator = &mc_default_allocator}
 
 MC_DECLARE_TYPE(mc_array);
 
 void mc_array_init(struct mc_array *array, struct mc_type const *elem_type);
+void mc_array_init_with_allocator(struct mc_array *array,
+                                  struct mc_type const *elem_type,
+                                  struct mc_allocator const *allocator);
 void mc_array_with_capacity(struct mc_array *array,
                             struct mc_type const *elem_type, size_t capacity);
 void mc_array_from(struct mc_array *array, struct mc_type const *elem_type,
@@ -33,12 +39,35 @@ void mc_array_push(struct mc_array *array, void *elem);
 bool mc_array_pop(struct mc_array *array, void *out_elem);
 void mc_array_insert(struct mc_array *array, size_t index, void *elem);
 void mc_array_remove(struct mc_array *array, size_t index, void *out_elem);
+/* O(1) removal that moves the last element into the hole; order is lost. */
+void mc_array_swap_remove(struct mc_array *array, size_t index,
+                          void *out_elem);
 void mc_array_append_range(struct mc_array *array, void *elems,
                            size_t elems_len);
 void mc_array_insert_range(struct mc_array *array, size_t index, void *elems,
                            size_t elems_len);
 void mc_array_remove_range(struct mc_array *array, size_t index, size_t len,
                            void *out_elems, size_t out_elems_len);
+
+/*
+ * Reserve slots and count them in len without constructing anything; the
+ * caller must initialize them in place before any other operation on the
+ * array. Returned pointers are invalidated like mc_array_get pointers.
+ */
+void *mc_array_emplace_back(struct mc_array *array);
+void *mc_array_emplace_at(struct mc_array *array, size_t index);
+void *mc_array_extend_uninit(struct mc_array *array, size_t n);
+
+/*
+ * Keep only the elements for which pred returns true (retain) or drop
+ * consecutive equal elements (dedup), preserving order. Both make a single
+ * pass and clean up every removed element.
+ */
+void mc_array_retain(struct mc_array *array,
+                     bool (*pred)(void const *, void const *user_data),
+                     void const *user_data);
+void mc_array_dedup(struct mc_array *array);
+
 void mc_array_clear(struct mc_array *array);
 
 void mc_array_reserve(struct mc_array *array, size_t additional);
@@ -55,9 +84,14 @@ void *mc_array_find_if(struct mc_array const *array,
                        void const *user_data);
 bool mc_array_binary_search(struct mc_array const *array, void const *elem,
                             size_t *out_index);
+bool mc_array_binary_search_branchless(struct mc_array const *array,
+                                       void const *elem, size_t *out_index);
 
 void mc_array_sort(struct mc_array const *array);
 void mc_array_sort_with(struct mc_array const *array, mc_compare_func cmp);
+void mc_array_stable_sort(struct mc_array const *array);
+void mc_array_stable_sort_with(struct mc_array const *array,
+                               mc_compare_func cmp);
 
 void mc_array_for_each(struct mc_array const *array,
                        void (*func)(void *elem, void *user_data),
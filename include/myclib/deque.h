@@ -0,0 +1,72 @@
+#ifndef MYCLIB_DEQUE_H
+#define MYCLIB_DEQUE_H
+
+#include "myclib/type.h"
+#include "myclib/iter.h"
+
+/* Double-ended queue backed by a ring buffer whose capacity is always zero
+ * or a power of two, so wrapping an index is a single mask. */
+struct mc_deque {
+    struct mc_type const *elem_type;
+    void *data;
+    size_t head;
+    size_t len;
+    size_t capacity;
+};
+
+#define MC_DEQUE_INITIALIZER(type)                                             \
+    {.elem_type = type, .data = NULL, .head = 0, .len = 0, .capacity = 0}
+
+MC_DECLARE_TYPE(mc_deque);
+
+void mc_deque_init(struct mc_deque *deque, struct mc_type const *elem_type);
+void mc_deque_with_capacity(struct mc_deque *deque,
+                            struct mc_type const *elem_type, size_t capacity);
+
+void mc_deque_cleanup(struct mc_deque *deque);
+
+void *mc_deque_get(struct mc_deque const *deque, size_t index);
+void *mc_deque_get_unchecked(struct mc_deque const *deque, size_t index);
+void *mc_deque_get_front(struct mc_deque const *deque);
+void *mc_deque_get_back(struct mc_deque const *deque);
+
+void mc_deque_push_back(struct mc_deque *deque, void *elem);
+void mc_deque_push_front(struct mc_deque *deque, void *elem);
+bool mc_deque_pop_back(struct mc_deque *deque, void *out_elem);
+bool mc_deque_pop_front(struct mc_deque *deque, void *out_elem);
+void mc_deque_clear(struct mc_deque *deque);
+
+void mc_deque_reserve(struct mc_deque *deque, size_t additional);
+void mc_deque_shrink_to_fit(struct mc_deque *deque);
+
+void mc_deque_for_each(struct mc_deque const *deque,
+                       void (*func)(void *elem, void *user_data),
+                       void *user_data);
+
+void mc_deque_move(struct mc_deque *dst, struct mc_deque *src);
+void mc_deque_copy(struct mc_deque *dst, struct mc_deque const *src);
+int mc_deque_compare(struct mc_deque const *deque1,
+                     struct mc_deque const *deque2);
+bool mc_deque_equal(struct mc_deque const *deque1,
+                    struct mc_deque const *deque2);
+size_t mc_deque_hash(struct mc_deque const *deque);
+
+void mc_deque_iter_init(struct mc_iter *iter, struct mc_deque const *deque);
+bool mc_deque_iter_next(struct mc_iter *iter);
+
+static inline size_t mc_deque_len(struct mc_deque const *deque)
+{
+    return deque->len;
+}
+
+static inline size_t mc_deque_capacity(struct mc_deque const *deque)
+{
+    return deque->capacity;
+}
+
+static inline bool mc_deque_is_empty(struct mc_deque const *deque)
+{
+    return deque->len == 0;
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef MYCLIB_EYTZINGER_H
+#define MYCLIB_EYTZINGER_H
+
+#include "myclib/type.h"
+#include "myclib/array.h"
+
+/*
+ * Read-only search index holding a copy of a sorted array in Eytzinger
+ * (breadth-first) order, so the first levels of every search share the
+ * same cache lines and later levels can be prefetched ahead of time.
+ */
+struct mc_eytzinger {
+    struct mc_type const *elem_type;
+    void *data;
+    size_t len;
+};
+
+void mc_eytzinger_init(struct mc_eytzinger *index,
+                       struct mc_array const *sorted);
+
+void mc_eytzinger_cleanup(struct mc_eytzinger *index);
+
+void *mc_eytzinger_lower_bound(struct mc_eytzinger const *index,
+                               void const *elem);
+void *mc_eytzinger_find(struct mc_eytzinger const *index, void const *elem);
+
+static inline size_t mc_eytzinger_len(struct mc_eytzinger const *index)
+{
+    return index->len;
+}
+
+#endif
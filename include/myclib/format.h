@@ -0,0 +1,35 @@
+#ifndef MYCLIB_FORMAT_H
+#define MYCLIB_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Numbers to text without printf. Each function writes into buf, which
+ * must hold at least the matching MC_FORMAT_*_MAX bytes, and returns the
+ * number of bytes written; no NUL is added.
+ */
+
+#define MC_FORMAT_U64_MAX 20
+#define MC_FORMAT_I64_MAX 20
+#define MC_FORMAT_HEX_MAX 16
+#define MC_FORMAT_F64_MAX 32
+
+/* Decimal, two digits per step from a table of pairs. */
+size_t mc_format_u64(char *buf, uint64_t value);
+size_t mc_format_i64(char *buf, int64_t value);
+/* Lowercase hexadecimal without a prefix or leading zeros. */
+size_t mc_format_hex(char *buf, uint64_t value);
+
+/*
+ * The digits come from Grisu2 (Loitsch, "Printing Floating-Point Numbers
+ * Quickly and Accurately with Integers", 2010), so strtod always reads
+ * back the same double. They are the shortest that do so for all but a
+ * tiny fraction of doubles, where one more digit may appear. The layout
+ * follows JavaScript's Number::toString: plain digits for magnitudes from
+ * 1e-6 up to 1e21, otherwise 1.5e+300 style. Unlike JavaScript, -0 keeps
+ * its sign and the special values print as nan, inf and -inf.
+ */
+size_t mc_format_f64(char *buf, double value);
+
+#endif
@@ -4,13 +4,26 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#define MC_HASH_FNV1A64_OFFSET 0xcbf29ce484222325ULL
+#define MC_HASH_FNV1A32_OFFSET 0x811c9dc5UL
+
 uint64_t mc_hash_fnv1a64(const void *data, size_t len);
 uint32_t mc_hash_fnv1a32(const void *data, size_t len);
 
+/* Continue a hash over more bytes, for data that is not contiguous:
+ * starting from the offset and updating piece by piece gives the same
+ * result as hashing the concatenation at once. */
+uint64_t mc_hash_fnv1a64_update(uint64_t hash, const void *data, size_t len);
+uint32_t mc_hash_fnv1a32_update(uint32_t hash, const void *data, size_t len);
+
 #if SIZE_MAX == UINT64_MAX
 #define MC_HASH(data, len) mc_hash_fnv1a64(data, len)
+#define MC_HASH_INIT MC_HASH_FNV1A64_OFFSET
+#define MC_HASH_UPDATE(hash, data, len) mc_hash_fnv1a64_update(hash, data, len)
 #else
 #define MC_HASH(data, len) mc_hash_fnv1a32(data, len)
+#define MC_HASH_INIT MC_HASH_FNV1A32_OFFSET
+#define MC_HASH_UPDATE(hash, data, len) mc_hash_fnv1a32_update(hash, data, len)
 #endif
 
 #endif
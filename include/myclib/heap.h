@@ -0,0 +1,61 @@
+#ifndef MYCLIB_HEAP_H
+#define MYCLIB_HEAP_H
+
+#include "myclib/type.h"
+#include "myclib/array.h"
+
+#define MC_HEAP_DEFAULT_ARITY 4
+#define MC_HEAP_INVALID_HANDLE SIZE_MAX
+
+/*
+ * d-ary min-heap over an mc_array: the element comparing smallest is on
+ * top, so pass a reversed comparator for a max-heap. A wider arity makes
+ * the heap shallower and keeps siblings on one cache line. Every element
+ * gets a handle on entry that stays valid until it leaves the heap and is
+ * used for decrease-key, update and removal.
+ */
+struct mc_heap {
+    struct mc_array elems;
+    struct mc_array handles;
+    struct mc_array positions;
+    struct mc_array free_handles;
+    mc_compare_func compare;
+    size_t arity;
+    void *scratch;
+};
+
+void mc_heap_init(struct mc_heap *heap, struct mc_type const *elem_type);
+void mc_heap_init_with(struct mc_heap *heap, struct mc_type const *elem_type,
+                       size_t arity, mc_compare_func compare);
+/* Takes over the elements of array in O(n); element i gets handle i. */
+void mc_heap_from_array(struct mc_heap *heap, struct mc_array *array,
+                        size_t arity, mc_compare_func compare);
+
+void mc_heap_cleanup(struct mc_heap *heap);
+
+size_t mc_heap_push(struct mc_heap *heap, void *elem);
+bool mc_heap_pop(struct mc_heap *heap, void *out_elem);
+void *mc_heap_peek(struct mc_heap const *heap);
+void mc_heap_clear(struct mc_heap *heap);
+/* The next additional pushes will not reallocate. */
+void mc_heap_reserve(struct mc_heap *heap, size_t additional);
+
+void *mc_heap_get(struct mc_heap const *heap, size_t handle);
+bool mc_heap_contains(struct mc_heap const *heap, size_t handle);
+/* Replaces the element with one that does not compare greater. */
+void mc_heap_decrease_key(struct mc_heap *heap, size_t handle, void *elem);
+/* Restores heap order after the element was modified through get. */
+void mc_heap_update(struct mc_heap *heap, size_t handle);
+void mc_heap_remove(struct mc_heap *heap, size_t handle, void *out_elem);
+
+static inline size_t mc_heap_len(struct mc_heap const *heap)
+{
+    return mc_array_len(&heap->elems);
+}
+
+static inline bool mc_heap_is_empty(struct mc_heap const *heap)
+{
+    return mc_array_is_empty(&heap->elems);
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef MYCLIB_INTERNER_H
+#define MYCLIB_INTERNER_H
+
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "myclib/arena.h"
+#include "myclib/str_view.h"
+
+#define MC_INTERNER_FIRST_SEGMENT_SHIFT 6
+#define MC_INTERNER_FIRST_SEGMENT ((size_t)1 << MC_INTERNER_FIRST_SEGMENT_SHIFT)
+#define MC_INTERNER_MAX_SEGMENTS                                               \
+    (sizeof(uint32_t) * CHAR_BIT - MC_INTERNER_FIRST_SEGMENT_SHIFT + 1)
+
+/* A string is kept once; hash_low completes the tag in its table slot. */
+struct mc_interner_entry {
+    char const *data;
+    uint32_t len;
+    uint32_t hash_low;
+};
+
+struct mc_interner_table;
+
+/*
+ * Maps strings to dense uint32_t IDs, 0, 1, 2, ... in order of first
+ * interning, so maps and arrays downstream can be keyed by the ID instead
+ * of the string. Bytes, the ID-indexed entries and the hash table all live
+ * in one arena and never move: the entries sit in segments like
+ * mc_segmented_array, and a table that fills up is replaced but kept until
+ * cleanup. Lookups of strings that are already interned take no lock and
+ * may run on any thread, alongside interning; interning new strings is
+ * serialized by a spin lock. The arena makes the interner immovable once
+ * initialized.
+ */
+struct mc_interner {
+    _Atomic(struct mc_interner_table *) table;
+    atomic_size_t len;
+    struct mc_interner_entry *segments[MC_INTERNER_MAX_SEGMENTS];
+    atomic_flag lock;
+    struct mc_arena arena;
+};
+
+void mc_interner_init(struct mc_interner *interner);
+void mc_interner_cleanup(struct mc_interner *interner);
+
+/* The ID of str, interning a copy first if it is new. Safe to call from
+ * several threads. */
+uint32_t mc_interner_intern(struct mc_interner *interner,
+                            struct mc_str_view str);
+/* Never locks; false if str was not interned. */
+bool mc_interner_find(struct mc_interner const *interner,
+                      struct mc_str_view str, uint32_t *id);
+/* The interned bytes, NUL-terminated and valid until cleanup. */
+struct mc_str_view mc_interner_get(struct mc_interner const *interner,
+                                   uint32_t id);
+
+/* Bytes taken from the arena: strings, entries and every table. */
+size_t mc_interner_memory(struct mc_interner const *interner);
+
+static inline size_t mc_interner_len(struct mc_interner const *interner)
+{
+    /* Loads do not write, but C11 does not take a const atomic. */
+    return atomic_load_explicit((atomic_size_t *)&interner->len,
+                                memory_order_acquire);
+}
+
+#endif
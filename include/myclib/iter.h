@@ -2,12 +2,15 @@
 #define MYCLIB_ITER_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 struct mc_iter {
     void const *container;
     void *current;
     void *value;
     void const *key;
+    /* Private position for iterators that need more than current. */
+    size_t cursor;
     bool (*next)(struct mc_iter *iter);
 };
 
@@ -3,6 +3,8 @@
 
 #include "myclib/type.h"
 #include "myclib/iter.h"
+#include "myclib/allocator.h"
+#include "myclib/pool.h"
 
 struct mc_list_node {
     struct mc_list_node *prev;
@@ -17,14 +19,26 @@ struct mc_list {
     size_t node_alignment;
     size_t node_size;
     size_t elem_offset;
+    struct mc_allocator const *allocator;
+    struct mc_pool *pool;
+    bool owns_pool;
 };
 
 MC_DECLARE_TYPE(mc_list);
 
 void mc_list_init(struct mc_list *list, struct mc_type const *elem_type);
+void mc_list_init_with_allocator(struct mc_list *list,
+                                 struct mc_type const *elem_type,
+                                 struct mc_allocator const *allocator);
 
 void mc_list_cleanup(struct mc_list *list);
 
+/* Takes nodes from pool instead of the allocator, which pays off when nodes
+ * churn. A NULL pool gives the list a private one that lives until cleanup;
+ * a shared pool must outlive the list and fit its nodes. Only an empty list
+ * may switch. */
+void mc_list_use_pool(struct mc_list *list, struct mc_pool *pool);
+
 void mc_list_push_back(struct mc_list *list, void *elem);
 void mc_list_push_front(struct mc_list *list, void *elem);
 bool mc_list_pop_back(struct mc_list *list, void *out_elem);
@@ -3,6 +3,8 @@
 
 #include "myclib/type.h"
 #include "myclib/iter.h"
+#include "myclib/allocator.h"
+#include "myclib/pool.h"
 
 struct mc_hash_entry;
 
@@ -15,6 +17,9 @@ struct mc_hash_table {
     size_t entry_alignment;
     size_t entry_size;
     size_t capacity;
+    struct mc_allocator const *allocator;
+    struct mc_pool *pool;
+    bool owns_pool;
 };
 
 struct mc_map {
@@ -26,9 +31,17 @@ MC_DECLARE_TYPE(mc_map);
 
 void mc_map_init(struct mc_map *map, struct mc_type const *key_type,
                  struct mc_type const *value_type);
+void mc_map_init_with_allocator(struct mc_map *map,
+                                struct mc_type const *key_type,
+                                struct mc_type const *value_type,
+                                struct mc_allocator const *allocator);
 
 void mc_map_cleanup(struct mc_map *map);
 
+/* Takes entry storage from pool; the slot array still comes from the
+ * allocator. Same rules as mc_list_use_pool. */
+void mc_map_use_pool(struct mc_map *map, struct mc_pool *pool);
+
 void mc_map_insert(struct mc_map *map, void *key, void *value);
 bool mc_map_remove(struct mc_map *map, void const *key, void *out_key,
                    void *out_value);
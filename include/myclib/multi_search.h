@@ -0,0 +1,88 @@
+#ifndef MYCLIB_MULTI_SEARCH_H
+#define MYCLIB_MULTI_SEARCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "myclib/array.h"
+#include "myclib/str_view.h"
+#include "myclib/type.h"
+
+/* Set on a transition whose target state ends at least one pattern. */
+#define MC_MULTI_SEARCH_MATCH_FLAG ((uint32_t)1 << 31)
+#define MC_MULTI_SEARCH_NONE UINT32_MAX
+
+/* pattern indexes the array the matcher was built from. */
+struct mc_multi_search_match {
+    size_t pattern;
+    size_t start;
+    size_t len;
+};
+
+MC_DECLARE_TYPE(mc_multi_search_match);
+
+/*
+ * Aho-Corasick automaton that finds any number of patterns in one pass over
+ * the text. Bytes that occur in no pattern share one class, and the others
+ * get a class each, so the transition table only has class_count columns.
+ * It is stored flat, one row per state in breadth-first order so the
+ * shallow states that most bytes visit sit together, and each entry holds
+ * the row offset of its target so a step is a single load. Rows of states
+ * that end a pattern are tagged with MC_MULTI_SEARCH_MATCH_FLAG.
+ */
+struct mc_multi_search {
+    uint32_t *table;
+    size_t class_count;
+    size_t state_count;
+    uint8_t classes[256];
+    /* Per state: a pattern equal to the state's path, the next shorter
+     * suffix state that ends a pattern, and the length of the path. */
+    uint32_t *state_pattern;
+    uint32_t *dict_link;
+    uint32_t *state_depth;
+    /* Per pattern: its length, and the next pattern with the same bytes. */
+    size_t *pattern_len;
+    uint32_t *pattern_next;
+    size_t pattern_count;
+};
+
+/* patterns is an array of mc_string; none of them may be empty. Patterns
+ * may contain any byte, NUL included, and may repeat. */
+void mc_multi_search_init(struct mc_multi_search *search,
+                          struct mc_array const *patterns);
+void mc_multi_search_cleanup(struct mc_multi_search *search);
+
+/* The match that ends first; of several ending at the same byte, the
+ * longest. */
+bool mc_multi_search_find_first(struct mc_multi_search const *search,
+                                struct mc_str_view text,
+                                struct mc_multi_search_match *match);
+/* The match that starts first; of several starting at the same byte, the
+ * longest. Calling it again on the text after the match yields the
+ * non-overlapping matches a left-to-right replacement would pick. */
+bool mc_multi_search_find_leftmost(struct mc_multi_search const *search,
+                                   struct mc_str_view text,
+                                   struct mc_multi_search_match *match);
+bool mc_multi_search_contains(struct mc_multi_search const *search,
+                              struct mc_str_view text);
+/* Initializes matches as an array of mc_multi_search_match and fills it
+ * with every occurrence of every pattern, overlapping ones included, in
+ * order of their end, longest first. */
+void mc_multi_search_find_all(struct mc_multi_search const *search,
+                              struct mc_str_view text,
+                              struct mc_array *matches);
+
+static inline size_t
+mc_multi_search_pattern_count(struct mc_multi_search const *search)
+{
+    return search->pattern_count;
+}
+
+static inline size_t
+mc_multi_search_pattern_len(struct mc_multi_search const *search,
+                            size_t pattern)
+{
+    return search->pattern_len[pattern];
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef MYCLIB_POOL_H
+#define MYCLIB_POOL_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "myclib/allocator.h"
+
+#define MC_POOL_OPTION_THREAD_CACHE 0x01
+
+#define MC_POOL_MIN_SLAB_SIZE ((size_t)4 << 10)
+#define MC_POOL_MAX_SLAB_SIZE ((size_t)1 << 20)
+
+struct mc_pool_slab;
+
+/*
+ * Allocator for objects of one size. Blocks are carved from slabs that only
+ * go back to the heap on cleanup; freed blocks are kept on a free list and
+ * handed out again first. Without options a pool is not thread-safe. With
+ * MC_POOL_OPTION_THREAD_CACHE every thread keeps a small private stack of
+ * blocks and only touches the shared, lock-protected free list to refill or
+ * spill a batch. Blocks parked in the cache of a thread that exits are
+ * reclaimed when the pool is cleaned up.
+ */
+struct mc_pool {
+    size_t obj_size;
+    size_t alignment;
+    size_t slab_size;
+    void *free_list;
+    char *bump;
+    char *bump_end;
+    struct mc_pool_slab *slabs;
+    unsigned options;
+    uint64_t id;
+    atomic_flag lock;
+    struct mc_pool *next_live;
+};
+
+/* obj_size is rounded up to a multiple of alignment and to at least one
+ * pointer; alignment must be a power of two. */
+void mc_pool_init(struct mc_pool *pool, size_t obj_size, size_t alignment,
+                  unsigned options);
+void mc_pool_cleanup(struct mc_pool *pool);
+
+/* A pool whose own struct comes from allocator, for containers that keep a
+ * private pool. mc_pool_new returns NULL when the allocation fails. */
+struct mc_pool *mc_pool_new(struct mc_allocator const *allocator,
+                            size_t obj_size, size_t alignment,
+                            unsigned options);
+void mc_pool_delete(struct mc_pool *pool,
+                    struct mc_allocator const *allocator);
+
+/* NULL only when the heap is exhausted. */
+void *mc_pool_alloc(struct mc_pool *pool);
+void mc_pool_free(struct mc_pool *pool, void *ptr);
+
+static inline size_t mc_pool_obj_size(struct mc_pool const *pool)
+{
+    return pool->obj_size;
+}
+
+static inline size_t mc_pool_alignment(struct mc_pool const *pool)
+{
+    return pool->alignment;
+}
+
+#endif
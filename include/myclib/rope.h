@@ -0,0 +1,98 @@
+#ifndef MYCLIB_ROPE_H
+#define MYCLIB_ROPE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "myclib/allocator.h"
+#include "myclib/str_view.h"
+#include "myclib/string.h"
+#include "myclib/type.h"
+
+/* Bytes per node. Edits that stay inside one chunk only move that chunk. */
+#define MC_ROPE_CHUNK_CAPACITY 2048
+
+/*
+ * Node of a treap keyed by position: the in-order sequence of chunks is the
+ * text, len counts the bytes of the whole subtree so a position is found
+ * by one descent, and random priorities keep the expected depth
+ * logarithmic. chunk holds MC_ROPE_CHUNK_CAPACITY bytes.
+ */
+struct mc_rope_node {
+    struct mc_rope_node *left;
+    struct mc_rope_node *right;
+    size_t len;
+    uint32_t priority;
+    uint32_t chunk_len;
+    char chunk[];
+};
+
+/*
+ * Text for large documents under random edits. Inserting, removing and
+ * reading a range cost O(log n) plus the bytes involved, instead of moving
+ * the whole tail as mc_string does. Edits split and join subtrees, and
+ * merge neighbouring chunks that fit in one, so chunks stay reasonably
+ * full however the text is edited.
+ */
+struct mc_rope {
+    struct mc_rope_node *root;
+    uint32_t seed;
+    struct mc_allocator const *allocator;
+};
+
+MC_DECLARE_TYPE(mc_rope);
+
+void mc_rope_init(struct mc_rope *rope);
+void mc_rope_init_with_allocator(struct mc_rope *rope,
+                                 struct mc_allocator const *allocator);
+void mc_rope_from_view(struct mc_rope *rope, struct mc_str_view text);
+void mc_rope_cleanup(struct mc_rope *rope);
+void mc_rope_clear(struct mc_rope *rope);
+
+char mc_rope_get(struct mc_rope const *rope, size_t index);
+
+/* text must not come from the rope itself. */
+void mc_rope_insert(struct mc_rope *rope, size_t pos, struct mc_str_view text);
+void mc_rope_append(struct mc_rope *rope, struct mc_str_view text);
+/* Like mc_str_view_substr, len is clamped to the end of the rope. */
+void mc_rope_remove(struct mc_rope *rope, size_t pos, size_t len);
+
+/* These append to out, which must be initialized. */
+void mc_rope_substr(struct mc_rope const *rope, size_t pos, size_t len,
+                    struct mc_string *out);
+void mc_rope_flatten(struct mc_rope const *rope, struct mc_string *out);
+
+/*
+ * Walks the chunks that cover a range, the first and last cut to it. Each
+ * step descends from the root, so it needs no stack, and the rope must not
+ * be edited while it is walked.
+ */
+struct mc_rope_chunks {
+    struct mc_rope const *rope;
+    size_t pos;
+    size_t end;
+};
+
+void mc_rope_chunks_init(struct mc_rope_chunks *chunks,
+                         struct mc_rope const *rope, size_t pos, size_t len);
+bool mc_rope_chunks_next(struct mc_rope_chunks *chunks,
+                         struct mc_str_view *chunk);
+
+void mc_rope_move(struct mc_rope *dst, struct mc_rope *src);
+void mc_rope_copy(struct mc_rope *dst, struct mc_rope const *src);
+int mc_rope_compare(struct mc_rope const *rope1, struct mc_rope const *rope2);
+bool mc_rope_equal(struct mc_rope const *rope1, struct mc_rope const *rope2);
+/* Equal to mc_string_hash of the same bytes. */
+size_t mc_rope_hash(struct mc_rope const *rope);
+
+static inline size_t mc_rope_len(struct mc_rope const *rope)
+{
+    return rope->root ? rope->root->len : 0;
+}
+
+static inline bool mc_rope_is_empty(struct mc_rope const *rope)
+{
+    return !rope->root;
+}
+
+#endif
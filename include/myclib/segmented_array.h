@@ -0,0 +1,89 @@
+#ifndef MYCLIB_SEGMENTED_ARRAY_H
+#define MYCLIB_SEGMENTED_ARRAY_H
+
+#include <limits.h>
+#include "myclib/type.h"
+#include "myclib/iter.h"
+
+/*
+ * Dynamic array made of segments that are never moved: segment k holds
+ * MC_SEGMENTED_ARRAY_FIRST_SEGMENT << k elements, so growing only allocates
+ * the next segment and element pointers stay valid until the element is
+ * popped or the array is cleaned up. Indexing is a bit scan plus a shift.
+ */
+#define MC_SEGMENTED_ARRAY_FIRST_SEGMENT_SHIFT 4
+#define MC_SEGMENTED_ARRAY_FIRST_SEGMENT                                       \
+    ((size_t)1 << MC_SEGMENTED_ARRAY_FIRST_SEGMENT_SHIFT)
+#define MC_SEGMENTED_ARRAY_MAX_SEGMENTS                                        \
+    (sizeof(size_t) * CHAR_BIT - MC_SEGMENTED_ARRAY_FIRST_SEGMENT_SHIFT)
+
+struct mc_segmented_array {
+    struct mc_type const *elem_type;
+    size_t len;
+    size_t segment_count;
+    void *segments[MC_SEGMENTED_ARRAY_MAX_SEGMENTS];
+};
+
+MC_DECLARE_TYPE(mc_segmented_array);
+
+void mc_segmented_array_init(struct mc_segmented_array *array,
+                             struct mc_type const *elem_type);
+
+void mc_segmented_array_cleanup(struct mc_segmented_array *array);
+
+void *mc_segmented_array_get(struct mc_segmented_array const *array,
+                             size_t index);
+void *mc_segmented_array_get_unchecked(struct mc_segmented_array const *array,
+                                       size_t index);
+void *mc_segmented_array_get_first(struct mc_segmented_array const *array);
+void *mc_segmented_array_get_last(struct mc_segmented_array const *array);
+
+void mc_segmented_array_push(struct mc_segmented_array *array, void *elem);
+void *mc_segmented_array_emplace_back(struct mc_segmented_array *array);
+bool mc_segmented_array_pop(struct mc_segmented_array *array, void *out_elem);
+void mc_segmented_array_clear(struct mc_segmented_array *array);
+
+/* Segments are kept when elements are removed; shrink_to_fit releases the
+ * ones left entirely unused. */
+void mc_segmented_array_reserve(struct mc_segmented_array *array,
+                                size_t additional);
+void mc_segmented_array_shrink_to_fit(struct mc_segmented_array *array);
+
+void mc_segmented_array_for_each(struct mc_segmented_array const *array,
+                                 void (*func)(void *elem, void *user_data),
+                                 void *user_data);
+
+void mc_segmented_array_move(struct mc_segmented_array *dst,
+                             struct mc_segmented_array *src);
+void mc_segmented_array_copy(struct mc_segmented_array *dst,
+                             struct mc_segmented_array const *src);
+int mc_segmented_array_compare(struct mc_segmented_array const *array1,
+                               struct mc_segmented_array const *array2);
+bool mc_segmented_array_equal(struct mc_segmented_array const *array1,
+                              struct mc_segmented_array const *array2);
+size_t mc_segmented_array_hash(struct mc_segmented_array const *array);
+
+void mc_segmented_array_iter_init(struct mc_iter *iter,
+                                  struct mc_segmented_array const *array);
+bool mc_segmented_array_iter_next(struct mc_iter *iter);
+
+static inline size_t
+mc_segmented_array_len(struct mc_segmented_array const *array)
+{
+    return array->len;
+}
+
+static inline size_t
+mc_segmented_array_capacity(struct mc_segmented_array const *array)
+{
+    return (((size_t)1 << array->segment_count) - 1)
+           << MC_SEGMENTED_ARRAY_FIRST_SEGMENT_SHIFT;
+}
+
+static inline bool
+mc_segmented_array_is_empty(struct mc_segmented_array const *array)
+{
+    return array->len == 0;
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef MYCLIB_SIMD_H
+#define MYCLIB_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Vectorized search kernels. Each returns the index of the first element
+ * equal to value, or len when there is none. The best instruction set is
+ * picked at runtime (AVX2, then SSE2) with a scalar fallback.
+ */
+size_t mc_simd_find_u8(uint8_t const *data, size_t len, uint8_t value);
+size_t mc_simd_find_u16(uint16_t const *data, size_t len, uint16_t value);
+size_t mc_simd_find_u32(uint32_t const *data, size_t len, uint32_t value);
+size_t mc_simd_find_u64(uint64_t const *data, size_t len, uint64_t value);
+
+/* Dispatches on elem_size, which must be 1, 2, 4 or 8. */
+size_t mc_simd_find(void const *data, size_t len, size_t elem_size,
+                    void const *value);
+
+/* Index of the last byte equal to value, or len when there is none. */
+size_t mc_simd_rfind_u8(uint8_t const *data, size_t len, uint8_t value);
+
+/*
+ * Index of the first (last) occurrence of needle in the len bytes at data,
+ * or len when there is none. Both sides may contain NUL bytes and nothing
+ * past len is read. Candidate positions are filtered on the first and last
+ * byte of the needle a vector at a time; should verifying them cost more
+ * than scanning, the search continues with Two-Way, so it stays linear in
+ * the worst case. needle_len must not be 0.
+ */
+size_t mc_simd_find_bytes(void const *data, size_t len, void const *needle,
+                          size_t needle_len);
+size_t mc_simd_rfind_bytes(void const *data, size_t len, void const *needle,
+                           size_t needle_len);
+
+/*
+ * Text kernels. ASCII is handled a vector at a time and the same way in
+ * every locale; bytes from 0x80 up go through toupper, tolower or isspace,
+ * so a single-byte locale still decides them.
+ */
+
+/* Maps the len bytes at src into dst, which may be src itself. */
+void mc_simd_to_upper(void *dst, void const *src, size_t len);
+void mc_simd_to_lower(void *dst, void const *src, size_t len);
+
+/* Index of the first byte that is not whitespace, or len. */
+size_t mc_simd_skip_space(void const *data, size_t len);
+/* len minus the trailing whitespace. */
+size_t mc_simd_rskip_space(void const *data, size_t len);
+
+/* Compares as if both sides went through tolower, then by length. */
+int mc_simd_compare_ignore_case(void const *a, size_t a_len, void const *b,
+                                size_t b_len);
+
+/*
+ * UTF-8 as in RFC 3629, so overlong forms, surrogates and code points past
+ * U+10FFFF are rejected. With AVX2, whole vectors are checked at once with
+ * nibble lookup tables; otherwise ASCII runs are skipped a vector at a time
+ * and the rest is checked one sequence at a time. Returns the offset of
+ * the first ill-formed or truncated sequence, or len when data is valid.
+ */
+size_t mc_simd_utf8_validate(void const *data, size_t len);
+/* Bytes that start a sequence, which is the code point count of valid
+ * UTF-8. */
+size_t mc_simd_utf8_count(void const *data, size_t len);
+
+#endif
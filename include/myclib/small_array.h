@@ -0,0 +1,144 @@
+#ifndef MYCLIB_SMALL_ARRAY_H
+#define MYCLIB_SMALL_ARRAY_H
+
+#include "myclib/type.h"
+#include "myclib/iter.h"
+
+/*
+ * Dynamic array that keeps its first MC_SMALL_ARRAY_INLINE_SIZE bytes of
+ * elements inside the struct and only allocates once it outgrows them, e.g.
+ * up to 8 elements of 8 bytes. Over-aligned element types always live on
+ * the heap. The functions match those of mc_array, except that heap storage
+ * always comes from mc_aligned_malloc, so there is no allocator to choose.
+ */
+#define MC_SMALL_ARRAY_INLINE_SIZE 64
+
+struct mc_small_array {
+    struct mc_type const *elem_type;
+    size_t len;
+    size_t capacity;
+    size_t inline_capacity;
+    union {
+        void *heap;
+        max_align_t align;
+        unsigned char buf[MC_SMALL_ARRAY_INLINE_SIZE];
+    } storage;
+};
+
+MC_DECLARE_TYPE(mc_small_array);
+
+void mc_small_array_init(struct mc_small_array *array,
+                         struct mc_type const *elem_type);
+void mc_small_array_with_capacity(struct mc_small_array *array,
+                                  struct mc_type const *elem_type,
+                                  size_t capacity);
+void mc_small_array_from(struct mc_small_array *array,
+                         struct mc_type const *elem_type, void *elems,
+                         size_t elems_len);
+
+void mc_small_array_cleanup(struct mc_small_array *array);
+
+void *mc_small_array_data(struct mc_small_array const *array);
+void *mc_small_array_get(struct mc_small_array const *array, size_t index);
+void *mc_small_array_get_unchecked(struct mc_small_array const *array,
+                                   size_t index);
+void *mc_small_array_get_first(struct mc_small_array const *array);
+void *mc_small_array_get_last(struct mc_small_array const *array);
+
+void mc_small_array_push(struct mc_small_array *array, void *elem);
+bool mc_small_array_pop(struct mc_small_array *array, void *out_elem);
+void mc_small_array_insert(struct mc_small_array *array, size_t index,
+                           void *elem);
+void mc_small_array_remove(struct mc_small_array *array, size_t index,
+                           void *out_elem);
+void mc_small_array_swap_remove(struct mc_small_array *array, size_t index,
+                                void *out_elem);
+void mc_small_array_append_range(struct mc_small_array *array, void *elems,
+                                 size_t elems_len);
+void mc_small_array_insert_range(struct mc_small_array *array, size_t index,
+                                 void *elems, size_t elems_len);
+void mc_small_array_remove_range(struct mc_small_array *array, size_t index,
+                                 size_t len, void *out_elems,
+                                 size_t out_elems_len);
+
+/* As mc_array_emplace_back, mc_array_emplace_at and mc_array_extend_uninit;
+ * the slots may be inline and move when the array grows or shrinks. */
+void *mc_small_array_emplace_back(struct mc_small_array *array);
+void *mc_small_array_emplace_at(struct mc_small_array *array, size_t index);
+void *mc_small_array_extend_uninit(struct mc_small_array *array, size_t n);
+
+void mc_small_array_retain(struct mc_small_array *array,
+                           bool (*pred)(void const *, void const *user_data),
+                           void const *user_data);
+void mc_small_array_dedup(struct mc_small_array *array);
+
+void mc_small_array_clear(struct mc_small_array *array);
+
+void mc_small_array_reserve(struct mc_small_array *array, size_t additional);
+void mc_small_array_reserve_exact(struct mc_small_array *array,
+                                  size_t additional);
+void mc_small_array_shrink_to_fit(struct mc_small_array *array);
+void mc_small_array_shrink_to(struct mc_small_array *array, size_t capacity);
+void mc_small_array_truncate(struct mc_small_array *array, size_t len);
+void mc_small_array_resize(struct mc_small_array *array, size_t len,
+                           void *elem);
+
+bool mc_small_array_contains(struct mc_small_array const *array,
+                             void const *elem);
+void *mc_small_array_find(struct mc_small_array const *array,
+                          void const *elem);
+void *mc_small_array_find_if(struct mc_small_array const *array,
+                             bool (*pred)(void const *, void const *user_data),
+                             void const *user_data);
+bool mc_small_array_binary_search(struct mc_small_array const *array,
+                                  void const *elem, size_t *out_index);
+bool mc_small_array_binary_search_branchless(
+    struct mc_small_array const *array, void const *elem, size_t *out_index);
+
+void mc_small_array_sort(struct mc_small_array const *array);
+void mc_small_array_sort_with(struct mc_small_array const *array,
+                              mc_compare_func cmp);
+void mc_small_array_stable_sort(struct mc_small_array const *array);
+void mc_small_array_stable_sort_with(struct mc_small_array const *array,
+                                     mc_compare_func cmp);
+
+void mc_small_array_for_each(struct mc_small_array const *array,
+                             void (*func)(void *elem, void *user_data),
+                             void *user_data);
+
+void mc_small_array_move(struct mc_small_array *dst,
+                         struct mc_small_array *src);
+void mc_small_array_copy(struct mc_small_array *dst,
+                         struct mc_small_array const *src);
+int mc_small_array_compare(struct mc_small_array const *array1,
+                           struct mc_small_array const *array2);
+bool mc_small_array_equal(struct mc_small_array const *array1,
+                          struct mc_small_array const *array2);
+size_t mc_small_array_hash(struct mc_small_array const *array);
+
+void mc_small_array_iter_init(struct mc_iter *iter,
+                              struct mc_small_array const *array);
+bool mc_small_array_iter_next(struct mc_iter *iter);
+
+static inline size_t mc_small_array_len(struct mc_small_array const *array)
+{
+    return array->len;
+}
+
+static inline size_t
+mc_small_array_capacity(struct mc_small_array const *array)
+{
+    return array->capacity;
+}
+
+static inline bool mc_small_array_is_empty(struct mc_small_array const *array)
+{
+    return array->len == 0;
+}
+
+static inline bool mc_small_array_is_inline(struct mc_small_array const *array)
+{
+    return array->capacity <= array->inline_capacity;
+}
+
+#endif
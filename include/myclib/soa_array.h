@@ -0,0 +1,89 @@
+#ifndef MYCLIB_SOA_ARRAY_H
+#define MYCLIB_SOA_ARRAY_H
+
+#include "myclib/type.h"
+#include "myclib/iter.h"
+
+/* Every column starts on its own cache line so per-column loops can use
+ * aligned vector loads. */
+#define MC_SOA_ARRAY_COLUMN_ALIGNMENT 64
+
+/*
+ * Structure-of-arrays container: row i is spread over field_count columns,
+ * each a contiguous buffer of one field type. Rows are passed in and out as
+ * arrays of field_count pointers, one per field in declaration order.
+ */
+struct mc_soa_array {
+    struct mc_type const **field_types;
+    void **columns;
+    size_t field_count;
+    size_t len;
+    size_t capacity;
+};
+
+MC_DECLARE_TYPE(mc_soa_array);
+
+void mc_soa_array_init(struct mc_soa_array *soa,
+                       struct mc_type const *const *field_types,
+                       size_t field_count);
+void mc_soa_array_with_capacity(struct mc_soa_array *soa,
+                                struct mc_type const *const *field_types,
+                                size_t field_count, size_t capacity);
+
+void mc_soa_array_cleanup(struct mc_soa_array *soa);
+
+void *mc_soa_array_get(struct mc_soa_array const *soa, size_t row,
+                       size_t field);
+void *mc_soa_array_get_unchecked(struct mc_soa_array const *soa, size_t row,
+                                 size_t field);
+bool mc_soa_array_get_row(struct mc_soa_array const *soa, size_t row,
+                          void **out_fields);
+void *mc_soa_array_column(struct mc_soa_array const *soa, size_t field);
+
+/* Fields are moved in; pop moves them out, or cleans up those whose out
+ * pointer is NULL (all of them when out_fields is NULL). */
+void mc_soa_array_push(struct mc_soa_array *soa, void *const *fields);
+bool mc_soa_array_pop(struct mc_soa_array *soa, void *const *out_fields);
+void mc_soa_array_clear(struct mc_soa_array *soa);
+
+void mc_soa_array_reserve(struct mc_soa_array *soa, size_t additional);
+void mc_soa_array_shrink_to_fit(struct mc_soa_array *soa);
+
+void mc_soa_array_move(struct mc_soa_array *dst, struct mc_soa_array *src);
+void mc_soa_array_copy(struct mc_soa_array *dst,
+                       struct mc_soa_array const *src);
+
+/* Row iteration: iter->value points at row_fields, which the caller
+ * provides with room for field_count pointers and which every call to
+ * next refills with the current row. */
+void mc_soa_array_iter_init(struct mc_iter *iter,
+                            struct mc_soa_array const *soa, void **row_fields);
+bool mc_soa_array_iter_next(struct mc_iter *iter);
+
+static inline size_t mc_soa_array_len(struct mc_soa_array const *soa)
+{
+    return soa->len;
+}
+
+static inline size_t mc_soa_array_capacity(struct mc_soa_array const *soa)
+{
+    return soa->capacity;
+}
+
+static inline bool mc_soa_array_is_empty(struct mc_soa_array const *soa)
+{
+    return soa->len == 0;
+}
+
+static inline size_t mc_soa_array_field_count(struct mc_soa_array const *soa)
+{
+    return soa->field_count;
+}
+
+static inline struct mc_type const *
+mc_soa_array_field_type(struct mc_soa_array const *soa, size_t field)
+{
+    return soa->field_types[field];
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef MYCLIB_STR_VIEW_H
+#define MYCLIB_STR_VIEW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "myclib/type.h"
+
+/*
+ * Non-owning reference to len bytes at data. The bytes need not be
+ * NUL-terminated and may contain NULs; every operation is bounded by len.
+ * Views are passed by value and stay valid only as long as the memory they
+ * point into, so a view of an mc_string dies with the next call that grows
+ * or shrinks that string.
+ */
+struct mc_str_view {
+    char const *data;
+    size_t len;
+};
+
+MC_DECLARE_TYPE(mc_str_view);
+
+static inline struct mc_str_view mc_str_view_make(char const *data,
+                                                  size_t len)
+{
+    struct mc_str_view view = {.data = data, .len = len};
+    return view;
+}
+
+static inline struct mc_str_view mc_str_view_from_cstr(char const *s)
+{
+    return mc_str_view_make(s, s ? strlen(s) : 0);
+}
+
+static inline bool mc_str_view_is_empty(struct mc_str_view view)
+{
+    return view.len == 0;
+}
+
+/* pos must be <= view.len; len is clamped to what is left. */
+struct mc_str_view mc_str_view_substr(struct mc_str_view view, size_t pos,
+                                      size_t len);
+/* index must be <= view.len. */
+void mc_str_view_split_at(struct mc_str_view view, size_t index,
+                          struct mc_str_view *left, struct mc_str_view *right);
+
+bool mc_str_view_find(struct mc_str_view view, struct mc_str_view needle,
+                      size_t *index);
+bool mc_str_view_rfind(struct mc_str_view view, struct mc_str_view needle,
+                       size_t *index);
+bool mc_str_view_find_ch(struct mc_str_view view, char ch, size_t *index);
+bool mc_str_view_rfind_ch(struct mc_str_view view, char ch, size_t *index);
+bool mc_str_view_contains(struct mc_str_view view, struct mc_str_view needle);
+bool mc_str_view_starts_with(struct mc_str_view view,
+                             struct mc_str_view prefix);
+bool mc_str_view_ends_with(struct mc_str_view view, struct mc_str_view suffix);
+
+struct mc_str_view mc_str_view_trim(struct mc_str_view view);
+struct mc_str_view mc_str_view_trim_left(struct mc_str_view view);
+struct mc_str_view mc_str_view_trim_right(struct mc_str_view view);
+
+/* Same order as mc_string_compare: shorter first, then bytewise. */
+int mc_str_view_compare(struct mc_str_view view1, struct mc_str_view view2);
+bool mc_str_view_equal(struct mc_str_view view1, struct mc_str_view view2);
+/* Equal to mc_string_hash of a string with the same bytes. */
+size_t mc_str_view_hash(struct mc_str_view view);
+
+/* Whether view is well-formed UTF-8; if not and error is not NULL, it
+ * receives the offset of the first bad sequence. */
+bool mc_str_view_utf8_validate(struct mc_str_view view, size_t *error);
+/* Code points in view, which must be valid UTF-8. */
+size_t mc_str_view_utf8_len(struct mc_str_view view);
+
+/*
+ * Lazy tokenizer: each call to mc_str_split_next yields the next run of
+ * bytes containing none of the delimiter bytes, skipping empty runs, which
+ * matches mc_string_split without allocating anything.
+ */
+struct mc_str_split {
+    struct mc_str_view rest;
+    unsigned char delims[32];
+    char single_delim;
+    bool is_single;
+};
+
+void mc_str_split_init(struct mc_str_split *split, struct mc_str_view view,
+                       char const *delims);
+bool mc_str_split_next(struct mc_str_split *split, struct mc_str_view *token);
+
+/*
+ * Decodes a view one code point at a time. Each maximal ill-formed
+ * subpart yields one U+FFFD, as Unicode recommends, so unvalidated input
+ * is safe to walk and nothing past the view is read.
+ */
+struct mc_str_code_points {
+    struct mc_str_view rest;
+};
+
+void mc_str_code_points_init(struct mc_str_code_points *code_points,
+                             struct mc_str_view view);
+/* The out-of-line part of mc_str_code_points_next. */
+bool mc_str_code_points_decode(struct mc_str_code_points *code_points,
+                               uint32_t *code_point);
+
+static inline bool mc_str_code_points_next(
+    struct mc_str_code_points *code_points, uint32_t *code_point)
+{
+    struct mc_str_view *const rest = &code_points->rest;
+    if (rest->len > 0 && (unsigned char)rest->data[0] < 0x80) {
+        *code_point = (unsigned char)rest->data[0];
+        ++rest->data;
+        --rest->len;
+        return true;
+    }
+    return mc_str_code_points_decode(code_points, code_point);
+}
+
+#endif
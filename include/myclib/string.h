@@ -1,20 +1,59 @@
 #ifndef MYCLIB_STRING_H
 #define MYCLIB_STRING_H
 
+#include <stdarg.h>
 #include "myclib/type.h"
 #include "myclib/array.h"
-
+#include "myclib/allocator.h"
+#include "myclib/str_view.h"
+
+#define MC_STRING_INLINE_CAPACITY 23
+
+struct mc_multi_search;
+
+/*
+ * Strings of up to MC_STRING_INLINE_CAPACITY bytes live inside the struct
+ * and need no allocation. Longer ones move to the heap and stay there until
+ * shrink_to_fit brings them back. An inline string keeps
+ * MC_STRING_INLINE_CAPACITY - len in the last byte of buf, so a full one
+ * finds its NUL there. A heap string sets the high bit of that byte, which
+ * on 64-bit targets is the high bit of heap.capacity; heap capacities are
+ * therefore kept below MC_STRING_CAPACITY_MAX. Nothing points into the
+ * struct itself, so strings may be relocated bytewise like any other
+ * element.
+ */
 struct mc_string {
-    char *data;
-    size_t len;
-    size_t capacity;
+    union {
+        struct {
+            char *data;
+            size_t len;
+            size_t capacity;
+        } heap;
+        char buf[MC_STRING_INLINE_CAPACITY + 1];
+    } storage;
+    struct mc_allocator const *allocator;
 };
 
+#if SIZE_MAX > UINT32_MAX
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "mc_string needs the top byte of heap.capacity to be the last of buf"
+#endif
+/* The top byte of heap.capacity is the tag byte */
+#define MC_STRING_CAPACITY_MAX (SIZE_MAX >> 8)
+#else
+#define MC_STRING_CAPACITY_MAX (SIZE_MAX >> 1)
+#endif
+
 MC_DECLARE_TYPE(mc_string);
+/* mc_string keys compared and hashed ignoring case. */
+MC_DECLARE_TYPE(mc_string_ignore_case);
 
 void mc_string_init(struct mc_string *str);
+void mc_string_init_with_allocator(struct mc_string *str,
+                                   struct mc_allocator const *allocator);
 void mc_string_from(struct mc_string *str, char const *s);
 void mc_string_from_bytes(struct mc_string *str, void const *bytes, size_t len);
+void mc_string_from_view(struct mc_string *str, struct mc_str_view view);
 void mc_string_format(struct mc_string *str, char const *fmt, ...);
 void mc_string_join(struct mc_array const *parts, char const *separator,
                     struct mc_string *str);
@@ -26,7 +65,21 @@ char const *mc_string_c_str(struct mc_string *str);
 void mc_string_append(struct mc_string *str, char const *s);
 void mc_string_append_bytes(struct mc_string *str, void const *bytes,
                             size_t len);
+void mc_string_append_view(struct mc_string *str, struct mc_str_view view);
+/* Appends the UTF-8 encoding of a Unicode scalar value. */
+void mc_string_append_code_point(struct mc_string *str, uint32_t code_point);
+/*
+ * The format functions print straight into the spare capacity and only
+ * grow the string and print again when the text did not fit.
+ */
 void mc_string_append_format(struct mc_string *str, char const *fmt, ...);
+void mc_string_append_vformat(struct mc_string *str, char const *fmt,
+                              va_list args);
+/* Number appends without printf, in the forms of myclib/format.h. */
+void mc_string_append_u64(struct mc_string *str, uint64_t value);
+void mc_string_append_i64(struct mc_string *str, int64_t value);
+void mc_string_append_hex(struct mc_string *str, uint64_t value);
+void mc_string_append_f64(struct mc_string *str, double value);
 void mc_string_insert(struct mc_string *str, size_t index, char const *s);
 void mc_string_remove(struct mc_string *str, char const *s);
 void mc_string_clear(struct mc_string *str);
@@ -35,10 +88,27 @@ void mc_string_reserve(struct mc_string *str, size_t additional);
 void mc_string_reserve_exact(struct mc_string *str, size_t additional);
 void mc_string_shrink_to_fit(struct mc_string *str);
 
+/*
+ * Replaces every non-overlapping occurrence, scanning left to right. When
+ * to is not longer than from this happens in place; otherwise the matches
+ * are counted first and the result is allocated once. from and to must
+ * not point into str.
+ */
 void mc_string_replace(struct mc_string *str, char const *from, char const *to);
+void mc_string_replace_view(struct mc_string *str, struct mc_str_view from,
+                            struct mc_str_view to);
+/* Replaces, in one scan, each leftmost-longest match of a pattern of search
+ * by the mc_string at the same index of replacements. */
+void mc_string_replace_many(struct mc_string *str,
+                            struct mc_multi_search const *search,
+                            struct mc_array const *replacements);
 void mc_string_repeat(struct mc_string *str, size_t n);
+/* ASCII letters are mapped a vector at a time in every locale; other
+ * bytes go through toupper (tolower). */
 void mc_string_to_upper(struct mc_string const *str);
 void mc_string_to_lower(struct mc_string const *str);
+/* ASCII whitespace is skipped a vector at a time; bytes past ASCII go
+ * through isspace. */
 void mc_string_trim(struct mc_string *str);
 void mc_string_trim_left(struct mc_string *str);
 void mc_string_trim_right(struct mc_string *str);
@@ -58,12 +128,26 @@ bool mc_string_contains_ch(struct mc_string const *str, char ch);
 bool mc_string_starts_with(struct mc_string const *str, char const *pattern);
 bool mc_string_ends_with(struct mc_string const *str, char const *pattern);
 
+/* As mc_str_view_utf8_validate and mc_str_view_utf8_len. */
+bool mc_string_utf8_validate(struct mc_string const *str, size_t *error);
+size_t mc_string_utf8_len(struct mc_string const *str);
+
 void mc_string_split(struct mc_string const *str, char const *delim,
                      struct mc_array *parts);
 void mc_string_split_at(struct mc_string *const str, size_t index,
                         struct mc_string *left, struct mc_string *right);
 void mc_string_lines(struct mc_string const *str, struct mc_array *lines);
 
+/* Views into str; they are invalidated by anything that resizes it. */
+struct mc_str_view mc_string_substr(struct mc_string const *str, size_t pos,
+                                    size_t len);
+/* Like mc_string_split, but parts is initialized as an array of
+ * mc_str_view and no part is copied. */
+void mc_string_split_views(struct mc_string const *str, char const *delim,
+                           struct mc_array *parts);
+void mc_string_split_iter(struct mc_str_split *split,
+                          struct mc_string const *str, char const *delim);
+
 void mc_string_move(struct mc_string *dst, struct mc_string *src);
 void mc_string_copy(struct mc_string *dst, struct mc_string const *src);
 int mc_string_compare(struct mc_string const *str1,
@@ -72,19 +156,61 @@ bool mc_string_equal(struct mc_string const *str1,
                      struct mc_string const *str2);
 size_t mc_string_hash(struct mc_string const *str);
 
+/* As if both sides went through mc_string_to_lower first, so the hash of
+ * a string equals mc_string_hash of its lowercase copy. */
+int mc_string_compare_ignore_case(struct mc_string const *str1,
+                                  struct mc_string const *str2);
+bool mc_string_equal_ignore_case(struct mc_string const *str1,
+                                 struct mc_string const *str2);
+size_t mc_string_hash_ignore_case(struct mc_string const *str);
+
+static inline bool mc_string_is_inline(struct mc_string const *str)
+{
+    return (unsigned char)str->storage.buf[MC_STRING_INLINE_CAPACITY] <=
+           MC_STRING_INLINE_CAPACITY;
+}
+
+/* Always NUL-terminated; valid until the next call that may grow or shrink
+ * the string. */
+static inline char *mc_string_data(struct mc_string const *str)
+{
+    return mc_string_is_inline(str) ? (char *)str->storage.buf
+                                    : str->storage.heap.data;
+}
+
 static inline size_t mc_string_len(struct mc_string const *str)
 {
-    return str->len;
+    return mc_string_is_inline(str)
+               ? (size_t)(MC_STRING_INLINE_CAPACITY -
+                          str->storage.buf[MC_STRING_INLINE_CAPACITY])
+               : str->storage.heap.len;
+}
+
+/* Sets the length without touching the bytes; the caller writes the NUL. */
+static inline void mc_string_set_len(struct mc_string *str, size_t len)
+{
+    if (mc_string_is_inline(str))
+        str->storage.buf[MC_STRING_INLINE_CAPACITY] =
+            (char)(MC_STRING_INLINE_CAPACITY - len);
+    else
+        str->storage.heap.len = len;
+}
+
+static inline struct mc_str_view mc_string_view(struct mc_string const *str)
+{
+    return mc_str_view_make(mc_string_data(str), mc_string_len(str));
 }
 
 static inline size_t mc_string_capacity(struct mc_string const *str)
 {
-    return str->capacity;
+    return mc_string_is_inline(str)
+               ? (size_t)MC_STRING_INLINE_CAPACITY
+               : str->storage.heap.capacity & MC_STRING_CAPACITY_MAX;
 }
 
 static inline bool mc_string_is_empty(struct mc_string const *str)
 {
-    return str->len == 0;
+    return mc_string_len(str) == 0;
 }
 
 #endif
@@ -29,6 +29,8 @@ struct mc_type {
     mc_compare_func compare;
     mc_equal_func equal;
     mc_hash_func hash;
+    /* Set only by the built-in integer types below. */
+    bool is_integer;
 };
 
 #define MC_DECLARE_TYPE(type_name)                                             \
@@ -129,6 +131,13 @@ MC_DECLARE_TYPE(uint64);
 MC_DECLARE_TYPE(size);
 MC_DECLARE_TYPE(str);
 
+/* True for the built-in integer types above, whose equality is bitwise. */
+static inline bool mc_type_is_integer(struct mc_type const *type)
+{
+    assert(type);
+    return type->is_integer;
+}
+
 mc_cleanup_func mc_type_get_cleanup_forced(char const *caller,
                                            struct mc_type const *type);
 
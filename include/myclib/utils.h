@@ -30,11 +30,34 @@ static inline size_t mc_max2(size_t a, size_t b)
     return a > b ? a : b;
 }
 
+static inline void mc_prefetch(void const *ptr)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(ptr);
+#else
+    (void)ptr;
+#endif
+}
+
 static inline bool mc_is_pow_of_two(size_t n)
 {
     return n != 0 && (n & (n - 1)) == 0;
 }
 
+/* Index of the highest set bit; n must be non-zero. */
+static inline size_t mc_log2_floor(size_t n)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return sizeof(unsigned long long) * 8 - 1 -
+           (size_t)__builtin_clzll((unsigned long long)n);
+#else
+    size_t log = 0;
+    while (n >>= 1)
+        ++log;
+    return log;
+#endif
+}
+
 static inline size_t mc_next_pow_of_two(size_t n)
 {
     if (n == 0)
@@ -1,20 +1,441 @@
 #include <stdalign.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include "myclib/aligned_malloc.h"
+#include "myclib/utils.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define MC_HAVE_MMAP 1
+#else
+#define MC_HAVE_MMAP 0
+#endif
 
 #define ISPOWOF2(X) (((X) & ((X) - 1)) == 0)
 #define PTRSZ (sizeof(void *))
 
-void *mc_aligned_malloc(size_t alignment, size_t size)
+/*
+ * The word just before an aligned pointer holds the raw allocation. Mapped
+ * buffers tag it with the low bit, which malloc results never have set,
+ * and keep the mapping length in the word before that.
+ */
+#define MC_MAPPED_TAG ((uintptr_t)1)
+#define MC_HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+static struct mc_large_alloc_policy mc_large_alloc_policy =
+    MC_LARGE_ALLOC_POLICY_DEFAULT();
+
+static enum mc_aligned_malloc_backend mc_aligned_malloc_backend =
+    MC_ALIGNED_MALLOC_BACKEND_HEAP;
+
+void mc_set_large_alloc_policy(struct mc_large_alloc_policy const *policy)
 {
-    if (!alignment || !size)
+    mc_large_alloc_policy = *policy;
+}
+
+void mc_get_large_alloc_policy(struct mc_large_alloc_policy *policy)
+{
+    *policy = mc_large_alloc_policy;
+}
+
+void mc_set_aligned_malloc_backend(enum mc_aligned_malloc_backend backend)
+{
+    mc_aligned_malloc_backend = backend;
+}
+
+enum mc_aligned_malloc_backend mc_get_aligned_malloc_backend(void)
+{
+    return mc_aligned_malloc_backend;
+}
+
+static bool mc_wants_size_class(size_t size)
+{
+    return MC_HAVE_MMAP &&
+           mc_aligned_malloc_backend == MC_ALIGNED_MALLOC_BACKEND_SIZE_CLASS &&
+           size <= MC_SIZE_CLASS_MAX;
+}
+
+static bool mc_wants_mapping(size_t size)
+{
+    size_t threshold = mc_large_alloc_policy.threshold;
+    return MC_HAVE_MMAP && threshold != 0 && size >= threshold;
+}
+
+static bool mc_is_mapped(void *ptr)
+{
+    uintptr_t raw = *(uintptr_t *)((uintptr_t)ptr - PTRSZ);
+    return (raw & MC_MAPPED_TAG) != 0;
+}
+
+#if MC_HAVE_MMAP
+
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+
+static void mc_bind_to_node(void *addr, size_t len, int node)
+{
+#ifdef SYS_mbind
+    unsigned long mask[4] = {0};
+    size_t bits = sizeof(mask) * 8;
+    if (node < 0 || (size_t)node >= bits)
+        return;
+    mask[(size_t)node / (sizeof(mask[0]) * 8)] |=
+        1UL << ((size_t)node % (sizeof(mask[0]) * 8));
+    /* Best effort: without NUMA support the kernel refuses and the
+     * mapping simply stays on the default policy. */
+    (void)syscall(SYS_mbind, addr, len, MPOL_BIND, mask, bits + 1, 0);
+#else
+    (void)addr;
+    (void)len;
+    (void)node;
+#endif
+}
+
+static void *mc_mapped_malloc(size_t alignment, size_t size)
+{
+    size_t header = 2 * PTRSZ;
+    size_t offset = (header + alignment - 1) & ~(alignment - 1);
+    if (alignment > MC_HUGE_PAGE_SIZE ||
+        size > SIZE_MAX - offset - 2 * MC_HUGE_PAGE_SIZE)
         return NULL;
 
-    if (!ISPOWOF2(alignment))
+    size_t map_len = (offset + size + MC_HUGE_PAGE_SIZE - 1) &
+                     ~(MC_HUGE_PAGE_SIZE - 1);
+
+    /* Over-map by one huge page and trim so the start is 2 MiB aligned. */
+    size_t over_len = map_len + MC_HUGE_PAGE_SIZE;
+    char *raw = mmap(NULL, over_len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return NULL;
+
+    uintptr_t base_addr = ((uintptr_t)raw + MC_HUGE_PAGE_SIZE - 1) &
+                          ~(uintptr_t)(MC_HUGE_PAGE_SIZE - 1);
+    char *base = (char *)base_addr;
+    size_t head = (size_t)(base - raw);
+    if (head > 0)
+        munmap(raw, head);
+    if (over_len - head > map_len)
+        munmap(base + map_len, over_len - head - map_len);
+
+#ifdef MADV_HUGEPAGE
+    if (mc_large_alloc_policy.huge_pages)
+        madvise(base, map_len, MADV_HUGEPAGE);
+#endif
+    if (mc_large_alloc_policy.numa_node >= 0)
+        mc_bind_to_node(base, map_len, mc_large_alloc_policy.numa_node);
+
+    uintptr_t aligned_addr = base_addr + offset;
+    *(uintptr_t *)(aligned_addr - PTRSZ) = base_addr | MC_MAPPED_TAG;
+    *(size_t *)(aligned_addr - 2 * PTRSZ) = map_len;
+
+    return (void *)aligned_addr;
+}
+
+static void mc_mapped_free(void *ptr)
+{
+    uintptr_t raw = *(uintptr_t *)((uintptr_t)ptr - PTRSZ);
+    size_t map_len = *(size_t *)((uintptr_t)ptr - 2 * PTRSZ);
+    munmap((void *)(raw & ~MC_MAPPED_TAG), map_len);
+}
+
+#define MC_SIZE_CLASS_COUNT 40
+#define MC_SIZE_CLASS_SLAB_SIZE ((size_t)256 << 10)
+#define MC_SIZE_CLASS_MAX_ALIGNMENT ((size_t)4096)
+#define MC_SIZE_CLASS_CACHE_BYTES ((size_t)64 << 10)
+#if SIZE_MAX > UINT32_MAX
+#define MC_SIZE_CLASS_REGION_SIZE ((size_t)64 << 30)
+#else
+#define MC_SIZE_CLASS_REGION_SIZE ((size_t)512 << 20)
+#endif
+
+/* 16-byte steps up to 128, then four classes per power of two. */
+static size_t const mc_size_classes[MC_SIZE_CLASS_COUNT] = {
+    16,    32,    48,    64,    80,    96,    112,   128,
+    160,   192,   224,   256,   320,   384,   448,   512,
+    640,   768,   896,   1024,  1280,  1536,  1792,  2048,
+    2560,  3072,  3584,  4096,  5120,  6144,  7168,  8192,
+    10240, 12288, 14336, 16384, 20480, 24576, 28672, 32768,
+};
+
+/*
+ * Slabs are MC_SIZE_CLASS_SLAB_SIZE aligned and hold blocks of one class,
+ * so masking a block address finds the header that names its class. The
+ * header is the only per-slab overhead; blocks start at the first offset
+ * aligned for the class.
+ */
+struct mc_size_class_slab {
+    size_t class_index;
+};
+
+struct mc_size_class_bin {
+    alignas(64) atomic_flag lock;
+    void *free_list;
+    char *bump;
+    char *bump_end;
+};
+
+struct mc_size_class_cache {
+    void *head;
+    size_t count;
+};
+
+static struct mc_size_class_bin mc_size_class_bins[MC_SIZE_CLASS_COUNT];
+static _Thread_local struct mc_size_class_cache
+    mc_size_class_caches[MC_SIZE_CLASS_COUNT];
+
+/* A thread that caches blocks sets this key so that the caches are spilled
+ * back to the bins when it exits. */
+static pthread_once_t mc_size_class_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t mc_size_class_key;
+static bool mc_size_class_key_failed;
+static _Thread_local bool mc_size_class_exit_registered;
+
+/* The region is reserved on first use and never released; slabs are
+ * committed from it in address order. The base stays 0 until then. */
+static atomic_flag mc_size_class_region_lock = ATOMIC_FLAG_INIT;
+static _Atomic(uintptr_t) mc_size_class_region_base;
+static char *mc_size_class_region_next;
+static bool mc_size_class_region_failed;
+
+static void mc_spin_lock(atomic_flag *lock)
+{
+    while (atomic_flag_test_and_set_explicit(lock, memory_order_acquire)) {
+#if (defined(__GNUC__) || defined(__clang__)) &&                               \
+    (defined(__x86_64__) || defined(__i386__))
+        __builtin_ia32_pause();
+#endif
+    }
+}
+
+static void mc_spin_unlock(atomic_flag *lock)
+{
+    atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+static size_t mc_size_class_index(size_t size)
+{
+    if (size <= 128)
+        return (size + 15) / 16 - 1;
+
+    size_t lg = mc_log2_floor(size - 1);
+    return 8 + (lg - 7) * 4 + ((size - 1 - ((size_t)1 << lg)) >> (lg - 2));
+}
+
+static size_t mc_size_class_alignment(size_t index)
+{
+    size_t size = mc_size_classes[index];
+    size_t alignment = size & (~size + 1);
+    return alignment < MC_SIZE_CLASS_MAX_ALIGNMENT
+               ? alignment
+               : MC_SIZE_CLASS_MAX_ALIGNMENT;
+}
+
+/* Caps what one thread parks per class at about 64 KiB. */
+static size_t mc_size_class_batch(size_t index)
+{
+    size_t batch = MC_SIZE_CLASS_CACHE_BYTES / mc_size_classes[index];
+    return batch < 2 ? 2 : batch > 32 ? 32 : batch;
+}
+
+static bool mc_size_class_owns(void const *ptr)
+{
+    uintptr_t base = atomic_load_explicit(&mc_size_class_region_base,
+                                          memory_order_relaxed);
+    return base && (uintptr_t)ptr - base < MC_SIZE_CLASS_REGION_SIZE;
+}
+
+static struct mc_size_class_slab *mc_size_class_slab_of(void const *ptr)
+{
+    return (struct mc_size_class_slab *)((uintptr_t)ptr &
+                                         ~(MC_SIZE_CLASS_SLAB_SIZE - 1));
+}
+
+static char *mc_size_class_new_slab(void)
+{
+    char *slab = NULL;
+
+    mc_spin_lock(&mc_size_class_region_lock);
+
+    uintptr_t base = atomic_load_explicit(&mc_size_class_region_base,
+                                          memory_order_relaxed);
+    if (!base && !mc_size_class_region_failed) {
+        size_t len = MC_SIZE_CLASS_REGION_SIZE + MC_SIZE_CLASS_SLAB_SIZE;
+        char *raw = mmap(NULL, len, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (raw == MAP_FAILED) {
+            mc_size_class_region_failed = true;
+        } else {
+            base = ((uintptr_t)raw + MC_SIZE_CLASS_SLAB_SIZE - 1) &
+                   ~(uintptr_t)(MC_SIZE_CLASS_SLAB_SIZE - 1);
+            mc_size_class_region_next = (char *)base;
+            atomic_store_explicit(&mc_size_class_region_base, base,
+                                  memory_order_relaxed);
+        }
+    }
+
+    if (base &&
+        (size_t)((uintptr_t)mc_size_class_region_next - base) <
+            MC_SIZE_CLASS_REGION_SIZE &&
+        mprotect(mc_size_class_region_next, MC_SIZE_CLASS_SLAB_SIZE,
+                 PROT_READ | PROT_WRITE) == 0) {
+        slab = mc_size_class_region_next;
+        mc_size_class_region_next += MC_SIZE_CLASS_SLAB_SIZE;
+    }
+
+    mc_spin_unlock(&mc_size_class_region_lock);
+    return slab;
+}
+
+/* Hands the chain first..last back to the shared bin. */
+static void mc_size_class_give_back(size_t index, void *first, void *last)
+{
+    struct mc_size_class_bin *bin = &mc_size_class_bins[index];
+    mc_spin_lock(&bin->lock);
+    *(void **)last = bin->free_list;
+    bin->free_list = first;
+    mc_spin_unlock(&bin->lock);
+}
+
+static void mc_size_class_thread_exit(void *unused)
+{
+    (void)unused;
+    for (size_t index = 0; index < MC_SIZE_CLASS_COUNT; ++index) {
+        struct mc_size_class_cache *cache = &mc_size_class_caches[index];
+        if (!cache->head)
+            continue;
+        void *last = cache->head;
+        while (*(void **)last)
+            last = *(void **)last;
+        mc_size_class_give_back(index, cache->head, last);
+        cache->head = NULL;
+        cache->count = 0;
+    }
+    /* A later destructor that allocates registers again */
+    mc_size_class_exit_registered = false;
+}
+
+static void mc_size_class_create_key(void)
+{
+    mc_size_class_key_failed =
+        pthread_key_create(&mc_size_class_key, mc_size_class_thread_exit) !=
+        0;
+}
+
+static void mc_size_class_register_exit(void)
+{
+    pthread_once(&mc_size_class_key_once, mc_size_class_create_key);
+    /* The value only has to be non-NULL for the destructor to run */
+    if (!mc_size_class_key_failed &&
+        pthread_setspecific(mc_size_class_key, &mc_size_class_key) == 0)
+        mc_size_class_exit_registered = true;
+}
+
+/* Moves up to one batch from the shared bin into the thread cache. */
+static bool mc_size_class_refill(size_t index,
+                                 struct mc_size_class_cache *cache)
+{
+    struct mc_size_class_bin *bin = &mc_size_class_bins[index];
+    size_t const size = mc_size_classes[index];
+    size_t const batch = mc_size_class_batch(index);
+
+    if (!mc_size_class_exit_registered)
+        mc_size_class_register_exit();
+
+    mc_spin_lock(&bin->lock);
+    while (cache->count < batch) {
+        void *block = bin->free_list;
+        if (block) {
+            bin->free_list = *(void **)block;
+        } else {
+            if (bin->bump == bin->bump_end) {
+                char *slab = mc_size_class_new_slab();
+                if (!slab)
+                    break;
+                ((struct mc_size_class_slab *)slab)->class_index = index;
+                size_t mask = mc_size_class_alignment(index) - 1;
+                size_t offset =
+                    (sizeof(struct mc_size_class_slab) + mask) & ~mask;
+                size_t count = (MC_SIZE_CLASS_SLAB_SIZE - offset) / size;
+                bin->bump = slab + offset;
+                bin->bump_end = bin->bump + count * size;
+            }
+            block = bin->bump;
+            bin->bump += size;
+        }
+        *(void **)block = cache->head;
+        cache->head = block;
+        ++cache->count;
+    }
+    mc_spin_unlock(&bin->lock);
+
+    return cache->head != NULL;
+}
+
+static void *mc_size_class_malloc(size_t alignment, size_t size)
+{
+    size_t index = mc_size_class_index(size);
+    while (index < MC_SIZE_CLASS_COUNT &&
+           mc_size_class_alignment(index) < alignment)
+        ++index;
+    if (index == MC_SIZE_CLASS_COUNT)
         return NULL;
 
+    struct mc_size_class_cache *cache = &mc_size_class_caches[index];
+    if (!cache->head && !mc_size_class_refill(index, cache))
+        return NULL;
+
+    void *block = cache->head;
+    cache->head = *(void **)block;
+    --cache->count;
+    return block;
+}
+
+static void mc_size_class_free(void *ptr)
+{
+    size_t const index = mc_size_class_slab_of(ptr)->class_index;
+    size_t const batch = mc_size_class_batch(index);
+    struct mc_size_class_cache *cache = &mc_size_class_caches[index];
+
+    /* A thread that only frees what others allocated caches blocks too */
+    if (!mc_size_class_exit_registered)
+        mc_size_class_register_exit();
+
+    *(void **)ptr = cache->head;
+    cache->head = ptr;
+    if (++cache->count < 2 * batch)
+        return;
+
+    /* Keep one batch for this thread and hand the rest to the bin. */
+    void *last = cache->head;
+    for (size_t i = 1; i < batch; ++i)
+        last = *(void **)last;
+    void *spill = *(void **)last;
+    *(void **)last = NULL;
+    cache->count = batch;
+
+    void *spill_last = spill;
+    while (*(void **)spill_last)
+        spill_last = *(void **)spill_last;
+    mc_size_class_give_back(index, spill, spill_last);
+}
+
+static size_t mc_size_class_usable_size(void const *ptr)
+{
+    return mc_size_classes[mc_size_class_slab_of(ptr)->class_index];
+}
+
+#endif
+
+static void *mc_heap_aligned_malloc(size_t alignment, size_t size)
+{
     size_t extras = PTRSZ + (alignment - 1);
     if (size > SIZE_MAX - extras)
         return NULL;
@@ -33,11 +454,111 @@ void *mc_aligned_malloc(size_t alignment, size_t size)
     return (void *)aligned_addr;
 }
 
+void *mc_aligned_malloc(size_t alignment, size_t size)
+{
+    if (!alignment || !size)
+        return NULL;
+
+    if (!ISPOWOF2(alignment))
+        return NULL;
+
+#if MC_HAVE_MMAP
+    if (mc_wants_mapping(size)) {
+        void *ptr = mc_mapped_malloc(alignment, size);
+        if (ptr)
+            return ptr;
+    }
+
+    if (mc_wants_size_class(size)) {
+        void *ptr = mc_size_class_malloc(alignment, size);
+        if (ptr)
+            return ptr;
+    }
+#endif
+
+    return mc_heap_aligned_malloc(alignment, size);
+}
+
+void *mc_aligned_realloc(void *ptr, size_t alignment, size_t old_size,
+                         size_t new_size)
+{
+    if (!ptr)
+        return mc_aligned_malloc(alignment, new_size);
+
+    if (!new_size) {
+        mc_aligned_free(ptr);
+        return NULL;
+    }
+
+    if (!alignment || !ISPOWOF2(alignment))
+        return NULL;
+
+    bool in_size_class = false;
+#if MC_HAVE_MMAP
+    in_size_class = mc_size_class_owns(ptr);
+    /* A block stays in its class unless it would waste more than half. */
+    if (in_size_class) {
+        size_t usable = mc_size_class_usable_size(ptr);
+        if (new_size <= usable && (new_size > usable / 2 || usable == 16) &&
+            (uintptr_t)ptr % alignment == 0)
+            return ptr;
+    }
+#endif
+
+    /* Heap to heap with at most malloc's own alignment can use realloc;
+     * the data only moves if the new block lands at a different offset. */
+    if (!in_size_class && !mc_is_mapped(ptr) && !mc_wants_mapping(new_size) &&
+        !mc_wants_size_class(new_size) && alignment <= alignof(max_align_t)) {
+        size_t extras = PTRSZ + (alignment - 1);
+        if (new_size > SIZE_MAX - extras)
+            return NULL;
+
+        void *raw_ptr = *(void **)((uintptr_t)ptr - PTRSZ);
+        size_t old_offset = (size_t)((uintptr_t)ptr - (uintptr_t)raw_ptr);
+
+        void *new_raw = realloc(raw_ptr, new_size + extras);
+        if (!new_raw)
+            return NULL;
+
+        uintptr_t raw_addr = (uintptr_t)new_raw;
+        uintptr_t mask = alignment - 1;
+        uintptr_t aligned_addr = (raw_addr + PTRSZ + mask) & ~mask;
+        size_t new_offset = (size_t)(aligned_addr - raw_addr);
+        if (new_offset != old_offset) {
+            size_t keep = old_size < new_size ? old_size : new_size;
+            memmove((void *)aligned_addr, (char *)new_raw + old_offset, keep);
+        }
+
+        *(void **)(aligned_addr - PTRSZ) = new_raw;
+        return (void *)aligned_addr;
+    }
+
+    void *new_ptr = mc_aligned_malloc(alignment, new_size);
+    if (!new_ptr)
+        return NULL;
+
+    memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+    mc_aligned_free(ptr);
+    return new_ptr;
+}
+
 void mc_aligned_free(void *ptr)
 {
     if (!ptr)
         return;
 
+#if MC_HAVE_MMAP
+    if (mc_size_class_owns(ptr)) {
+        mc_size_class_free(ptr);
+        return;
+    }
+
+    if (mc_is_mapped(ptr)) {
+        mc_mapped_free(ptr);
+        return;
+    }
+#endif
+
     void **raw_ptr_storage = (void *)((uintptr_t)ptr - PTRSZ);
     free(*raw_ptr_storage);
 }
@@ -0,0 +1,70 @@
+#include <assert.h>
+#include <string.h>
+#include "myclib/allocator.h"
+#include "myclib/aligned_malloc.h"
+
+static void *mc_default_alloc(void *ctx, size_t alignment, size_t size)
+{
+    (void)ctx;
+    return mc_aligned_malloc(alignment, size);
+}
+
+static void *mc_default_realloc(void *ctx, void *ptr, size_t alignment,
+                                size_t old_size, size_t new_size)
+{
+    (void)ctx;
+    return mc_aligned_realloc(ptr, alignment, old_size, new_size);
+}
+
+static void mc_default_free(void *ctx, void *ptr, size_t size)
+{
+    (void)ctx;
+    (void)size;
+    mc_aligned_free(ptr);
+}
+
+struct mc_allocator const mc_default_allocator = {
+    .alloc = mc_default_alloc,
+    .realloc = mc_default_realloc,
+    .free = mc_default_free,
+    .ctx = NULL,
+};
+
+void *mc_allocator_alloc(struct mc_allocator const *allocator,
+                         size_t alignment, size_t size)
+{
+    assert(allocator);
+    return allocator->alloc(allocator->ctx, alignment, size);
+}
+
+void *mc_allocator_realloc(struct mc_allocator const *allocator, void *ptr,
+                           size_t alignment, size_t old_size, size_t new_size)
+{
+    assert(allocator);
+
+    if (allocator->realloc)
+        return allocator->realloc(allocator->ctx, ptr, alignment, old_size,
+                                  new_size);
+
+    void *new_ptr = NULL;
+    if (new_size > 0) {
+        new_ptr = allocator->alloc(allocator->ctx, alignment, new_size);
+        if (!new_ptr)
+            return NULL;
+        if (ptr)
+            memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+    }
+
+    if (ptr)
+        allocator->free(allocator->ctx, ptr, old_size);
+
+    return new_ptr;
+}
+
+void mc_allocator_free(struct mc_allocator const *allocator, void *ptr,
+                       size_t size)
+{
+    assert(allocator);
+    if (ptr)
+        allocator->free(allocator->ctx, ptr, size);
+}
@@ -0,0 +1,229 @@
+#include <assert.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+#include "myclib/arena.h"
+#include "myclib/aligned_malloc.h"
+#include "myclib/utils.h"
+
+struct mc_arena_chunk {
+    struct mc_arena_chunk *next;
+    size_t size;
+    size_t used;
+    alignas(max_align_t) char data[];
+};
+
+static void *mc_arena_allocator_alloc(void *ctx, size_t alignment, size_t size)
+{
+    return mc_arena_alloc(ctx, alignment, size);
+}
+
+static void *mc_arena_allocator_realloc(void *ctx, void *ptr, size_t alignment,
+                                        size_t old_size, size_t new_size)
+{
+    return mc_arena_realloc(ctx, ptr, alignment, old_size, new_size);
+}
+
+static void mc_arena_allocator_free(void *ctx, void *ptr, size_t size)
+{
+    mc_arena_free(ctx, ptr, size);
+}
+
+void mc_arena_init(struct mc_arena *arena, size_t chunk_size)
+{
+    assert(arena);
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->ptr = NULL;
+    arena->end = NULL;
+    arena->chunk_size = chunk_size ? chunk_size : MC_ARENA_DEFAULT_CHUNK_SIZE;
+    arena->allocator.alloc = mc_arena_allocator_alloc;
+    arena->allocator.realloc = mc_arena_allocator_realloc;
+    arena->allocator.free = mc_arena_allocator_free;
+    arena->allocator.ctx = arena;
+}
+
+void mc_arena_cleanup(struct mc_arena *arena)
+{
+    assert(arena);
+
+    struct mc_arena_chunk *chunk = arena->first;
+    while (chunk) {
+        struct mc_arena_chunk *next = chunk->next;
+        mc_aligned_free(chunk);
+        chunk = next;
+    }
+
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->ptr = NULL;
+    arena->end = NULL;
+}
+
+static void mc_arena_enter(struct mc_arena *arena, struct mc_arena_chunk *chunk,
+                           size_t used)
+{
+    arena->current = chunk;
+    arena->ptr = chunk->data + used;
+    arena->end = chunk->data + chunk->size;
+}
+
+static char *mc_arena_align(char *ptr, size_t alignment)
+{
+    uintptr_t addr = (uintptr_t)ptr;
+    return ptr + (((addr + alignment - 1) & ~(uintptr_t)(alignment - 1)) - addr);
+}
+
+/* Moves on to the next chunk that can hold the request, reusing chunks
+ * kept by an earlier rewind or reset, or links in a new one. */
+static bool mc_arena_grow(struct mc_arena *arena, size_t alignment,
+                          size_t size)
+{
+    if (size > SIZE_MAX / 2 - alignment)
+        return false;
+    size_t needed = size + alignment;
+
+    struct mc_arena_chunk *prev = arena->current;
+    if (prev) {
+        prev->used = (size_t)(arena->ptr - prev->data);
+        struct mc_arena_chunk *next = prev->next;
+        if (next && next->size >= needed) {
+            mc_arena_enter(arena, next, 0);
+            return true;
+        }
+    }
+
+    size_t chunk_size = arena->chunk_size;
+    if (prev)
+        chunk_size = mc_max2(chunk_size,
+                             prev->size < MC_ARENA_MAX_CHUNK_GROWTH
+                                 ? prev->size * 2
+                                 : MC_ARENA_MAX_CHUNK_GROWTH);
+    chunk_size = mc_max2(chunk_size, needed);
+
+    struct mc_arena_chunk *chunk = mc_aligned_malloc(
+        alignof(struct mc_arena_chunk), sizeof(*chunk) + chunk_size);
+    if (!chunk)
+        return false;
+
+    chunk->size = chunk_size;
+    chunk->used = 0;
+    if (prev) {
+        chunk->next = prev->next;
+        prev->next = chunk;
+    } else {
+        chunk->next = arena->first;
+        arena->first = chunk;
+    }
+
+    mc_arena_enter(arena, chunk, 0);
+    return true;
+}
+
+void *mc_arena_alloc(struct mc_arena *arena, size_t alignment, size_t size)
+{
+    assert(arena);
+
+    if (!alignment || !size || !mc_is_pow_of_two(alignment))
+        return NULL;
+
+    if (arena->ptr) {
+        char *ptr = mc_arena_align(arena->ptr, alignment);
+        if (ptr <= arena->end && size <= (size_t)(arena->end - ptr)) {
+            arena->ptr = ptr + size;
+            return ptr;
+        }
+    }
+
+    if (!mc_arena_grow(arena, alignment, size))
+        return NULL;
+
+    char *ptr = mc_arena_align(arena->ptr, alignment);
+    arena->ptr = ptr + size;
+    return ptr;
+}
+
+static bool mc_arena_is_last(struct mc_arena const *arena, void const *ptr,
+                             size_t size)
+{
+    return ptr && (char const *)ptr + size == arena->ptr;
+}
+
+void *mc_arena_realloc(struct mc_arena *arena, void *ptr, size_t alignment,
+                       size_t old_size, size_t new_size)
+{
+    assert(arena);
+
+    if (!ptr)
+        return mc_arena_alloc(arena, alignment, new_size);
+
+    if (!new_size) {
+        mc_arena_free(arena, ptr, old_size);
+        return NULL;
+    }
+
+    /* The most recent block grows or shrinks in place when it fits. */
+    if (mc_arena_is_last(arena, ptr, old_size) &&
+        new_size <= (size_t)(arena->end - (char *)ptr)) {
+        arena->ptr = (char *)ptr + new_size;
+        return ptr;
+    }
+
+    if (new_size <= old_size)
+        return ptr;
+
+    void *new_ptr = mc_arena_alloc(arena, alignment, new_size);
+    if (new_ptr)
+        memcpy(new_ptr, ptr, old_size);
+    return new_ptr;
+}
+
+void mc_arena_free(struct mc_arena *arena, void *ptr, size_t size)
+{
+    assert(arena);
+
+    if (mc_arena_is_last(arena, ptr, size))
+        arena->ptr = ptr;
+}
+
+struct mc_arena_mark mc_arena_mark(struct mc_arena const *arena)
+{
+    assert(arena);
+    struct mc_arena_mark mark = {.chunk = arena->current, .ptr = arena->ptr};
+    return mark;
+}
+
+void mc_arena_rewind(struct mc_arena *arena, struct mc_arena_mark mark)
+{
+    assert(arena);
+
+    if (!mark.chunk) {
+        mc_arena_reset(arena);
+        return;
+    }
+
+    mc_arena_enter(arena, mark.chunk, (size_t)(mark.ptr - mark.chunk->data));
+}
+
+void mc_arena_reset(struct mc_arena *arena)
+{
+    assert(arena);
+
+    if (arena->first)
+        mc_arena_enter(arena, arena->first, 0);
+}
+
+size_t mc_arena_used(struct mc_arena const *arena)
+{
+    assert(arena);
+
+    if (!arena->current)
+        return 0;
+
+    size_t used = 0;
+    for (struct mc_arena_chunk *chunk = arena->first; chunk != arena->current;
+         chunk = chunk->next)
+        used += chunk->used;
+
+    return used + (size_t)(arena->ptr - arena->current->data);
+}
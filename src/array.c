@@ -3,6 +3,7 @@
 #include <string.h>
 #include "myclib/array.h"
 #include "myclib/aligned_malloc.h"
+#include "myclib/simd.h"
 #include "myclib/utils.h"
 
 #define MC_ARRAY_FOR_EACH(elem, array, start, end, body)                       \
@@ -15,16 +16,25 @@
     } while (0)
 
 void mc_array_init(struct mc_array *array, struct mc_type const *elem_type)
+{
+    mc_array_init_with_allocator(array, elem_type, &mc_default_allocator);
+}
+
+void mc_array_init_with_allocator(struct mc_array *array,
+                                  struct mc_type const *elem_type,
+                                  struct mc_allocator const *allocator)
 {
     assert(array);
     assert(elem_type);
     assert(elem_type->move);
     assert(elem_type->size > 0);
     assert(mc_is_pow_of_two(elem_type->alignment));
+    assert(allocator);
     array->data = NULL;
     array->len = 0;
     array->capacity = 0;
     array->elem_type = elem_type;
+    array->allocator = allocator;
 }
 
 void mc_array_with_capacity(struct mc_array *array,
@@ -55,7 +65,8 @@ void mc_array_from(struct mc_array *array, struct mc_type const *elem_type,
 static void mc_array_free_data(struct mc_array *array)
 {
     if (array->capacity > 0) {
-        mc_aligned_free(array->data);
+        mc_allocator_free(array->allocator, array->data,
+                          array->capacity * array->elem_type->size);
         array->data = NULL;
         array->capacity = 0;
     }
@@ -137,6 +148,15 @@ void mc_array_push(struct mc_array *array, void *elem)
     ++array->len;
 }
 
+void *mc_array_emplace_back(struct mc_array *array)
+{
+    assert(array);
+
+    mc_array_grow_capacity_if_needed(array);
+
+    return mc_array_get_unchecked(array, array->len++);
+}
+
 static void mc_array_extract_one(struct mc_array *array, size_t index,
                                  void *out_elem)
 {
@@ -254,6 +274,55 @@ void mc_array_remove(struct mc_array *array, size_t index, void *out_elem)
     --array->len;
 }
 
+void mc_array_swap_remove(struct mc_array *array, size_t index,
+                          void *out_elem)
+{
+    assert(array);
+
+    size_t len = array->len;
+
+    mc_array_bounds_check(__func__, index, len, false);
+
+    mc_array_extract_one(array, index, out_elem);
+
+    if (index != len - 1)
+        memcpy(mc_array_get_unchecked(array, index),
+               mc_array_get_unchecked(array, len - 1), array->elem_type->size);
+
+    --array->len;
+}
+
+void *mc_array_emplace_at(struct mc_array *array, size_t index)
+{
+    assert(array);
+
+    size_t len = array->len;
+
+    /* Allow insertion at the end. */
+    mc_array_bounds_check(__func__, index, len, true);
+
+    mc_array_grow_capacity_if_needed(array);
+
+    mc_array_shift(array, index + 1, index, len - index);
+
+    ++array->len;
+
+    return mc_array_get_unchecked(array, index);
+}
+
+void *mc_array_extend_uninit(struct mc_array *array, size_t n)
+{
+    assert(array);
+
+    if (n > array->capacity - array->len)
+        mc_array_reserve(array, n);
+
+    void *slots = mc_array_get_unchecked(array, array->len);
+    array->len += n;
+
+    return slots;
+}
+
 void mc_array_append_range(struct mc_array *array, void *elems,
                            size_t elems_len)
 {
@@ -315,6 +384,91 @@ void mc_array_remove_range(struct mc_array *array, size_t index, size_t len,
     array->len -= len;
 }
 
+/*
+ * Single pass compaction shared by retain and dedup. Elements for which
+ * keep() is false are cleaned up, and each run of kept elements is moved
+ * down with one memmove once the run ends. keep() also receives the last
+ * element kept so far (NULL if none), wherever it currently sits.
+ */
+static void mc_array_compact(struct mc_array *array,
+                             bool (*keep)(void const *elem,
+                                          void const *last_kept,
+                                          void const *ctx),
+                             void const *ctx)
+{
+    size_t len = array->len;
+    size_t write = 0;
+    size_t run_start = 0;
+    mc_cleanup_func cleanup = array->elem_type->cleanup;
+
+    for (size_t read = 0; read < len; ++read) {
+        void *elem = mc_array_get_unchecked(array, read);
+        void const *last_kept = NULL;
+
+        if (read != run_start)
+            last_kept = mc_array_get_unchecked(array, read - 1);
+        else if (write != 0)
+            last_kept = mc_array_get_unchecked(array, write - 1);
+
+        if (keep(elem, last_kept, ctx))
+            continue;
+
+        mc_array_shift(array, write, run_start, read - run_start);
+        write += read - run_start;
+        run_start = read + 1;
+
+        if (cleanup)
+            cleanup(elem);
+    }
+
+    mc_array_shift(array, write, run_start, len - run_start);
+    array->len = write + (len - run_start);
+}
+
+struct mc_array_retain_ctx {
+    bool (*pred)(void const *, void const *user_data);
+    void const *user_data;
+};
+
+static bool mc_array_retain_keep(void const *elem, void const *last_kept,
+                                 void const *ctx)
+{
+    struct mc_array_retain_ctx const *retain = ctx;
+    (void)last_kept;
+    return retain->pred(elem, retain->user_data);
+}
+
+void mc_array_retain(struct mc_array *array,
+                     bool (*pred)(void const *, void const *user_data),
+                     void const *user_data)
+{
+    assert(array);
+    assert(pred);
+
+    struct mc_array_retain_ctx ctx = {.pred = pred, .user_data = user_data};
+    mc_array_compact(array, mc_array_retain_keep, &ctx);
+}
+
+struct mc_array_dedup_ctx {
+    mc_equal_func eq;
+};
+
+static bool mc_array_dedup_keep(void const *elem, void const *last_kept,
+                                void const *ctx)
+{
+    struct mc_array_dedup_ctx const *dedup = ctx;
+    return !last_kept || !dedup->eq(last_kept, elem);
+}
+
+void mc_array_dedup(struct mc_array *array)
+{
+    assert(array);
+
+    struct mc_array_dedup_ctx ctx = {
+        .eq = mc_type_get_equal_forced(__func__, array->elem_type)};
+    mc_array_compact(array, mc_array_dedup_keep, &ctx);
+}
+
 void mc_array_clear(struct mc_array *array)
 {
     assert(array);
@@ -332,15 +486,14 @@ static void mc_array_adjust_capacity(struct mc_array *array, size_t capacity)
     size_t elem_size = array->elem_type->size;
     size_t total_size = capacity * elem_size;
 
-    void *new_data = mc_aligned_malloc(elem_align, total_size);
+    void *new_data =
+        mc_allocator_realloc(array->allocator, array->data, elem_align,
+                             array->capacity * elem_size, total_size);
     if (!new_data) {
         fprintf(stderr, "memory allocation of %zu bytes failed\n", total_size);
         abort();
     }
 
-    memcpy(new_data, array->data, array->len * elem_size);
-
-    mc_aligned_free(array->data);
     array->data = new_data;
     array->capacity = capacity;
 }
@@ -427,26 +580,40 @@ void mc_array_resize(struct mc_array *array, size_t len, void *elem)
     array->len = len;
 }
 
+/* Below this length the per-element loop is as fast as the vector kernels. */
+#define MC_ARRAY_SIMD_FIND_MIN_LEN 16
+
+static bool mc_array_can_simd_find(struct mc_array const *array)
+{
+    return array->len >= MC_ARRAY_SIMD_FIND_MIN_LEN &&
+           mc_type_is_integer(array->elem_type);
+}
+
+static void *mc_array_simd_find(struct mc_array const *array, void const *elem)
+{
+    size_t index =
+        mc_simd_find(array->data, array->len, array->elem_type->size, elem);
+    return index < array->len ? mc_array_get_unchecked(array, index) : NULL;
+}
+
 bool mc_array_contains(struct mc_array const *array, void const *elem)
 {
     assert(array);
     assert(elem);
 
-    mc_equal_func eq = mc_type_get_equal_forced(__func__, array->elem_type);
-    MC_ARRAY_FOR_EACH(curr, array, 0, array->len, {
-        if (eq(curr, elem))
-            return true;
-    });
-
-    return false;
+    return mc_array_find(array, elem) != NULL;
 }
 
 void *mc_array_find(struct mc_array const *array, void const *elem)
 {
     assert(array);
+    assert(elem);
 
     mc_equal_func eq = mc_type_get_equal_forced(__func__, array->elem_type);
 
+    if (mc_array_can_simd_find(array))
+        return mc_array_simd_find(array, elem);
+
     MC_ARRAY_FOR_EACH(curr, array, 0, array->len, {
         if (eq(curr, elem))
             return curr;
@@ -489,6 +656,348 @@ void mc_array_sort_with(struct mc_array const *array, mc_compare_func cmp)
     qsort(array->data, array->len, array->elem_type->size, cmp);
 }
 
+#define MC_STABLE_SORT_MIN_MERGE 32
+#define MC_STABLE_SORT_MAX_RUNS 128
+
+struct mc_stable_sort_run {
+    size_t base;
+    size_t len;
+};
+
+struct mc_stable_sort_state {
+    char *data;
+    size_t elem_size;
+    size_t elem_align;
+    mc_compare_func cmp;
+    char *scratch;
+    size_t scratch_capacity;
+    struct mc_stable_sort_run runs[MC_STABLE_SORT_MAX_RUNS];
+    size_t num_runs;
+};
+
+static inline char *mc_stable_sort_at(struct mc_stable_sort_state const *state,
+                                      size_t index)
+{
+    return state->data + index * state->elem_size;
+}
+
+/* The scratch buffer is allocated once per sort and only grows, so every
+ * merge and insertion step reuses the same memory. */
+static void mc_stable_sort_ensure_scratch(struct mc_stable_sort_state *state,
+                                          size_t len)
+{
+    if (len <= state->scratch_capacity)
+        return;
+
+    size_t capacity = mc_max2(len, state->scratch_capacity * 2);
+    size_t total_size = capacity * state->elem_size;
+
+    void *new_scratch = mc_aligned_malloc(state->elem_align, total_size);
+    if (!new_scratch) {
+        fprintf(stderr, "memory allocation of %zu bytes failed\n", total_size);
+        abort();
+    }
+
+    mc_aligned_free(state->scratch);
+    state->scratch = new_scratch;
+    state->scratch_capacity = capacity;
+}
+
+static size_t mc_stable_sort_min_run(size_t len)
+{
+    size_t r = 0;
+
+    while (len >= MC_STABLE_SORT_MIN_MERGE) {
+        r |= len & 1;
+        len >>= 1;
+    }
+
+    return len + r;
+}
+
+static void mc_stable_sort_reverse(struct mc_stable_sort_state *state,
+                                   size_t lo, size_t hi)
+{
+    size_t elem_size = state->elem_size;
+    char *tmp = state->scratch;
+
+    while (hi - lo > 1) {
+        --hi;
+        char *a = mc_stable_sort_at(state, lo);
+        char *b = mc_stable_sort_at(state, hi);
+        memcpy(tmp, a, elem_size);
+        memcpy(a, b, elem_size);
+        memcpy(b, tmp, elem_size);
+        ++lo;
+    }
+}
+
+/* Returns the length of the run starting at lo, reversing it in place if it
+ * is strictly descending. Strictness keeps equal elements in order. */
+static size_t mc_stable_sort_count_run(struct mc_stable_sort_state *state,
+                                       size_t lo, size_t hi)
+{
+    mc_compare_func cmp = state->cmp;
+    size_t run_hi = lo + 1;
+
+    if (run_hi == hi)
+        return 1;
+
+    if (cmp(mc_stable_sort_at(state, run_hi), mc_stable_sort_at(state, lo)) <
+        0) {
+        ++run_hi;
+        while (run_hi < hi && cmp(mc_stable_sort_at(state, run_hi),
+                                  mc_stable_sort_at(state, run_hi - 1)) < 0)
+            ++run_hi;
+        mc_stable_sort_reverse(state, lo, run_hi);
+    } else {
+        ++run_hi;
+        while (run_hi < hi && cmp(mc_stable_sort_at(state, run_hi),
+                                  mc_stable_sort_at(state, run_hi - 1)) >= 0)
+            ++run_hi;
+    }
+
+    return run_hi - lo;
+}
+
+/* Sorts [lo, hi) given that [lo, start) is already sorted. */
+static void mc_stable_sort_binary_insertion(struct mc_stable_sort_state *state,
+                                            size_t lo, size_t hi, size_t start)
+{
+    mc_compare_func cmp = state->cmp;
+    size_t elem_size = state->elem_size;
+    char *pivot = state->scratch;
+
+    for (; start < hi; ++start) {
+        memcpy(pivot, mc_stable_sort_at(state, start), elem_size);
+
+        size_t left = lo, right = start;
+        while (left < right) {
+            size_t mid = left + (right - left) / 2;
+            if (cmp(pivot, mc_stable_sort_at(state, mid)) < 0)
+                right = mid;
+            else
+                left = mid + 1;
+        }
+
+        memmove(mc_stable_sort_at(state, left + 1),
+                mc_stable_sort_at(state, left), (start - left) * elem_size);
+        memcpy(mc_stable_sort_at(state, left), pivot, elem_size);
+    }
+}
+
+/* First index in [lo, hi) whose element is greater than key. */
+static size_t mc_stable_sort_upper_bound(struct mc_stable_sort_state *state,
+                                         void const *key, size_t lo, size_t hi)
+{
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (state->cmp(key, mc_stable_sort_at(state, mid)) < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return lo;
+}
+
+/* First index in [lo, hi) whose element is not less than key. */
+static size_t mc_stable_sort_lower_bound(struct mc_stable_sort_state *state,
+                                         void const *key, size_t lo, size_t hi)
+{
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (state->cmp(mc_stable_sort_at(state, mid), key) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void mc_stable_sort_merge_lo(struct mc_stable_sort_state *state,
+                                    size_t base, size_t len_a, size_t len_b)
+{
+    mc_compare_func cmp = state->cmp;
+    size_t elem_size = state->elem_size;
+
+    mc_stable_sort_ensure_scratch(state, len_a);
+    memcpy(state->scratch, mc_stable_sort_at(state, base), len_a * elem_size);
+
+    char *a = state->scratch;
+    char *a_end = a + len_a * elem_size;
+    char *b = mc_stable_sort_at(state, base + len_a);
+    char *b_end = b + len_b * elem_size;
+    char *dst = mc_stable_sort_at(state, base);
+
+    while (a < a_end && b < b_end) {
+        if (cmp(b, a) < 0) {
+            memcpy(dst, b, elem_size);
+            b += elem_size;
+        } else {
+            memcpy(dst, a, elem_size);
+            a += elem_size;
+        }
+        dst += elem_size;
+    }
+
+    /* Whatever is left of B is already in place. */
+    memcpy(dst, a, (size_t)(a_end - a));
+}
+
+static void mc_stable_sort_merge_hi(struct mc_stable_sort_state *state,
+                                    size_t base, size_t len_a, size_t len_b)
+{
+    mc_compare_func cmp = state->cmp;
+    size_t elem_size = state->elem_size;
+
+    mc_stable_sort_ensure_scratch(state, len_b);
+    memcpy(state->scratch, mc_stable_sort_at(state, base + len_a),
+           len_b * elem_size);
+
+    char *a_begin = mc_stable_sort_at(state, base);
+    char *a = a_begin + len_a * elem_size;
+    char *b_begin = state->scratch;
+    char *b = b_begin + len_b * elem_size;
+    char *dst = mc_stable_sort_at(state, base + len_a + len_b);
+
+    while (a > a_begin && b > b_begin) {
+        dst -= elem_size;
+        if (cmp(b - elem_size, a - elem_size) < 0) {
+            a -= elem_size;
+            memcpy(dst, a, elem_size);
+        } else {
+            b -= elem_size;
+            memcpy(dst, b, elem_size);
+        }
+    }
+
+    /* Whatever is left of A is already in place. */
+    memcpy(a_begin, b_begin, (size_t)(b - b_begin));
+}
+
+static void mc_stable_sort_merge_at(struct mc_stable_sort_state *state,
+                                    size_t i)
+{
+    struct mc_stable_sort_run *runs = state->runs;
+    size_t base = runs[i].base;
+    size_t len_a = runs[i].len;
+    size_t len_b = runs[i + 1].len;
+
+    runs[i].len = len_a + len_b;
+    if (i + 3 == state->num_runs)
+        runs[i + 1] = runs[i + 2];
+    --state->num_runs;
+
+    /* Elements of A not greater than B[0] are already in place. */
+    size_t b_base = base + len_a;
+    size_t k = mc_stable_sort_upper_bound(
+        state, mc_stable_sort_at(state, b_base), base, b_base);
+    len_a -= k - base;
+    base = k;
+    if (len_a == 0)
+        return;
+
+    /* Elements of B not less than A[last] are already in place. */
+    len_b = mc_stable_sort_lower_bound(state,
+                                       mc_stable_sort_at(state, b_base - 1),
+                                       b_base, b_base + len_b) -
+            b_base;
+    if (len_b == 0)
+        return;
+
+    if (len_a <= len_b)
+        mc_stable_sort_merge_lo(state, base, len_a, len_b);
+    else
+        mc_stable_sort_merge_hi(state, base, len_a, len_b);
+}
+
+static void mc_stable_sort_merge_collapse(struct mc_stable_sort_state *state)
+{
+    struct mc_stable_sort_run *runs = state->runs;
+
+    while (state->num_runs > 1) {
+        size_t n = state->num_runs - 2;
+
+        if ((n > 0 && runs[n - 1].len <= runs[n].len + runs[n + 1].len) ||
+            (n > 1 && runs[n - 2].len <= runs[n - 1].len + runs[n].len)) {
+            if (runs[n - 1].len < runs[n + 1].len)
+                --n;
+        } else if (runs[n].len > runs[n + 1].len) {
+            break;
+        }
+
+        mc_stable_sort_merge_at(state, n);
+    }
+}
+
+static void
+mc_stable_sort_merge_force_collapse(struct mc_stable_sort_state *state)
+{
+    struct mc_stable_sort_run *runs = state->runs;
+
+    while (state->num_runs > 1) {
+        size_t n = state->num_runs - 2;
+        if (n > 0 && runs[n - 1].len < runs[n + 1].len)
+            --n;
+        mc_stable_sort_merge_at(state, n);
+    }
+}
+
+void mc_array_stable_sort(struct mc_array const *array)
+{
+    assert(array);
+    mc_compare_func cmp =
+        mc_type_get_compare_forced(__func__, array->elem_type);
+    mc_array_stable_sort_with(array, cmp);
+}
+
+void mc_array_stable_sort_with(struct mc_array const *array,
+                               mc_compare_func cmp)
+{
+    assert(array);
+    assert(cmp);
+
+    size_t len = array->len;
+    if (len < 2)
+        return;
+
+    struct mc_stable_sort_state state = {
+        .data = array->data,
+        .elem_size = array->elem_type->size,
+        .elem_align = array->elem_type->alignment,
+        .cmp = cmp,
+        .scratch = NULL,
+        .scratch_capacity = 0,
+        .num_runs = 0,
+    };
+
+    size_t min_run = mc_stable_sort_min_run(len);
+    mc_stable_sort_ensure_scratch(&state, min_run);
+
+    size_t lo = 0;
+    while (lo < len) {
+        size_t remaining = len - lo;
+        size_t run_len = mc_stable_sort_count_run(&state, lo, len);
+
+        if (run_len < min_run) {
+            size_t forced = remaining < min_run ? remaining : min_run;
+            mc_stable_sort_binary_insertion(&state, lo, lo + forced,
+                                            lo + run_len);
+            run_len = forced;
+        }
+
+        state.runs[state.num_runs].base = lo;
+        state.runs[state.num_runs].len = run_len;
+        ++state.num_runs;
+        mc_stable_sort_merge_collapse(&state);
+
+        lo += run_len;
+    }
+
+    mc_stable_sort_merge_force_collapse(&state);
+    mc_aligned_free(state.scratch);
+}
+
 bool mc_array_binary_search(struct mc_array const *array, void const *elem,
                             size_t *out_index)
 {
@@ -519,6 +1028,52 @@ bool mc_array_binary_search(struct mc_array const *array, void const *elem,
     return false;
 }
 
+bool mc_array_binary_search_branchless(struct mc_array const *array,
+                                       void const *elem, size_t *out_index)
+{
+    assert(array);
+    assert(elem);
+
+    mc_compare_func cmp =
+        mc_type_get_compare_forced(__func__, array->elem_type);
+
+    size_t len = array->len;
+    if (len < 1)
+        return false;
+
+    size_t elem_size = array->elem_type->size;
+    char const *base = array->data;
+
+    /*
+     * Halve the range without an unpredictable branch: the only data
+     * dependent choice is a conditional move of base. Both candidates for
+     * the next probe are prefetched so the memory latency overlaps.
+     */
+    while (len > 1) {
+        size_t half = len / 2;
+        mc_prefetch(base + (half / 2) * elem_size);
+        mc_prefetch(base + (half + half / 2) * elem_size);
+        char const *mid = base + half * elem_size;
+        base = cmp(mid, elem) < 0 ? mid : base;
+        len -= half;
+    }
+
+    /* base is now the last element less than elem, or the first element. */
+    if (cmp(base, elem) < 0) {
+        base += elem_size;
+        if (base == (char const *)mc_array_get_unchecked(array, array->len))
+            return false;
+    }
+
+    if (cmp(base, elem) != 0)
+        return false;
+
+    if (out_index)
+        *out_index = (size_t)(base - (char const *)array->data) / elem_size;
+
+    return true;
+}
+
 void mc_array_for_each(struct mc_array const *array,
                        void (*func)(void *elem, void *user_data),
                        void *user_data)
@@ -547,7 +1102,7 @@ void mc_array_copy(struct mc_array *dst, struct mc_array const *src)
     assert(dst);
     assert(src);
 
-    mc_array_init(dst, src->elem_type);
+    mc_array_init_with_allocator(dst, src->elem_type, src->allocator);
     mc_array_reserve(dst, src->len);
 
     copy = mc_type_get_copy_forced(__func__, dst->elem_type);
@@ -0,0 +1,353 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/deque.h"
+#include "myclib/aligned_malloc.h"
+#include "myclib/utils.h"
+
+void mc_deque_init(struct mc_deque *deque, struct mc_type const *elem_type)
+{
+    assert(deque);
+    assert(elem_type);
+    assert(elem_type->move);
+    assert(elem_type->size > 0);
+    assert(mc_is_pow_of_two(elem_type->alignment));
+    deque->elem_type = elem_type;
+    deque->data = NULL;
+    deque->head = 0;
+    deque->len = 0;
+    deque->capacity = 0;
+}
+
+void mc_deque_with_capacity(struct mc_deque *deque,
+                            struct mc_type const *elem_type, size_t capacity)
+{
+    assert(deque);
+    mc_deque_init(deque, elem_type);
+    mc_deque_reserve(deque, capacity);
+}
+
+static void mc_deque_free_data(struct mc_deque *deque)
+{
+    if (deque->capacity > 0) {
+        mc_aligned_free(deque->data);
+        deque->data = NULL;
+        deque->capacity = 0;
+        deque->head = 0;
+    }
+}
+
+void mc_deque_cleanup(struct mc_deque *deque)
+{
+    assert(deque);
+    mc_deque_clear(deque);
+    mc_deque_free_data(deque);
+    deque->elem_type = NULL;
+}
+
+static inline void *mc_deque_slot(struct mc_deque const *deque, size_t slot)
+{
+    return mc_ptr_add(deque->data, deque->elem_type->size * slot);
+}
+
+static inline size_t mc_deque_wrap(struct mc_deque const *deque, size_t index)
+{
+    return index & (deque->capacity - 1);
+}
+
+void *mc_deque_get(struct mc_deque const *deque, size_t index)
+{
+    assert(deque);
+    return index < deque->len ? mc_deque_get_unchecked(deque, index) : NULL;
+}
+
+void *mc_deque_get_unchecked(struct mc_deque const *deque, size_t index)
+{
+    assert(deque);
+    return mc_deque_slot(deque, mc_deque_wrap(deque, deque->head + index));
+}
+
+void *mc_deque_get_front(struct mc_deque const *deque)
+{
+    assert(deque);
+    return deque->len > 0 ? mc_deque_get_unchecked(deque, 0) : NULL;
+}
+
+void *mc_deque_get_back(struct mc_deque const *deque)
+{
+    assert(deque);
+    return deque->len > 0 ? mc_deque_get_unchecked(deque, deque->len - 1)
+                          : NULL;
+}
+
+/* Unwraps the elements to the start of a new buffer. */
+static void mc_deque_adjust_capacity(struct mc_deque *deque, size_t capacity)
+{
+    if (capacity == 0) {
+        mc_deque_free_data(deque);
+        return;
+    }
+
+    size_t elem_size = deque->elem_type->size;
+    size_t total_size = capacity * elem_size;
+
+    void *new_data = mc_aligned_malloc(deque->elem_type->alignment, total_size);
+    if (!new_data) {
+        fprintf(stderr, "memory allocation of %zu bytes failed\n", total_size);
+        abort();
+    }
+
+    if (deque->len > 0) {
+        size_t first = deque->capacity - deque->head;
+        if (first > deque->len)
+            first = deque->len;
+        memcpy(new_data, mc_deque_slot(deque, deque->head), first * elem_size);
+        memcpy(mc_ptr_add(new_data, first * elem_size), deque->data,
+               (deque->len - first) * elem_size);
+    }
+
+    mc_aligned_free(deque->data);
+    deque->data = new_data;
+    deque->capacity = capacity;
+    deque->head = 0;
+}
+
+void mc_deque_reserve(struct mc_deque *deque, size_t additional)
+{
+    assert(deque);
+
+    if (additional > SIZE_MAX / deque->elem_type->size - deque->len) {
+        fprintf(stderr, "capacity overflow\n");
+        abort();
+    }
+
+    size_t request_size = deque->len + additional;
+    if (request_size <= deque->capacity)
+        return;
+
+    size_t capacity = mc_next_pow_of_two(request_size);
+    if (capacity == SIZE_MAX ||
+        capacity > SIZE_MAX / deque->elem_type->size) {
+        fprintf(stderr, "capacity overflow\n");
+        abort();
+    }
+
+    mc_deque_adjust_capacity(deque, capacity);
+}
+
+void mc_deque_shrink_to_fit(struct mc_deque *deque)
+{
+    assert(deque);
+
+    size_t capacity = deque->len == 0 ? 0 : mc_next_pow_of_two(deque->len);
+    if (capacity < deque->capacity)
+        mc_deque_adjust_capacity(deque, capacity);
+}
+
+void mc_deque_push_back(struct mc_deque *deque, void *elem)
+{
+    assert(deque);
+    assert(elem);
+
+    if (deque->len == deque->capacity)
+        mc_deque_reserve(deque, 1);
+
+    deque->elem_type->move(mc_deque_get_unchecked(deque, deque->len), elem);
+    ++deque->len;
+}
+
+void mc_deque_push_front(struct mc_deque *deque, void *elem)
+{
+    assert(deque);
+    assert(elem);
+
+    if (deque->len == deque->capacity)
+        mc_deque_reserve(deque, 1);
+
+    deque->head = mc_deque_wrap(deque, deque->head - 1);
+    deque->elem_type->move(mc_deque_slot(deque, deque->head), elem);
+    ++deque->len;
+}
+
+static void mc_deque_extract(struct mc_deque *deque, void *elem,
+                             void *out_elem)
+{
+    if (out_elem)
+        deque->elem_type->move(out_elem, elem);
+    else if (deque->elem_type->cleanup)
+        deque->elem_type->cleanup(elem);
+}
+
+bool mc_deque_pop_back(struct mc_deque *deque, void *out_elem)
+{
+    assert(deque);
+
+    if (deque->len == 0)
+        return false;
+
+    --deque->len;
+    mc_deque_extract(deque, mc_deque_get_unchecked(deque, deque->len),
+                     out_elem);
+
+    return true;
+}
+
+bool mc_deque_pop_front(struct mc_deque *deque, void *out_elem)
+{
+    assert(deque);
+
+    if (deque->len == 0)
+        return false;
+
+    mc_deque_extract(deque, mc_deque_slot(deque, deque->head), out_elem);
+    deque->head = mc_deque_wrap(deque, deque->head + 1);
+    --deque->len;
+
+    return true;
+}
+
+void mc_deque_clear(struct mc_deque *deque)
+{
+    assert(deque);
+
+    mc_cleanup_func cleanup = deque->elem_type->cleanup;
+    if (cleanup) {
+        for (size_t i = 0, len = deque->len; i < len; ++i)
+            cleanup(mc_deque_get_unchecked(deque, i));
+    }
+
+    deque->head = 0;
+    deque->len = 0;
+}
+
+void mc_deque_for_each(struct mc_deque const *deque,
+                       void (*func)(void *elem, void *user_data),
+                       void *user_data)
+{
+    assert(deque);
+    assert(func);
+
+    for (size_t i = 0, len = deque->len; i < len; ++i)
+        func(mc_deque_get_unchecked(deque, i), user_data);
+}
+
+void mc_deque_move(struct mc_deque *dst, struct mc_deque *src)
+{
+    assert(dst);
+    assert(src);
+
+    *dst = *src;
+
+    src->data = NULL;
+    src->head = 0;
+    src->len = 0;
+    src->capacity = 0;
+}
+
+void mc_deque_copy(struct mc_deque *dst, struct mc_deque const *src)
+{
+    assert(dst);
+    assert(src);
+
+    mc_copy_func copy = mc_type_get_copy_forced(__func__, src->elem_type);
+
+    mc_deque_init(dst, src->elem_type);
+    mc_deque_reserve(dst, src->len);
+
+    for (size_t i = 0, len = src->len; i < len; ++i)
+        copy(mc_deque_slot(dst, i), mc_deque_get_unchecked(src, i));
+
+    dst->len = src->len;
+}
+
+int mc_deque_compare(struct mc_deque const *deque1,
+                     struct mc_deque const *deque2)
+{
+    assert(deque1);
+    assert(deque2);
+
+    mc_compare_func cmp =
+        mc_type_get_compare_forced(__func__, deque1->elem_type);
+
+    if (deque1->len > deque2->len)
+        return 1;
+    if (deque1->len < deque2->len)
+        return -1;
+
+    for (size_t i = 0, len = deque1->len; i < len; ++i) {
+        int res = cmp(mc_deque_get_unchecked(deque1, i),
+                      mc_deque_get_unchecked(deque2, i));
+        if (res != 0)
+            return res;
+    }
+
+    return 0;
+}
+
+bool mc_deque_equal(struct mc_deque const *deque1,
+                    struct mc_deque const *deque2)
+{
+    assert(deque1);
+    assert(deque2);
+
+    if (deque1->len != deque2->len)
+        return false;
+
+    mc_equal_func eq = mc_type_get_equal_forced(__func__, deque1->elem_type);
+
+    for (size_t i = 0, len = deque1->len; i < len; ++i) {
+        if (!eq(mc_deque_get_unchecked(deque1, i),
+                mc_deque_get_unchecked(deque2, i)))
+            return false;
+    }
+
+    return true;
+}
+
+size_t mc_deque_hash(struct mc_deque const *deque)
+{
+    assert(deque);
+
+    mc_hash_func hash = mc_type_get_hash_forced(__func__, deque->elem_type);
+
+    size_t h = 0;
+    for (size_t i = 0, len = deque->len; i < len; ++i)
+        h = h * 31 + hash(mc_deque_get_unchecked(deque, i));
+
+    return h;
+}
+
+void mc_deque_iter_init(struct mc_iter *iter, struct mc_deque const *deque)
+{
+    assert(iter);
+    assert(deque);
+    iter->container = deque;
+    iter->current = mc_deque_get_front(deque);
+    iter->value = NULL;
+    iter->key = NULL;
+    iter->next = mc_deque_iter_next;
+}
+
+bool mc_deque_iter_next(struct mc_iter *iter)
+{
+    assert(iter);
+    void *curr = iter->current;
+    if (!curr)
+        return false;
+    iter->value = curr;
+    struct mc_deque const *deque = iter->container;
+    if (curr == mc_deque_get_back(deque)) {
+        iter->current = NULL;
+        return true;
+    }
+    curr = mc_ptr_add(curr, deque->elem_type->size);
+    if (curr == mc_deque_slot(deque, deque->capacity))
+        curr = deque->data;
+    iter->current = curr;
+    return true;
+}
+
+MC_DEFINE_TYPE(mc_deque, struct mc_deque, (mc_cleanup_func)mc_deque_cleanup,
+               (mc_move_func)mc_deque_move, (mc_copy_func)mc_deque_copy,
+               (mc_compare_func)mc_deque_compare, (mc_equal_func)mc_deque_equal,
+               (mc_hash_func)mc_deque_hash)
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/eytzinger.h"
+#include "myclib/aligned_malloc.h"
+#include "myclib/utils.h"
+
+/* Slot 0 is unused so that the children of slot k are 2k and 2k + 1. */
+static inline void *mc_eytzinger_slot(struct mc_eytzinger const *index,
+                                      size_t k)
+{
+    return mc_ptr_add(index->data, index->elem_type->size * k);
+}
+
+static size_t mc_eytzinger_build(struct mc_eytzinger *index,
+                                 struct mc_array const *sorted,
+                                 mc_copy_func copy, size_t i, size_t k)
+{
+    if (k > index->len)
+        return i;
+
+    i = mc_eytzinger_build(index, sorted, copy, i, 2 * k);
+    copy(mc_eytzinger_slot(index, k), mc_array_get_unchecked(sorted, i++));
+    return mc_eytzinger_build(index, sorted, copy, i, 2 * k + 1);
+}
+
+void mc_eytzinger_init(struct mc_eytzinger *index,
+                       struct mc_array const *sorted)
+{
+    assert(index);
+    assert(sorted);
+
+    struct mc_type const *elem_type = sorted->elem_type;
+    mc_copy_func copy = mc_type_get_copy_forced(__func__, elem_type);
+    mc_type_get_compare_forced(__func__, elem_type);
+
+    index->elem_type = elem_type;
+    index->data = NULL;
+    index->len = mc_array_len(sorted);
+
+    if (index->len == 0)
+        return;
+
+    size_t total_size = (index->len + 1) * elem_type->size;
+    index->data = mc_aligned_malloc(mc_max2(elem_type->alignment, 64),
+                                    total_size);
+    if (!index->data) {
+        fprintf(stderr, "memory allocation of %zu bytes failed\n", total_size);
+        abort();
+    }
+
+    mc_eytzinger_build(index, sorted, copy, 0, 1);
+}
+
+void mc_eytzinger_cleanup(struct mc_eytzinger *index)
+{
+    assert(index);
+
+    mc_cleanup_func cleanup = index->elem_type->cleanup;
+    if (cleanup) {
+        for (size_t k = 1; k <= index->len; ++k)
+            cleanup(mc_eytzinger_slot(index, k));
+    }
+
+    mc_aligned_free(index->data);
+    index->data = NULL;
+    index->len = 0;
+    index->elem_type = NULL;
+}
+
+static size_t mc_eytzinger_search(struct mc_eytzinger const *index,
+                                  void const *elem)
+{
+    mc_compare_func cmp = index->elem_type->compare;
+    size_t elem_size = index->elem_type->size;
+    size_t len = index->len;
+    char const *data = index->data;
+    size_t k = 1;
+
+    /* The 16 descendants four levels below k are contiguous from slot 16k,
+     * so prefetching them hides most of the latency of the descent. */
+    while (k <= len) {
+        if (16 * k <= len)
+            mc_prefetch(data + 16 * k * elem_size);
+        k = 2 * k + (cmp(data + k * elem_size, elem) < 0);
+    }
+
+    /* Undo the trailing right turns plus the last left turn. */
+#if defined(__GNUC__) || defined(__clang__)
+    return k >> (__builtin_ctzll(~(unsigned long long)k) + 1);
+#else
+    while (k & 1)
+        k >>= 1;
+    return k >> 1;
+#endif
+}
+
+void *mc_eytzinger_lower_bound(struct mc_eytzinger const *index,
+                               void const *elem)
+{
+    assert(index);
+    assert(elem);
+
+    size_t k = mc_eytzinger_search(index, elem);
+    return k == 0 ? NULL : mc_eytzinger_slot(index, k);
+}
+
+void *mc_eytzinger_find(struct mc_eytzinger const *index, void const *elem)
+{
+    assert(index);
+    assert(elem);
+
+    void *found = mc_eytzinger_lower_bound(index, elem);
+    if (found && index->elem_type->compare(found, elem) == 0)
+        return found;
+
+    return NULL;
+}
@@ -0,0 +1,343 @@
+#include <assert.h>
+#include <string.h>
+#include "myclib/format.h"
+
+static char const mc_format_pairs[200] = {
+    '0', '0', '0', '1', '0', '2', '0', '3', '0', '4', '0', '5', '0', '6', '0',
+    '7', '0', '8', '0', '9', '1', '0', '1', '1', '1', '2', '1', '3', '1', '4',
+    '1', '5', '1', '6', '1', '7', '1', '8', '1', '9', '2', '0', '2', '1', '2',
+    '2', '2', '3', '2', '4', '2', '5', '2', '6', '2', '7', '2', '8', '2', '9',
+    '3', '0', '3', '1', '3', '2', '3', '3', '3', '4', '3', '5', '3', '6', '3',
+    '7', '3', '8', '3', '9', '4', '0', '4', '1', '4', '2', '4', '3', '4', '4',
+    '4', '5', '4', '6', '4', '7', '4', '8', '4', '9', '5', '0', '5', '1', '5',
+    '2', '5', '3', '5', '4', '5', '5', '5', '6', '5', '7', '5', '8', '5', '9',
+    '6', '0', '6', '1', '6', '2', '6', '3', '6', '4', '6', '5', '6', '6', '6',
+    '7', '6', '8', '6', '9', '7', '0', '7', '1', '7', '2', '7', '3', '7', '4',
+    '7', '5', '7', '6', '7', '7', '7', '8', '7', '9', '8', '0', '8', '1', '8',
+    '2', '8', '3', '8', '4', '8', '5', '8', '6', '8', '7', '8', '8', '8', '9',
+    '9', '0', '9', '1', '9', '2', '9', '3', '9', '4', '9', '5', '9', '6', '9',
+    '7', '9', '8', '9', '9'};
+
+/* Writes the digits so that they end at end; returns where they start. */
+static char *mc_format_u64_backward(char *end, uint64_t value)
+{
+    while (value >= 100) {
+        unsigned const pair = (unsigned)(value % 100) * 2;
+        value /= 100;
+        end -= 2;
+        memcpy(end, mc_format_pairs + pair, 2);
+    }
+    if (value >= 10) {
+        end -= 2;
+        memcpy(end, mc_format_pairs + value * 2, 2);
+    } else {
+        *--end = (char)('0' + value);
+    }
+    return end;
+}
+
+size_t mc_format_u64(char *buf, uint64_t value)
+{
+    assert(buf);
+    char digits[MC_FORMAT_U64_MAX];
+    char *const end = digits + sizeof(digits);
+    char const *const start = mc_format_u64_backward(end, value);
+    size_t const len = (size_t)(end - start);
+    memcpy(buf, start, len);
+    return len;
+}
+
+size_t mc_format_i64(char *buf, int64_t value)
+{
+    assert(buf);
+    if (value >= 0)
+        return mc_format_u64(buf, (uint64_t)value);
+    buf[0] = '-';
+    return 1 + mc_format_u64(buf + 1, 0 - (uint64_t)value);
+}
+
+size_t mc_format_hex(char *buf, uint64_t value)
+{
+    assert(buf);
+    static char const hex[16] = "0123456789abcdef";
+    size_t len = 1;
+    while (len < 16 && value >> (4 * len))
+        ++len;
+    for (size_t i = len; i-- > 0; value >>= 4)
+        buf[i] = hex[value & 0xf];
+    return len;
+}
+
+/* A floating-point value f * 2^e with a 64-bit significand. */
+struct mc_format_fp {
+    uint64_t f;
+    int e;
+};
+
+/* Normalized 10^k for k = -348, -340, ..., 340. */
+static struct mc_format_fp const mc_format_cached_powers[] = {
+    {0xfa8fd5a0081c0288ULL, -1220}, {0xbaaee17fa23ebf76ULL, -1193},
+    {0x8b16fb203055ac76ULL, -1166}, {0xcf42894a5dce35eaULL, -1140},
+    {0x9a6bb0aa55653b2dULL, -1113}, {0xe61acf033d1a45dfULL, -1087},
+    {0xab70fe17c79ac6caULL, -1060}, {0xff77b1fcbebcdc4fULL, -1034},
+    {0xbe5691ef416bd60cULL, -1007}, {0x8dd01fad907ffc3cULL, -980},
+    {0xd3515c2831559a83ULL, -954}, {0x9d71ac8fada6c9b5ULL, -927},
+    {0xea9c227723ee8bcbULL, -901}, {0xaecc49914078536dULL, -874},
+    {0x823c12795db6ce57ULL, -847}, {0xc21094364dfb5637ULL, -821},
+    {0x9096ea6f3848984fULL, -794}, {0xd77485cb25823ac7ULL, -768},
+    {0xa086cfcd97bf97f4ULL, -741}, {0xef340a98172aace5ULL, -715},
+    {0xb23867fb2a35b28eULL, -688}, {0x84c8d4dfd2c63f3bULL, -661},
+    {0xc5dd44271ad3cdbaULL, -635}, {0x936b9fcebb25c996ULL, -608},
+    {0xdbac6c247d62a584ULL, -582}, {0xa3ab66580d5fdaf6ULL, -555},
+    {0xf3e2f893dec3f126ULL, -529}, {0xb5b5ada8aaff80b8ULL, -502},
+    {0x87625f056c7c4a8bULL, -475}, {0xc9bcff6034c13053ULL, -449},
+    {0x964e858c91ba2655ULL, -422}, {0xdff9772470297ebdULL, -396},
+    {0xa6dfbd9fb8e5b88fULL, -369}, {0xf8a95fcf88747d94ULL, -343},
+    {0xb94470938fa89bcfULL, -316}, {0x8a08f0f8bf0f156bULL, -289},
+    {0xcdb02555653131b6ULL, -263}, {0x993fe2c6d07b7facULL, -236},
+    {0xe45c10c42a2b3b06ULL, -210}, {0xaa242499697392d3ULL, -183},
+    {0xfd87b5f28300ca0eULL, -157}, {0xbce5086492111aebULL, -130},
+    {0x8cbccc096f5088ccULL, -103}, {0xd1b71758e219652cULL, -77},
+    {0x9c40000000000000ULL, -50}, {0xe8d4a51000000000ULL, -24},
+    {0xad78ebc5ac620000ULL, 3}, {0x813f3978f8940984ULL, 30},
+    {0xc097ce7bc90715b3ULL, 56}, {0x8f7e32ce7bea5c70ULL, 83},
+    {0xd5d238a4abe98068ULL, 109}, {0x9f4f2726179a2245ULL, 136},
+    {0xed63a231d4c4fb27ULL, 162}, {0xb0de65388cc8ada8ULL, 189},
+    {0x83c7088e1aab65dbULL, 216}, {0xc45d1df942711d9aULL, 242},
+    {0x924d692ca61be758ULL, 269}, {0xda01ee641a708deaULL, 295},
+    {0xa26da3999aef774aULL, 322}, {0xf209787bb47d6b85ULL, 348},
+    {0xb454e4a179dd1877ULL, 375}, {0x865b86925b9bc5c2ULL, 402},
+    {0xc83553c5c8965d3dULL, 428}, {0x952ab45cfa97a0b3ULL, 455},
+    {0xde469fbd99a05fe3ULL, 481}, {0xa59bc234db398c25ULL, 508},
+    {0xf6c69a72a3989f5cULL, 534}, {0xb7dcbf5354e9beceULL, 561},
+    {0x88fcf317f22241e2ULL, 588}, {0xcc20ce9bd35c78a5ULL, 614},
+    {0x98165af37b2153dfULL, 641}, {0xe2a0b5dc971f303aULL, 667},
+    {0xa8d9d1535ce3b396ULL, 694}, {0xfb9b7cd9a4a7443cULL, 720},
+    {0xbb764c4ca7a44410ULL, 747}, {0x8bab8eefb6409c1aULL, 774},
+    {0xd01fef10a657842cULL, 800}, {0x9b10a4e5e9913129ULL, 827},
+    {0xe7109bfba19c0c9dULL, 853}, {0xac2820d9623bf429ULL, 880},
+    {0x80444b5e7aa7cf85ULL, 907}, {0xbf21e44003acdd2dULL, 933},
+    {0x8e679c2f5e44ff8fULL, 960}, {0xd433179d9c8cb841ULL, 986},
+    {0x9e19db92b4e31ba9ULL, 1013}, {0xeb96bf6ebadf77d9ULL, 1039},
+    {0xaf87023b9bf0ee6bULL, 1066},
+};
+
+static struct mc_format_fp mc_format_fp_make(uint64_t f, int e)
+{
+    struct mc_format_fp fp = {.f = f, .e = e};
+    return fp;
+}
+
+/* The upper 64 bits of the product, rounded. */
+static struct mc_format_fp mc_format_fp_mul(struct mc_format_fp x,
+                                            struct mc_format_fp y)
+{
+    uint64_t const mask = 0xffffffffu;
+    uint64_t const a = x.f >> 32, b = x.f & mask;
+    uint64_t const c = y.f >> 32, d = y.f & mask;
+    uint64_t const ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t const mid =
+        (bd >> 32) + (ad & mask) + (bc & mask) + ((uint64_t)1 << 31);
+    return mc_format_fp_make(ac + (ad >> 32) + (bc >> 32) + (mid >> 32),
+                             x.e + y.e + 64);
+}
+
+static struct mc_format_fp mc_format_fp_normalize(struct mc_format_fp x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    int const shift = __builtin_clzll(x.f);
+    x.f <<= shift;
+    x.e -= shift;
+#else
+    while (!(x.f >> 63)) {
+        x.f <<= 1;
+        x.e--;
+    }
+#endif
+    return x;
+}
+
+static uint32_t const mc_format_pow10_32[] = {
+    1u,      10u,      100u,      1000u,      10000u,
+    100000u, 1000000u, 10000000u, 100000000u, 1000000000u};
+
+static unsigned mc_format_count_digits32(uint32_t n)
+{
+    unsigned count = 1;
+    while (count < 10 && n >= mc_format_pow10_32[count])
+        ++count;
+    return count;
+}
+
+/* Moves the last digit down while that brings it closer to the value. */
+static void mc_format_grisu_round(char *digits, size_t len, uint64_t delta,
+                                  uint64_t rest, uint64_t ten_kappa,
+                                  uint64_t wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w ||
+            wp_w - rest > rest + ten_kappa - wp_w)) {
+        digits[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+/*
+ * Produces the digits of the scaled upper bound high until what is left
+ * falls within delta of it, which keeps the result inside the interval of
+ * values that round to the double.
+ */
+static size_t mc_format_digit_gen(struct mc_format_fp w,
+                                  struct mc_format_fp high, uint64_t delta,
+                                  char *digits, int *k)
+{
+    struct mc_format_fp const one =
+        mc_format_fp_make((uint64_t)1 << -high.e, high.e);
+    uint64_t const wp_w = high.f - w.f;
+    uint32_t p1 = (uint32_t)(high.f >> -one.e);
+    uint64_t p2 = high.f & (one.f - 1);
+    unsigned kappa = mc_format_count_digits32(p1);
+    size_t len = 0;
+
+    while (kappa > 0) {
+        uint32_t const pow10 = mc_format_pow10_32[kappa - 1];
+        uint32_t const d = p1 / pow10;
+        p1 %= pow10;
+        if (d || len)
+            digits[len++] = (char)('0' + d);
+        kappa--;
+        uint64_t const rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest <= delta) {
+            *k += (int)kappa;
+            mc_format_grisu_round(digits, len, delta, rest,
+                                  (uint64_t)mc_format_pow10_32[kappa]
+                                      << -one.e,
+                                  wp_w);
+            return len;
+        }
+    }
+
+    /* Past the decimal point of the scaled value */
+    for (int index = 1;; ++index) {
+        p2 *= 10;
+        delta *= 10;
+        char const d = (char)(p2 >> -one.e);
+        if (d || len)
+            digits[len++] = (char)('0' + d);
+        p2 &= one.f - 1;
+        if (p2 < delta) {
+            *k -= index;
+            uint64_t scale = 0;
+            if (index < 10)
+                scale = mc_format_pow10_32[index];
+            mc_format_grisu_round(digits, len, delta, p2, one.f, wp_w * scale);
+            return len;
+        }
+    }
+}
+
+/* value must be finite and positive; value = digits * 10^k. */
+static size_t mc_format_grisu2(double value, char *digits, int *k)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int const biased_e = (int)(bits >> 52);
+    uint64_t const significand = bits & (((uint64_t)1 << 52) - 1);
+    uint64_t const hidden = (uint64_t)1 << 52;
+    struct mc_format_fp const v =
+        biased_e ? mc_format_fp_make(significand + hidden, biased_e - 1075)
+                 : mc_format_fp_make(significand, -1074);
+
+    /* The boundaries halfway to the neighbouring doubles */
+    struct mc_format_fp high = mc_format_fp_make((v.f << 1) + 1, v.e - 1);
+    while (!(high.f & (hidden << 1))) {
+        high.f <<= 1;
+        high.e--;
+    }
+    high.f <<= 10;
+    high.e -= 10;
+    struct mc_format_fp low = v.f == hidden
+                                  ? mc_format_fp_make((v.f << 2) - 1, v.e - 2)
+                                  : mc_format_fp_make((v.f << 1) - 1, v.e - 1);
+    low.f <<= low.e - high.e;
+    low.e = high.e;
+
+    /* A power of ten that brings the exponent into [-60, -32] */
+    double const dk = (-61 - high.e) * 0.30102999566398114 + 347;
+    int cached = (int)dk;
+    if (dk - cached > 0.0)
+        cached++;
+    unsigned const index = (unsigned)(cached >> 3) + 1;
+    *k = -(-348 + (int)index * 8);
+    struct mc_format_fp const c = mc_format_cached_powers[index];
+
+    struct mc_format_fp const w =
+        mc_format_fp_mul(mc_format_fp_normalize(v), c);
+    struct mc_format_fp scaled_high = mc_format_fp_mul(high, c);
+    struct mc_format_fp scaled_low = mc_format_fp_mul(low, c);
+    scaled_low.f++;
+    scaled_high.f--;
+    return mc_format_digit_gen(w, scaled_high, scaled_high.f - scaled_low.f,
+                               digits, k);
+}
+
+size_t mc_format_f64(char *buf, double value)
+{
+    assert(buf);
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    char *p = buf;
+    if (bits >> 63) {
+        *p++ = '-';
+        bits &= ~((uint64_t)1 << 63);
+    }
+    if ((bits >> 52) == 0x7ff) {
+        if (bits & (((uint64_t)1 << 52) - 1)) {
+            memcpy(buf, "nan", 3);
+            return 3;
+        }
+        memcpy(p, "inf", 3);
+        return (size_t)(p - buf) + 3;
+    }
+    if (bits == 0) {
+        *p = '0';
+        return (size_t)(p - buf) + 1;
+    }
+
+    double magnitude;
+    memcpy(&magnitude, &bits, sizeof(magnitude));
+    char digits[MC_FORMAT_F64_MAX];
+    int k;
+    int const len = (int)mc_format_grisu2(magnitude, digits, &k);
+    /* The decimal point sits after the first point digits */
+    int const point = len + k;
+
+    if (k >= 0 && point <= 21) {
+        memcpy(p, digits, (size_t)len);
+        memset(p + len, '0', (size_t)k);
+        p += point;
+    } else if (point > 0 && point <= 21) {
+        memcpy(p, digits, (size_t)point);
+        p[point] = '.';
+        memcpy(p + point + 1, digits + point, (size_t)(len - point));
+        p += len + 1;
+    } else if (point > -6 && point <= 0) {
+        p[0] = '0';
+        p[1] = '.';
+        memset(p + 2, '0', (size_t)-point);
+        memcpy(p + 2 - point, digits, (size_t)len);
+        p += 2 - point + len;
+    } else {
+        *p++ = digits[0];
+        if (len > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, (size_t)(len - 1));
+            p += len - 1;
+        }
+        int const exponent = point - 1;
+        *p++ = 'e';
+        *p++ = exponent < 0 ? '-' : '+';
+        p += mc_format_u64(p, (uint64_t)(exponent < 0 ? -exponent : exponent));
+    }
+    return (size_t)(p - buf);
+}
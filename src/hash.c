@@ -4,8 +4,16 @@
 
 uint64_t mc_hash_fnv1a64(const void *data, size_t len)
 {
-    const uint64_t offset = 0xcbf29ce484222325ULL;
-    uint64_t hash = offset;
+    return mc_hash_fnv1a64_update(MC_HASH_FNV1A64_OFFSET, data, len);
+}
+
+uint32_t mc_hash_fnv1a32(const void *data, size_t len)
+{
+    return mc_hash_fnv1a32_update(MC_HASH_FNV1A32_OFFSET, data, len);
+}
+
+uint64_t mc_hash_fnv1a64_update(uint64_t hash, const void *data, size_t len)
+{
     const uint8_t *bytes = data;
     for (size_t i = 0; i < len; i++) {
         hash ^= bytes[i];
@@ -14,10 +22,8 @@ uint64_t mc_hash_fnv1a64(const void *data, size_t len)
     return hash;
 }
 
-uint32_t mc_hash_fnv1a32(const void *data, size_t len)
+uint32_t mc_hash_fnv1a32_update(uint32_t hash, const void *data, size_t len)
 {
-    const uint32_t offset = 0x811c9dc5;
-    uint32_t hash = offset;
     const uint8_t *bytes = data;
     for (size_t i = 0; i < len; i++) {
         hash ^= bytes[i];
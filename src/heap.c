@@ -0,0 +1,349 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/heap.h"
+#include "myclib/aligned_malloc.h"
+#include "myclib/utils.h"
+
+void mc_heap_init(struct mc_heap *heap, struct mc_type const *elem_type)
+{
+    assert(heap);
+    assert(elem_type);
+    mc_heap_init_with(heap, elem_type, MC_HEAP_DEFAULT_ARITY,
+                      mc_type_get_compare_forced(__func__, elem_type));
+}
+
+void mc_heap_init_with(struct mc_heap *heap, struct mc_type const *elem_type,
+                       size_t arity, mc_compare_func compare)
+{
+    assert(heap);
+    assert(elem_type);
+    assert(arity >= 2);
+    assert(compare);
+
+    mc_array_init(&heap->elems, elem_type);
+    mc_array_init(&heap->handles, size_get_mc_type());
+    mc_array_init(&heap->positions, size_get_mc_type());
+    mc_array_init(&heap->free_handles, size_get_mc_type());
+    heap->compare = compare;
+    heap->arity = arity;
+
+    heap->scratch = mc_aligned_malloc(elem_type->alignment, elem_type->size);
+    if (!heap->scratch) {
+        fprintf(stderr, "memory allocation of %zu bytes failed\n",
+                elem_type->size);
+        abort();
+    }
+}
+
+static inline void *mc_heap_elem(struct mc_heap const *heap, size_t index)
+{
+    return mc_ptr_add(heap->elems.data, index * heap->elems.elem_type->size);
+}
+
+static inline size_t *mc_heap_handles(struct mc_heap const *heap)
+{
+    return heap->handles.data;
+}
+
+static inline size_t *mc_heap_positions(struct mc_heap const *heap)
+{
+    return heap->positions.data;
+}
+
+/* Lets the common element sizes compile to a single load and store. */
+static inline void mc_heap_copy_elem(void *dst, void const *src, size_t size)
+{
+    switch (size) {
+    case 4:
+        memcpy(dst, src, 4);
+        break;
+    case 8:
+        memcpy(dst, src, 8);
+        break;
+    case 16:
+        memcpy(dst, src, 16);
+        break;
+    default:
+        memcpy(dst, src, size);
+        break;
+    }
+}
+
+/*
+ * Both sifts lift the moving element into scratch and shift the others
+ * over the hole, so each level costs one element copy instead of a swap.
+ */
+static void mc_heap_sift_up(struct mc_heap *heap, size_t index)
+{
+    size_t elem_size = heap->elems.elem_type->size;
+    size_t *handles = mc_heap_handles(heap);
+    size_t *positions = mc_heap_positions(heap);
+    mc_compare_func cmp = heap->compare;
+
+    mc_heap_copy_elem(heap->scratch, mc_heap_elem(heap, index), elem_size);
+    size_t handle = handles[index];
+
+    while (index > 0) {
+        size_t parent = (index - 1) / heap->arity;
+        void *parent_elem = mc_heap_elem(heap, parent);
+        if (cmp(heap->scratch, parent_elem) >= 0)
+            break;
+        mc_heap_copy_elem(mc_heap_elem(heap, index), parent_elem, elem_size);
+        handles[index] = handles[parent];
+        positions[handles[index]] = index;
+        index = parent;
+    }
+
+    mc_heap_copy_elem(mc_heap_elem(heap, index), heap->scratch, elem_size);
+    handles[index] = handle;
+    positions[handle] = index;
+}
+
+static void mc_heap_sift_down(struct mc_heap *heap, size_t index)
+{
+    size_t elem_size = heap->elems.elem_type->size;
+    size_t len = heap->elems.len;
+    size_t arity = heap->arity;
+    size_t *handles = mc_heap_handles(heap);
+    size_t *positions = mc_heap_positions(heap);
+    mc_compare_func cmp = heap->compare;
+
+    mc_heap_copy_elem(heap->scratch, mc_heap_elem(heap, index), elem_size);
+    size_t handle = handles[index];
+
+    for (;;) {
+        size_t first = index * arity + 1;
+        if (first >= len)
+            break;
+
+        size_t last = first + arity < len ? first + arity : len;
+        size_t best = first;
+        void *best_elem = mc_heap_elem(heap, first);
+        for (size_t child = first + 1; child < last; ++child) {
+            void *child_elem = mc_heap_elem(heap, child);
+            if (cmp(child_elem, best_elem) < 0) {
+                best = child;
+                best_elem = child_elem;
+            }
+        }
+
+        if (cmp(best_elem, heap->scratch) >= 0)
+            break;
+
+        if (best * arity + 1 < len)
+            mc_prefetch(mc_heap_elem(heap, best * arity + 1));
+
+        mc_heap_copy_elem(mc_heap_elem(heap, index), best_elem, elem_size);
+        handles[index] = handles[best];
+        positions[handles[index]] = index;
+        index = best;
+    }
+
+    mc_heap_copy_elem(mc_heap_elem(heap, index), heap->scratch, elem_size);
+    handles[index] = handle;
+    positions[handle] = index;
+}
+
+static void mc_heapify(struct mc_heap *heap)
+{
+    size_t len = heap->elems.len;
+    if (len < 2)
+        return;
+
+    for (size_t i = (len - 2) / heap->arity + 1; i-- > 0;)
+        mc_heap_sift_down(heap, i);
+}
+
+void mc_heap_from_array(struct mc_heap *heap, struct mc_array *array,
+                        size_t arity, mc_compare_func compare)
+{
+    assert(heap);
+    assert(array);
+
+    mc_heap_init_with(heap, array->elem_type, arity, compare);
+    mc_array_cleanup(&heap->elems);
+    mc_array_move(&heap->elems, array);
+
+    size_t len = heap->elems.len;
+    size_t *handles = mc_array_extend_uninit(&heap->handles, len);
+    size_t *positions = mc_array_extend_uninit(&heap->positions, len);
+    for (size_t i = 0; i < len; ++i) {
+        handles[i] = i;
+        positions[i] = i;
+    }
+
+    mc_heapify(heap);
+}
+
+void mc_heap_cleanup(struct mc_heap *heap)
+{
+    assert(heap);
+    mc_array_cleanup(&heap->elems);
+    mc_array_cleanup(&heap->handles);
+    mc_array_cleanup(&heap->positions);
+    mc_array_cleanup(&heap->free_handles);
+    mc_aligned_free(heap->scratch);
+    heap->scratch = NULL;
+}
+
+void mc_heap_reserve(struct mc_heap *heap, size_t additional)
+{
+    assert(heap);
+    mc_array_reserve(&heap->elems, additional);
+    mc_array_reserve(&heap->handles, additional);
+    /* Pushes take released handles before growing positions */
+    size_t const free_handles = heap->free_handles.len;
+    if (additional > free_handles)
+        mc_array_reserve(&heap->positions, additional - free_handles);
+}
+
+static size_t mc_heap_acquire_handle(struct mc_heap *heap)
+{
+    size_t handle;
+    if (mc_array_pop(&heap->free_handles, &handle))
+        return handle;
+
+    handle = heap->positions.len;
+    *(size_t *)mc_array_emplace_back(&heap->positions) = MC_HEAP_INVALID_HANDLE;
+    return handle;
+}
+
+static void mc_heap_release_handle(struct mc_heap *heap, size_t handle)
+{
+    mc_heap_positions(heap)[handle] = MC_HEAP_INVALID_HANDLE;
+    mc_array_push(&heap->free_handles, &handle);
+}
+
+size_t mc_heap_push(struct mc_heap *heap, void *elem)
+{
+    assert(heap);
+    assert(elem);
+
+    size_t handle = mc_heap_acquire_handle(heap);
+    mc_array_push(&heap->elems, elem);
+    *(size_t *)mc_array_emplace_back(&heap->handles) = handle;
+    mc_heap_sift_up(heap, heap->elems.len - 1);
+
+    return handle;
+}
+
+/* Takes the element at index out of the heap and fills the hole with the
+ * last element, which is then sifted whichever way it needs to go. */
+static void mc_heap_remove_at(struct mc_heap *heap, size_t index,
+                              void *out_elem)
+{
+    size_t last = heap->elems.len - 1;
+    size_t *handles = mc_heap_handles(heap);
+    void *elem = mc_heap_elem(heap, index);
+
+    mc_heap_release_handle(heap, handles[index]);
+
+    if (out_elem)
+        heap->elems.elem_type->move(out_elem, elem);
+    else if (heap->elems.elem_type->cleanup)
+        heap->elems.elem_type->cleanup(elem);
+
+    --heap->elems.len;
+    --heap->handles.len;
+
+    if (index == last)
+        return;
+
+    size_t moved = handles[last];
+    mc_heap_copy_elem(elem, mc_heap_elem(heap, last),
+                      heap->elems.elem_type->size);
+    handles[index] = moved;
+    mc_heap_positions(heap)[moved] = index;
+
+    mc_heap_sift_up(heap, index);
+    if (mc_heap_positions(heap)[moved] == index)
+        mc_heap_sift_down(heap, index);
+}
+
+bool mc_heap_pop(struct mc_heap *heap, void *out_elem)
+{
+    assert(heap);
+
+    if (heap->elems.len == 0)
+        return false;
+
+    mc_heap_remove_at(heap, 0, out_elem);
+    return true;
+}
+
+void *mc_heap_peek(struct mc_heap const *heap)
+{
+    assert(heap);
+    return heap->elems.len > 0 ? mc_heap_elem(heap, 0) : NULL;
+}
+
+void mc_heap_clear(struct mc_heap *heap)
+{
+    assert(heap);
+    mc_array_clear(&heap->elems);
+    mc_array_clear(&heap->handles);
+    mc_array_clear(&heap->positions);
+    mc_array_clear(&heap->free_handles);
+}
+
+bool mc_heap_contains(struct mc_heap const *heap, size_t handle)
+{
+    assert(heap);
+    return handle < heap->positions.len &&
+           mc_heap_positions(heap)[handle] != MC_HEAP_INVALID_HANDLE;
+}
+
+void *mc_heap_get(struct mc_heap const *heap, size_t handle)
+{
+    assert(heap);
+    return mc_heap_contains(heap, handle)
+               ? mc_heap_elem(heap, mc_heap_positions(heap)[handle])
+               : NULL;
+}
+
+static size_t mc_heap_position_checked(char const *func_name,
+                                       struct mc_heap const *heap,
+                                       size_t handle)
+{
+    if (!mc_heap_contains(heap, handle)) {
+        fprintf(stderr, "%s: invalid heap handle %zu\n", func_name, handle);
+        abort();
+    }
+    return mc_heap_positions(heap)[handle];
+}
+
+void mc_heap_decrease_key(struct mc_heap *heap, size_t handle, void *elem)
+{
+    assert(heap);
+    assert(elem);
+
+    size_t index = mc_heap_position_checked(__func__, heap, handle);
+    void *slot = mc_heap_elem(heap, index);
+
+    assert(heap->compare(elem, slot) <= 0);
+
+    if (heap->elems.elem_type->cleanup)
+        heap->elems.elem_type->cleanup(slot);
+    heap->elems.elem_type->move(slot, elem);
+
+    mc_heap_sift_up(heap, index);
+}
+
+void mc_heap_update(struct mc_heap *heap, size_t handle)
+{
+    assert(heap);
+
+    size_t index = mc_heap_position_checked(__func__, heap, handle);
+
+    mc_heap_sift_up(heap, index);
+    if (mc_heap_positions(heap)[handle] == index)
+        mc_heap_sift_down(heap, index);
+}
+
+void mc_heap_remove(struct mc_heap *heap, size_t handle, void *out_elem)
+{
+    assert(heap);
+    mc_heap_remove_at(heap, mc_heap_position_checked(__func__, heap, handle),
+                      out_elem);
+}
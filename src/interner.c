@@ -0,0 +1,246 @@
+#include <assert.h>
+#include <stdalign.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/interner.h"
+#include "myclib/hash.h"
+#include "myclib/utils.h"
+
+#define MC_INTERNER_MIN_SLOTS 64
+
+/*
+ * Open addressing with linear probing, kept at most half full. A slot is 0
+ * when empty, and otherwise holds the high half of the hash above ID + 1,
+ * so most mismatches are rejected without touching the entry. Slots are
+ * written once, with release order, after the entry they point to.
+ */
+struct mc_interner_table {
+    size_t mask;
+    _Atomic(uint64_t) slots[];
+};
+
+static void mc_interner_lock(atomic_flag *lock)
+{
+    while (atomic_flag_test_and_set_explicit(lock, memory_order_acquire)) {
+#if (defined(__GNUC__) || defined(__clang__)) &&                               \
+    (defined(__x86_64__) || defined(__i386__))
+        __builtin_ia32_pause();
+#endif
+    }
+}
+
+static void mc_interner_unlock(atomic_flag *lock)
+{
+    atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+static void *mc_interner_alloc(struct mc_interner *interner, size_t alignment,
+                               size_t size)
+{
+    void *ptr = mc_arena_alloc(&interner->arena, alignment, size);
+    if (!ptr) {
+        fprintf(stderr, "memory allocation of %zu bytes failed\n", size);
+        abort();
+    }
+    return ptr;
+}
+
+static struct mc_interner_table *
+mc_interner_table_new(struct mc_interner *interner, size_t slot_count)
+{
+    struct mc_interner_table *table = mc_interner_alloc(
+        interner, alignof(struct mc_interner_table),
+        sizeof(*table) + slot_count * sizeof(table->slots[0]));
+    table->mask = slot_count - 1;
+    for (size_t i = 0; i < slot_count; i++)
+        atomic_init(&table->slots[i], 0);
+    return table;
+}
+
+/* Segment k starts at ID (2^k - 1) * FIRST_SEGMENT, as in
+ * mc_segmented_array. */
+static struct mc_interner_entry *
+mc_interner_entry(struct mc_interner const *interner, uint32_t id)
+{
+    size_t const segment =
+        mc_log2_floor(((size_t)id >> MC_INTERNER_FIRST_SEGMENT_SHIFT) + 1);
+    size_t const offset = id - ((MC_INTERNER_FIRST_SEGMENT << segment) -
+                                MC_INTERNER_FIRST_SEGMENT);
+    return &interner->segments[segment][offset];
+}
+
+static uint64_t mc_interner_slot(uint64_t hash, uint32_t id)
+{
+    return (hash & 0xffffffff00000000ULL) | ((uint64_t)id + 1);
+}
+
+static bool mc_interner_lookup(struct mc_interner const *interner,
+                               struct mc_interner_table *table, uint64_t hash,
+                               struct mc_str_view str, uint32_t *id)
+{
+    uint64_t const tag = hash & 0xffffffff00000000ULL;
+    for (size_t i = (size_t)hash & table->mask;; i = (i + 1) & table->mask) {
+        uint64_t const slot =
+            atomic_load_explicit(&table->slots[i], memory_order_acquire);
+        if (slot == 0)
+            return false;
+        if ((slot & 0xffffffff00000000ULL) != tag)
+            continue;
+        uint32_t const candidate = (uint32_t)slot - 1;
+        struct mc_interner_entry const *entry =
+            mc_interner_entry(interner, candidate);
+        if (entry->len == str.len &&
+            (str.len == 0 || memcmp(entry->data, str.data, str.len) == 0)) {
+            *id = candidate;
+            return true;
+        }
+    }
+}
+
+static void mc_interner_place(struct mc_interner_table *table, uint64_t slot,
+                              uint64_t hash)
+{
+    size_t i = (size_t)hash & table->mask;
+    while (atomic_load_explicit(&table->slots[i], memory_order_relaxed))
+        i = (i + 1) & table->mask;
+    atomic_store_explicit(&table->slots[i], slot, memory_order_release);
+}
+
+/* Called with the lock held. Readers still probing the old table find
+ * everything that was in it, and it stays in the arena until cleanup. */
+static struct mc_interner_table *mc_interner_grow(struct mc_interner *interner,
+                                                  struct mc_interner_table *old)
+{
+    size_t const old_count = old->mask + 1;
+    struct mc_interner_table *table =
+        mc_interner_table_new(interner, old_count * 2);
+    for (size_t i = 0; i < old_count; i++) {
+        uint64_t const slot =
+            atomic_load_explicit(&old->slots[i], memory_order_relaxed);
+        if (slot == 0)
+            continue;
+        struct mc_interner_entry const *entry =
+            mc_interner_entry(interner, (uint32_t)slot - 1);
+        mc_interner_place(table, slot,
+                          (slot & 0xffffffff00000000ULL) | entry->hash_low);
+    }
+    atomic_store_explicit(&interner->table, table, memory_order_release);
+    return table;
+}
+
+void mc_interner_init(struct mc_interner *interner)
+{
+    assert(interner);
+    mc_arena_init(&interner->arena, 0);
+    for (size_t k = 0; k < MC_INTERNER_MAX_SEGMENTS; k++)
+        interner->segments[k] = NULL;
+    atomic_init(&interner->len, 0);
+    atomic_flag_clear(&interner->lock);
+    atomic_init(&interner->table,
+                mc_interner_table_new(interner, MC_INTERNER_MIN_SLOTS));
+}
+
+void mc_interner_cleanup(struct mc_interner *interner)
+{
+    assert(interner);
+    mc_arena_cleanup(&interner->arena);
+    for (size_t k = 0; k < MC_INTERNER_MAX_SEGMENTS; k++)
+        interner->segments[k] = NULL;
+    atomic_store(&interner->len, 0);
+    atomic_store(&interner->table, NULL);
+}
+
+uint32_t mc_interner_intern(struct mc_interner *interner,
+                            struct mc_str_view str)
+{
+    assert(interner);
+    if (str.len > UINT32_MAX) {
+        fprintf(stderr, "%s: len (is %zu) must fit in 32 bits\n", __func__,
+                str.len);
+        abort();
+    }
+
+    uint64_t const hash = mc_hash_fnv1a64(str.data, str.len);
+    uint32_t id;
+    if (mc_interner_lookup(interner,
+                           atomic_load_explicit(&interner->table,
+                                                memory_order_acquire),
+                           hash, str, &id))
+        return id;
+
+    mc_interner_lock(&interner->lock);
+
+    /* Another thread may have interned it since */
+    struct mc_interner_table *table =
+        atomic_load_explicit(&interner->table, memory_order_relaxed);
+    if (mc_interner_lookup(interner, table, hash, str, &id)) {
+        mc_interner_unlock(&interner->lock);
+        return id;
+    }
+
+    size_t const len =
+        atomic_load_explicit(&interner->len, memory_order_relaxed);
+    if (len >= UINT32_MAX - 1) {
+        fprintf(stderr, "%s: too many strings (is %zu)\n", __func__, len);
+        abort();
+    }
+    if ((len + 1) * 2 > table->mask + 1)
+        table = mc_interner_grow(interner, table);
+
+    id = (uint32_t)len;
+    size_t const segment =
+        mc_log2_floor(((size_t)id >> MC_INTERNER_FIRST_SEGMENT_SHIFT) + 1);
+    if (!interner->segments[segment])
+        interner->segments[segment] = mc_interner_alloc(
+            interner, alignof(struct mc_interner_entry),
+            (MC_INTERNER_FIRST_SEGMENT << segment) *
+                sizeof(struct mc_interner_entry));
+
+    char *data = mc_interner_alloc(interner, 1, str.len + 1);
+    if (str.len > 0)
+        memcpy(data, str.data, str.len);
+    data[str.len] = '\0';
+    struct mc_interner_entry *entry = mc_interner_entry(interner, id);
+    entry->data = data;
+    entry->len = (uint32_t)str.len;
+    entry->hash_low = (uint32_t)hash;
+
+    mc_interner_place(table, mc_interner_slot(hash, id), hash);
+    atomic_store_explicit(&interner->len, len + 1, memory_order_release);
+
+    mc_interner_unlock(&interner->lock);
+    return id;
+}
+
+bool mc_interner_find(struct mc_interner const *interner,
+                      struct mc_str_view str, uint32_t *id)
+{
+    assert(interner);
+    assert(id);
+    struct mc_interner_table *table = atomic_load_explicit(
+        (_Atomic(struct mc_interner_table *) *)&interner->table,
+        memory_order_acquire);
+    return mc_interner_lookup(interner, table,
+                              mc_hash_fnv1a64(str.data, str.len), str, id);
+}
+
+struct mc_str_view mc_interner_get(struct mc_interner const *interner,
+                                   uint32_t id)
+{
+    assert(interner);
+    size_t const len = mc_interner_len(interner);
+    if (id >= len) {
+        fprintf(stderr, "%s: id (is %u) must < len (is %zu)\n", __func__,
+                (unsigned)id, len);
+        abort();
+    }
+    struct mc_interner_entry const *entry = mc_interner_entry(interner, id);
+    return mc_str_view_make(entry->data, entry->len);
+}
+
+size_t mc_interner_memory(struct mc_interner const *interner)
+{
+    assert(interner);
+    return mc_arena_used(&interner->arena);
+}
@@ -2,16 +2,26 @@
 #include <stdlib.h>
 #include "myclib/list.h"
 #include "myclib/utils.h"
-#include "myclib/aligned_malloc.h"
 
 void mc_list_init(struct mc_list *list, struct mc_type const *elem_type)
+{
+    mc_list_init_with_allocator(list, elem_type, &mc_default_allocator);
+}
+
+void mc_list_init_with_allocator(struct mc_list *list,
+                                 struct mc_type const *elem_type,
+                                 struct mc_allocator const *allocator)
 {
     assert(list);
     assert(elem_type);
     assert(elem_type->size > 0);
     assert(mc_is_pow_of_two(elem_type->alignment));
     assert(elem_type->move);
+    assert(allocator);
     list->elem_type = elem_type;
+    list->allocator = allocator;
+    list->pool = NULL;
+    list->owns_pool = false;
     list->head = NULL;
     list->tail = NULL;
     list->len = 0;
@@ -26,12 +36,44 @@ void mc_list_cleanup(struct mc_list *list)
 {
     assert(list);
     mc_list_clear(list);
+    if (list->owns_pool)
+        mc_pool_delete(list->pool, list->allocator);
+    list->pool = NULL;
+    list->owns_pool = false;
     list->elem_type = NULL;
     list->node_alignment = 0;
     list->node_size = 0;
     list->elem_offset = 0;
 }
 
+void mc_list_use_pool(struct mc_list *list, struct mc_pool *pool)
+{
+    assert(list);
+    assert(list->len == 0);
+
+    if (pool && (mc_pool_obj_size(pool) < list->node_size ||
+                 mc_pool_alignment(pool) < list->node_alignment)) {
+        fprintf(stderr, "%s: pool blocks cannot hold %zu-byte nodes\n",
+                __func__, list->node_size);
+        abort();
+    }
+
+    if (list->owns_pool)
+        mc_pool_delete(list->pool, list->allocator);
+
+    list->owns_pool = !pool;
+    if (!pool) {
+        pool = mc_pool_new(list->allocator, list->node_size,
+                           list->node_alignment, 0);
+        if (!pool) {
+            fprintf(stderr, "memory allocation of %zu bytes failed\n",
+                    sizeof(*pool));
+            abort();
+        }
+    }
+    list->pool = pool;
+}
+
 static void *mc_list_node_elem(struct mc_list const *list,
                                struct mc_list_node *node)
 {
@@ -43,7 +85,9 @@ static void *mc_list_node_elem(struct mc_list const *list,
 static struct mc_list_node *mc_list_allocate_node(struct mc_list *list)
 {
     struct mc_list_node *node =
-        mc_aligned_malloc(list->node_alignment, list->node_size);
+        list->pool ? mc_pool_alloc(list->pool)
+                   : mc_allocator_alloc(list->allocator, list->node_alignment,
+                                        list->node_size);
 
     if (!node) {
         fprintf(stderr, "memory allocation of %zu bytes failed\n",
@@ -70,7 +114,10 @@ static void mc_list_delete_node(struct mc_list *list, struct mc_list_node *node)
 {
     if (list->elem_type->cleanup)
         list->elem_type->cleanup(mc_list_node_elem(list, node));
-    mc_aligned_free(node);
+    if (list->pool)
+        mc_pool_free(list->pool, node);
+    else
+        mc_allocator_free(list->allocator, node, list->node_size);
 }
 
 static void mc_list_append_node(struct mc_list *list, struct mc_list_node *node)
@@ -271,6 +318,8 @@ void mc_list_move(struct mc_list *dst, struct mc_list *src)
     src->head = NULL;
     src->tail = NULL;
     src->len = 0;
+    src->pool = NULL;
+    src->owns_pool = false;
 }
 
 void mc_list_copy(struct mc_list *dst, struct mc_list const *src)
@@ -280,7 +329,9 @@ void mc_list_copy(struct mc_list *dst, struct mc_list const *src)
 
     mc_copy_func const copy = mc_type_get_copy_forced(__func__, src->elem_type);
 
-    mc_list_init(dst, src->elem_type);
+    mc_list_init_with_allocator(dst, src->elem_type, src->allocator);
+    if (src->pool)
+        mc_list_use_pool(dst, src->owns_pool ? NULL : src->pool);
 
     struct mc_list_node *node = src->head;
     while (node) {
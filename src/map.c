@@ -2,7 +2,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "myclib/map.h"
-#include "myclib/aligned_malloc.h"
 #include "myclib/utils.h"
 
 struct mc_hash_entry {
@@ -43,7 +42,10 @@ static inline void *mc_hash_table_entry_value(struct mc_hash_table const *table,
 static void *
 mc_hash_table_allocate_entry_storage(struct mc_hash_table const *table)
 {
-    void *ptr = mc_aligned_malloc(table->entry_alignment, table->entry_size);
+    void *ptr = table->pool ? mc_pool_alloc(table->pool)
+                            : mc_allocator_alloc(table->allocator,
+                                                 table->entry_alignment,
+                                                 table->entry_size);
     if (!ptr) {
         fprintf(stderr, "memory allocation of %zu bytes failed\n",
                 table->entry_size);
@@ -92,7 +94,10 @@ static void mc_hash_table_cleanup_entry(struct mc_hash_table const *table,
                                         struct mc_hash_entry *entry)
 {
     mc_hash_table_cleanup_entry_storage(table, entry);
-    mc_aligned_free(entry->storage);
+    if (table->pool)
+        mc_pool_free(table->pool, entry->storage);
+    else
+        mc_allocator_free(table->allocator, entry->storage, table->entry_size);
     entry->storage = NULL;
 }
 
@@ -109,12 +114,16 @@ mc_hash_table_replace_entry_content(struct mc_hash_table const *table,
 static void mc_hash_table_init(struct mc_hash_table *table,
                                struct mc_type const *key_type,
                                struct mc_type const *value_type,
+                               struct mc_allocator const *allocator,
                                size_t capacity)
 {
     size_t total_size;
 
     table->key_type = key_type;
     table->value_type = value_type;
+    table->allocator = allocator;
+    table->pool = NULL;
+    table->owns_pool = false;
     if (key_type->alignment > value_type->alignment) {
         table->entry_alignment = key_type->alignment;
         table->key_offset = 0;
@@ -136,7 +145,8 @@ static void mc_hash_table_init(struct mc_hash_table *table,
     }
 
     total_size = MC_HASH_ENTRY_SIZE * capacity;
-    table->entries = mc_aligned_malloc(MC_HASH_ENTRY_ALIGNMENT, total_size);
+    table->entries =
+        mc_allocator_alloc(allocator, MC_HASH_ENTRY_ALIGNMENT, total_size);
     if (!table->entries) {
         fprintf(stderr, "memory allocation of %zu bytes failed\n", total_size);
         abort();
@@ -148,7 +158,8 @@ static void mc_hash_table_init(struct mc_hash_table *table,
 static void mc_hash_table_free_entries(struct mc_hash_table *table)
 {
     if (table->capacity > 0) {
-        mc_aligned_free(table->entries);
+        mc_allocator_free(table->allocator, table->entries,
+                          MC_HASH_ENTRY_SIZE * table->capacity);
         table->entries = NULL;
         table->capacity = 0;
     }
@@ -211,6 +222,10 @@ static void mc_hash_table_cleanup(struct mc_hash_table *table)
 {
     mc_hash_table_remove_all_entries(table);
     mc_hash_table_free_entries(table);
+    if (table->owns_pool)
+        mc_pool_delete(table->pool, table->allocator);
+    table->pool = NULL;
+    table->owns_pool = false;
     table->key_type = NULL;
     table->value_type = NULL;
 }
@@ -306,6 +321,15 @@ static void mc_hash_table_for_each(struct mc_hash_table const *table,
 
 void mc_map_init(struct mc_map *map, struct mc_type const *key_type,
                  struct mc_type const *value_type)
+{
+    mc_map_init_with_allocator(map, key_type, value_type,
+                               &mc_default_allocator);
+}
+
+void mc_map_init_with_allocator(struct mc_map *map,
+                                struct mc_type const *key_type,
+                                struct mc_type const *value_type,
+                                struct mc_allocator const *allocator)
 {
     assert(map);
     assert(key_type);
@@ -316,7 +340,8 @@ void mc_map_init(struct mc_map *map, struct mc_type const *key_type,
     assert(value_type);
     assert(value_type->size > 0);
     assert(mc_is_pow_of_two(value_type->alignment));
-    mc_hash_table_init(&map->table, key_type, value_type, 0);
+    assert(allocator);
+    mc_hash_table_init(&map->table, key_type, value_type, allocator, 0);
     map->len = 0;
 }
 
@@ -329,6 +354,37 @@ void mc_map_cleanup(struct mc_map *map)
     map->len = 0;
 }
 
+void mc_map_use_pool(struct mc_map *map, struct mc_pool *pool)
+{
+    struct mc_hash_table *table;
+
+    assert(map);
+    assert(map->len == 0);
+
+    table = &map->table;
+    if (pool && (mc_pool_obj_size(pool) < table->entry_size ||
+                 mc_pool_alignment(pool) < table->entry_alignment)) {
+        fprintf(stderr, "%s: pool blocks cannot hold %zu-byte entries\n",
+                __func__, table->entry_size);
+        abort();
+    }
+
+    if (table->owns_pool)
+        mc_pool_delete(table->pool, table->allocator);
+
+    table->owns_pool = !pool;
+    if (!pool) {
+        pool = mc_pool_new(table->allocator, table->entry_size,
+                           table->entry_alignment, 0);
+        if (!pool) {
+            fprintf(stderr, "memory allocation of %zu bytes failed\n",
+                    sizeof(*pool));
+            abort();
+        }
+    }
+    table->pool = pool;
+}
+
 static size_t mc_map_scramble_hash(size_t hash_value)
 {
     hash_value ^= (hash_value >> 20) ^ (hash_value >> 12);
@@ -401,7 +457,9 @@ static void mc_map_resize_table(struct mc_map *map, size_t capacity)
     }
 
     mc_hash_table_init(&new_table, map->table.key_type, map->table.value_type,
-                       capacity);
+                       map->table.allocator, capacity);
+    new_table.pool = map->table.pool;
+    new_table.owns_pool = map->table.owns_pool;
 
     if (map->len > 0)
         mc_hash_table_rehash_entries(&new_table, &map->table);
@@ -491,6 +549,8 @@ void mc_map_move(struct mc_map *dst, struct mc_map *src)
 
     src->table.entries = NULL;
     src->table.capacity = 0;
+    src->table.pool = NULL;
+    src->table.owns_pool = false;
     src->len = 0;
 }
 
@@ -505,7 +565,10 @@ void mc_map_copy(struct mc_map *dst, struct mc_map const *src)
     mc_type_get_copy_forced(__func__, src->table.key_type);
     mc_type_get_copy_forced(__func__, src->table.value_type);
 
-    mc_map_init(dst, src->table.key_type, src->table.value_type);
+    mc_map_init_with_allocator(dst, src->table.key_type,
+                               src->table.value_type, src->table.allocator);
+    if (src->table.pool)
+        mc_map_use_pool(dst, src->table.owns_pool ? NULL : src->table.pool);
 
     if (src->len == 0)
         return;
@@ -0,0 +1,399 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/multi_search.h"
+#include "myclib/aligned_malloc.h"
+#include "myclib/hash.h"
+#include "myclib/string.h"
+
+#define MC_MULTI_SEARCH_ALIGNMENT 64
+
+static void *mc_multi_search_alloc(size_t count, size_t size)
+{
+    if (size != 0 && count > SIZE_MAX / size) {
+        fprintf(stderr, "capacity overflow\n");
+        abort();
+    }
+
+    size_t const total = count * size > 0 ? count * size : 1;
+    void *ptr = mc_aligned_malloc(MC_MULTI_SEARCH_ALIGNMENT, total);
+    if (!ptr) {
+        fprintf(stderr, "memory allocation of %zu bytes failed\n", total);
+        abort();
+    }
+    return ptr;
+}
+
+static void *mc_multi_search_grow(void *ptr, size_t old_count,
+                                  size_t new_count, size_t size)
+{
+    void *new_ptr = mc_multi_search_alloc(new_count, size);
+    memcpy(new_ptr, ptr, old_count * size);
+    memset((char *)new_ptr + old_count * size, 0,
+           (new_count - old_count) * size);
+    mc_aligned_free(ptr);
+    return new_ptr;
+}
+
+/* The trie while it is built: rows of class_count child states, 0 meaning
+ * none since the root is nobody's child. */
+struct mc_multi_search_trie {
+    uint32_t *next;
+    uint32_t *state_pattern;
+    size_t count;
+    size_t capacity;
+    size_t class_count;
+};
+
+static uint32_t mc_multi_search_trie_add(struct mc_multi_search_trie *trie)
+{
+    if (trie->count == trie->capacity) {
+        size_t const capacity = trie->capacity * 2;
+        if (capacity * trie->class_count >= MC_MULTI_SEARCH_MATCH_FLAG) {
+            fprintf(stderr, "mc_multi_search: too many states\n");
+            abort();
+        }
+        trie->next = mc_multi_search_grow(
+            trie->next, trie->capacity * trie->class_count,
+            capacity * trie->class_count, sizeof(uint32_t));
+        trie->state_pattern =
+            mc_multi_search_grow(trie->state_pattern, trie->capacity,
+                                 capacity, sizeof(uint32_t));
+        trie->capacity = capacity;
+    }
+
+    trie->state_pattern[trie->count] = MC_MULTI_SEARCH_NONE;
+    return (uint32_t)trie->count++;
+}
+
+void mc_multi_search_init(struct mc_multi_search *search,
+                          struct mc_array const *patterns)
+{
+    assert(search);
+    assert(patterns);
+
+    size_t const pattern_count = mc_array_len(patterns);
+    if (pattern_count >= MC_MULTI_SEARCH_NONE) {
+        fprintf(stderr, "mc_multi_search: too many patterns\n");
+        abort();
+    }
+
+    bool seen[256] = {false};
+    for (size_t p = 0; p < pattern_count; ++p) {
+        struct mc_string const *pattern = mc_array_get_unchecked(patterns, p);
+        struct mc_str_view const view = mc_string_view(pattern);
+        if (view.len == 0) {
+            fprintf(stderr, "mc_multi_search: pattern %zu is empty\n", p);
+            abort();
+        }
+        for (size_t i = 0; i < view.len; ++i)
+            seen[(uint8_t)view.data[i]] = true;
+    }
+
+    /* Bytes in no pattern share the last class, if there are any. */
+    size_t class_count = 0;
+    for (size_t b = 0; b < 256; ++b) {
+        if (seen[b])
+            search->classes[b] = (uint8_t)class_count++;
+    }
+    if (class_count < 256) {
+        for (size_t b = 0; b < 256; ++b) {
+            if (!seen[b])
+                search->classes[b] = (uint8_t)class_count;
+        }
+        ++class_count;
+    }
+
+    search->pattern_count = pattern_count;
+    search->pattern_len = mc_multi_search_alloc(pattern_count, sizeof(size_t));
+    search->pattern_next =
+        mc_multi_search_alloc(pattern_count, sizeof(uint32_t));
+
+    struct mc_multi_search_trie trie = {
+        .next = mc_multi_search_alloc(64 * class_count, sizeof(uint32_t)),
+        .state_pattern = mc_multi_search_alloc(64, sizeof(uint32_t)),
+        .count = 0,
+        .capacity = 64,
+        .class_count = class_count,
+    };
+    memset(trie.next, 0, 64 * class_count * sizeof(uint32_t));
+    mc_multi_search_trie_add(&trie);
+
+    /* Backwards, so that repeated patterns chain in ascending order. */
+    for (size_t p = pattern_count; p-- > 0;) {
+        struct mc_string const *pattern = mc_array_get_unchecked(patterns, p);
+        struct mc_str_view const view = mc_string_view(pattern);
+        uint32_t state = 0;
+        for (size_t i = 0; i < view.len; ++i) {
+            size_t const slot =
+                state * class_count + search->classes[(uint8_t)view.data[i]];
+            if (trie.next[slot] == 0) {
+                uint32_t const child = mc_multi_search_trie_add(&trie);
+                trie.next[slot] = child;
+            }
+            state = trie.next[slot];
+        }
+        search->pattern_len[p] = view.len;
+        search->pattern_next[p] = trie.state_pattern[state];
+        trie.state_pattern[state] = (uint32_t)p;
+    }
+
+    /*
+     * Breadth-first, every missing edge is replaced by the edge of the
+     * failure state, whose row is already complete because it is
+     * shallower. The queue doubles as the new state order.
+     */
+    size_t const n = trie.count;
+    uint32_t *const queue = mc_multi_search_alloc(n, sizeof(uint32_t));
+    uint32_t *const fail = mc_multi_search_alloc(n, sizeof(uint32_t));
+    uint32_t *const dict_link = mc_multi_search_alloc(n, sizeof(uint32_t));
+    uint32_t *const depth = mc_multi_search_alloc(n, sizeof(uint32_t));
+    size_t head = 0;
+    size_t tail = 0;
+
+    queue[tail++] = 0;
+    fail[0] = 0;
+    dict_link[0] = MC_MULTI_SEARCH_NONE;
+    depth[0] = 0;
+    while (head < tail) {
+        uint32_t const state = queue[head++];
+        uint32_t *const row = trie.next + (size_t)state * class_count;
+        uint32_t const *const fail_row =
+            trie.next + (size_t)fail[state] * class_count;
+        for (size_t c = 0; c < class_count; ++c) {
+            uint32_t const child = row[c];
+            if (child == 0) {
+                row[c] = state == 0 ? 0 : fail_row[c];
+                continue;
+            }
+            uint32_t const link = state == 0 ? 0 : fail_row[c];
+            fail[child] = link;
+            dict_link[child] =
+                trie.state_pattern[link] != MC_MULTI_SEARCH_NONE
+                    ? link
+                    : dict_link[link];
+            depth[child] = depth[state] + 1;
+            queue[tail++] = child;
+        }
+    }
+    assert(tail == n);
+
+    uint32_t *const new_id = fail;
+    for (size_t i = 0; i < n; ++i)
+        new_id[queue[i]] = (uint32_t)i;
+
+    search->class_count = class_count;
+    search->state_count = n;
+    search->table = mc_multi_search_alloc(n * class_count, sizeof(uint32_t));
+    search->state_pattern = mc_multi_search_alloc(n, sizeof(uint32_t));
+    search->dict_link = mc_multi_search_alloc(n, sizeof(uint32_t));
+    search->state_depth = mc_multi_search_alloc(n, sizeof(uint32_t));
+
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t const old = queue[i];
+        search->state_pattern[i] = trie.state_pattern[old];
+        search->state_depth[i] = depth[old];
+        search->dict_link[i] = dict_link[old] == MC_MULTI_SEARCH_NONE
+                                   ? MC_MULTI_SEARCH_NONE
+                                   : new_id[dict_link[old]];
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t const *const row =
+            trie.next + (size_t)queue[i] * class_count;
+        uint32_t *const out = search->table + i * class_count;
+        for (size_t c = 0; c < class_count; ++c) {
+            uint32_t const target = new_id[row[c]];
+            uint32_t entry = target * (uint32_t)class_count;
+            if (search->state_pattern[target] != MC_MULTI_SEARCH_NONE ||
+                search->dict_link[target] != MC_MULTI_SEARCH_NONE)
+                entry |= MC_MULTI_SEARCH_MATCH_FLAG;
+            out[c] = entry;
+        }
+    }
+
+    mc_aligned_free(depth);
+    mc_aligned_free(dict_link);
+    mc_aligned_free(fail);
+    mc_aligned_free(queue);
+    mc_aligned_free(trie.state_pattern);
+    mc_aligned_free(trie.next);
+}
+
+void mc_multi_search_cleanup(struct mc_multi_search *search)
+{
+    assert(search);
+
+    mc_aligned_free(search->table);
+    mc_aligned_free(search->state_pattern);
+    mc_aligned_free(search->dict_link);
+    mc_aligned_free(search->state_depth);
+    mc_aligned_free(search->pattern_len);
+    mc_aligned_free(search->pattern_next);
+    search->table = NULL;
+    search->state_pattern = NULL;
+    search->dict_link = NULL;
+    search->state_depth = NULL;
+    search->pattern_len = NULL;
+    search->pattern_next = NULL;
+    search->state_count = 0;
+    search->pattern_count = 0;
+}
+
+bool mc_multi_search_find_first(struct mc_multi_search const *search,
+                                struct mc_str_view text,
+                                struct mc_multi_search_match *match)
+{
+    assert(search);
+
+    uint32_t const *const table = search->table;
+    uint8_t const *const classes = search->classes;
+    uint8_t const *const data = (uint8_t const *)text.data;
+    uint32_t offset = 0;
+
+    for (size_t i = 0; i < text.len; ++i) {
+        uint32_t const entry = table[offset + classes[data[i]]];
+        offset = entry & ~MC_MULTI_SEARCH_MATCH_FLAG;
+        if (!(entry & MC_MULTI_SEARCH_MATCH_FLAG))
+            continue;
+
+        if (match) {
+            size_t state = offset / search->class_count;
+            if (search->state_pattern[state] == MC_MULTI_SEARCH_NONE)
+                state = search->dict_link[state];
+            size_t const pattern = search->state_pattern[state];
+            match->pattern = pattern;
+            match->len = search->pattern_len[pattern];
+            match->start = i + 1 - match->len;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+bool mc_multi_search_find_leftmost(struct mc_multi_search const *search,
+                                   struct mc_str_view text,
+                                   struct mc_multi_search_match *match)
+{
+    assert(search);
+
+    uint32_t const *const table = search->table;
+    uint8_t const *const classes = search->classes;
+    uint8_t const *const data = (uint8_t const *)text.data;
+    size_t const class_count = search->class_count;
+    uint32_t offset = 0;
+    bool found = false;
+    size_t best_start = 0;
+    size_t best_pattern = 0;
+
+    /*
+     * The first match seen ends first, but one that starts earlier may
+     * still end later. That is only possible while the current state
+     * spells a suffix reaching back to the best start, so the scan goes on
+     * until the state gets shallower than that.
+     */
+    for (size_t i = 0; i < text.len; ++i) {
+        uint32_t const entry = table[offset + classes[data[i]]];
+        offset = entry & ~MC_MULTI_SEARCH_MATCH_FLAG;
+        if (found &&
+            i + 1 - search->state_depth[offset / class_count] > best_start)
+            break;
+        if (!(entry & MC_MULTI_SEARCH_MATCH_FLAG))
+            continue;
+
+        /* The first pattern listed for a state is the longest. */
+        size_t state = offset / class_count;
+        if (search->state_pattern[state] == MC_MULTI_SEARCH_NONE)
+            state = search->dict_link[state];
+        size_t const pattern = search->state_pattern[state];
+        size_t const start = i + 1 - search->pattern_len[pattern];
+        if (!found || start <= best_start) {
+            found = true;
+            best_start = start;
+            best_pattern = pattern;
+        }
+    }
+
+    if (found && match) {
+        match->pattern = best_pattern;
+        match->start = best_start;
+        match->len = search->pattern_len[best_pattern];
+    }
+    return found;
+}
+
+bool mc_multi_search_contains(struct mc_multi_search const *search,
+                              struct mc_str_view text)
+{
+    return mc_multi_search_find_first(search, text, NULL);
+}
+
+void mc_multi_search_find_all(struct mc_multi_search const *search,
+                              struct mc_str_view text,
+                              struct mc_array *matches)
+{
+    assert(search);
+    assert(matches);
+
+    mc_array_init(matches, mc_multi_search_match_get_mc_type());
+
+    uint32_t const *const table = search->table;
+    uint8_t const *const classes = search->classes;
+    uint8_t const *const data = (uint8_t const *)text.data;
+    uint32_t offset = 0;
+
+    for (size_t i = 0; i < text.len; ++i) {
+        uint32_t const entry = table[offset + classes[data[i]]];
+        offset = entry & ~MC_MULTI_SEARCH_MATCH_FLAG;
+        if (!(entry & MC_MULTI_SEARCH_MATCH_FLAG))
+            continue;
+
+        uint32_t state = offset / (uint32_t)search->class_count;
+        if (search->state_pattern[state] == MC_MULTI_SEARCH_NONE)
+            state = search->dict_link[state];
+        for (; state != MC_MULTI_SEARCH_NONE;
+             state = search->dict_link[state]) {
+            uint32_t pattern = search->state_pattern[state];
+            for (; pattern != MC_MULTI_SEARCH_NONE;
+                 pattern = search->pattern_next[pattern]) {
+                struct mc_multi_search_match match = {
+                    .pattern = pattern,
+                    .start = i + 1 - search->pattern_len[pattern],
+                    .len = search->pattern_len[pattern],
+                };
+                mc_array_push(matches, &match);
+            }
+        }
+    }
+}
+
+static int mc_multi_search_match_compare(void const *match1,
+                                         void const *match2)
+{
+    struct mc_multi_search_match const *a = match1;
+    struct mc_multi_search_match const *b = match2;
+    if (a->start != b->start)
+        return a->start < b->start ? -1 : 1;
+    if (a->len != b->len)
+        return a->len < b->len ? -1 : 1;
+    if (a->pattern != b->pattern)
+        return a->pattern < b->pattern ? -1 : 1;
+    return 0;
+}
+
+static bool mc_multi_search_match_equal(void const *match1,
+                                        void const *match2)
+{
+    return mc_multi_search_match_compare(match1, match2) == 0;
+}
+
+static size_t mc_multi_search_match_hash(void const *match)
+{
+    return MC_HASH(match, sizeof(struct mc_multi_search_match));
+}
+
+MC_DEFINE_POD_TYPE(mc_multi_search_match, struct mc_multi_search_match,
+                   mc_multi_search_match_compare, mc_multi_search_match_equal,
+                   mc_multi_search_match_hash)
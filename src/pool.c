@@ -0,0 +1,295 @@
+#include <assert.h>
+#include <stdalign.h>
+#include "myclib/pool.h"
+#include "myclib/aligned_malloc.h"
+#include "myclib/utils.h"
+
+#define MC_POOL_CACHE_SLOTS 8
+#define MC_POOL_CACHE_BATCH 32
+
+struct mc_pool_slab {
+    struct mc_pool_slab *next;
+};
+
+/* One thread's private stack of blocks for a pool. Slots are picked by pool
+ * id; a pool that lands on an occupied slot evicts the previous owner. */
+struct mc_pool_cache {
+    uint64_t pool_id;
+    struct mc_pool *pool;
+    void *head;
+    size_t count;
+};
+
+static _Thread_local struct mc_pool_cache mc_pool_caches[MC_POOL_CACHE_SLOTS];
+
+static atomic_uint_fast64_t mc_pool_next_id = 1;
+
+/* Thread-cached pools that are still alive, so that an evicted cache can
+ * tell whether its blocks still have a pool to go back to. */
+static atomic_flag mc_pool_live_lock = ATOMIC_FLAG_INIT;
+static struct mc_pool *mc_pool_live;
+
+static void mc_pool_lock(atomic_flag *lock)
+{
+    while (atomic_flag_test_and_set_explicit(lock, memory_order_acquire)) {
+#if (defined(__GNUC__) || defined(__clang__)) &&                               \
+    (defined(__x86_64__) || defined(__i386__))
+        __builtin_ia32_pause();
+#endif
+    }
+}
+
+static void mc_pool_unlock(atomic_flag *lock)
+{
+    atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+static inline void *mc_pool_next_block(void *block)
+{
+    return *(void **)block;
+}
+
+static inline void mc_pool_set_next_block(void *block, void *next)
+{
+    *(void **)block = next;
+}
+
+static size_t mc_pool_slab_header_size(struct mc_pool const *pool)
+{
+    size_t const mask = pool->alignment - 1;
+    return (sizeof(struct mc_pool_slab) + mask) & ~mask;
+}
+
+void mc_pool_init(struct mc_pool *pool, size_t obj_size, size_t alignment,
+                  unsigned options)
+{
+    assert(pool);
+    assert(obj_size > 0);
+    assert(mc_is_pow_of_two(alignment));
+
+    alignment = mc_max2(alignment, alignof(void *));
+    size_t const mask = alignment - 1;
+    pool->obj_size = (mc_max2(obj_size, sizeof(void *)) + mask) & ~mask;
+    pool->alignment = alignment;
+    pool->slab_size = MC_POOL_MIN_SLAB_SIZE;
+    pool->free_list = NULL;
+    pool->bump = NULL;
+    pool->bump_end = NULL;
+    pool->slabs = NULL;
+    pool->options = options;
+    pool->id = atomic_fetch_add(&mc_pool_next_id, 1);
+    atomic_flag_clear(&pool->lock);
+    pool->next_live = NULL;
+
+    if (options & MC_POOL_OPTION_THREAD_CACHE) {
+        mc_pool_lock(&mc_pool_live_lock);
+        pool->next_live = mc_pool_live;
+        mc_pool_live = pool;
+        mc_pool_unlock(&mc_pool_live_lock);
+    }
+}
+
+void mc_pool_cleanup(struct mc_pool *pool)
+{
+    assert(pool);
+
+    if (pool->options & MC_POOL_OPTION_THREAD_CACHE) {
+        mc_pool_lock(&mc_pool_live_lock);
+        struct mc_pool **link = &mc_pool_live;
+        while (*link != pool)
+            link = &(*link)->next_live;
+        *link = pool->next_live;
+        mc_pool_unlock(&mc_pool_live_lock);
+
+        /* This thread's cache would otherwise point into the freed slabs */
+        struct mc_pool_cache *cache =
+            &mc_pool_caches[pool->id % MC_POOL_CACHE_SLOTS];
+        if (cache->pool_id == pool->id) {
+            cache->pool_id = 0;
+            cache->pool = NULL;
+            cache->head = NULL;
+            cache->count = 0;
+        }
+    }
+
+    struct mc_pool_slab *slab = pool->slabs;
+    while (slab) {
+        struct mc_pool_slab *next = slab->next;
+        mc_aligned_free(slab);
+        slab = next;
+    }
+
+    pool->free_list = NULL;
+    pool->bump = NULL;
+    pool->bump_end = NULL;
+    pool->slabs = NULL;
+}
+
+struct mc_pool *mc_pool_new(struct mc_allocator const *allocator,
+                            size_t obj_size, size_t alignment,
+                            unsigned options)
+{
+    struct mc_pool *pool = mc_allocator_alloc(
+        allocator, alignof(struct mc_pool), sizeof(struct mc_pool));
+    if (pool)
+        mc_pool_init(pool, obj_size, alignment, options);
+    return pool;
+}
+
+void mc_pool_delete(struct mc_pool *pool,
+                    struct mc_allocator const *allocator)
+{
+    if (!pool)
+        return;
+    mc_pool_cleanup(pool);
+    mc_allocator_free(allocator, pool, sizeof(*pool));
+}
+
+/* Slabs double from MC_POOL_MIN_SLAB_SIZE up to MC_POOL_MAX_SLAB_SIZE and
+ * are carved lazily, so a fresh slab costs no more than one malloc. */
+static bool mc_pool_add_slab(struct mc_pool *pool)
+{
+    size_t const count = mc_max2(pool->slab_size / pool->obj_size, 1);
+    size_t const header = mc_pool_slab_header_size(pool);
+    struct mc_pool_slab *slab =
+        mc_aligned_malloc(pool->alignment, header + count * pool->obj_size);
+    if (!slab)
+        return false;
+
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->bump = mc_ptr_add(slab, header);
+    pool->bump_end = pool->bump + count * pool->obj_size;
+    if (pool->slab_size < MC_POOL_MAX_SLAB_SIZE)
+        pool->slab_size *= 2;
+    return true;
+}
+
+static void *mc_pool_take(struct mc_pool *pool)
+{
+    void *block = pool->free_list;
+    if (block) {
+        pool->free_list = mc_pool_next_block(block);
+        return block;
+    }
+
+    if (pool->bump == pool->bump_end && !mc_pool_add_slab(pool))
+        return NULL;
+
+    block = pool->bump;
+    pool->bump += pool->obj_size;
+    return block;
+}
+
+/* Hands the chain first..last back to the shared free list. */
+static void mc_pool_give_back(struct mc_pool *pool, void *first, void *last)
+{
+    mc_pool_lock(&pool->lock);
+    mc_pool_set_next_block(last, pool->free_list);
+    pool->free_list = first;
+    mc_pool_unlock(&pool->lock);
+}
+
+static void mc_pool_cache_evict(struct mc_pool_cache *cache)
+{
+    if (!cache->head)
+        return;
+
+    /* Ids are never reused, so a pool found here with the same address and
+     * id is the one the blocks came from. Holding the live lock keeps it
+     * from being cleaned up underneath us; the blocks of a pool that is
+     * gone live in freed slabs and must not be touched. */
+    mc_pool_lock(&mc_pool_live_lock);
+    for (struct mc_pool *pool = mc_pool_live; pool; pool = pool->next_live) {
+        if (pool == cache->pool && pool->id == cache->pool_id) {
+            void *last = cache->head;
+            while (mc_pool_next_block(last))
+                last = mc_pool_next_block(last);
+            mc_pool_give_back(pool, cache->head, last);
+            break;
+        }
+    }
+    mc_pool_unlock(&mc_pool_live_lock);
+    cache->head = NULL;
+    cache->count = 0;
+}
+
+static struct mc_pool_cache *mc_pool_get_cache(struct mc_pool *pool)
+{
+    struct mc_pool_cache *cache =
+        &mc_pool_caches[pool->id % MC_POOL_CACHE_SLOTS];
+    if (cache->pool_id != pool->id) {
+        mc_pool_cache_evict(cache);
+        cache->pool_id = pool->id;
+        cache->pool = pool;
+        cache->head = NULL;
+        cache->count = 0;
+    }
+    return cache;
+}
+
+static bool mc_pool_cache_refill(struct mc_pool *pool,
+                                 struct mc_pool_cache *cache)
+{
+    mc_pool_lock(&pool->lock);
+    while (cache->count < MC_POOL_CACHE_BATCH) {
+        void *block = mc_pool_take(pool);
+        if (!block)
+            break;
+        mc_pool_set_next_block(block, cache->head);
+        cache->head = block;
+        ++cache->count;
+    }
+    mc_pool_unlock(&pool->lock);
+    return cache->head != NULL;
+}
+
+void *mc_pool_alloc(struct mc_pool *pool)
+{
+    assert(pool);
+
+    if (!(pool->options & MC_POOL_OPTION_THREAD_CACHE))
+        return mc_pool_take(pool);
+
+    struct mc_pool_cache *cache = mc_pool_get_cache(pool);
+    if (!cache->head && !mc_pool_cache_refill(pool, cache))
+        return NULL;
+
+    void *block = cache->head;
+    cache->head = mc_pool_next_block(block);
+    --cache->count;
+    return block;
+}
+
+void mc_pool_free(struct mc_pool *pool, void *ptr)
+{
+    assert(pool);
+
+    if (!ptr)
+        return;
+
+    if (!(pool->options & MC_POOL_OPTION_THREAD_CACHE)) {
+        mc_pool_set_next_block(ptr, pool->free_list);
+        pool->free_list = ptr;
+        return;
+    }
+
+    struct mc_pool_cache *cache = mc_pool_get_cache(pool);
+    mc_pool_set_next_block(ptr, cache->head);
+    cache->head = ptr;
+    if (++cache->count < 2 * MC_POOL_CACHE_BATCH)
+        return;
+
+    /* Keep one batch for this thread and spill the rest. */
+    void *last = cache->head;
+    for (size_t i = 1; i < MC_POOL_CACHE_BATCH; ++i)
+        last = mc_pool_next_block(last);
+    void *spill = mc_pool_next_block(last);
+    mc_pool_set_next_block(last, NULL);
+    cache->count = MC_POOL_CACHE_BATCH;
+
+    void *spill_last = spill;
+    while (mc_pool_next_block(spill_last))
+        spill_last = mc_pool_next_block(spill_last);
+    mc_pool_give_back(pool, spill, spill_last);
+}
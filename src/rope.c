@@ -0,0 +1,519 @@
+#include <assert.h>
+#include <stdalign.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/rope.h"
+#include "myclib/hash.h"
+
+#define MC_ROPE_NODE_SIZE                                                      \
+    (sizeof(struct mc_rope_node) + MC_ROPE_CHUNK_CAPACITY)
+
+static void mc_rope_bounds_check(char const *func_name, size_t index,
+                                 size_t bounds, bool allow_equal)
+{
+    if (!allow_equal && index >= bounds) {
+        fprintf(stderr, "%s: index (is %zu) must < len (is %zu)\n", func_name,
+                index, bounds);
+        abort();
+    }
+    if (allow_equal && index > bounds) {
+        fprintf(stderr, "%s: index (is %zu) must <= len (is %zu)\n", func_name,
+                index, bounds);
+        abort();
+    }
+}
+
+static uint32_t mc_rope_random(struct mc_rope *rope)
+{
+    uint32_t x = rope->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rope->seed = x;
+    return x;
+}
+
+static struct mc_rope_node *mc_rope_node_new(struct mc_rope *rope,
+                                             char const *data, size_t len)
+{
+    assert(len <= MC_ROPE_CHUNK_CAPACITY);
+    struct mc_rope_node *node = mc_allocator_alloc(
+        rope->allocator, alignof(struct mc_rope_node), MC_ROPE_NODE_SIZE);
+    if (!node) {
+        fprintf(stderr, "memory allocation of %zu bytes failed\n",
+                MC_ROPE_NODE_SIZE);
+        abort();
+    }
+    node->left = NULL;
+    node->right = NULL;
+    node->len = len;
+    node->priority = mc_rope_random(rope);
+    node->chunk_len = (uint32_t)len;
+    memcpy(node->chunk, data, len);
+    return node;
+}
+
+static void mc_rope_free_tree(struct mc_rope const *rope,
+                              struct mc_rope_node *node)
+{
+    while (node) {
+        mc_rope_free_tree(rope, node->left);
+        struct mc_rope_node *right = node->right;
+        mc_allocator_free(rope->allocator, node, MC_ROPE_NODE_SIZE);
+        node = right;
+    }
+}
+
+static size_t mc_rope_node_len(struct mc_rope_node const *node)
+{
+    return node ? node->len : 0;
+}
+
+static void mc_rope_node_update(struct mc_rope_node *node)
+{
+    node->len = mc_rope_node_len(node->left) + node->chunk_len +
+                mc_rope_node_len(node->right);
+}
+
+/* Concatenates two treaps; every position in a comes before those in b. */
+static struct mc_rope_node *mc_rope_merge(struct mc_rope_node *a,
+                                          struct mc_rope_node *b)
+{
+    if (!a)
+        return b;
+    if (!b)
+        return a;
+    if (a->priority >= b->priority) {
+        a->right = mc_rope_merge(a->right, b);
+        mc_rope_node_update(a);
+        return a;
+    }
+    b->left = mc_rope_merge(a, b->left);
+    mc_rope_node_update(b);
+    return b;
+}
+
+/* Cuts node into the first pos bytes and the rest, splitting the chunk
+ * that straddles pos in two. */
+static void mc_rope_split(struct mc_rope *rope, struct mc_rope_node *node,
+                          size_t pos, struct mc_rope_node **left,
+                          struct mc_rope_node **right)
+{
+    if (!node) {
+        *left = NULL;
+        *right = NULL;
+        return;
+    }
+
+    size_t const left_len = mc_rope_node_len(node->left);
+    if (pos <= left_len) {
+        mc_rope_split(rope, node->left, pos, left, &node->left);
+        mc_rope_node_update(node);
+        *right = node;
+    } else if (pos >= left_len + node->chunk_len) {
+        mc_rope_split(rope, node->right, pos - left_len - node->chunk_len,
+                      &node->right, right);
+        mc_rope_node_update(node);
+        *left = node;
+    } else {
+        size_t const offset = pos - left_len;
+        /* The tail inherits the priority so that it can take the node's
+         * place under any of its ancestors. */
+        struct mc_rope_node *tail = mc_rope_node_new(
+            rope, node->chunk + offset, node->chunk_len - offset);
+        tail->priority = node->priority;
+        node->chunk_len = (uint32_t)offset;
+        *right = mc_rope_merge(tail, node->right);
+        node->right = NULL;
+        mc_rope_node_update(node);
+        *left = node;
+    }
+}
+
+static struct mc_rope_node *mc_rope_last(struct mc_rope_node *node)
+{
+    while (node->right)
+        node = node->right;
+    return node;
+}
+
+/* Appends to the last chunk, which must have room, and to the lengths of
+ * the subtrees above it. */
+static void mc_rope_append_last(struct mc_rope_node *root, char const *data,
+                                size_t len)
+{
+    struct mc_rope_node *last = mc_rope_last(root);
+    memcpy(last->chunk + last->chunk_len, data, len);
+    last->chunk_len += (uint32_t)len;
+    for (struct mc_rope_node *node = root; node; node = node->right)
+        node->len += len;
+}
+
+/* Like merge, but first moves the first chunk of b into the last chunk of
+ * a when both fit in one, so that edits do not leave slivers behind. */
+static struct mc_rope_node *mc_rope_join(struct mc_rope *rope,
+                                         struct mc_rope_node *a,
+                                         struct mc_rope_node *b)
+{
+    if (!a || !b)
+        return a ? a : b;
+
+    struct mc_rope_node const *first = b;
+    while (first->left)
+        first = first->left;
+
+    size_t const moved = first->chunk_len;
+    if (mc_rope_last(a)->chunk_len + moved <= MC_ROPE_CHUNK_CAPACITY) {
+        struct mc_rope_node *head;
+        mc_rope_split(rope, b, moved, &head, &b);
+        mc_rope_append_last(a, head->chunk, moved);
+        mc_rope_free_tree(rope, head);
+    }
+    return mc_rope_merge(a, b);
+}
+
+static struct mc_rope_node *mc_rope_build(struct mc_rope *rope,
+                                          struct mc_str_view text)
+{
+    struct mc_rope_node *root = NULL;
+    for (size_t pos = 0; pos < text.len; pos += MC_ROPE_CHUNK_CAPACITY) {
+        size_t const rest = text.len - pos;
+        size_t const len =
+            rest < MC_ROPE_CHUNK_CAPACITY ? rest : MC_ROPE_CHUNK_CAPACITY;
+        root =
+            mc_rope_merge(root, mc_rope_node_new(rope, text.data + pos, len));
+    }
+    return root;
+}
+
+/* The node whose chunk holds byte pos, and pos within it. */
+static struct mc_rope_node *mc_rope_find(struct mc_rope_node *node,
+                                         size_t *pos)
+{
+    for (;;) {
+        size_t const left_len = mc_rope_node_len(node->left);
+        if (*pos < left_len) {
+            node = node->left;
+        } else if (*pos < left_len + node->chunk_len) {
+            *pos -= left_len;
+            return node;
+        } else {
+            *pos -= left_len + node->chunk_len;
+            node = node->right;
+        }
+    }
+}
+
+void mc_rope_init(struct mc_rope *rope)
+{
+    mc_rope_init_with_allocator(rope, &mc_default_allocator);
+}
+
+void mc_rope_init_with_allocator(struct mc_rope *rope,
+                                 struct mc_allocator const *allocator)
+{
+    assert(rope);
+    assert(allocator);
+    rope->root = NULL;
+    rope->seed = 2463534242u;
+    rope->allocator = allocator;
+}
+
+void mc_rope_from_view(struct mc_rope *rope, struct mc_str_view text)
+{
+    mc_rope_init(rope);
+    rope->root = mc_rope_build(rope, text);
+}
+
+void mc_rope_cleanup(struct mc_rope *rope)
+{
+    assert(rope);
+    mc_rope_clear(rope);
+}
+
+void mc_rope_clear(struct mc_rope *rope)
+{
+    assert(rope);
+    mc_rope_free_tree(rope, rope->root);
+    rope->root = NULL;
+}
+
+char mc_rope_get(struct mc_rope const *rope, size_t index)
+{
+    assert(rope);
+    mc_rope_bounds_check(__func__, index, mc_rope_len(rope), false);
+    struct mc_rope_node const *node = mc_rope_find(rope->root, &index);
+    return node->chunk[index];
+}
+
+void mc_rope_insert(struct mc_rope *rope, size_t pos, struct mc_str_view text)
+{
+    assert(rope);
+    mc_rope_bounds_check(__func__, pos, mc_rope_len(rope), true);
+    if (text.len == 0)
+        return;
+
+    /* The chunk that pos falls in, or ends at, may have room. */
+    struct mc_rope_node *node = rope->root;
+    size_t offset = pos;
+    while (node) {
+        size_t const left_len = mc_rope_node_len(node->left);
+        if (node->left && offset <= left_len) {
+            node = node->left;
+        } else if (offset <= left_len + node->chunk_len) {
+            offset -= left_len;
+            break;
+        } else {
+            offset -= left_len + node->chunk_len;
+            node = node->right;
+        }
+    }
+
+    if (node && node->chunk_len + text.len <= MC_ROPE_CHUNK_CAPACITY) {
+        struct mc_rope_node *path = rope->root;
+        size_t rest = pos;
+        while (path != node) {
+            size_t const left_len = mc_rope_node_len(path->left);
+            path->len += text.len;
+            if (path->left && rest <= left_len) {
+                path = path->left;
+            } else {
+                rest -= left_len + path->chunk_len;
+                path = path->right;
+            }
+        }
+        memmove(node->chunk + offset + text.len, node->chunk + offset,
+                node->chunk_len - offset);
+        memcpy(node->chunk + offset, text.data, text.len);
+        node->chunk_len += (uint32_t)text.len;
+        node->len += text.len;
+        return;
+    }
+
+    struct mc_rope_node *left;
+    struct mc_rope_node *right;
+    mc_rope_split(rope, rope->root, pos, &left, &right);
+    if (left) {
+        /* Top up the chunk before pos so that only full chunks are added */
+        size_t room = MC_ROPE_CHUNK_CAPACITY - mc_rope_last(left)->chunk_len;
+        if (room > text.len)
+            room = text.len;
+        mc_rope_append_last(left, text.data, room);
+        text = mc_str_view_substr(text, room, text.len);
+    }
+    struct mc_rope_node *middle = mc_rope_build(rope, text);
+    rope->root = mc_rope_join(rope, mc_rope_join(rope, left, middle), right);
+}
+
+void mc_rope_append(struct mc_rope *rope, struct mc_str_view text)
+{
+    assert(rope);
+    mc_rope_insert(rope, mc_rope_len(rope), text);
+}
+
+void mc_rope_remove(struct mc_rope *rope, size_t pos, size_t len)
+{
+    assert(rope);
+    size_t const total = mc_rope_len(rope);
+    mc_rope_bounds_check(__func__, pos, total, true);
+    if (len > total - pos)
+        len = total - pos;
+    if (len == 0)
+        return;
+
+    /* Within one chunk that stays at least half full, or is all there is,
+     * the bytes are closed up in place. */
+    size_t offset = pos;
+    struct mc_rope_node *node = mc_rope_find(rope->root, &offset);
+    size_t const kept = node->chunk_len - len;
+    if (offset + len <= node->chunk_len && kept > 0 &&
+        (kept >= MC_ROPE_CHUNK_CAPACITY / 2 || node->chunk_len == total)) {
+        struct mc_rope_node *path = rope->root;
+        size_t rest = pos;
+        while (path != node) {
+            size_t const left_len = mc_rope_node_len(path->left);
+            path->len -= len;
+            if (rest < left_len) {
+                path = path->left;
+            } else {
+                rest -= left_len + path->chunk_len;
+                path = path->right;
+            }
+        }
+        memmove(node->chunk + offset, node->chunk + offset + len,
+                node->chunk_len - offset - len);
+        node->chunk_len = (uint32_t)kept;
+        node->len -= len;
+        return;
+    }
+
+    struct mc_rope_node *left;
+    struct mc_rope_node *middle;
+    struct mc_rope_node *right;
+    mc_rope_split(rope, rope->root, pos, &left, &right);
+    mc_rope_split(rope, right, len, &middle, &right);
+    mc_rope_free_tree(rope, middle);
+    rope->root = mc_rope_join(rope, left, right);
+}
+
+/* Appends the bytes in [pos, end) of the subtree in order. One walk costs
+ * less than descending from the root for every chunk. */
+static void mc_rope_collect(struct mc_rope_node const *node, size_t pos,
+                            size_t end, struct mc_string *out)
+{
+    while (node && pos < end) {
+        size_t const chunk_start = mc_rope_node_len(node->left);
+        size_t const chunk_end = chunk_start + node->chunk_len;
+        if (pos < chunk_start)
+            mc_rope_collect(node->left, pos,
+                            end < chunk_start ? end : chunk_start, out);
+        if (pos < chunk_end && end > chunk_start) {
+            size_t const from = pos > chunk_start ? pos : chunk_start;
+            size_t const to = end < chunk_end ? end : chunk_end;
+            mc_string_append_bytes(out, node->chunk + from - chunk_start,
+                                   to - from);
+        }
+        if (end <= chunk_end)
+            return;
+        pos = pos > chunk_end ? pos - chunk_end : 0;
+        end -= chunk_end;
+        node = node->right;
+    }
+}
+
+void mc_rope_substr(struct mc_rope const *rope, size_t pos, size_t len,
+                    struct mc_string *out)
+{
+    assert(rope);
+    assert(out);
+    size_t const total = mc_rope_len(rope);
+    mc_rope_bounds_check(__func__, pos, total, true);
+    if (len > total - pos)
+        len = total - pos;
+
+    mc_string_reserve(out, len);
+    mc_rope_collect(rope->root, pos, pos + len, out);
+}
+
+void mc_rope_flatten(struct mc_rope const *rope, struct mc_string *out)
+{
+    mc_rope_substr(rope, 0, mc_rope_len(rope), out);
+}
+
+void mc_rope_chunks_init(struct mc_rope_chunks *chunks,
+                         struct mc_rope const *rope, size_t pos, size_t len)
+{
+    assert(chunks);
+    assert(rope);
+    size_t const total = mc_rope_len(rope);
+    mc_rope_bounds_check(__func__, pos, total, true);
+    chunks->rope = rope;
+    chunks->pos = pos;
+    chunks->end = len < total - pos ? pos + len : total;
+}
+
+bool mc_rope_chunks_next(struct mc_rope_chunks *chunks,
+                         struct mc_str_view *chunk)
+{
+    assert(chunks);
+    assert(chunk);
+    if (chunks->pos >= chunks->end)
+        return false;
+
+    size_t offset = chunks->pos;
+    struct mc_rope_node const *node =
+        mc_rope_find(chunks->rope->root, &offset);
+    size_t len = node->chunk_len - offset;
+    if (len > chunks->end - chunks->pos)
+        len = chunks->end - chunks->pos;
+    *chunk = mc_str_view_make(node->chunk + offset, len);
+    chunks->pos += len;
+    return true;
+}
+
+void mc_rope_move(struct mc_rope *dst, struct mc_rope *src)
+{
+    assert(dst);
+    assert(src);
+    *dst = *src;
+    src->root = NULL;
+}
+
+static struct mc_rope_node *mc_rope_copy_tree(struct mc_rope *rope,
+                                              struct mc_rope_node const *node)
+{
+    if (!node)
+        return NULL;
+    struct mc_rope_node *copy =
+        mc_rope_node_new(rope, node->chunk, node->chunk_len);
+    copy->priority = node->priority;
+    copy->len = node->len;
+    copy->left = mc_rope_copy_tree(rope, node->left);
+    copy->right = mc_rope_copy_tree(rope, node->right);
+    return copy;
+}
+
+void mc_rope_copy(struct mc_rope *dst, struct mc_rope const *src)
+{
+    assert(dst);
+    assert(src);
+    mc_rope_init_with_allocator(dst, src->allocator);
+    dst->seed = src->seed;
+    dst->root = mc_rope_copy_tree(dst, src->root);
+}
+
+int mc_rope_compare(struct mc_rope const *rope1, struct mc_rope const *rope2)
+{
+    assert(rope1);
+    assert(rope2);
+    size_t const len1 = mc_rope_len(rope1);
+    size_t const len2 = mc_rope_len(rope2);
+    if (len1 != len2)
+        return len1 > len2 ? 1 : -1;
+
+    /* Chunk boundaries differ between the two, so compare the overlap of
+     * the current pieces and advance whichever runs out. */
+    struct mc_rope_chunks chunks1;
+    struct mc_rope_chunks chunks2;
+    struct mc_str_view piece1 = mc_str_view_make(NULL, 0);
+    struct mc_str_view piece2 = mc_str_view_make(NULL, 0);
+    mc_rope_chunks_init(&chunks1, rope1, 0, len1);
+    mc_rope_chunks_init(&chunks2, rope2, 0, len2);
+    for (;;) {
+        if (piece1.len == 0 && !mc_rope_chunks_next(&chunks1, &piece1))
+            return 0;
+        if (piece2.len == 0)
+            mc_rope_chunks_next(&chunks2, &piece2);
+        size_t const n = piece1.len < piece2.len ? piece1.len : piece2.len;
+        int const result = memcmp(piece1.data, piece2.data, n);
+        if (result != 0)
+            return result;
+        piece1 = mc_str_view_substr(piece1, n, piece1.len);
+        piece2 = mc_str_view_substr(piece2, n, piece2.len);
+    }
+}
+
+bool mc_rope_equal(struct mc_rope const *rope1, struct mc_rope const *rope2)
+{
+    assert(rope1);
+    assert(rope2);
+    return mc_rope_compare(rope1, rope2) == 0;
+}
+
+size_t mc_rope_hash(struct mc_rope const *rope)
+{
+    assert(rope);
+    struct mc_rope_chunks chunks;
+    struct mc_str_view chunk;
+    size_t hash = MC_HASH_INIT;
+    mc_rope_chunks_init(&chunks, rope, 0, mc_rope_len(rope));
+    while (mc_rope_chunks_next(&chunks, &chunk))
+        hash = MC_HASH_UPDATE(hash, chunk.data, chunk.len);
+    return hash;
+}
+
+MC_DEFINE_TYPE(mc_rope, struct mc_rope, (mc_cleanup_func)mc_rope_cleanup,
+               (mc_move_func)mc_rope_move, (mc_copy_func)mc_rope_copy,
+               (mc_compare_func)mc_rope_compare,
+               (mc_equal_func)mc_rope_equal, (mc_hash_func)mc_rope_hash)
@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/segmented_array.h"
+#include "myclib/aligned_malloc.h"
+#include "myclib/utils.h"
+
+void mc_segmented_array_init(struct mc_segmented_array *array,
+                             struct mc_type const *elem_type)
+{
+    assert(array);
+    assert(elem_type);
+    assert(elem_type->move);
+    assert(elem_type->size > 0);
+    assert(mc_is_pow_of_two(elem_type->alignment));
+    array->elem_type = elem_type;
+    array->len = 0;
+    array->segment_count = 0;
+}
+
+void mc_segmented_array_cleanup(struct mc_segmented_array *array)
+{
+    assert(array);
+    mc_segmented_array_clear(array);
+    for (size_t k = 0; k < array->segment_count; ++k)
+        mc_aligned_free(array->segments[k]);
+    array->segment_count = 0;
+    array->elem_type = NULL;
+}
+
+static inline size_t mc_segmented_array_segment_len(size_t segment)
+{
+    return MC_SEGMENTED_ARRAY_FIRST_SEGMENT << segment;
+}
+
+void *mc_segmented_array_get(struct mc_segmented_array const *array,
+                             size_t index)
+{
+    assert(array);
+    return index < array->len ? mc_segmented_array_get_unchecked(array, index)
+                              : NULL;
+}
+
+/* Segment k starts at index (2^k - 1) * FIRST_SEGMENT, so the segment is
+ * the highest set bit of index / FIRST_SEGMENT + 1. */
+void *mc_segmented_array_get_unchecked(struct mc_segmented_array const *array,
+                                       size_t index)
+{
+    assert(array);
+    size_t segment =
+        mc_log2_floor((index >> MC_SEGMENTED_ARRAY_FIRST_SEGMENT_SHIFT) + 1);
+    size_t offset = index - (mc_segmented_array_segment_len(segment) -
+                             MC_SEGMENTED_ARRAY_FIRST_SEGMENT);
+    return mc_ptr_add(array->segments[segment],
+                      offset * array->elem_type->size);
+}
+
+void *mc_segmented_array_get_first(struct mc_segmented_array const *array)
+{
+    assert(array);
+    return array->len > 0 ? array->segments[0] : NULL;
+}
+
+void *mc_segmented_array_get_last(struct mc_segmented_array const *array)
+{
+    assert(array);
+    return array->len > 0
+               ? mc_segmented_array_get_unchecked(array, array->len - 1)
+               : NULL;
+}
+
+static void mc_segmented_array_add_segment(struct mc_segmented_array *array)
+{
+    size_t segment = array->segment_count;
+    size_t elem_size = array->elem_type->size;
+
+    if (segment == MC_SEGMENTED_ARRAY_MAX_SEGMENTS ||
+        mc_segmented_array_segment_len(segment) > SIZE_MAX / elem_size) {
+        fprintf(stderr, "capacity overflow\n");
+        abort();
+    }
+
+    size_t total_size = mc_segmented_array_segment_len(segment) * elem_size;
+    void *data = mc_aligned_malloc(array->elem_type->alignment, total_size);
+    if (!data) {
+        fprintf(stderr, "memory allocation of %zu bytes failed\n", total_size);
+        abort();
+    }
+
+    array->segments[segment] = data;
+    ++array->segment_count;
+}
+
+void mc_segmented_array_reserve(struct mc_segmented_array *array,
+                                size_t additional)
+{
+    assert(array);
+
+    if (additional > SIZE_MAX - array->len) {
+        fprintf(stderr, "capacity overflow\n");
+        abort();
+    }
+
+    size_t request_size = array->len + additional;
+    while (mc_segmented_array_capacity(array) < request_size)
+        mc_segmented_array_add_segment(array);
+}
+
+void mc_segmented_array_shrink_to_fit(struct mc_segmented_array *array)
+{
+    assert(array);
+
+    size_t needed = 0;
+    if (array->len > 0) {
+        needed = mc_log2_floor(((array->len - 1) >>
+                                MC_SEGMENTED_ARRAY_FIRST_SEGMENT_SHIFT) +
+                               1) +
+                 1;
+    }
+
+    while (array->segment_count > needed) {
+        --array->segment_count;
+        mc_aligned_free(array->segments[array->segment_count]);
+    }
+}
+
+void *mc_segmented_array_emplace_back(struct mc_segmented_array *array)
+{
+    assert(array);
+
+    if (array->len == mc_segmented_array_capacity(array))
+        mc_segmented_array_add_segment(array);
+
+    return mc_segmented_array_get_unchecked(array, array->len++);
+}
+
+void mc_segmented_array_push(struct mc_segmented_array *array, void *elem)
+{
+    assert(array);
+    assert(elem);
+    array->elem_type->move(mc_segmented_array_emplace_back(array), elem);
+}
+
+bool mc_segmented_array_pop(struct mc_segmented_array *array, void *out_elem)
+{
+    assert(array);
+
+    if (array->len == 0)
+        return false;
+
+    void *elem = mc_segmented_array_get_unchecked(array, --array->len);
+    if (out_elem)
+        array->elem_type->move(out_elem, elem);
+    else if (array->elem_type->cleanup)
+        array->elem_type->cleanup(elem);
+
+    return true;
+}
+
+void mc_segmented_array_clear(struct mc_segmented_array *array)
+{
+    assert(array);
+
+    mc_cleanup_func cleanup = array->elem_type->cleanup;
+    if (cleanup) {
+        for (size_t i = 0, len = array->len; i < len; ++i)
+            cleanup(mc_segmented_array_get_unchecked(array, i));
+    }
+
+    array->len = 0;
+}
+
+void mc_segmented_array_for_each(struct mc_segmented_array const *array,
+                                 void (*func)(void *elem, void *user_data),
+                                 void *user_data)
+{
+    assert(array);
+    assert(func);
+
+    size_t elem_size = array->elem_type->size;
+    size_t remaining = array->len;
+
+    for (size_t k = 0; remaining > 0; ++k) {
+        size_t n = mc_segmented_array_segment_len(k);
+        if (n > remaining)
+            n = remaining;
+        char *elem = array->segments[k];
+        for (size_t i = 0; i < n; ++i, elem += elem_size)
+            func(elem, user_data);
+        remaining -= n;
+    }
+}
+
+void mc_segmented_array_move(struct mc_segmented_array *dst,
+                             struct mc_segmented_array *src)
+{
+    assert(dst);
+    assert(src);
+
+    dst->elem_type = src->elem_type;
+    dst->len = src->len;
+    dst->segment_count = src->segment_count;
+    memcpy(dst->segments, src->segments,
+           src->segment_count * sizeof(src->segments[0]));
+
+    src->len = 0;
+    src->segment_count = 0;
+}
+
+void mc_segmented_array_copy(struct mc_segmented_array *dst,
+                             struct mc_segmented_array const *src)
+{
+    assert(dst);
+    assert(src);
+
+    mc_copy_func copy = mc_type_get_copy_forced(__func__, src->elem_type);
+
+    mc_segmented_array_init(dst, src->elem_type);
+    mc_segmented_array_reserve(dst, src->len);
+
+    for (size_t i = 0, len = src->len; i < len; ++i)
+        copy(mc_segmented_array_get_unchecked(dst, i),
+             mc_segmented_array_get_unchecked(src, i));
+
+    dst->len = src->len;
+}
+
+int mc_segmented_array_compare(struct mc_segmented_array const *array1,
+                               struct mc_segmented_array const *array2)
+{
+    assert(array1);
+    assert(array2);
+
+    mc_compare_func cmp =
+        mc_type_get_compare_forced(__func__, array1->elem_type);
+
+    if (array1->len > array2->len)
+        return 1;
+    if (array1->len < array2->len)
+        return -1;
+
+    for (size_t i = 0, len = array1->len; i < len; ++i) {
+        int res = cmp(mc_segmented_array_get_unchecked(array1, i),
+                      mc_segmented_array_get_unchecked(array2, i));
+        if (res != 0)
+            return res;
+    }
+
+    return 0;
+}
+
+bool mc_segmented_array_equal(struct mc_segmented_array const *array1,
+                              struct mc_segmented_array const *array2)
+{
+    assert(array1);
+    assert(array2);
+
+    if (array1->len != array2->len)
+        return false;
+
+    mc_equal_func eq = mc_type_get_equal_forced(__func__, array1->elem_type);
+
+    for (size_t i = 0, len = array1->len; i < len; ++i) {
+        if (!eq(mc_segmented_array_get_unchecked(array1, i),
+                mc_segmented_array_get_unchecked(array2, i)))
+            return false;
+    }
+
+    return true;
+}
+
+size_t mc_segmented_array_hash(struct mc_segmented_array const *array)
+{
+    assert(array);
+
+    mc_hash_func hash = mc_type_get_hash_forced(__func__, array->elem_type);
+
+    size_t h = 0;
+    for (size_t i = 0, len = array->len; i < len; ++i)
+        h = h * 31 + hash(mc_segmented_array_get_unchecked(array, i));
+
+    return h;
+}
+
+void mc_segmented_array_iter_init(struct mc_iter *iter,
+                                  struct mc_segmented_array const *array)
+{
+    assert(iter);
+    assert(array);
+    iter->container = array;
+    iter->current = mc_segmented_array_get_first(array);
+    iter->value = NULL;
+    iter->key = NULL;
+    iter->cursor = 0;
+    iter->next = mc_segmented_array_iter_next;
+}
+
+bool mc_segmented_array_iter_next(struct mc_iter *iter)
+{
+    assert(iter);
+    void *curr = iter->current;
+    if (!curr)
+        return false;
+    iter->value = curr;
+    struct mc_segmented_array const *array = iter->container;
+    if (curr == mc_segmented_array_get_last(array)) {
+        iter->current = NULL;
+        return true;
+    }
+    size_t elem_size = array->elem_type->size;
+    size_t segment = iter->cursor;
+    curr = mc_ptr_add(curr, elem_size);
+    if (curr == mc_ptr_add(array->segments[segment],
+                           mc_segmented_array_segment_len(segment) *
+                               elem_size)) {
+        iter->cursor = ++segment;
+        curr = array->segments[segment];
+    }
+    iter->current = curr;
+    return true;
+}
+
+MC_DEFINE_TYPE(mc_segmented_array, struct mc_segmented_array,
+               (mc_cleanup_func)mc_segmented_array_cleanup,
+               (mc_move_func)mc_segmented_array_move,
+               (mc_copy_func)mc_segmented_array_copy,
+               (mc_compare_func)mc_segmented_array_compare,
+               (mc_equal_func)mc_segmented_array_equal,
+               (mc_hash_func)mc_segmented_array_hash)
@@ -0,0 +1,1207 @@
+#include <assert.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <string.h>
+#include "myclib/simd.h"
+
+#if defined(__x86_64__) || defined(_M_X64) ||                                  \
+    (defined(__i386__) && defined(__SSE2__))
+#define MC_SIMD_HAVE_SSE2 1
+#include <emmintrin.h>
+#else
+#define MC_SIMD_HAVE_SSE2 0
+#endif
+
+#if MC_SIMD_HAVE_SSE2 && (defined(__GNUC__) || defined(__clang__))
+#define MC_SIMD_HAVE_AVX2 1
+#include <immintrin.h>
+#define MC_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MC_SIMD_HAVE_AVX2 0
+#endif
+
+#if MC_SIMD_HAVE_SSE2
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+
+static inline unsigned mc_simd_ctz(unsigned mask)
+{
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+}
+
+static inline unsigned mc_simd_msb(unsigned mask)
+{
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return (unsigned)index;
+}
+#else
+static inline unsigned mc_simd_ctz(unsigned mask)
+{
+    return (unsigned)__builtin_ctz(mask);
+}
+
+static inline unsigned mc_simd_msb(unsigned mask)
+{
+    return 31u - (unsigned)__builtin_clz(mask);
+}
+#endif
+
+#endif
+
+#if MC_SIMD_HAVE_AVX2
+static bool mc_simd_cpu_has_avx2(void)
+{
+    static int has_avx2 = -1;
+
+    if (has_avx2 < 0) {
+        __builtin_cpu_init();
+        has_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return has_avx2 == 1;
+}
+#endif
+
+#define MC_SIMD_DEFINE_SCALAR_FIND(bits)                                       \
+    static size_t mc_simd_find_u##bits##_scalar(uint##bits##_t const *data,    \
+                                                size_t len,                    \
+                                                uint##bits##_t value)          \
+    {                                                                          \
+        for (size_t i = 0; i < len; ++i) {                                     \
+            if (data[i] == value)                                              \
+                return i;                                                      \
+        }                                                                      \
+        return len;                                                            \
+    }
+
+MC_SIMD_DEFINE_SCALAR_FIND(8)
+MC_SIMD_DEFINE_SCALAR_FIND(16)
+MC_SIMD_DEFINE_SCALAR_FIND(32)
+MC_SIMD_DEFINE_SCALAR_FIND(64)
+
+#if MC_SIMD_HAVE_SSE2
+
+/* SSE2 has no 64-bit equality, so both 32-bit halves must match. */
+static inline __m128i mc_simd_sse2_cmpeq_epi64(__m128i a, __m128i b)
+{
+    __m128i eq32 = _mm_cmpeq_epi32(a, b);
+    return _mm_and_si128(eq32,
+                         _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+/*
+ * Four vectors are compared per iteration and only the combined mask is
+ * tested, which keeps the loop branch well predicted on long misses.
+ */
+#define MC_SIMD_DEFINE_SSE2_FIND(bits, set1, cmpeq)                            \
+    static size_t mc_simd_find_u##bits##_sse2(uint##bits##_t const *data,      \
+                                              size_t len,                      \
+                                              uint##bits##_t value)            \
+    {                                                                          \
+        size_t const lanes = 16 / sizeof(uint##bits##_t);                      \
+        __m128i const needle = set1(value);                                    \
+        size_t i = 0;                                                          \
+                                                                               \
+        for (; i + 4 * lanes <= len; i += 4 * lanes) {                         \
+            __m128i const *p = (__m128i const *)(data + i);                    \
+            __m128i e0 = cmpeq(_mm_loadu_si128(p + 0), needle);                \
+            __m128i e1 = cmpeq(_mm_loadu_si128(p + 1), needle);                \
+            __m128i e2 = cmpeq(_mm_loadu_si128(p + 2), needle);                \
+            __m128i e3 = cmpeq(_mm_loadu_si128(p + 3), needle);                \
+            __m128i any =                                                      \
+                _mm_or_si128(_mm_or_si128(e0, e1), _mm_or_si128(e2, e3));      \
+            if (!_mm_movemask_epi8(any))                                       \
+                continue;                                                      \
+            unsigned mask = (unsigned)_mm_movemask_epi8(e0) |                  \
+                            (unsigned)_mm_movemask_epi8(e1) << 16;             \
+            if (mask)                                                          \
+                return i + mc_simd_ctz(mask) / sizeof(uint##bits##_t);         \
+            mask = (unsigned)_mm_movemask_epi8(e2) |                           \
+                   (unsigned)_mm_movemask_epi8(e3) << 16;                      \
+            return i + 2 * lanes + mc_simd_ctz(mask) / sizeof(uint##bits##_t); \
+        }                                                                      \
+                                                                               \
+        for (; i + lanes <= len; i += lanes) {                                 \
+            __m128i v = _mm_loadu_si128((__m128i const *)(data + i));          \
+            unsigned mask = (unsigned)_mm_movemask_epi8(cmpeq(v, needle));     \
+            if (mask)                                                          \
+                return i + mc_simd_ctz(mask) / sizeof(uint##bits##_t);         \
+        }                                                                      \
+                                                                               \
+        return i + mc_simd_find_u##bits##_scalar(data + i, len - i, value);    \
+    }
+
+#define MC_SIMD_SSE2_SET1_8(v) _mm_set1_epi8((char)(v))
+#define MC_SIMD_SSE2_SET1_16(v) _mm_set1_epi16((short)(v))
+#define MC_SIMD_SSE2_SET1_32(v) _mm_set1_epi32((int)(v))
+#define MC_SIMD_SSE2_SET1_64(v) _mm_set1_epi64x((long long)(v))
+
+MC_SIMD_DEFINE_SSE2_FIND(8, MC_SIMD_SSE2_SET1_8, _mm_cmpeq_epi8)
+MC_SIMD_DEFINE_SSE2_FIND(16, MC_SIMD_SSE2_SET1_16, _mm_cmpeq_epi16)
+MC_SIMD_DEFINE_SSE2_FIND(32, MC_SIMD_SSE2_SET1_32, _mm_cmpeq_epi32)
+MC_SIMD_DEFINE_SSE2_FIND(64, MC_SIMD_SSE2_SET1_64, mc_simd_sse2_cmpeq_epi64)
+
+#endif
+
+#if MC_SIMD_HAVE_AVX2
+
+#define MC_SIMD_DEFINE_AVX2_FIND(bits, set1, cmpeq)                            \
+    MC_SIMD_TARGET_AVX2 static size_t mc_simd_find_u##bits##_avx2(             \
+        uint##bits##_t const *data, size_t len, uint##bits##_t value)          \
+    {                                                                          \
+        size_t const lanes = 32 / sizeof(uint##bits##_t);                      \
+        __m256i const needle = set1(value);                                    \
+        size_t i = 0;                                                          \
+                                                                               \
+        for (; i + 4 * lanes <= len; i += 4 * lanes) {                         \
+            __m256i const *p = (__m256i const *)(data + i);                    \
+            __m256i e0 = cmpeq(_mm256_loadu_si256(p + 0), needle);             \
+            __m256i e1 = cmpeq(_mm256_loadu_si256(p + 1), needle);             \
+            __m256i e2 = cmpeq(_mm256_loadu_si256(p + 2), needle);             \
+            __m256i e3 = cmpeq(_mm256_loadu_si256(p + 3), needle);             \
+            __m256i any = _mm256_or_si256(_mm256_or_si256(e0, e1),             \
+                                          _mm256_or_si256(e2, e3));            \
+            if (_mm256_testz_si256(any, any))                                  \
+                continue;                                                      \
+            __m256i const e[4] = {e0, e1, e2, e3};                             \
+            for (size_t k = 0; k < 4; ++k) {                                   \
+                unsigned mask = (unsigned)_mm256_movemask_epi8(e[k]);          \
+                if (mask)                                                      \
+                    return i + k * lanes +                                     \
+                           mc_simd_ctz(mask) / sizeof(uint##bits##_t);         \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        for (; i + lanes <= len; i += lanes) {                                 \
+            __m256i v = _mm256_loadu_si256((__m256i const *)(data + i));       \
+            unsigned mask = (unsigned)_mm256_movemask_epi8(cmpeq(v, needle));  \
+            if (mask)                                                          \
+                return i + mc_simd_ctz(mask) / sizeof(uint##bits##_t);         \
+        }                                                                      \
+                                                                               \
+        /* Legacy SSE code after dirty upper halves stalls on every op. */     \
+        _mm256_zeroupper();                                                    \
+        return i + mc_simd_find_u##bits##_sse2(data + i, len - i, value);      \
+    }
+
+#define MC_SIMD_AVX2_SET1_8(v) _mm256_set1_epi8((char)(v))
+#define MC_SIMD_AVX2_SET1_16(v) _mm256_set1_epi16((short)(v))
+#define MC_SIMD_AVX2_SET1_32(v) _mm256_set1_epi32((int)(v))
+#define MC_SIMD_AVX2_SET1_64(v) _mm256_set1_epi64x((long long)(v))
+
+MC_SIMD_DEFINE_AVX2_FIND(8, MC_SIMD_AVX2_SET1_8, _mm256_cmpeq_epi8)
+MC_SIMD_DEFINE_AVX2_FIND(16, MC_SIMD_AVX2_SET1_16, _mm256_cmpeq_epi16)
+MC_SIMD_DEFINE_AVX2_FIND(32, MC_SIMD_AVX2_SET1_32, _mm256_cmpeq_epi32)
+MC_SIMD_DEFINE_AVX2_FIND(64, MC_SIMD_AVX2_SET1_64, _mm256_cmpeq_epi64)
+
+#endif
+
+#if MC_SIMD_HAVE_AVX2
+#define MC_SIMD_DEFINE_FIND(bits)                                              \
+    size_t mc_simd_find_u##bits(uint##bits##_t const *data, size_t len,        \
+                                uint##bits##_t value)                          \
+    {                                                                          \
+        assert(data || len == 0);                                              \
+        if (mc_simd_cpu_has_avx2())                                            \
+            return mc_simd_find_u##bits##_avx2(data, len, value);              \
+        return mc_simd_find_u##bits##_sse2(data, len, value);                  \
+    }
+#elif MC_SIMD_HAVE_SSE2
+#define MC_SIMD_DEFINE_FIND(bits)                                              \
+    size_t mc_simd_find_u##bits(uint##bits##_t const *data, size_t len,        \
+                                uint##bits##_t value)                          \
+    {                                                                          \
+        assert(data || len == 0);                                              \
+        return mc_simd_find_u##bits##_sse2(data, len, value);                  \
+    }
+#else
+#define MC_SIMD_DEFINE_FIND(bits)                                              \
+    size_t mc_simd_find_u##bits(uint##bits##_t const *data, size_t len,        \
+                                uint##bits##_t value)                          \
+    {                                                                          \
+        assert(data || len == 0);                                              \
+        return mc_simd_find_u##bits##_scalar(data, len, value);                \
+    }
+#endif
+
+MC_SIMD_DEFINE_FIND(8)
+MC_SIMD_DEFINE_FIND(16)
+MC_SIMD_DEFINE_FIND(32)
+MC_SIMD_DEFINE_FIND(64)
+
+size_t mc_simd_find(void const *data, size_t len, size_t elem_size,
+                    void const *value)
+{
+    assert(value);
+
+    switch (elem_size) {
+    case 1: {
+        uint8_t v;
+        memcpy(&v, value, sizeof(v));
+        return mc_simd_find_u8(data, len, v);
+    }
+    case 2: {
+        uint16_t v;
+        memcpy(&v, value, sizeof(v));
+        return mc_simd_find_u16(data, len, v);
+    }
+    case 4: {
+        uint32_t v;
+        memcpy(&v, value, sizeof(v));
+        return mc_simd_find_u32(data, len, v);
+    }
+    case 8: {
+        uint64_t v;
+        memcpy(&v, value, sizeof(v));
+        return mc_simd_find_u64(data, len, v);
+    }
+    default:
+        assert(!"unsupported element size");
+        return len;
+    }
+}
+
+static size_t mc_simd_rfind_u8_scalar(uint8_t const *data, size_t len,
+                                      uint8_t value)
+{
+    for (size_t i = len; i-- > 0;) {
+        if (data[i] == value)
+            return i;
+    }
+    return len;
+}
+
+#if MC_SIMD_HAVE_SSE2 || MC_SIMD_HAVE_AVX2
+
+/* Scans whole vectors from the end; the unaligned head is done last. */
+#define MC_SIMD_DEFINE_RFIND_U8(isa, target, vec, width, load, set1, cmpeq,    \
+                                movemask)                                      \
+    target static size_t mc_simd_rfind_u8_##isa(uint8_t const *data,           \
+                                                size_t len, uint8_t value)     \
+    {                                                                          \
+        vec const needle = set1((char)value);                                  \
+        size_t end = len;                                                      \
+                                                                               \
+        while (end >= width) {                                                 \
+            size_t const base = end - width;                                   \
+            vec const block = load((vec const *)(data + base));                \
+            unsigned const mask = (unsigned)movemask(cmpeq(block, needle));    \
+            if (mask)                                                          \
+                return base + mc_simd_msb(mask);                               \
+            end = base;                                                        \
+        }                                                                      \
+                                                                               \
+        size_t const index = mc_simd_rfind_u8_scalar(data, end, value);        \
+        return index == end ? len : index;                                     \
+    }
+
+#endif
+
+#if MC_SIMD_HAVE_SSE2
+MC_SIMD_DEFINE_RFIND_U8(sse2, , __m128i, 16, _mm_loadu_si128, _mm_set1_epi8,
+                        _mm_cmpeq_epi8, _mm_movemask_epi8)
+#endif
+
+#if MC_SIMD_HAVE_AVX2
+MC_SIMD_DEFINE_RFIND_U8(avx2, MC_SIMD_TARGET_AVX2, __m256i, 32,
+                        _mm256_loadu_si256, _mm256_set1_epi8,
+                        _mm256_cmpeq_epi8, _mm256_movemask_epi8)
+#endif
+
+size_t mc_simd_rfind_u8(uint8_t const *data, size_t len, uint8_t value)
+{
+    assert(data || len == 0);
+#if MC_SIMD_HAVE_AVX2
+    if (mc_simd_cpu_has_avx2())
+        return mc_simd_rfind_u8_avx2(data, len, value);
+#endif
+#if MC_SIMD_HAVE_SSE2
+    return mc_simd_rfind_u8_sse2(data, len, value);
+#else
+    return mc_simd_rfind_u8_scalar(data, len, value);
+#endif
+}
+
+/*
+ * Two-Way (Crochemore and Perrin) with a last-byte shift table as in
+ * glibc and musl. The needle is split at its critical factorization; the
+ * right part is matched first, then the left, and the period learned from
+ * the factorization bounds every shift so that no byte is compared twice
+ * after a partial match. at(p, i) reads the i-th byte of a sequence, which
+ * lets the same code run on the needle and haystack read backwards.
+ */
+#define MC_SIMD_AT_FORWARD(p, i) ((p)[i])
+#define MC_SIMD_AT_BACKWARD(p, i) ((p)[-(ptrdiff_t)(i)])
+
+#define MC_SIMD_WORD_BITS (8 * sizeof(size_t))
+
+#define MC_SIMD_DEFINE_TWO_WAY(name, at)                                       \
+    static size_t name(uint8_t const *data, size_t len, uint8_t const *needle, \
+                       size_t needle_len)                                      \
+    {                                                                          \
+        size_t byteset[256 / MC_SIMD_WORD_BITS] = {0};                         \
+        size_t shift[256];                                                     \
+        size_t const n = needle_len;                                           \
+                                                                               \
+        for (size_t i = 0; i < n; ++i) {                                       \
+            uint8_t const c = at(needle, i);                                   \
+            byteset[c / MC_SIMD_WORD_BITS] |= (size_t)1                        \
+                << (c % MC_SIMD_WORD_BITS);                                    \
+            shift[c] = i + 1;                                                  \
+        }                                                                      \
+                                                                               \
+        /* Maximal suffix for < and for >; keep the later one. */              \
+        size_t suffix[2];                                                      \
+        size_t period[2];                                                      \
+        for (int order = 0; order < 2; ++order) {                              \
+            size_t ip = SIZE_MAX;                                              \
+            size_t jp = 0;                                                     \
+            size_t k = 1;                                                      \
+            size_t p = 1;                                                      \
+            while (jp + k < n) {                                               \
+                uint8_t const a = at(needle, ip + k);                          \
+                uint8_t const b = at(needle, jp + k);                          \
+                if (a == b) {                                                  \
+                    if (k == p) {                                              \
+                        jp += p;                                               \
+                        k = 1;                                                 \
+                    } else {                                                   \
+                        ++k;                                                   \
+                    }                                                          \
+                } else if (order == 0 ? a > b : a < b) {                       \
+                    jp += k;                                                   \
+                    k = 1;                                                     \
+                    p = jp - ip;                                               \
+                } else {                                                       \
+                    ip = jp++;                                                 \
+                    k = p = 1;                                                 \
+                }                                                              \
+            }                                                                  \
+            suffix[order] = ip;                                                \
+            period[order] = p;                                                 \
+        }                                                                      \
+        int const pick = suffix[1] + 1 > suffix[0] + 1;                        \
+        size_t const ms = suffix[pick];                                        \
+        size_t p = period[pick];                                               \
+                                                                               \
+        /* A periodic needle remembers how much of it already matched. */      \
+        size_t mem0 = n - p;                                                   \
+        for (size_t i = 0; i < ms + 1; ++i) {                                  \
+            if (at(needle, i) != at(needle, i + p)) {                          \
+                mem0 = 0;                                                      \
+                p = (ms > n - ms - 1 ? ms : n - ms - 1) + 1;                   \
+                break;                                                         \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        size_t pos = 0;                                                        \
+        size_t mem = 0;                                                        \
+        while (len - pos >= n) {                                               \
+            uint8_t const c = at(data, pos + n - 1);                           \
+            size_t const word = byteset[c / MC_SIMD_WORD_BITS];                \
+            if (!(word >> (c % MC_SIMD_WORD_BITS) & 1)) {                      \
+                pos += n;                                                      \
+                mem = 0;                                                       \
+                continue;                                                      \
+            }                                                                  \
+            size_t k = n - shift[c];                                           \
+            if (k) {                                                           \
+                pos += k < mem ? mem : k;                                      \
+                mem = 0;                                                       \
+                continue;                                                      \
+            }                                                                  \
+                                                                               \
+            k = ms + 1 > mem ? ms + 1 : mem;                                   \
+            while (k < n && at(needle, k) == at(data, pos + k))                \
+                ++k;                                                           \
+            if (k < n) {                                                       \
+                pos += k - ms;                                                 \
+                mem = 0;                                                       \
+                continue;                                                      \
+            }                                                                  \
+                                                                               \
+            k = ms + 1;                                                        \
+            while (k > mem && at(needle, k - 1) == at(data, pos + k - 1))      \
+                --k;                                                           \
+            if (k <= mem)                                                      \
+                return pos;                                                    \
+            pos += p;                                                          \
+            mem = mem0;                                                        \
+        }                                                                      \
+                                                                               \
+        return len;                                                            \
+    }
+
+MC_SIMD_DEFINE_TWO_WAY(mc_simd_two_way_forward, MC_SIMD_AT_FORWARD)
+MC_SIMD_DEFINE_TWO_WAY(mc_simd_two_way_backward, MC_SIMD_AT_BACKWARD)
+
+/* Index of the last occurrence, or len; the Two-Way scan runs backwards. */
+static size_t mc_simd_two_way_reverse(uint8_t const *data, size_t len,
+                                      uint8_t const *needle,
+                                      size_t needle_len)
+{
+    size_t const pos = mc_simd_two_way_backward(
+        data + len - 1, len, needle + needle_len - 1, needle_len);
+    return pos == len ? len : len - pos - needle_len;
+}
+
+/* Number of leading bytes a and b have in common, at most len. */
+static inline size_t mc_simd_common_prefix(uint8_t const *a, uint8_t const *b,
+                                           size_t len)
+{
+    size_t i = 0;
+    while (i < len && a[i] == b[i])
+        ++i;
+    return i;
+}
+
+/*
+ * The filters below verify candidate positions byte by byte and count the
+ * work. Once it exceeds the bytes scanned by more than this, the input is
+ * adversarial (say, a periodic needle in a periodic haystack) and the rest
+ * is handed to Two-Way so that every search stays linear.
+ */
+#define MC_SIMD_VERIFY_SLACK 1024
+
+/* The callers below guarantee 2 <= needle_len <= len. */
+static size_t mc_simd_find_bytes_scalar(uint8_t const *data, size_t len,
+                                        uint8_t const *needle,
+                                        size_t needle_len)
+{
+    size_t const last = len - needle_len;
+    size_t work = 0;
+    size_t i = 0;
+
+    while (i <= last) {
+        uint8_t const *p = memchr(data + i, needle[0], last - i + 1);
+        if (!p)
+            return len;
+        i = (size_t)(p - data);
+        size_t const same =
+            mc_simd_common_prefix(p + 1, needle + 1, needle_len - 1);
+        if (same == needle_len - 1)
+            return i;
+        ++i;
+        work += same + 1;
+        if (work > i + MC_SIMD_VERIFY_SLACK)
+            return i + mc_simd_two_way_forward(data + i, len - i, needle,
+                                               needle_len);
+    }
+
+    return len;
+}
+
+static size_t mc_simd_rfind_bytes_scalar(uint8_t const *data, size_t len,
+                                         uint8_t const *needle,
+                                         size_t needle_len)
+{
+    size_t const positions = len - needle_len + 1;
+    size_t work = 0;
+
+    for (size_t i = positions; i-- > 0;) {
+        if (data[i] != needle[0])
+            continue;
+        size_t const same = mc_simd_common_prefix(data + i + 1, needle + 1,
+                                                  needle_len - 1);
+        if (same == needle_len - 1)
+            return i;
+        work += same + 1;
+        if (work > positions - i + MC_SIMD_VERIFY_SLACK) {
+            size_t const rest = i + needle_len - 1;
+            size_t const index =
+                mc_simd_two_way_reverse(data, rest, needle, needle_len);
+            return index == rest ? len : index;
+        }
+    }
+
+    return len;
+}
+
+#if MC_SIMD_HAVE_SSE2 || MC_SIMD_HAVE_AVX2
+
+/*
+ * One vector holds the bytes at width candidate positions, a second one the
+ * bytes needle_len - 1 further on. Only positions where both the first and
+ * the last byte of the needle match are compared in full.
+ */
+#define MC_SIMD_DEFINE_FIND_BYTES(isa, target, vec, width, load, set1, cmpeq,  \
+                                  and_, movemask)                              \
+    target static size_t mc_simd_find_bytes_##isa(                             \
+        uint8_t const *data, size_t len, uint8_t const *needle,                \
+        size_t needle_len)                                                     \
+    {                                                                          \
+        vec const first = set1((char)needle[0]);                               \
+        vec const last = set1((char)needle[needle_len - 1]);                   \
+        size_t const positions = len - needle_len + 1;                         \
+        size_t work = 0;                                                       \
+        size_t i = 0;                                                          \
+                                                                               \
+        for (; i + width <= positions; i += width) {                           \
+            vec const head = load((vec const *)(data + i));                    \
+            vec const tail = load((vec const *)(data + i + needle_len - 1));   \
+            unsigned mask = (unsigned)movemask(                                \
+                and_(cmpeq(head, first), cmpeq(tail, last)));                  \
+            if (!mask)                                                         \
+                continue;                                                      \
+            do {                                                               \
+                size_t const k = i + mc_simd_ctz(mask);                        \
+                size_t const same = mc_simd_common_prefix(                     \
+                    data + k + 1, needle + 1, needle_len - 2);                 \
+                if (same == needle_len - 2)                                    \
+                    return k;                                                  \
+                work += same + 1;                                              \
+                mask &= mask - 1;                                              \
+            } while (mask);                                                    \
+            if (work > i + MC_SIMD_VERIFY_SLACK) {                             \
+                i += width;                                                    \
+                return i + mc_simd_two_way_forward(data + i, len - i, needle,  \
+                                                   needle_len);                \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        if (len - i < needle_len)                                              \
+            return len;                                                        \
+        return i + mc_simd_find_bytes_scalar(data + i, len - i, needle,        \
+                                             needle_len);                      \
+    }                                                                          \
+                                                                               \
+    target static size_t mc_simd_rfind_bytes_##isa(                            \
+        uint8_t const *data, size_t len, uint8_t const *needle,                \
+        size_t needle_len)                                                     \
+    {                                                                          \
+        vec const first = set1((char)needle[0]);                               \
+        vec const last = set1((char)needle[needle_len - 1]);                   \
+        size_t const positions = len - needle_len + 1;                         \
+        size_t work = 0;                                                       \
+        size_t end = positions;                                                \
+                                                                               \
+        while (end >= width) {                                                 \
+            size_t const base = end - width;                                   \
+            vec const head = load((vec const *)(data + base));                 \
+            vec const tail =                                                   \
+                load((vec const *)(data + base + needle_len - 1));             \
+            unsigned mask = (unsigned)movemask(                                \
+                and_(cmpeq(head, first), cmpeq(tail, last)));                  \
+            end = base;                                                        \
+            if (!mask)                                                         \
+                continue;                                                      \
+            do {                                                               \
+                unsigned const bit = mc_simd_msb(mask);                        \
+                size_t const k = base + bit;                                   \
+                size_t const same = mc_simd_common_prefix(                     \
+                    data + k + 1, needle + 1, needle_len - 2);                 \
+                if (same == needle_len - 2)                                    \
+                    return k;                                                  \
+                work += same + 1;                                              \
+                mask &= ~(1u << bit);                                          \
+            } while (mask);                                                    \
+            if (work > positions - end + MC_SIMD_VERIFY_SLACK) {               \
+                size_t const rest = end + needle_len - 1;                      \
+                size_t const index =                                           \
+                    mc_simd_two_way_reverse(data, rest, needle, needle_len);   \
+                return index == rest ? len : index;                            \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        size_t const rest = end + needle_len - 1;                              \
+        size_t const index =                                                   \
+            mc_simd_rfind_bytes_scalar(data, rest, needle, needle_len);        \
+        return index == rest ? len : index;                                    \
+    }
+
+#endif
+
+#if MC_SIMD_HAVE_SSE2
+MC_SIMD_DEFINE_FIND_BYTES(sse2, , __m128i, 16, _mm_loadu_si128,
+                          _mm_set1_epi8, _mm_cmpeq_epi8, _mm_and_si128,
+                          _mm_movemask_epi8)
+#endif
+
+#if MC_SIMD_HAVE_AVX2
+MC_SIMD_DEFINE_FIND_BYTES(avx2, MC_SIMD_TARGET_AVX2, __m256i, 32,
+                          _mm256_loadu_si256, _mm256_set1_epi8,
+                          _mm256_cmpeq_epi8, _mm256_and_si256,
+                          _mm256_movemask_epi8)
+#endif
+
+size_t mc_simd_find_bytes(void const *data, size_t len, void const *needle,
+                          size_t needle_len)
+{
+    assert(data || len == 0);
+    assert(needle);
+    assert(needle_len > 0);
+
+    uint8_t const *const bytes = data;
+    uint8_t const *const pattern = needle;
+    if (needle_len > len)
+        return len;
+    if (needle_len == 1)
+        return mc_simd_find_u8(bytes, len, pattern[0]);
+
+#if MC_SIMD_HAVE_AVX2
+    if (mc_simd_cpu_has_avx2())
+        return mc_simd_find_bytes_avx2(bytes, len, pattern, needle_len);
+#endif
+#if MC_SIMD_HAVE_SSE2
+    return mc_simd_find_bytes_sse2(bytes, len, pattern, needle_len);
+#else
+    return mc_simd_find_bytes_scalar(bytes, len, pattern, needle_len);
+#endif
+}
+
+size_t mc_simd_rfind_bytes(void const *data, size_t len, void const *needle,
+                           size_t needle_len)
+{
+    assert(data || len == 0);
+    assert(needle);
+    assert(needle_len > 0);
+
+    uint8_t const *const bytes = data;
+    uint8_t const *const pattern = needle;
+    if (needle_len > len)
+        return len;
+    if (needle_len == 1)
+        return mc_simd_rfind_u8(bytes, len, pattern[0]);
+
+#if MC_SIMD_HAVE_AVX2
+    if (mc_simd_cpu_has_avx2())
+        return mc_simd_rfind_bytes_avx2(bytes, len, pattern, needle_len);
+#endif
+#if MC_SIMD_HAVE_SSE2
+    return mc_simd_rfind_bytes_sse2(bytes, len, pattern, needle_len);
+#else
+    return mc_simd_rfind_bytes_scalar(bytes, len, pattern, needle_len);
+#endif
+}
+
+/*
+ * ASCII text kernels. Every byte below 0x80 is handled without ctype, the
+ * same way in any locale; the rest go through toupper, tolower or isspace
+ * one at a time, so a single-byte locale still decides them.
+ */
+
+static inline uint8_t mc_simd_fold(uint8_t c, uint8_t first, int (*map)(int))
+{
+    if (c >= 0x80)
+        return (uint8_t)map(c);
+    return (uint8_t)(c - first) < 26 ? (uint8_t)(c ^ 0x20) : c;
+}
+
+static void mc_simd_map_case_scalar(uint8_t *dst, uint8_t const *src,
+                                    size_t len, uint8_t first,
+                                    int (*map)(int))
+{
+    for (size_t i = 0; i < len; ++i)
+        dst[i] = mc_simd_fold(src[i], first, map);
+}
+
+static inline bool mc_simd_is_ascii_space(uint8_t c)
+{
+    return c == ' ' || (uint8_t)(c - '\t') < 5;
+}
+
+static size_t mc_simd_skip_ascii_space_scalar(uint8_t const *data, size_t len)
+{
+    size_t i = 0;
+    while (i < len && mc_simd_is_ascii_space(data[i]))
+        ++i;
+    return i;
+}
+
+static size_t mc_simd_rskip_ascii_space_scalar(uint8_t const *data, size_t len)
+{
+    while (len > 0 && mc_simd_is_ascii_space(data[len - 1]))
+        --len;
+    return len;
+}
+
+static size_t mc_simd_mismatch_ignore_case_scalar(uint8_t const *a,
+                                                  uint8_t const *b, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        if (a[i] != b[i] && mc_simd_fold(a[i], 'A', tolower) !=
+                                mc_simd_fold(b[i], 'A', tolower))
+            return i;
+    }
+    return len;
+}
+
+#if MC_SIMD_HAVE_SSE2 || MC_SIMD_HAVE_AVX2
+
+/*
+ * Bytes are compared as signed, so anything from 0x80 up is below every
+ * ASCII bound and never taken for a letter or a space. A vector holding
+ * such a byte is mapped one byte at a time instead.
+ */
+#define MC_SIMD_DEFINE_TEXT(isa, target, vec, width, load, store, set1,       \
+                            cmpeq, cmpgt, and_, or_, xor_, movemask)           \
+    target static void mc_simd_map_case_##isa(uint8_t *dst,                    \
+                                              uint8_t const *src, size_t len,  \
+                                              uint8_t first, int (*map)(int))  \
+    {                                                                          \
+        vec const below = set1((char)(first - 1));                             \
+        vec const above = set1((char)(first + 26));                            \
+        vec const bit = set1(0x20);                                            \
+        size_t i = 0;                                                          \
+                                                                               \
+        for (; i + width <= len; i += width) {                                 \
+            vec const v = load((vec const *)(src + i));                        \
+            if (movemask(v)) {                                                 \
+                mc_simd_map_case_scalar(dst + i, src + i, width, first, map);  \
+                continue;                                                      \
+            }                                                                  \
+            vec const letter = and_(cmpgt(v, below), cmpgt(above, v));        \
+            store((vec *)(dst + i), xor_(v, and_(letter, bit)));               \
+        }                                                                      \
+        mc_simd_map_case_scalar(dst + i, src + i, len - i, first, map);        \
+    }                                                                          \
+                                                                               \
+    target static inline unsigned mc_simd_space_mask_##isa(vec v)              \
+    {                                                                          \
+        vec const space = or_(cmpeq(v, set1(' ')),                             \
+                              and_(cmpgt(v, set1('\t' - 1)),                   \
+                                   cmpgt(set1('\r' + 1), v)));                 \
+        return (unsigned)movemask(space);                                      \
+    }                                                                          \
+                                                                               \
+    target static size_t mc_simd_skip_ascii_space_##isa(uint8_t const *data,   \
+                                                        size_t len)            \
+    {                                                                          \
+        unsigned const all = (unsigned)(((uint64_t)1 << width) - 1);           \
+        size_t i = 0;                                                          \
+                                                                               \
+        for (; i + width <= len; i += width) {                                 \
+            vec const v = load((vec const *)(data + i));                       \
+            unsigned const other = mc_simd_space_mask_##isa(v) ^ all;          \
+            if (other)                                                         \
+                return i + mc_simd_ctz(other);                                 \
+        }                                                                      \
+        return i + mc_simd_skip_ascii_space_scalar(data + i, len - i);         \
+    }                                                                          \
+                                                                               \
+    target static size_t mc_simd_rskip_ascii_space_##isa(uint8_t const *data,  \
+                                                         size_t len)           \
+    {                                                                          \
+        unsigned const all = (unsigned)(((uint64_t)1 << width) - 1);           \
+                                                                               \
+        while (len >= width) {                                                 \
+            vec const v = load((vec const *)(data + len - width));             \
+            unsigned const other = mc_simd_space_mask_##isa(v) ^ all;          \
+            if (other)                                                         \
+                return len - width + mc_simd_msb(other) + 1;                   \
+            len -= width;                                                      \
+        }                                                                      \
+        return mc_simd_rskip_ascii_space_scalar(data, len);                    \
+    }                                                                          \
+                                                                               \
+    target static size_t mc_simd_mismatch_ignore_case_##isa(                   \
+        uint8_t const *a, uint8_t const *b, size_t len)                        \
+    {                                                                          \
+        unsigned const all = (unsigned)(((uint64_t)1 << width) - 1);           \
+        vec const below = set1('A' - 1);                                       \
+        vec const above = set1('Z' + 1);                                       \
+        vec const bit = set1(0x20);                                            \
+        size_t i = 0;                                                          \
+                                                                               \
+        for (; i + width <= len; i += width) {                                 \
+            vec const va = load((vec const *)(a + i));                         \
+            vec const vb = load((vec const *)(b + i));                         \
+            vec const la =                                                     \
+                or_(va, and_(and_(cmpgt(va, below), cmpgt(above, va)), bit));  \
+            vec const lb =                                                     \
+                or_(vb, and_(and_(cmpgt(vb, below), cmpgt(above, vb)), bit));  \
+            if ((unsigned)movemask(cmpeq(la, lb)) == all)                      \
+                continue;                                                      \
+            /* Either a real mismatch or a non-ASCII pair tolower joins */     \
+            size_t const k =                                                   \
+                mc_simd_mismatch_ignore_case_scalar(a + i, b + i, width);      \
+            if (k < width)                                                     \
+                return i + k;                                                  \
+        }                                                                      \
+        return i + mc_simd_mismatch_ignore_case_scalar(a + i, b + i, len - i); \
+    }
+
+#endif
+
+#if MC_SIMD_HAVE_SSE2
+MC_SIMD_DEFINE_TEXT(sse2, , __m128i, 16, _mm_loadu_si128, _mm_storeu_si128,
+                    _mm_set1_epi8, _mm_cmpeq_epi8, _mm_cmpgt_epi8,
+                    _mm_and_si128, _mm_or_si128, _mm_xor_si128,
+                    _mm_movemask_epi8)
+#endif
+
+#if MC_SIMD_HAVE_AVX2
+MC_SIMD_DEFINE_TEXT(avx2, MC_SIMD_TARGET_AVX2, __m256i, 32,
+                    _mm256_loadu_si256, _mm256_storeu_si256,
+                    _mm256_set1_epi8, _mm256_cmpeq_epi8, _mm256_cmpgt_epi8,
+                    _mm256_and_si256, _mm256_or_si256, _mm256_xor_si256,
+                    _mm256_movemask_epi8)
+#endif
+
+#if MC_SIMD_HAVE_AVX2
+#define MC_SIMD_DISPATCH_TEXT(name, ...)                                       \
+    (mc_simd_cpu_has_avx2() ? name##_avx2(__VA_ARGS__)                         \
+                            : name##_sse2(__VA_ARGS__))
+#elif MC_SIMD_HAVE_SSE2
+#define MC_SIMD_DISPATCH_TEXT(name, ...) name##_sse2(__VA_ARGS__)
+#else
+#define MC_SIMD_DISPATCH_TEXT(name, ...) name##_scalar(__VA_ARGS__)
+#endif
+
+void mc_simd_to_upper(void *dst, void const *src, size_t len)
+{
+    assert((dst && src) || len == 0);
+    MC_SIMD_DISPATCH_TEXT(mc_simd_map_case, dst, src, len, 'a', toupper);
+}
+
+void mc_simd_to_lower(void *dst, void const *src, size_t len)
+{
+    assert((dst && src) || len == 0);
+    MC_SIMD_DISPATCH_TEXT(mc_simd_map_case, dst, src, len, 'A', tolower);
+}
+
+size_t mc_simd_skip_space(void const *data, size_t len)
+{
+    assert(data || len == 0);
+    uint8_t const *const bytes = data;
+    size_t i = 0;
+    for (;;) {
+        i += MC_SIMD_DISPATCH_TEXT(mc_simd_skip_ascii_space, bytes + i,
+                                   len - i);
+        if (i == len || bytes[i] < 0x80 || !isspace(bytes[i]))
+            return i;
+        ++i;
+    }
+}
+
+size_t mc_simd_rskip_space(void const *data, size_t len)
+{
+    assert(data || len == 0);
+    uint8_t const *const bytes = data;
+    for (;;) {
+        len = MC_SIMD_DISPATCH_TEXT(mc_simd_rskip_ascii_space, bytes, len);
+        if (len == 0 || bytes[len - 1] < 0x80 || !isspace(bytes[len - 1]))
+            return len;
+        --len;
+    }
+}
+
+int mc_simd_compare_ignore_case(void const *a, size_t a_len, void const *b,
+                                size_t b_len)
+{
+    assert(a || a_len == 0);
+    assert(b || b_len == 0);
+    uint8_t const *const x = a;
+    uint8_t const *const y = b;
+    size_t const len = a_len < b_len ? a_len : b_len;
+    size_t const i =
+        MC_SIMD_DISPATCH_TEXT(mc_simd_mismatch_ignore_case, x, y, len);
+    if (i < len)
+        return (int)mc_simd_fold(x[i], 'A', tolower) -
+               (int)mc_simd_fold(y[i], 'A', tolower);
+    return (a_len > b_len) - (a_len < b_len);
+}
+
+/*
+ * UTF-8 as in RFC 3629. Returns the length of the well-formed sequence at
+ * the start of data, or 0 when it is ill-formed or cut short. The second
+ * byte range rules out overlong forms, surrogates and code points past
+ * U+10FFFF.
+ */
+static size_t mc_simd_utf8_sequence(uint8_t const *data, size_t len)
+{
+    uint8_t const lead = data[0];
+    size_t size;
+    uint8_t low = 0x80, high = 0xbf;
+
+    if (lead < 0x80)
+        return 1;
+    if (lead < 0xc2)
+        return 0;
+    if (lead < 0xe0) {
+        size = 2;
+    } else if (lead < 0xf0) {
+        size = 3;
+        low = lead == 0xe0 ? 0xa0 : 0x80;
+        high = lead == 0xed ? 0x9f : 0xbf;
+    } else if (lead < 0xf5) {
+        size = 4;
+        low = lead == 0xf0 ? 0x90 : 0x80;
+        high = lead == 0xf4 ? 0x8f : 0xbf;
+    } else {
+        return 0;
+    }
+
+    if (len < size || data[1] < low || data[1] > high)
+        return 0;
+    for (size_t i = 2; i < size; ++i) {
+        if ((data[i] & 0xc0) != 0x80)
+            return 0;
+    }
+    return size;
+}
+
+/* Eight ASCII bytes at a time, then one sequence at a time. */
+static size_t mc_simd_utf8_validate_scalar(uint8_t const *data, size_t len)
+{
+    size_t i = 0;
+    while (i < len) {
+        uint64_t word;
+        if (i + sizeof(word) <= len) {
+            memcpy(&word, data + i, sizeof(word));
+            if (!(word & 0x8080808080808080ULL)) {
+                i += sizeof(word);
+                continue;
+            }
+        }
+        size_t const size = mc_simd_utf8_sequence(data + i, len - i);
+        if (size == 0)
+            return i;
+        i += size;
+    }
+    return len;
+}
+
+static size_t mc_simd_utf8_count_scalar(uint8_t const *data, size_t len)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < len; ++i)
+        count += (data[i] & 0xc0) != 0x80;
+    return count;
+}
+
+#if MC_SIMD_HAVE_SSE2
+
+static size_t mc_simd_utf8_validate_sse2(uint8_t const *data, size_t len)
+{
+    size_t i = 0;
+    while (i < len) {
+        if (i + 16 <= len &&
+            !_mm_movemask_epi8(_mm_loadu_si128((__m128i const *)(data + i)))) {
+            i += 16;
+            continue;
+        }
+        size_t const size = mc_simd_utf8_sequence(data + i, len - i);
+        if (size == 0)
+            return i;
+        i += size;
+    }
+    return len;
+}
+
+#endif
+
+#if MC_SIMD_HAVE_SSE2 || MC_SIMD_HAVE_AVX2
+
+/*
+ * Bytes above 0xbf as signed are the ones that start a code point. The
+ * per-byte counters are -1 for each, so they are drained into 64-bit sums
+ * before 255 vectors can overflow them.
+ */
+#define MC_SIMD_DEFINE_UTF8_COUNT(isa, target, vec, width, load, store, set1,  \
+                                  setzero, cmpgt, sub, sad, add64)             \
+    target static size_t mc_simd_utf8_count_##isa(uint8_t const *data,         \
+                                                  size_t len)                  \
+    {                                                                          \
+        vec const continuation = set1((char)0xbf);                             \
+        vec sums = setzero();                                                  \
+        size_t i = 0;                                                          \
+                                                                               \
+        while (i + width <= len) {                                             \
+            vec counts = setzero();                                            \
+            for (size_t n = 0; n < 255 && i + width <= len; ++n, i += width) { \
+                vec const v = load((vec const *)(data + i));                   \
+                counts = sub(counts, cmpgt(v, continuation));                  \
+            }                                                                  \
+            sums = add64(sums, sad(counts, setzero()));                        \
+        }                                                                      \
+                                                                               \
+        uint64_t lanes[width / 8];                                             \
+        store((vec *)lanes, sums);                                             \
+        size_t count = 0;                                                      \
+        for (size_t k = 0; k < width / 8; ++k)                                 \
+            count += (size_t)lanes[k];                                         \
+        return count + mc_simd_utf8_count_scalar(data + i, len - i);           \
+    }
+
+#endif
+
+#if MC_SIMD_HAVE_SSE2
+MC_SIMD_DEFINE_UTF8_COUNT(sse2, , __m128i, 16, _mm_loadu_si128,
+                          _mm_storeu_si128, _mm_set1_epi8, _mm_setzero_si128,
+                          _mm_cmpgt_epi8, _mm_sub_epi8, _mm_sad_epu8,
+                          _mm_add_epi64)
+#endif
+
+#if MC_SIMD_HAVE_AVX2
+
+MC_SIMD_DEFINE_UTF8_COUNT(avx2, MC_SIMD_TARGET_AVX2, __m256i, 32,
+                          _mm256_loadu_si256, _mm256_storeu_si256,
+                          _mm256_set1_epi8, _mm256_setzero_si256,
+                          _mm256_cmpgt_epi8, _mm256_sub_epi8, _mm256_sad_epu8,
+                          _mm256_add_epi64)
+
+#define MC_SIMD_UTF8_TOO_SHORT (1 << 0)
+#define MC_SIMD_UTF8_TOO_LONG (1 << 1)
+#define MC_SIMD_UTF8_OVERLONG_3 (1 << 2)
+#define MC_SIMD_UTF8_TOO_LARGE (1 << 3)
+#define MC_SIMD_UTF8_SURROGATE (1 << 4)
+#define MC_SIMD_UTF8_OVERLONG_2 (1 << 5)
+#define MC_SIMD_UTF8_TOO_LARGE_1000 (1 << 6)
+#define MC_SIMD_UTF8_OVERLONG_4 (1 << 6)
+/* Bit 7, written so that the tables fit in char */
+#define MC_SIMD_UTF8_TWO_CONTS (-0x80)
+#define MC_SIMD_UTF8_CARRY                                                     \
+    (MC_SIMD_UTF8_TOO_SHORT | MC_SIMD_UTF8_TOO_LONG | MC_SIMD_UTF8_TWO_CONTS)
+
+/* The same 16-entry table in both lanes, for _mm256_shuffle_epi8. */
+#define MC_SIMD_TABLE16(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+MC_SIMD_TARGET_AVX2 static inline __m256i mc_simd_high_nibbles(__m256i v)
+{
+    return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0f));
+}
+
+/* The vector of bytes n places back, taking them from prev at the start. */
+#define MC_SIMD_PREV(input, prev, n)                                           \
+    _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21),    \
+                       16 - (n))
+
+/*
+ * Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per
+ * Byte" (2021). Each byte and the one before it index three 16-entry
+ * tables by their nibbles; a bit that survives the AND of the three names
+ * an error. A continuation byte two or three places after a 3- or 4-byte
+ * lead is expected, which the TWO_CONTS bit then has to agree with.
+ */
+MC_SIMD_TARGET_AVX2 static __m256i mc_simd_utf8_errors_avx2(__m256i input,
+                                                            __m256i prev)
+{
+    enum {
+        SHORT = MC_SIMD_UTF8_TOO_SHORT,
+        LONG = MC_SIMD_UTF8_TOO_LONG,
+        OVER2 = MC_SIMD_UTF8_OVERLONG_2,
+        OVER3 = MC_SIMD_UTF8_OVERLONG_3,
+        OVER4 = MC_SIMD_UTF8_OVERLONG_4,
+        LARGE = MC_SIMD_UTF8_TOO_LARGE,
+        L1000 = MC_SIMD_UTF8_TOO_LARGE_1000,
+        SURR = MC_SIMD_UTF8_SURROGATE,
+        CONTS = MC_SIMD_UTF8_TWO_CONTS,
+        CARRY = MC_SIMD_UTF8_CARRY,
+    };
+    __m256i const byte_1_high_table = MC_SIMD_TABLE16(
+        LONG, LONG, LONG, LONG, LONG, LONG, LONG, LONG, CONTS, CONTS, CONTS,
+        CONTS, SHORT | OVER2, SHORT, SHORT | OVER3 | SURR,
+        SHORT | LARGE | L1000 | OVER4);
+    __m256i const byte_1_low_table = MC_SIMD_TABLE16(
+        CARRY | OVER3 | OVER2 | OVER4, CARRY | OVER2, CARRY, CARRY,
+        CARRY | LARGE, CARRY | LARGE | L1000, CARRY | LARGE | L1000,
+        CARRY | LARGE | L1000, CARRY | LARGE | L1000, CARRY | LARGE | L1000,
+        CARRY | LARGE | L1000, CARRY | LARGE | L1000, CARRY | LARGE | L1000,
+        CARRY | LARGE | L1000 | SURR, CARRY | LARGE | L1000,
+        CARRY | LARGE | L1000);
+    __m256i const byte_2_high_table = MC_SIMD_TABLE16(
+        SHORT, SHORT, SHORT, SHORT, SHORT, SHORT, SHORT, SHORT,
+        LONG | OVER2 | CONTS | OVER3 | L1000 | OVER4,
+        LONG | OVER2 | CONTS | OVER3 | LARGE,
+        LONG | OVER2 | CONTS | SURR | LARGE,
+        LONG | OVER2 | CONTS | SURR | LARGE, SHORT, SHORT, SHORT, SHORT);
+
+    __m256i const prev1 = MC_SIMD_PREV(input, prev, 1);
+    __m256i const special = _mm256_and_si256(
+        _mm256_and_si256(
+            _mm256_shuffle_epi8(byte_1_high_table, mc_simd_high_nibbles(prev1)),
+            _mm256_shuffle_epi8(
+                byte_1_low_table,
+                _mm256_and_si256(prev1, _mm256_set1_epi8(0x0f)))),
+        _mm256_shuffle_epi8(byte_2_high_table, mc_simd_high_nibbles(input)));
+
+    /* Only 111_____ two back and 1111____ three back reach 0x80 */
+    __m256i const third = _mm256_subs_epu8(MC_SIMD_PREV(input, prev, 2),
+                                           _mm256_set1_epi8(0xe0 - 0x80));
+    __m256i const fourth =
+        _mm256_subs_epu8(MC_SIMD_PREV(input, prev, 3),
+                         _mm256_set1_epi8((char)(0xf0 - 0x80)));
+    __m256i const expected = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                              _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(expected, special);
+}
+
+/*
+ * All sequences before a vector boundary were checked except possibly the
+ * one that crosses it. Its lead is at most three bytes back; everything
+ * before that lead is valid.
+ */
+static size_t mc_simd_utf8_resume(uint8_t const *data, size_t boundary)
+{
+    for (size_t k = 1; k <= 3 && k <= boundary; ++k) {
+        uint8_t const byte = data[boundary - k];
+        if (byte >= 0xc0)
+            return boundary - k;
+        if (byte < 0x80)
+            break;
+    }
+    return boundary;
+}
+
+MC_SIMD_TARGET_AVX2 static size_t mc_simd_utf8_validate_avx2(
+    uint8_t const *data, size_t len)
+{
+    /* Leads in the last three bytes that need more than are left */
+    __m256i const last_lead = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xf0 - 1),
+        (char)(0xe0 - 1), (char)(0xc0 - 1));
+    __m256i prev = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 32 <= len; i += 32) {
+        __m256i const input = _mm256_loadu_si256((__m256i const *)(data + i));
+        __m256i errors = incomplete;
+        /* ASCII is only wrong right after an unfinished sequence */
+        if (_mm256_movemask_epi8(input)) {
+            errors = mc_simd_utf8_errors_avx2(input, prev);
+            incomplete = _mm256_subs_epu8(input, last_lead);
+        } else {
+            incomplete = _mm256_setzero_si256();
+        }
+        if (!_mm256_testz_si256(errors, errors)) {
+            size_t const start = mc_simd_utf8_resume(data, i);
+            _mm256_zeroupper();
+            return start +
+                   mc_simd_utf8_validate_scalar(data + start, len - start);
+        }
+        prev = input;
+    }
+
+    size_t const start = mc_simd_utf8_resume(data, i);
+    _mm256_zeroupper();
+    return start + mc_simd_utf8_validate_scalar(data + start, len - start);
+}
+
+#endif
+
+#if MC_SIMD_HAVE_AVX2
+#define MC_SIMD_DISPATCH_UTF8(name, ...)                                       \
+    MC_SIMD_DISPATCH_TEXT(name, __VA_ARGS__)
+#elif MC_SIMD_HAVE_SSE2
+#define MC_SIMD_DISPATCH_UTF8(name, ...) name##_sse2(__VA_ARGS__)
+#else
+#define MC_SIMD_DISPATCH_UTF8(name, ...) name##_scalar(__VA_ARGS__)
+#endif
+
+size_t mc_simd_utf8_validate(void const *data, size_t len)
+{
+    assert(data || len == 0);
+    return MC_SIMD_DISPATCH_UTF8(mc_simd_utf8_validate, data, len);
+}
+
+size_t mc_simd_utf8_count(void const *data, size_t len)
+{
+    assert(data || len == 0);
+    return MC_SIMD_DISPATCH_UTF8(mc_simd_utf8_count, data, len);
+}
@@ -0,0 +1,680 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/small_array.h"
+#include "myclib/array.h"
+#include "myclib/aligned_malloc.h"
+#include "myclib/utils.h"
+
+void mc_small_array_init(struct mc_small_array *array,
+                         struct mc_type const *elem_type)
+{
+    assert(array);
+    assert(elem_type);
+    assert(elem_type->move);
+    assert(elem_type->size > 0);
+    assert(mc_is_pow_of_two(elem_type->alignment));
+    array->elem_type = elem_type;
+    array->len = 0;
+    array->inline_capacity = elem_type->alignment <= alignof(max_align_t)
+                                 ? MC_SMALL_ARRAY_INLINE_SIZE / elem_type->size
+                                 : 0;
+    array->capacity = array->inline_capacity;
+    array->storage.heap = NULL;
+}
+
+void mc_small_array_with_capacity(struct mc_small_array *array,
+                                  struct mc_type const *elem_type,
+                                  size_t capacity)
+{
+    assert(array);
+    mc_small_array_init(array, elem_type);
+    mc_small_array_reserve_exact(array, capacity);
+}
+
+void mc_small_array_from(struct mc_small_array *array,
+                         struct mc_type const *elem_type, void *elems,
+                         size_t elems_len)
+{
+    assert(array);
+    assert(elems || elems_len == 0);
+    mc_small_array_init(array, elem_type);
+    mc_small_array_append_range(array, elems, elems_len);
+}
+
+static void mc_small_array_free_data(struct mc_small_array *array)
+{
+    if (!mc_small_array_is_inline(array)) {
+        mc_aligned_free(array->storage.heap);
+        array->storage.heap = NULL;
+        array->capacity = array->inline_capacity;
+    }
+}
+
+void mc_small_array_cleanup(struct mc_small_array *array)
+{
+    assert(array);
+    mc_small_array_truncate(array, 0);
+    mc_small_array_free_data(array);
+    array->elem_type = NULL;
+}
+
+void *mc_small_array_data(struct mc_small_array const *array)
+{
+    assert(array);
+    return mc_small_array_is_inline(array) ? (void *)array->storage.buf
+                                           : array->storage.heap;
+}
+
+void *mc_small_array_get(struct mc_small_array const *array, size_t index)
+{
+    assert(array);
+    return index < array->len ? mc_small_array_get_unchecked(array, index)
+                              : NULL;
+}
+
+void *mc_small_array_get_unchecked(struct mc_small_array const *array,
+                                   size_t index)
+{
+    assert(array);
+    return mc_ptr_add(mc_small_array_data(array),
+                      array->elem_type->size * index);
+}
+
+void *mc_small_array_get_first(struct mc_small_array const *array)
+{
+    assert(array);
+    return array->len > 0 ? mc_small_array_get_unchecked(array, 0) : NULL;
+}
+
+void *mc_small_array_get_last(struct mc_small_array const *array)
+{
+    assert(array);
+    return array->len > 0 ? mc_small_array_get_unchecked(array, array->len - 1)
+                          : NULL;
+}
+
+/*
+ * View used to share the code of mc_array. Only operations that never
+ * reallocate may go through it; those that remove elements leave their new
+ * length in the view for the caller to write back.
+ */
+static struct mc_array mc_small_array_view(struct mc_small_array const *array)
+{
+    struct mc_array view = {
+        .elem_type = array->elem_type,
+        .data = mc_small_array_data(array),
+        .len = array->len,
+        .capacity = array->capacity,
+        .allocator = &mc_default_allocator,
+    };
+    return view;
+}
+
+/*
+ * Moves the elements into a buffer of the given capacity, going back to the
+ * inline buffer whenever they fit there.
+ */
+static void mc_small_array_adjust_capacity(struct mc_small_array *array,
+                                           size_t capacity)
+{
+    size_t elem_size = array->elem_type->size;
+    void *old_data = mc_small_array_data(array);
+    bool was_inline = mc_small_array_is_inline(array);
+
+    if (capacity <= array->inline_capacity) {
+        if (was_inline)
+            return;
+        memcpy(array->storage.buf, old_data, array->len * elem_size);
+        mc_aligned_free(old_data);
+        array->capacity = array->inline_capacity;
+        return;
+    }
+
+    size_t total_size = capacity * elem_size;
+    void *new_data = mc_aligned_malloc(array->elem_type->alignment, total_size);
+    if (!new_data) {
+        fprintf(stderr, "memory allocation of %zu bytes failed\n", total_size);
+        abort();
+    }
+
+    memcpy(new_data, old_data, array->len * elem_size);
+
+    if (!was_inline)
+        mc_aligned_free(old_data);
+    array->storage.heap = new_data;
+    array->capacity = capacity;
+}
+
+void mc_small_array_reserve(struct mc_small_array *array, size_t additional)
+{
+    assert(array);
+
+    if (additional > SIZE_MAX / array->elem_type->size - array->len) {
+        fprintf(stderr, "capacity overflow\n");
+        abort();
+    }
+
+    if (array->len + additional <= array->capacity)
+        return;
+
+    mc_small_array_adjust_capacity(
+        array, mc_max2(array->len + additional, array->capacity * 2));
+}
+
+void mc_small_array_reserve_exact(struct mc_small_array *array,
+                                  size_t additional)
+{
+    assert(array);
+
+    if (additional > SIZE_MAX / array->elem_type->size - array->len) {
+        fprintf(stderr, "capacity overflow\n");
+        abort();
+    }
+
+    if (array->len + additional <= array->capacity)
+        return;
+
+    mc_small_array_adjust_capacity(array, array->len + additional);
+}
+
+void mc_small_array_shrink_to_fit(struct mc_small_array *array)
+{
+    assert(array);
+    if (array->capacity > array->len)
+        mc_small_array_adjust_capacity(array, array->len);
+}
+
+void mc_small_array_shrink_to(struct mc_small_array *array, size_t capacity)
+{
+    assert(array);
+
+    if (capacity < array->len)
+        return;
+
+    if (capacity >= array->capacity)
+        return;
+
+    mc_small_array_adjust_capacity(array, capacity);
+}
+
+void mc_small_array_push(struct mc_small_array *array, void *elem)
+{
+    assert(array);
+    assert(elem);
+
+    if (array->len == array->capacity)
+        mc_small_array_reserve(array, 1);
+
+    array->elem_type->move(mc_small_array_get_unchecked(array, array->len),
+                           elem);
+    ++array->len;
+}
+
+static void mc_small_array_extract_one(struct mc_small_array *array,
+                                       size_t index, void *out_elem)
+{
+    void *elem = mc_small_array_get_unchecked(array, index);
+
+    if (out_elem)
+        array->elem_type->move(out_elem, elem);
+    else if (array->elem_type->cleanup)
+        array->elem_type->cleanup(elem);
+}
+
+bool mc_small_array_pop(struct mc_small_array *array, void *out_elem)
+{
+    assert(array);
+
+    if (array->len == 0)
+        return false;
+
+    mc_small_array_extract_one(array, --array->len, out_elem);
+
+    return true;
+}
+
+static void mc_small_array_bounds_check(char const *func_name, size_t index,
+                                        size_t bounds, bool allow_equal)
+{
+    if (!allow_equal && index >= bounds) {
+        fprintf(stderr, "%s: index (is %zu) must < len (is %zu)\n", func_name,
+                index, bounds);
+        abort();
+    }
+    if (allow_equal && index > bounds) {
+        fprintf(stderr, "%s: index (is %zu) must <= len (is %zu)\n", func_name,
+                index, bounds);
+        abort();
+    }
+}
+
+static void mc_small_array_shift(struct mc_small_array *array, size_t dst,
+                                 size_t src, size_t n)
+{
+    if (n == 0)
+        return;
+
+    memmove(mc_small_array_get_unchecked(array, dst),
+            mc_small_array_get_unchecked(array, src),
+            n * array->elem_type->size);
+}
+
+void mc_small_array_insert(struct mc_small_array *array, size_t index,
+                           void *elem)
+{
+    assert(array);
+    assert(elem);
+
+    size_t len = array->len;
+
+    /* Allow insertion at the end. */
+    mc_small_array_bounds_check(__func__, index, len, true);
+
+    if (len == array->capacity)
+        mc_small_array_reserve(array, 1);
+
+    mc_small_array_shift(array, index + 1, index, len - index);
+
+    array->elem_type->move(mc_small_array_get_unchecked(array, index), elem);
+
+    ++array->len;
+}
+
+void mc_small_array_remove(struct mc_small_array *array, size_t index,
+                           void *out_elem)
+{
+    assert(array);
+
+    size_t len = array->len;
+
+    mc_small_array_bounds_check(__func__, index, len, false);
+
+    mc_small_array_extract_one(array, index, out_elem);
+
+    mc_small_array_shift(array, index, index + 1, len - index - 1);
+
+    --array->len;
+}
+
+void mc_small_array_swap_remove(struct mc_small_array *array, size_t index,
+                                void *out_elem)
+{
+    assert(array);
+
+    mc_small_array_bounds_check(__func__, index, array->len, false);
+
+    struct mc_array view = mc_small_array_view(array);
+    mc_array_swap_remove(&view, index, out_elem);
+    array->len = view.len;
+}
+
+static void mc_small_array_place_range(struct mc_small_array *array,
+                                       size_t index, void *elems,
+                                       size_t elems_len)
+{
+    mc_move_func move = array->elem_type->move;
+    size_t elem_size = array->elem_type->size;
+    char *dst = mc_small_array_get_unchecked(array, index);
+    char *src = elems;
+
+    for (size_t i = 0; i < elems_len; ++i) {
+        move(dst, src);
+        dst += elem_size;
+        src += elem_size;
+    }
+}
+
+void mc_small_array_append_range(struct mc_small_array *array, void *elems,
+                                 size_t elems_len)
+{
+    assert(array);
+    assert(elems_len == 0 || elems);
+
+    if (elems_len == 0)
+        return;
+
+    mc_small_array_reserve(array, elems_len);
+
+    mc_small_array_place_range(array, array->len, elems, elems_len);
+
+    array->len += elems_len;
+}
+
+void mc_small_array_insert_range(struct mc_small_array *array, size_t index,
+                                 void *elems, size_t elems_len)
+{
+    assert(array);
+    assert(elems_len == 0 || elems);
+
+    if (elems_len == 0)
+        return;
+
+    size_t len = array->len;
+
+    /* Allow insertion at the end. */
+    mc_small_array_bounds_check(__func__, index, len, true);
+
+    mc_small_array_reserve(array, elems_len);
+
+    mc_small_array_shift(array, index + elems_len, index, len - index);
+
+    mc_small_array_place_range(array, index, elems, elems_len);
+
+    array->len += elems_len;
+}
+
+void mc_small_array_remove_range(struct mc_small_array *array, size_t index,
+                                 size_t len, void *out_elems,
+                                 size_t out_elems_len)
+{
+    assert(array);
+
+    if (len == 0)
+        return;
+
+    mc_small_array_bounds_check(__func__, index, array->len, false);
+
+    struct mc_array view = mc_small_array_view(array);
+    mc_array_remove_range(&view, index, len, out_elems, out_elems_len);
+    array->len = view.len;
+}
+
+void *mc_small_array_emplace_back(struct mc_small_array *array)
+{
+    assert(array);
+
+    if (array->len == array->capacity)
+        mc_small_array_reserve(array, 1);
+
+    return mc_small_array_get_unchecked(array, array->len++);
+}
+
+void *mc_small_array_emplace_at(struct mc_small_array *array, size_t index)
+{
+    assert(array);
+
+    size_t len = array->len;
+
+    /* Allow insertion at the end. */
+    mc_small_array_bounds_check(__func__, index, len, true);
+
+    if (len == array->capacity)
+        mc_small_array_reserve(array, 1);
+
+    mc_small_array_shift(array, index + 1, index, len - index);
+
+    ++array->len;
+
+    return mc_small_array_get_unchecked(array, index);
+}
+
+void *mc_small_array_extend_uninit(struct mc_small_array *array, size_t n)
+{
+    assert(array);
+
+    if (n > array->capacity - array->len)
+        mc_small_array_reserve(array, n);
+
+    void *slots = mc_small_array_get_unchecked(array, array->len);
+    array->len += n;
+
+    return slots;
+}
+
+void mc_small_array_retain(struct mc_small_array *array,
+                           bool (*pred)(void const *, void const *user_data),
+                           void const *user_data)
+{
+    assert(array);
+    assert(pred);
+
+    struct mc_array view = mc_small_array_view(array);
+    mc_array_retain(&view, pred, user_data);
+    array->len = view.len;
+}
+
+void mc_small_array_dedup(struct mc_small_array *array)
+{
+    assert(array);
+
+    struct mc_array view = mc_small_array_view(array);
+    mc_array_dedup(&view);
+    array->len = view.len;
+}
+
+void mc_small_array_clear(struct mc_small_array *array)
+{
+    assert(array);
+    mc_small_array_truncate(array, 0);
+}
+
+void mc_small_array_truncate(struct mc_small_array *array, size_t len)
+{
+    assert(array);
+
+    if (len >= array->len)
+        return;
+
+    mc_cleanup_func cleanup = array->elem_type->cleanup;
+    if (cleanup) {
+        size_t elem_size = array->elem_type->size;
+        char *curr = mc_small_array_get_unchecked(array, len);
+        for (size_t i = len; i < array->len; ++i) {
+            cleanup(curr);
+            curr += elem_size;
+        }
+    }
+
+    array->len = len;
+}
+
+void mc_small_array_resize(struct mc_small_array *array, size_t len,
+                           void *elem)
+{
+    assert(array);
+
+    mc_copy_func copy = mc_type_get_copy_forced(__func__, array->elem_type);
+
+    if (len <= array->len) {
+        mc_small_array_truncate(array, len);
+        if (elem && array->elem_type->cleanup)
+            array->elem_type->cleanup(elem);
+        return;
+    }
+
+    assert(elem);
+
+    mc_small_array_reserve(array, len - array->len);
+
+    for (size_t i = array->len; i < len - 1; ++i)
+        copy(mc_small_array_get_unchecked(array, i), elem);
+
+    array->elem_type->move(mc_small_array_get_unchecked(array, len - 1), elem);
+
+    array->len = len;
+}
+
+bool mc_small_array_contains(struct mc_small_array const *array,
+                             void const *elem)
+{
+    assert(array);
+    assert(elem);
+    struct mc_array view = mc_small_array_view(array);
+    return mc_array_contains(&view, elem);
+}
+
+void *mc_small_array_find(struct mc_small_array const *array,
+                          void const *elem)
+{
+    assert(array);
+    assert(elem);
+    struct mc_array view = mc_small_array_view(array);
+    return mc_array_find(&view, elem);
+}
+
+void *mc_small_array_find_if(struct mc_small_array const *array,
+                             bool (*pred)(void const *, void const *user_data),
+                             void const *user_data)
+{
+    assert(array);
+    assert(pred);
+    struct mc_array view = mc_small_array_view(array);
+    return mc_array_find_if(&view, pred, user_data);
+}
+
+bool mc_small_array_binary_search(struct mc_small_array const *array,
+                                  void const *elem, size_t *out_index)
+{
+    assert(array);
+    assert(elem);
+    struct mc_array view = mc_small_array_view(array);
+    return mc_array_binary_search(&view, elem, out_index);
+}
+
+bool mc_small_array_binary_search_branchless(
+    struct mc_small_array const *array, void const *elem, size_t *out_index)
+{
+    assert(array);
+    assert(elem);
+    struct mc_array view = mc_small_array_view(array);
+    return mc_array_binary_search_branchless(&view, elem, out_index);
+}
+
+void mc_small_array_sort(struct mc_small_array const *array)
+{
+    assert(array);
+    struct mc_array view = mc_small_array_view(array);
+    mc_array_sort(&view);
+}
+
+void mc_small_array_sort_with(struct mc_small_array const *array,
+                              mc_compare_func cmp)
+{
+    assert(array);
+    assert(cmp);
+    struct mc_array view = mc_small_array_view(array);
+    mc_array_sort_with(&view, cmp);
+}
+
+void mc_small_array_stable_sort(struct mc_small_array const *array)
+{
+    assert(array);
+    struct mc_array view = mc_small_array_view(array);
+    mc_array_stable_sort(&view);
+}
+
+void mc_small_array_stable_sort_with(struct mc_small_array const *array,
+                                     mc_compare_func cmp)
+{
+    assert(array);
+    assert(cmp);
+    struct mc_array view = mc_small_array_view(array);
+    mc_array_stable_sort_with(&view, cmp);
+}
+
+void mc_small_array_for_each(struct mc_small_array const *array,
+                             void (*func)(void *elem, void *user_data),
+                             void *user_data)
+{
+    assert(array);
+    assert(func);
+    struct mc_array view = mc_small_array_view(array);
+    mc_array_for_each(&view, func, user_data);
+}
+
+void mc_small_array_move(struct mc_small_array *dst,
+                         struct mc_small_array *src)
+{
+    assert(dst);
+    assert(src);
+
+    /* Inline elements are relocated bytewise, just like a reallocation. */
+    *dst = *src;
+
+    src->len = 0;
+    src->capacity = src->inline_capacity;
+    src->storage.heap = NULL;
+}
+
+void mc_small_array_copy(struct mc_small_array *dst,
+                         struct mc_small_array const *src)
+{
+    assert(dst);
+    assert(src);
+
+    mc_copy_func copy = mc_type_get_copy_forced(__func__, src->elem_type);
+
+    mc_small_array_init(dst, src->elem_type);
+    mc_small_array_reserve(dst, src->len);
+
+    for (size_t i = 0, len = src->len; i < len; ++i)
+        copy(mc_small_array_get_unchecked(dst, i),
+             mc_small_array_get_unchecked(src, i));
+
+    dst->len = src->len;
+}
+
+int mc_small_array_compare(struct mc_small_array const *array1,
+                           struct mc_small_array const *array2)
+{
+    assert(array1);
+    assert(array2);
+    struct mc_array view1 = mc_small_array_view(array1);
+    struct mc_array view2 = mc_small_array_view(array2);
+    return mc_array_compare(&view1, &view2);
+}
+
+bool mc_small_array_equal(struct mc_small_array const *array1,
+                          struct mc_small_array const *array2)
+{
+    assert(array1);
+    assert(array2);
+    struct mc_array view1 = mc_small_array_view(array1);
+    struct mc_array view2 = mc_small_array_view(array2);
+    return mc_array_equal(&view1, &view2);
+}
+
+size_t mc_small_array_hash(struct mc_small_array const *array)
+{
+    assert(array);
+    struct mc_array view = mc_small_array_view(array);
+    return mc_array_hash(&view);
+}
+
+void mc_small_array_iter_init(struct mc_iter *iter,
+                              struct mc_small_array const *array)
+{
+    assert(iter);
+    assert(array);
+    iter->container = array;
+    iter->current = array->len == 0 ? NULL : mc_small_array_data(array);
+    iter->value = NULL;
+    iter->key = NULL;
+    iter->next = mc_small_array_iter_next;
+}
+
+bool mc_small_array_iter_next(struct mc_iter *iter)
+{
+    assert(iter);
+    void *curr = iter->current;
+    if (!curr)
+        return false;
+    iter->value = curr;
+    struct mc_small_array const *array = iter->container;
+    void const *const end = mc_small_array_get_unchecked(array, array->len);
+    curr = mc_ptr_add(curr, array->elem_type->size);
+    if (curr >= end)
+        iter->current = NULL;
+    else
+        iter->current = curr;
+    return true;
+}
+
+MC_DEFINE_TYPE(mc_small_array, struct mc_small_array,
+               (mc_cleanup_func)mc_small_array_cleanup,
+               (mc_move_func)mc_small_array_move,
+               (mc_copy_func)mc_small_array_copy,
+               (mc_compare_func)mc_small_array_compare,
+               (mc_equal_func)mc_small_array_equal,
+               (mc_hash_func)mc_small_array_hash)
@@ -0,0 +1,289 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/soa_array.h"
+#include "myclib/aligned_malloc.h"
+#include "myclib/utils.h"
+
+static void *mc_soa_array_alloc(size_t alignment, size_t size)
+{
+    void *ptr = mc_aligned_malloc(alignment, size);
+    if (!ptr) {
+        fprintf(stderr, "memory allocation of %zu bytes failed\n", size);
+        abort();
+    }
+    return ptr;
+}
+
+void mc_soa_array_init(struct mc_soa_array *soa,
+                       struct mc_type const *const *field_types,
+                       size_t field_count)
+{
+    assert(soa);
+    assert(field_types);
+    assert(field_count > 0);
+
+    soa->field_types =
+        mc_soa_array_alloc(alignof(struct mc_type const *),
+                           field_count * sizeof(*soa->field_types));
+    soa->columns = mc_soa_array_alloc(alignof(void *),
+                                      field_count * sizeof(*soa->columns));
+
+    for (size_t i = 0; i < field_count; ++i) {
+        struct mc_type const *type = field_types[i];
+        assert(type);
+        assert(type->move);
+        assert(type->size > 0);
+        assert(mc_is_pow_of_two(type->alignment));
+        soa->field_types[i] = type;
+        soa->columns[i] = NULL;
+    }
+
+    soa->field_count = field_count;
+    soa->len = 0;
+    soa->capacity = 0;
+}
+
+void mc_soa_array_with_capacity(struct mc_soa_array *soa,
+                                struct mc_type const *const *field_types,
+                                size_t field_count, size_t capacity)
+{
+    assert(soa);
+    mc_soa_array_init(soa, field_types, field_count);
+    mc_soa_array_reserve(soa, capacity);
+}
+
+static void mc_soa_array_free_columns(struct mc_soa_array *soa)
+{
+    for (size_t i = 0; i < soa->field_count; ++i) {
+        mc_aligned_free(soa->columns[i]);
+        soa->columns[i] = NULL;
+    }
+    soa->capacity = 0;
+}
+
+void mc_soa_array_cleanup(struct mc_soa_array *soa)
+{
+    assert(soa);
+
+    if (!soa->field_types)
+        return;
+
+    mc_soa_array_clear(soa);
+    mc_soa_array_free_columns(soa);
+    mc_aligned_free(soa->columns);
+    mc_aligned_free(soa->field_types);
+    soa->columns = NULL;
+    soa->field_types = NULL;
+    soa->field_count = 0;
+}
+
+void *mc_soa_array_get(struct mc_soa_array const *soa, size_t row,
+                       size_t field)
+{
+    assert(soa);
+    assert(field < soa->field_count);
+    return row < soa->len ? mc_soa_array_get_unchecked(soa, row, field) : NULL;
+}
+
+void *mc_soa_array_get_unchecked(struct mc_soa_array const *soa, size_t row,
+                                 size_t field)
+{
+    assert(soa);
+    return mc_ptr_add(soa->columns[field], soa->field_types[field]->size * row);
+}
+
+bool mc_soa_array_get_row(struct mc_soa_array const *soa, size_t row,
+                          void **out_fields)
+{
+    assert(soa);
+    assert(out_fields);
+
+    if (row >= soa->len)
+        return false;
+
+    for (size_t i = 0; i < soa->field_count; ++i)
+        out_fields[i] = mc_soa_array_get_unchecked(soa, row, i);
+
+    return true;
+}
+
+void *mc_soa_array_column(struct mc_soa_array const *soa, size_t field)
+{
+    assert(soa);
+    assert(field < soa->field_count);
+    return soa->columns[field];
+}
+
+static void mc_soa_array_adjust_capacity(struct mc_soa_array *soa,
+                                         size_t capacity)
+{
+    if (capacity == 0) {
+        mc_soa_array_free_columns(soa);
+        return;
+    }
+
+    for (size_t i = 0; i < soa->field_count; ++i) {
+        size_t elem_size = soa->field_types[i]->size;
+        size_t alignment = mc_max2(soa->field_types[i]->alignment,
+                                   (size_t)MC_SOA_ARRAY_COLUMN_ALIGNMENT);
+        void *column = mc_soa_array_alloc(alignment, capacity * elem_size);
+
+        if (soa->len > 0)
+            memcpy(column, soa->columns[i], soa->len * elem_size);
+
+        mc_aligned_free(soa->columns[i]);
+        soa->columns[i] = column;
+    }
+
+    soa->capacity = capacity;
+}
+
+void mc_soa_array_reserve(struct mc_soa_array *soa, size_t additional)
+{
+    assert(soa);
+
+    size_t max_size = 0;
+    for (size_t i = 0; i < soa->field_count; ++i)
+        max_size = mc_max2(max_size, soa->field_types[i]->size);
+
+    if (additional > SIZE_MAX / max_size - soa->len) {
+        fprintf(stderr, "capacity overflow\n");
+        abort();
+    }
+
+    size_t request_size = soa->len + additional;
+    if (request_size <= soa->capacity)
+        return;
+
+    mc_soa_array_adjust_capacity(soa,
+                                 mc_max2(request_size, soa->capacity * 2));
+}
+
+void mc_soa_array_shrink_to_fit(struct mc_soa_array *soa)
+{
+    assert(soa);
+
+    if (soa->len < soa->capacity)
+        mc_soa_array_adjust_capacity(soa, soa->len);
+}
+
+void mc_soa_array_push(struct mc_soa_array *soa, void *const *fields)
+{
+    assert(soa);
+    assert(fields);
+
+    if (soa->len == soa->capacity)
+        mc_soa_array_reserve(soa, 1);
+
+    for (size_t i = 0; i < soa->field_count; ++i) {
+        assert(fields[i]);
+        soa->field_types[i]->move(
+            mc_soa_array_get_unchecked(soa, soa->len, i), fields[i]);
+    }
+
+    ++soa->len;
+}
+
+bool mc_soa_array_pop(struct mc_soa_array *soa, void *const *out_fields)
+{
+    assert(soa);
+
+    if (soa->len == 0)
+        return false;
+
+    --soa->len;
+
+    for (size_t i = 0; i < soa->field_count; ++i) {
+        struct mc_type const *type = soa->field_types[i];
+        void *elem = mc_soa_array_get_unchecked(soa, soa->len, i);
+
+        if (out_fields && out_fields[i])
+            type->move(out_fields[i], elem);
+        else if (type->cleanup)
+            type->cleanup(elem);
+    }
+
+    return true;
+}
+
+void mc_soa_array_clear(struct mc_soa_array *soa)
+{
+    assert(soa);
+
+    for (size_t i = 0; i < soa->field_count; ++i) {
+        mc_cleanup_func cleanup = soa->field_types[i]->cleanup;
+        if (!cleanup)
+            continue;
+        for (size_t row = 0; row < soa->len; ++row)
+            cleanup(mc_soa_array_get_unchecked(soa, row, i));
+    }
+
+    soa->len = 0;
+}
+
+void mc_soa_array_move(struct mc_soa_array *dst, struct mc_soa_array *src)
+{
+    assert(dst);
+    assert(src);
+
+    *dst = *src;
+
+    src->field_types = NULL;
+    src->columns = NULL;
+    src->field_count = 0;
+    src->len = 0;
+    src->capacity = 0;
+}
+
+void mc_soa_array_copy(struct mc_soa_array *dst,
+                       struct mc_soa_array const *src)
+{
+    assert(dst);
+    assert(src);
+
+    mc_soa_array_init(dst, src->field_types, src->field_count);
+    mc_soa_array_reserve(dst, src->len);
+
+    for (size_t i = 0; i < src->field_count; ++i) {
+        mc_copy_func copy =
+            mc_type_get_copy_forced(__func__, src->field_types[i]);
+        for (size_t row = 0; row < src->len; ++row)
+            copy(mc_soa_array_get_unchecked(dst, row, i),
+                 mc_soa_array_get_unchecked(src, row, i));
+    }
+
+    dst->len = src->len;
+}
+
+void mc_soa_array_iter_init(struct mc_iter *iter,
+                            struct mc_soa_array const *soa, void **row_fields)
+{
+    assert(iter);
+    assert(soa);
+    assert(row_fields);
+    iter->container = soa;
+    iter->current = soa->len > 0 ? soa->columns[0] : NULL;
+    iter->value = row_fields;
+    iter->key = NULL;
+    iter->next = mc_soa_array_iter_next;
+}
+
+bool mc_soa_array_iter_next(struct mc_iter *iter)
+{
+    assert(iter);
+    void *curr = iter->current;
+    if (!curr)
+        return false;
+    struct mc_soa_array const *soa = iter->container;
+    size_t size = soa->field_types[0]->size;
+    size_t row = (size_t)((char *)curr - (char *)soa->columns[0]) / size;
+    mc_soa_array_get_row(soa, row, iter->value);
+    iter->current = row + 1 < soa->len ? mc_ptr_add(curr, size) : NULL;
+    return true;
+}
+
+MC_DEFINE_TYPE(mc_soa_array, struct mc_soa_array,
+               (mc_cleanup_func)mc_soa_array_cleanup,
+               (mc_move_func)mc_soa_array_move,
+               (mc_copy_func)mc_soa_array_copy, NULL, NULL, NULL)
@@ -0,0 +1,309 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "myclib/str_view.h"
+#include "myclib/hash.h"
+#include "myclib/simd.h"
+
+static void mc_str_view_bounds_check(char const *func_name, size_t index,
+                                     size_t len)
+{
+    if (index > len) {
+        fprintf(stderr, "%s: index (is %zu) must <= len (is %zu)\n", func_name,
+                index, len);
+        abort();
+    }
+}
+
+struct mc_str_view mc_str_view_substr(struct mc_str_view view, size_t pos,
+                                      size_t len)
+{
+    mc_str_view_bounds_check(__func__, pos, view.len);
+    size_t const rest = view.len - pos;
+    return mc_str_view_make(view.data + pos, len < rest ? len : rest);
+}
+
+void mc_str_view_split_at(struct mc_str_view view, size_t index,
+                          struct mc_str_view *left, struct mc_str_view *right)
+{
+    assert(left);
+    assert(right);
+
+    mc_str_view_bounds_check(__func__, index, view.len);
+    *left = mc_str_view_make(view.data, index);
+    *right = mc_str_view_make(view.data + index, view.len - index);
+}
+
+bool mc_str_view_find(struct mc_str_view view, struct mc_str_view needle,
+                      size_t *index)
+{
+    if (needle.len == 0) {
+        if (index)
+            *index = 0;
+        return true;
+    }
+
+    size_t const position =
+        mc_simd_find_bytes(view.data, view.len, needle.data, needle.len);
+    if (position == view.len)
+        return false;
+
+    if (index)
+        *index = position;
+    return true;
+}
+
+bool mc_str_view_rfind(struct mc_str_view view, struct mc_str_view needle,
+                       size_t *index)
+{
+    if (needle.len == 0) {
+        if (index)
+            *index = view.len;
+        return true;
+    }
+
+    size_t const position =
+        mc_simd_rfind_bytes(view.data, view.len, needle.data, needle.len);
+    if (position == view.len)
+        return false;
+
+    if (index)
+        *index = position;
+    return true;
+}
+
+bool mc_str_view_find_ch(struct mc_str_view view, char ch, size_t *index)
+{
+    size_t const position =
+        mc_simd_find_u8((uint8_t const *)view.data, view.len, (uint8_t)ch);
+    if (position == view.len)
+        return false;
+
+    if (index)
+        *index = position;
+    return true;
+}
+
+bool mc_str_view_rfind_ch(struct mc_str_view view, char ch, size_t *index)
+{
+    size_t const position =
+        mc_simd_rfind_u8((uint8_t const *)view.data, view.len, (uint8_t)ch);
+    if (position == view.len)
+        return false;
+
+    if (index)
+        *index = position;
+    return true;
+}
+
+bool mc_str_view_contains(struct mc_str_view view, struct mc_str_view needle)
+{
+    return mc_str_view_find(view, needle, NULL);
+}
+
+bool mc_str_view_starts_with(struct mc_str_view view,
+                             struct mc_str_view prefix)
+{
+    return prefix.len <= view.len &&
+           (prefix.len == 0 || memcmp(view.data, prefix.data, prefix.len) == 0);
+}
+
+bool mc_str_view_ends_with(struct mc_str_view view, struct mc_str_view suffix)
+{
+    return suffix.len <= view.len &&
+           (suffix.len == 0 || memcmp(view.data + view.len - suffix.len,
+                                      suffix.data, suffix.len) == 0);
+}
+
+struct mc_str_view mc_str_view_trim(struct mc_str_view view)
+{
+    return mc_str_view_trim_right(mc_str_view_trim_left(view));
+}
+
+struct mc_str_view mc_str_view_trim_left(struct mc_str_view view)
+{
+    size_t const i = mc_simd_skip_space(view.data, view.len);
+    return mc_str_view_make(view.data + i, view.len - i);
+}
+
+struct mc_str_view mc_str_view_trim_right(struct mc_str_view view)
+{
+    return mc_str_view_make(view.data,
+                            mc_simd_rskip_space(view.data, view.len));
+}
+
+int mc_str_view_compare(struct mc_str_view view1, struct mc_str_view view2)
+{
+    if (view1.len > view2.len)
+        return 1;
+    if (view1.len < view2.len)
+        return -1;
+    if (view1.len == 0)
+        return 0;
+    return memcmp(view1.data, view2.data, view1.len);
+}
+
+bool mc_str_view_equal(struct mc_str_view view1, struct mc_str_view view2)
+{
+    return mc_str_view_compare(view1, view2) == 0;
+}
+
+size_t mc_str_view_hash(struct mc_str_view view)
+{
+    return MC_HASH(view.data, view.len);
+}
+
+bool mc_str_view_utf8_validate(struct mc_str_view view, size_t *error)
+{
+    size_t const offset = mc_simd_utf8_validate(view.data, view.len);
+    if (offset == view.len)
+        return true;
+    if (error)
+        *error = offset;
+    return false;
+}
+
+size_t mc_str_view_utf8_len(struct mc_str_view view)
+{
+    return mc_simd_utf8_count(view.data, view.len);
+}
+
+static inline bool mc_str_split_is_delim(struct mc_str_split const *split,
+                                         char ch)
+{
+    unsigned char const byte = (unsigned char)ch;
+    return (split->delims[byte >> 3] >> (byte & 7)) & 1;
+}
+
+void mc_str_split_init(struct mc_str_split *split, struct mc_str_view view,
+                       char const *delims)
+{
+    assert(split);
+    assert(delims);
+
+    split->rest = view;
+    memset(split->delims, 0, sizeof(split->delims));
+    for (char const *p = delims; *p; ++p) {
+        unsigned char const byte = (unsigned char)*p;
+        split->delims[byte >> 3] |= (unsigned char)(1u << (byte & 7));
+    }
+    split->single_delim = delims[0];
+    split->is_single = delims[0] != '\0' && delims[1] == '\0';
+}
+
+bool mc_str_split_next(struct mc_str_split *split, struct mc_str_view *token)
+{
+    assert(split);
+    assert(token);
+
+    if (split->rest.len == 0)
+        return false;
+
+    char const *p = split->rest.data;
+    char const *const end = p + split->rest.len;
+    while (p < end && mc_str_split_is_delim(split, *p))
+        ++p;
+
+    if (p == end) {
+        split->rest = mc_str_view_make(end, 0);
+        return false;
+    }
+
+    char const *const start = p;
+    if (split->is_single) {
+        p = memchr(p, split->single_delim, (size_t)(end - p));
+        if (!p)
+            p = end;
+    } else {
+        while (p < end && !mc_str_split_is_delim(split, *p))
+            ++p;
+    }
+
+    *token = mc_str_view_make(start, (size_t)(p - start));
+    split->rest = mc_str_view_make(p, (size_t)(end - p));
+    return true;
+}
+
+void mc_str_code_points_init(struct mc_str_code_points *code_points,
+                             struct mc_str_view view)
+{
+    assert(code_points);
+    code_points->rest = view;
+}
+
+bool mc_str_code_points_decode(struct mc_str_code_points *code_points,
+                               uint32_t *code_point)
+{
+    assert(code_points);
+    assert(code_point);
+
+    unsigned char const *const p =
+        (unsigned char const *)code_points->rest.data;
+    size_t const len = code_points->rest.len;
+    if (len == 0)
+        return false;
+
+    unsigned char const lead = p[0];
+    if (lead < 0x80) {
+        *code_point = lead;
+        code_points->rest = mc_str_view_make(code_points->rest.data + 1,
+                                             len - 1);
+        return true;
+    }
+
+    /* Second-byte bounds exclude overlongs, surrogates and > U+10FFFF */
+    unsigned char low = 0x80, high = 0xbf;
+    size_t size = 1;
+    uint32_t value = lead;
+    if (lead >= 0xc2 && lead < 0xe0) {
+        size = 2;
+        value = lead & 0x1f;
+    } else if (lead >= 0xe0 && lead < 0xf0) {
+        size = 3;
+        value = lead & 0x0f;
+        low = lead == 0xe0 ? 0xa0 : 0x80;
+        high = lead == 0xed ? 0x9f : 0xbf;
+    } else if (lead >= 0xf0 && lead < 0xf5) {
+        size = 4;
+        value = lead & 0x07;
+        low = lead == 0xf0 ? 0x90 : 0x80;
+        high = lead == 0xf4 ? 0x8f : 0xbf;
+    } else if (lead >= 0x80) {
+        value = 0xfffd;
+    }
+
+    size_t i = 1;
+    for (; i < size; ++i) {
+        if (i == len || p[i] < low || p[i] > high) {
+            value = 0xfffd;
+            break;
+        }
+        value = value << 6 | (p[i] & 0x3fu);
+        low = 0x80;
+        high = 0xbf;
+    }
+
+    *code_point = value;
+    code_points->rest = mc_str_view_make(code_points->rest.data + i, len - i);
+    return true;
+}
+
+static int mc_str_view_compare_ptr(void const *view1, void const *view2)
+{
+    return mc_str_view_compare(*(struct mc_str_view const *)view1,
+                               *(struct mc_str_view const *)view2);
+}
+
+static bool mc_str_view_equal_ptr(void const *view1, void const *view2)
+{
+    return mc_str_view_equal(*(struct mc_str_view const *)view1,
+                             *(struct mc_str_view const *)view2);
+}
+
+static size_t mc_str_view_hash_ptr(void const *view)
+{
+    return mc_str_view_hash(*(struct mc_str_view const *)view);
+}
+
+MC_DEFINE_POD_TYPE(mc_str_view, struct mc_str_view, mc_str_view_compare_ptr,
+                   mc_str_view_equal_ptr, mc_str_view_hash_ptr)
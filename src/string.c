@@ -1,17 +1,27 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <ctype.h>
 #include <stdarg.h>
 #include "myclib/string.h"
+#include "myclib/aligned_malloc.h"
+#include "myclib/format.h"
 #include "myclib/hash.h"
+#include "myclib/multi_search.h"
+#include "myclib/simd.h"
 #include "myclib/utils.h"
 
 void mc_string_init(struct mc_string *str)
+{
+    mc_string_init_with_allocator(str, &mc_default_allocator);
+}
+
+void mc_string_init_with_allocator(struct mc_string *str,
+                                   struct mc_allocator const *allocator)
 {
     assert(str);
-    str->data = NULL;
-    str->len = 0;
-    str->capacity = 0;
+    assert(allocator);
+    str->storage.buf[0] = '\0';
+    str->storage.buf[MC_STRING_INLINE_CAPACITY] = MC_STRING_INLINE_CAPACITY;
+    str->allocator = allocator;
 }
 
 void mc_string_from(struct mc_string *str, char const *s)
@@ -30,27 +40,25 @@ void mc_string_from_bytes(struct mc_string *str, void const *bytes, size_t len)
     mc_string_append_bytes(str, bytes, len);
 }
 
+void mc_string_from_view(struct mc_string *str, struct mc_str_view view)
+{
+    assert(str);
+    mc_string_init(str);
+    mc_string_append_bytes(str, view.data, view.len);
+}
+
 void mc_string_format(struct mc_string *str, char const *fmt, ...)
 {
-    va_list args1, args2;
+    va_list args;
 
     assert(str);
     assert(fmt);
 
     mc_string_init(str);
 
-    va_start(args1, fmt);
-    va_copy(args2, args1);
-
-    int const n = vsnprintf(NULL, 0, fmt, args2);
-    va_end(args2);
-
-    mc_string_reserve(str, n + 1);
-
-    vsnprintf(str->data, n + 1, fmt, args1);
-    va_end(args1);
-
-    str->len += n;
+    va_start(args, fmt);
+    mc_string_append_vformat(str, fmt, args);
+    va_end(args);
 }
 
 void mc_string_join(struct mc_array const *parts, char const *separator,
@@ -69,7 +77,8 @@ void mc_string_join(struct mc_array const *parts, char const *separator,
     size_t const sep_len = strlen(separator);
     for (size_t i = 0; i < arr_len; ++i) {
         struct mc_string const *const part = mc_array_get_unchecked(parts, i);
-        mc_string_append_bytes(str, part->data, part->len);
+        mc_string_append_bytes(str, mc_string_data(part),
+                               mc_string_len(part));
         if (i < arr_len - 1)
             mc_string_append_bytes(str, separator, sep_len);
     }
@@ -77,10 +86,12 @@ void mc_string_join(struct mc_array const *parts, char const *separator,
 
 static void mc_string_deallocate(struct mc_string *str)
 {
-    if (str->capacity > 0) {
-        free(str->data);
-        str->data = NULL;
-        str->capacity = 0;
+    if (!mc_string_is_inline(str)) {
+        mc_allocator_free(str->allocator, str->storage.heap.data,
+                          mc_string_capacity(str) + 1);
+        str->storage.buf[0] = '\0';
+        str->storage.buf[MC_STRING_INLINE_CAPACITY] =
+            MC_STRING_INLINE_CAPACITY;
     }
 }
 
@@ -94,9 +105,7 @@ void mc_string_cleanup(struct mc_string *str)
 char const *mc_string_c_str(struct mc_string *str)
 {
     assert(str);
-    mc_string_reserve(str, 1);
-    str->data[str->len] = '\0';
-    return str->data;
+    return mc_string_data(str);
 }
 
 void mc_string_append(struct mc_string *str, char const *s)
@@ -116,29 +125,105 @@ void mc_string_append_bytes(struct mc_string *str, void const *bytes,
         return;
 
     mc_string_reserve(str, len);
-    memcpy(str->data + str->len, bytes, len);
-    str->len += len;
-    str->data[str->len] = '\0';
+    char *const data = mc_string_data(str);
+    size_t const old_len = mc_string_len(str);
+    memcpy(data + old_len, bytes, len);
+    data[old_len + len] = '\0';
+    mc_string_set_len(str, old_len + len);
+}
+
+void mc_string_append_view(struct mc_string *str, struct mc_str_view view)
+{
+    mc_string_append_bytes(str, view.data, view.len);
+}
+
+void mc_string_append_code_point(struct mc_string *str, uint32_t code_point)
+{
+    assert(str);
+    if (code_point > 0x10ffff ||
+        (code_point >= 0xd800 && code_point <= 0xdfff)) {
+        fprintf(stderr, "%s: code point (is U+%04X) must be a scalar value\n",
+                __func__, (unsigned)code_point);
+        abort();
+    }
+
+    char bytes[4];
+    size_t len;
+    if (code_point < 0x80) {
+        bytes[0] = (char)code_point;
+        len = 1;
+    } else if (code_point < 0x800) {
+        bytes[0] = (char)(0xc0 | code_point >> 6);
+        len = 2;
+    } else if (code_point < 0x10000) {
+        bytes[0] = (char)(0xe0 | code_point >> 12);
+        len = 3;
+    } else {
+        bytes[0] = (char)(0xf0 | code_point >> 18);
+        len = 4;
+    }
+    for (size_t i = len - 1; i > 0; --i) {
+        bytes[i] = (char)(0x80 | (code_point & 0x3f));
+        code_point >>= 6;
+    }
+    mc_string_append_bytes(str, bytes, len);
 }
 
 void mc_string_append_format(struct mc_string *str, char const *fmt, ...)
 {
-    va_list args1, args2;
+    va_list args;
 
-    va_start(args1, fmt);
-    va_copy(args2, args1);
+    va_start(args, fmt);
+    mc_string_append_vformat(str, fmt, args);
+    va_end(args);
+}
 
-    int const n = vsnprintf(NULL, 0, fmt, args2);
-    va_end(args2);
+void mc_string_append_vformat(struct mc_string *str, char const *fmt,
+                              va_list args)
+{
+    va_list retry;
 
-    mc_string_reserve(str, n + 1);
+    assert(str);
+    assert(fmt);
 
-    vsnprintf(str->data + str->len, n + 1, fmt, args1);
-    va_end(args1);
+    /* The buffer always has room for a NUL past the capacity. Inline, that
+     * NUL may land on the length byte, so the length is restored before
+     * growing. */
+    size_t const len = mc_string_len(str);
+    size_t const spare = mc_string_capacity(str) - len;
+    va_copy(retry, args);
+    int const n = vsnprintf(mc_string_data(str) + len, spare + 1, fmt, args);
+    if (n < 0) {
+        fprintf(stderr, "%s: invalid format string \"%s\"\n", __func__, fmt);
+        abort();
+    }
+    if ((size_t)n > spare) {
+        mc_string_set_len(str, len);
+        mc_string_reserve(str, (size_t)n);
+        vsnprintf(mc_string_data(str) + len, (size_t)n + 1, fmt, retry);
+    }
+    va_end(retry);
 
-    str->len += n;
+    mc_string_set_len(str, len + (size_t)n);
 }
 
+#define MC_STRING_DEFINE_APPEND_NUMBER(name, type, max)                        \
+    void mc_string_append_##name(struct mc_string *str, type value)            \
+    {                                                                          \
+        assert(str);                                                           \
+        mc_string_reserve(str, max);                                           \
+        char *const data = mc_string_data(str);                                \
+        size_t const len = mc_string_len(str);                                 \
+        size_t const n = mc_format_##name(data + len, value);                  \
+        data[len + n] = '\0';                                                  \
+        mc_string_set_len(str, len + n);                                       \
+    }
+
+MC_STRING_DEFINE_APPEND_NUMBER(u64, uint64_t, MC_FORMAT_U64_MAX)
+MC_STRING_DEFINE_APPEND_NUMBER(i64, int64_t, MC_FORMAT_I64_MAX)
+MC_STRING_DEFINE_APPEND_NUMBER(hex, uint64_t, MC_FORMAT_HEX_MAX)
+MC_STRING_DEFINE_APPEND_NUMBER(f64, double, MC_FORMAT_F64_MAX)
+
 static void mc_string_bounds_check(char const *func_name, size_t index,
                                    size_t bounds, bool allow_equal)
 {
@@ -158,7 +243,7 @@ void mc_string_insert(struct mc_string *str, size_t index, char const *s)
 {
     assert(str);
 
-    size_t len = str->len;
+    size_t len = mc_string_len(str);
     mc_string_bounds_check(__func__, index, len, true);
 
     if (!s)
@@ -170,12 +255,12 @@ void mc_string_insert(struct mc_string *str, size_t index, char const *s)
 
     mc_string_reserve(str, s_len);
 
-    char *const data = str->data;
+    char *const data = mc_string_data(str);
     memmove(data + index + s_len, data + index, len - index + 1);
     memcpy(data + index, s, s_len);
     len += s_len;
     data[len] = '\0';
-    str->len = len;
+    mc_string_set_len(str, len);
 }
 
 void mc_string_remove(struct mc_string *str, char const *s)
@@ -185,66 +270,93 @@ void mc_string_remove(struct mc_string *str, char const *s)
     if (!s)
         return;
 
-    size_t len = str->len;
+    size_t len = mc_string_len(str);
     size_t const s_len = strlen(s);
     if (len == 0 || s_len == 0)
         return;
 
-    char *const data = str->data;
-    char *const p = strstr(data, s);
-    if (!p)
+    size_t s_start;
+    if (!mc_string_find(str, s, &s_start))
         return;
 
-    size_t const s_start = p - data;
+    char *const data = mc_string_data(str);
     size_t const s_end = s_start + s_len;
     memmove(data + s_start, data + s_end, len - s_end + 1);
     len -= s_len;
     data[len] = '\0';
-    str->len = len;
+    mc_string_set_len(str, len);
 }
 
 void mc_string_clear(struct mc_string *str)
 {
     assert(str);
 
-    if (str->len > 0) {
-        str->len = 0;
-        str->data[str->len] = '\0';
+    if (mc_string_len(str) > 0) {
+        mc_string_data(str)[0] = '\0';
+        mc_string_set_len(str, 0);
     }
 }
 
+/* Capacities that fit inline bring a heap string back into the struct;
+ * the caller guarantees the contents fit the new capacity. */
 static void mc_string_reallocate(struct mc_string *str, size_t new_capacity)
 {
-    if (new_capacity == 0) {
-        mc_string_deallocate(str);
+    bool const is_inline = mc_string_is_inline(str);
+    size_t const len = mc_string_len(str);
+
+    if (new_capacity <= MC_STRING_INLINE_CAPACITY) {
+        if (!is_inline) {
+            char *const heap_data = str->storage.heap.data;
+            size_t const heap_size = mc_string_capacity(str) + 1;
+            memcpy(str->storage.buf, heap_data, len + 1);
+            str->storage.buf[MC_STRING_INLINE_CAPACITY] =
+                (char)(MC_STRING_INLINE_CAPACITY - len);
+            mc_allocator_free(str->allocator, heap_data, heap_size);
+        }
         return;
     }
 
-    new_capacity += 1;
+    if (new_capacity > MC_STRING_CAPACITY_MAX) {
+        fprintf(stderr, "capacity overflow\n");
+        abort();
+    }
 
-    char *const new_data = realloc(str->data, new_capacity);
+    size_t const new_size = new_capacity + 1;
+    char *new_data;
+    if (is_inline) {
+        new_data = mc_allocator_alloc(str->allocator, 1, new_size);
+        if (new_data)
+            memcpy(new_data, str->storage.buf, len + 1);
+    } else {
+        new_data = mc_allocator_realloc(str->allocator, str->storage.heap.data,
+                                        1, mc_string_capacity(str) + 1,
+                                        new_size);
+    }
     if (new_data == NULL) {
-        fprintf(stderr, "memory allocation of %zu bytes failed\n",
-                new_capacity);
+        fprintf(stderr, "memory allocation of %zu bytes failed\n", new_size);
         abort();
     }
 
-    str->data = new_data;
-    str->capacity = new_capacity - 1;
+    /* The tag is written last: on 64-bit targets it overlays the top byte
+     * of the capacity, which MC_STRING_CAPACITY_MAX keeps clear. */
+    str->storage.heap.data = new_data;
+    str->storage.heap.len = len;
+    str->storage.heap.capacity = new_capacity;
+    str->storage.buf[MC_STRING_INLINE_CAPACITY] = (char)0x80;
 }
 
 void mc_string_reserve(struct mc_string *str, size_t additional)
 {
     assert(str);
 
-    size_t const len = str->len;
+    size_t const len = mc_string_len(str);
     if (additional > SIZE_MAX - len - 1) {
         fprintf(stderr, "capacity overflow\n");
         abort();
     }
 
     size_t const request_size = len + additional;
-    size_t const capacity = str->capacity;
+    size_t const capacity = mc_string_capacity(str);
     if (capacity >= request_size)
         return;
 
@@ -255,14 +367,14 @@ void mc_string_reserve_exact(struct mc_string *str, size_t additional)
 {
     assert(str);
 
-    size_t const len = str->len;
+    size_t const len = mc_string_len(str);
     if (additional > SIZE_MAX - len - 1) {
         fprintf(stderr, "capacity overflow\n");
         abort();
     }
 
     size_t const request_size = len + additional;
-    size_t const capacity = str->capacity;
+    size_t const capacity = mc_string_capacity(str);
     if (capacity >= request_size)
         return;
 
@@ -272,8 +384,9 @@ void mc_string_reserve_exact(struct mc_string *str, size_t additional)
 void mc_string_shrink_to_fit(struct mc_string *str)
 {
     assert(str);
-    if (str->capacity > str->len)
-        mc_string_reallocate(str, str->len);
+    size_t const len = mc_string_len(str);
+    if (mc_string_capacity(str) > len)
+        mc_string_reallocate(str, len);
 }
 
 void mc_string_trim(struct mc_string *str)
@@ -287,37 +400,26 @@ void mc_string_trim_left(struct mc_string *str)
 {
     assert(str);
 
-    size_t len = str->len;
+    size_t len = mc_string_len(str);
     if (len == 0)
         return;
 
-    size_t i = 0;
-    char *const data = str->data;
-    while (i < len && isspace(data[i]))
-        ++i;
+    char *const data = mc_string_data(str);
+    size_t const i = mc_simd_skip_space(data, len);
     len -= i;
     memmove(data, data + i, len);
     data[len] = '\0';
-    str->len = len;
+    mc_string_set_len(str, len);
 }
 
 void mc_string_trim_right(struct mc_string *str)
 {
     assert(str);
 
-    size_t const len = str->len;
-    if (len == 0)
-        return;
-
-    size_t i = len - 1;
-    char *const data = str->data;
-    while (isspace(data[i])) {
-        if (i-- == 0)
-            break;
-    }
-    ++i;
-    data[i] = '\0';
-    str->len = i;
+    char *const data = mc_string_data(str);
+    size_t const len = mc_simd_rskip_space(data, mc_string_len(str));
+    data[len] = '\0';
+    mc_string_set_len(str, len);
 }
 
 void mc_string_replace(struct mc_string *str, char const *from, char const *to)
@@ -325,48 +427,233 @@ void mc_string_replace(struct mc_string *str, char const *from, char const *to)
     assert(str);
     assert(from);
     assert(to);
+    mc_string_replace_view(str, mc_str_view_from_cstr(from),
+                           mc_str_view_from_cstr(to));
+}
+
+/* Index of the next occurrence of from at or after pos, or len. */
+static size_t mc_string_find_from(char const *data, size_t len, size_t pos,
+                                  struct mc_str_view from)
+{
+    return pos + mc_simd_find_bytes(data + pos, len - pos, from.data, from.len);
+}
 
-    size_t const from_len = strlen(from);
-    if (from_len == 0)
+/* Doubles the match gaps of replace_view, moving them off the stack on
+ * the first call. The scratch never outlives the call, so it uses the
+ * default allocator like the sort scratch of mc_array. */
+static uint32_t *mc_string_grow_gaps(uint32_t *gaps, uint32_t *stack_gaps,
+                                     size_t *kept)
+{
+    size_t const old_size = *kept * sizeof(*gaps);
+    if (*kept > SIZE_MAX / 2 / sizeof(*gaps)) {
+        fprintf(stderr, "capacity overflow\n");
+        abort();
+    }
+    uint32_t *grown =
+        gaps == stack_gaps
+            ? mc_aligned_malloc(alignof(uint32_t), 2 * old_size)
+            : mc_aligned_realloc(gaps, alignof(uint32_t), old_size,
+                                 2 * old_size);
+    if (!grown) {
+        fprintf(stderr, "memory allocation of %zu bytes failed\n",
+                2 * old_size);
+        abort();
+    }
+    if (gaps == stack_gaps)
+        memcpy(grown, stack_gaps, old_size);
+    *kept *= 2;
+    return grown;
+}
+
+void mc_string_replace_view(struct mc_string *str, struct mc_str_view from,
+                            struct mc_str_view to)
+{
+    assert(str);
+
+    size_t const len = mc_string_len(str);
+    if (from.len == 0 || from.len > len)
         return;
 
-    size_t const to_len = strlen(to);
+    char *const data = mc_string_data(str);
+    size_t read = 0;
+
+    if (to.len <= from.len) {
+        /* The output never overtakes the input, so it can share the buffer. */
+        size_t write = 0;
+        size_t index;
+        while ((index = mc_string_find_from(data, len, read, from)) < len) {
+            memmove(data + write, data + read, index - read);
+            write += index - read;
+            memcpy(data + write, to.data, to.len);
+            write += to.len;
+            read = index + from.len;
+        }
+        memmove(data + write, data + read, len - read);
+        data[write + len - read] = '\0';
+        mc_string_set_len(str, write + len - read);
+        return;
+    }
+
+    /* The counting pass keeps the gap before each match, so the text is
+     * searched once. A few fit on the stack; more move to a growing buffer
+     * that, at four bytes a match, stays well below the text itself. Only
+     * a gap of 4 GiB or more stops the recording and leaves the rest of
+     * the text to be searched again. */
+    uint32_t stack_gaps[128];
+    uint32_t *gaps = stack_gaps;
+    size_t kept = sizeof(stack_gaps) / sizeof(stack_gaps[0]);
+    size_t recorded = 0;
+    bool recording = true;
+    size_t count = 0;
+    size_t index;
+    while ((index = mc_string_find_from(data, len, read, from)) < len) {
+        if (recording && index - read > UINT32_MAX)
+            recording = false;
+        if (recording) {
+            if (recorded == kept)
+                gaps = mc_string_grow_gaps(gaps, stack_gaps, &kept);
+            gaps[recorded++] = (uint32_t)(index - read);
+        }
+        ++count;
+        read = index + from.len;
+    }
+    if (count == 0)
+        return;
 
-    struct mc_string new_str;
-    mc_string_init(&new_str);
+    size_t const growth = to.len - from.len;
+    if (count > (SIZE_MAX - 1 - len) / growth) {
+        fprintf(stderr, "capacity overflow\n");
+        abort();
+    }
 
-    char *start = str->data;
-    char *index = NULL;
-    while ((index = strstr(start, from))) {
-        mc_string_append_bytes(&new_str, start, index - start);
-        mc_string_append_bytes(&new_str, to, to_len);
-        start = index + from_len;
+    struct mc_string result;
+    mc_string_init_with_allocator(&result, str->allocator);
+    mc_string_reserve_exact(&result, len + count * growth);
+    char *out = mc_string_data(&result);
+
+    read = 0;
+    for (size_t m = 0; m < count; m++) {
+        index = m < recorded ? read + gaps[m]
+                             : mc_string_find_from(data, len, read, from);
+        memcpy(out, data + read, index - read);
+        out += index - read;
+        memcpy(out, to.data, to.len);
+        out += to.len;
+        read = index + from.len;
     }
-    mc_string_append_bytes(&new_str, start, str->len - (start - str->data));
+    memcpy(out, data + read, len - read);
+    mc_string_data(&result)[len + count * growth] = '\0';
+    mc_string_set_len(&result, len + count * growth);
+    if (gaps != stack_gaps)
+        mc_aligned_free(gaps);
 
     mc_string_cleanup(str);
-    mc_string_move(str, &new_str);
+    mc_string_move(str, &result);
+}
+
+void mc_string_replace_many(struct mc_string *str,
+                            struct mc_multi_search const *search,
+                            struct mc_array const *replacements)
+{
+    assert(str);
+    assert(search);
+    assert(replacements);
+
+    size_t const pattern_count = mc_multi_search_pattern_count(search);
+    if (mc_array_len(replacements) != pattern_count) {
+        fprintf(stderr,
+                "%s: replacements (is %zu) must match patterns (is %zu)\n",
+                __func__, mc_array_len(replacements), pattern_count);
+        abort();
+    }
+
+    bool grows = false;
+    for (size_t p = 0; p < pattern_count && !grows; p++) {
+        struct mc_string const *to = mc_array_get_unchecked(replacements, p);
+        grows = mc_string_len(to) > mc_multi_search_pattern_len(search, p);
+    }
+
+    char *const data = mc_string_data(str);
+    size_t const len = mc_string_len(str);
+    struct mc_multi_search_match match;
+    size_t read = 0;
+
+    if (!grows) {
+        size_t write = 0;
+        while (mc_multi_search_find_leftmost(
+            search, mc_str_view_make(data + read, len - read), &match)) {
+            struct mc_str_view const to = mc_string_view(
+                mc_array_get_unchecked(replacements, match.pattern));
+            memmove(data + write, data + read, match.start);
+            write += match.start;
+            memcpy(data + write, to.data, to.len);
+            write += to.len;
+            read += match.start + match.len;
+        }
+        memmove(data + write, data + read, len - read);
+        data[write + len - read] = '\0';
+        mc_string_set_len(str, write + len - read);
+        return;
+    }
+
+    size_t new_len = len;
+    while (mc_multi_search_find_leftmost(
+        search, mc_str_view_make(data + read, len - read), &match)) {
+        size_t const to_len = mc_string_len(
+            mc_array_get_unchecked(replacements, match.pattern));
+        if (to_len > match.len && to_len - match.len > SIZE_MAX - 1 - new_len) {
+            fprintf(stderr, "capacity overflow\n");
+            abort();
+        }
+        new_len = new_len - match.len + to_len;
+        read += match.start + match.len;
+    }
+    if (read == 0)
+        return;
+
+    struct mc_string result;
+    mc_string_init_with_allocator(&result, str->allocator);
+    mc_string_reserve_exact(&result, new_len);
+    char *out = mc_string_data(&result);
+
+    read = 0;
+    while (mc_multi_search_find_leftmost(
+        search, mc_str_view_make(data + read, len - read), &match)) {
+        struct mc_str_view const to = mc_string_view(
+            mc_array_get_unchecked(replacements, match.pattern));
+        memcpy(out, data + read, match.start);
+        out += match.start;
+        memcpy(out, to.data, to.len);
+        out += to.len;
+        read += match.start + match.len;
+    }
+    memcpy(out, data + read, len - read);
+    mc_string_data(&result)[new_len] = '\0';
+    mc_string_set_len(&result, new_len);
+
+    mc_string_cleanup(str);
+    mc_string_move(str, &result);
 }
 
 void mc_string_to_upper(struct mc_string const *str)
 {
     assert(str);
-    for (size_t i = 0, len = str->len; i < len; i++)
-        str->data[i] = (char)toupper(str->data[i]);
+    char *const data = mc_string_data(str);
+    mc_simd_to_upper(data, data, mc_string_len(str));
 }
 
 void mc_string_to_lower(struct mc_string const *str)
 {
     assert(str);
-    for (size_t i = 0, len = str->len; i < len; i++)
-        str->data[i] = (char)tolower(str->data[i]);
+    char *const data = mc_string_data(str);
+    mc_simd_to_lower(data, data, mc_string_len(str));
 }
 
 void mc_string_repeat(struct mc_string *str, size_t n)
 {
     assert(str);
 
-    size_t const len = str->len;
+    size_t const len = mc_string_len(str);
     if (n > (SIZE_MAX - 1) / len) {
         fprintf(stderr, "capacity overflow\n");
         abort();
@@ -377,12 +664,12 @@ void mc_string_repeat(struct mc_string *str, size_t n)
 
     mc_string_reserve(str, len * (n - 1));
 
-    char *data = str->data;
+    char *data = mc_string_data(str);
     for (size_t i = 1; i < n; ++i)
         memcpy(data + len * i, data, len);
 
-    str->len = n * len;
-    str->data[str->len] = '\0';
+    data[n * len] = '\0';
+    mc_string_set_len(str, n * len);
 }
 
 bool mc_string_find(struct mc_string const *str, char const *pattern,
@@ -390,25 +677,8 @@ bool mc_string_find(struct mc_string const *str, char const *pattern,
 {
     assert(str);
     assert(pattern);
-
-    size_t const pattern_len = strlen(pattern);
-    if (pattern_len == 0) {
-        if (index)
-            *index = 0;
-        return true;
-    }
-
-    if (str->len < pattern_len)
-        return false;
-
-    char const *const position = strstr(str->data, pattern);
-    if (!position)
-        return false;
-
-    if (index)
-        *index = position - str->data;
-
-    return true;
+    return mc_str_view_find(mc_string_view(str),
+                            mc_str_view_from_cstr(pattern), index);
 }
 
 bool mc_string_rfind(struct mc_string const *str, char const *pattern,
@@ -416,88 +686,35 @@ bool mc_string_rfind(struct mc_string const *str, char const *pattern,
 {
     assert(str);
     assert(pattern);
-
-    size_t const len = str->len;
-    size_t const pattern_len = strlen(pattern);
-    if (pattern_len == 0) {
-        if (index)
-            *index = len;
-        return true;
-    }
-
-    if (len < pattern_len)
-        return false;
-
-    char const *curr = str->data + len - pattern_len;
-    char const *const end = str->data;
-    for (; curr >= end; --curr) {
-        if (curr[0] != pattern[0])
-            continue;
-
-        if (memcmp(curr, pattern, pattern_len) != 0)
-            continue;
-
-        break;
-    }
-
-    if (curr < end)
-        return false;
-
-    if (index)
-        *index = curr - end;
-
-    return true;
+    return mc_str_view_rfind(mc_string_view(str),
+                             mc_str_view_from_cstr(pattern), index);
 }
 
 bool mc_string_find_ch(struct mc_string const *str, char pattern, size_t *index)
 {
     assert(str);
-
-    if (str->len == 0)
-        return false;
-
-    char const *position = strchr(str->data, pattern);
-    if (position == NULL)
-        return false;
-
-    if (index)
-        *index = position - str->data;
-
-    return true;
+    return mc_str_view_find_ch(mc_string_view(str), pattern, index);
 }
 
 bool mc_string_rfind_ch(struct mc_string const *str, char pattern,
                         size_t *index)
 {
     assert(str);
-
-    if (str->len == 0)
-        return false;
-
-    char const *position = strrchr(str->data, pattern);
-    if (position == NULL)
-        return false;
-
-    if (index)
-        *index = position - str->data;
-
-    return true;
+    return mc_str_view_rfind_ch(mc_string_view(str), pattern, index);
 }
 
 bool mc_string_contains(struct mc_string const *str, char const *pattern)
 {
     assert(str);
-    if (str->len == 0)
+    if (mc_string_len(str) == 0)
         return false;
-    return strstr(str->data, pattern) != NULL;
+    return mc_string_find(str, pattern, NULL);
 }
 
 bool mc_string_contains_ch(struct mc_string const *str, char ch)
 {
     assert(str);
-    if (str->len == 0)
-        return false;
-    return strchr(str->data, ch) != NULL;
+    return mc_string_find_ch(str, ch, NULL);
 }
 
 bool mc_string_starts_with(struct mc_string const *str, char const *pattern)
@@ -509,11 +726,11 @@ bool mc_string_starts_with(struct mc_string const *str, char const *pattern)
     if (pattern_len == 0)
         return true;
 
-    size_t const len = str->len;
+    size_t const len = mc_string_len(str);
     if (len == 0 || pattern_len > len)
         return false;
 
-    return memcmp(str->data, pattern, pattern_len) == 0;
+    return memcmp(mc_string_data(str), pattern, pattern_len) == 0;
 }
 
 bool mc_string_ends_with(struct mc_string const *str, char const *pattern)
@@ -525,11 +742,24 @@ bool mc_string_ends_with(struct mc_string const *str, char const *pattern)
     if (pattern_len == 0)
         return true;
 
-    size_t const len = str->len;
+    size_t const len = mc_string_len(str);
     if (len == 0 || pattern_len > len)
         return false;
 
-    return memcmp(str->data + len - pattern_len, pattern, pattern_len) == 0;
+    return memcmp(mc_string_data(str) + len - pattern_len, pattern,
+                  pattern_len) == 0;
+}
+
+bool mc_string_utf8_validate(struct mc_string const *str, size_t *error)
+{
+    assert(str);
+    return mc_str_view_utf8_validate(mc_string_view(str), error);
+}
+
+size_t mc_string_utf8_len(struct mc_string const *str)
+{
+    assert(str);
+    return mc_simd_utf8_count(mc_string_data(str), mc_string_len(str));
 }
 
 void mc_string_strip_prefix(struct mc_string *str, char const *prefix)
@@ -541,16 +771,16 @@ void mc_string_strip_prefix(struct mc_string *str, char const *prefix)
     if (prefix_len == 0)
         return;
 
-    size_t len = str->len;
+    size_t len = mc_string_len(str);
     if (len == 0 || prefix_len > len)
         return;
 
-    char *data = str->data;
+    char *data = mc_string_data(str);
     if (memcmp(data, prefix, prefix_len) == 0) {
         memmove(data, data + prefix_len, len - prefix_len);
         len -= prefix_len;
         data[len] = '\0';
-        str->len = len;
+        mc_string_set_len(str, len);
     }
 }
 
@@ -563,15 +793,15 @@ void mc_string_strip_suffix(struct mc_string *str, char const *suffix)
     if (suffix_len == 0)
         return;
 
-    size_t len = str->len;
+    size_t len = mc_string_len(str);
     if (len == 0 || suffix_len > len)
         return;
 
-    char *data = str->data;
+    char *data = mc_string_data(str);
     if (memcmp(data + len - suffix_len, suffix, suffix_len) == 0) {
         len -= suffix_len;
         data[len] = '\0';
-        str->len = len;
+        mc_string_set_len(str, len);
     }
 }
 
@@ -584,19 +814,13 @@ void mc_string_split(struct mc_string const *str, char const *delim,
 
     mc_array_init(parts, mc_string_get_mc_type());
 
-    char const *s = str->data;
-    size_t n = 0;
-    while (*s != '\0') {
-        s += strspn(s, delim);
-        if (*s == '\0')
-            break;
-        n = strcspn(s, delim);
-        if (n == 0)
-            break;
+    struct mc_str_split split;
+    struct mc_str_view token;
+    mc_string_split_iter(&split, str, delim);
+    while (mc_str_split_next(&split, &token)) {
         struct mc_string part;
-        mc_string_from_bytes(&part, s, n);
+        mc_string_from_view(&part, token);
         mc_array_push(parts, &part);
-        s += n;
     }
 }
 
@@ -607,11 +831,12 @@ void mc_string_split_at(struct mc_string *const str, size_t index,
     assert(left);
     assert(right);
 
-    size_t const len = str->len;
+    size_t const len = mc_string_len(str);
     mc_string_bounds_check(__func__, index, len, false);
 
-    mc_string_from_bytes(left, str->data, index);
-    mc_string_from_bytes(right, str->data + index, len - index);
+    char const *const data = mc_string_data(str);
+    mc_string_from_bytes(left, data, index);
+    mc_string_from_bytes(right, data + index, len - index);
 }
 
 void mc_string_lines(struct mc_string const *str, struct mc_array *lines)
@@ -621,21 +846,54 @@ void mc_string_lines(struct mc_string const *str, struct mc_array *lines)
     mc_string_split(str, "\n", lines);
 }
 
+struct mc_str_view mc_string_substr(struct mc_string const *str, size_t pos,
+                                    size_t len)
+{
+    assert(str);
+    mc_string_bounds_check(__func__, pos, mc_string_len(str), true);
+    return mc_str_view_substr(mc_string_view(str), pos, len);
+}
+
+void mc_string_split_views(struct mc_string const *str, char const *delim,
+                           struct mc_array *parts)
+{
+    assert(str);
+    assert(delim);
+    assert(parts);
+
+    mc_array_init(parts, mc_str_view_get_mc_type());
+
+    struct mc_str_split split;
+    struct mc_str_view token;
+    mc_string_split_iter(&split, str, delim);
+    while (mc_str_split_next(&split, &token))
+        mc_array_push(parts, &token);
+}
+
+void mc_string_split_iter(struct mc_str_split *split,
+                          struct mc_string const *str, char const *delim)
+{
+    assert(split);
+    assert(str);
+    assert(delim);
+    mc_str_split_init(split, mc_string_view(str), delim);
+}
+
 void mc_string_move(struct mc_string *dst, struct mc_string *src)
 {
     assert(dst);
     assert(src);
     *dst = *src;
-    src->data = NULL;
-    src->len = 0;
-    src->capacity = 0;
+    src->storage.buf[0] = '\0';
+    src->storage.buf[MC_STRING_INLINE_CAPACITY] = MC_STRING_INLINE_CAPACITY;
 }
 
 void mc_string_copy(struct mc_string *dst, const struct mc_string *src)
 {
     assert(dst);
     assert(src);
-    mc_string_from_bytes(dst, src->data, src->len);
+    mc_string_init_with_allocator(dst, src->allocator);
+    mc_string_append_bytes(dst, mc_string_data(src), mc_string_len(src));
 }
 
 int mc_string_compare(struct mc_string const *str1,
@@ -643,11 +901,13 @@ int mc_string_compare(struct mc_string const *str1,
 {
     assert(str1);
     assert(str2);
-    if (str1->len > str2->len)
+    size_t const len1 = mc_string_len(str1);
+    size_t const len2 = mc_string_len(str2);
+    if (len1 > len2)
         return 1;
-    if (str1->len < str2->len)
+    if (len1 < len2)
         return -1;
-    return memcmp(str1->data, str2->data, str1->len);
+    return memcmp(mc_string_data(str1), mc_string_data(str2), len1);
 }
 
 bool mc_string_equal(struct mc_string const *str1, struct mc_string const *str2)
@@ -660,10 +920,56 @@ bool mc_string_equal(struct mc_string const *str1, struct mc_string const *str2)
 size_t mc_string_hash(struct mc_string const *str)
 {
     assert(str);
-    return MC_HASH(str->data, str->len);
+    return MC_HASH(mc_string_data(str), mc_string_len(str));
+}
+
+int mc_string_compare_ignore_case(struct mc_string const *str1,
+                                  struct mc_string const *str2)
+{
+    assert(str1);
+    assert(str2);
+    size_t const len1 = mc_string_len(str1);
+    size_t const len2 = mc_string_len(str2);
+    if (len1 > len2)
+        return 1;
+    if (len1 < len2)
+        return -1;
+    return mc_simd_compare_ignore_case(mc_string_data(str1), len1,
+                                       mc_string_data(str2), len2);
+}
+
+bool mc_string_equal_ignore_case(struct mc_string const *str1,
+                                 struct mc_string const *str2)
+{
+    assert(str1);
+    assert(str2);
+    return mc_string_compare_ignore_case(str1, str2) == 0;
+}
+
+size_t mc_string_hash_ignore_case(struct mc_string const *str)
+{
+    assert(str);
+    char folded[256];
+    char const *const data = mc_string_data(str);
+    size_t const len = mc_string_len(str);
+    size_t hash = MC_HASH_INIT;
+    for (size_t pos = 0; pos < len; pos += sizeof(folded)) {
+        size_t const rest = len - pos;
+        size_t const n = rest < sizeof(folded) ? rest : sizeof(folded);
+        mc_simd_to_lower(folded, data + pos, n);
+        hash = MC_HASH_UPDATE(hash, folded, n);
+    }
+    return hash;
 }
 
 MC_DEFINE_TYPE(mc_string, struct mc_string, (mc_cleanup_func)mc_string_cleanup,
                (mc_move_func)mc_string_move, (mc_copy_func)mc_string_copy,
                (mc_compare_func)mc_string_compare,
                (mc_equal_func)mc_string_equal, (mc_hash_func)mc_string_hash)
+
+MC_DEFINE_TYPE(mc_string_ignore_case, struct mc_string,
+               (mc_cleanup_func)mc_string_cleanup,
+               (mc_move_func)mc_string_move, (mc_copy_func)mc_string_copy,
+               (mc_compare_func)mc_string_compare_ignore_case,
+               (mc_equal_func)mc_string_equal_ignore_case,
+               (mc_hash_func)mc_string_hash_ignore_case)
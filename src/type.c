@@ -28,8 +28,35 @@
         assert(obj != NULL);                                                   \
         return MC_HASH(obj, sizeof(type));                                     \
     }                                                                          \
-    MC_DEFINE_POD_TYPE(type_name, type, type_name##_compare,                   \
-                       type_name##_equal, type_name##_hash)
+    static void type_name##_move(void *dst, void *src)                         \
+    {                                                                          \
+        assert(dst);                                                           \
+        assert(src);                                                           \
+        memcpy(dst, src, sizeof(type));                                        \
+    }                                                                          \
+    static void type_name##_copy(void *dst, void const *src)                   \
+    {                                                                          \
+        assert(dst);                                                           \
+        assert(src);                                                           \
+        memcpy(dst, src, sizeof(type));                                        \
+    }                                                                          \
+    /* MC_DEFINE_POD_TYPE, plus the flag mc_type_is_integer reads */           \
+    struct mc_type const *type_name##_get_mc_type(void)                        \
+    {                                                                          \
+        static struct mc_type const type_name##_mc_type = {                    \
+            .name = #type_name,                                                \
+            .alignment = alignof(type),                                        \
+            .size = sizeof(type),                                              \
+            .cleanup = NULL,                                                   \
+            .move = type_name##_move,                                          \
+            .copy = type_name##_copy,                                          \
+            .compare = type_name##_compare,                                    \
+            .equal = type_name##_equal,                                        \
+            .hash = type_name##_hash,                                          \
+            .is_integer = true,                                                \
+        };                                                                     \
+        return &type_name##_mc_type;                                           \
+    }
 
 MC_DEFINE_INT_TYPE(char, signed char)
 MC_DEFINE_INT_TYPE(short, signed short)
@@ -0,0 +1,308 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/aligned_malloc.h"
+#include "myclib/array.h"
+#include "myclib/string.h"
+#include "myclib/test.h"
+#include "myclib/type.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+MC_TEST_SUITE(aligned_malloc);
+
+static void fill_pattern(unsigned char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+        data[i] = (unsigned char)(i * 31 + 7);
+}
+
+static bool check_pattern(unsigned char const *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] != (unsigned char)(i * 31 + 7))
+            return false;
+    }
+    return true;
+}
+
+MC_TEST_IN_SUITE(aligned_malloc, alignment)
+{
+    MC_ASSERT_NULL(mc_aligned_malloc(0, 16));
+    MC_ASSERT_NULL(mc_aligned_malloc(16, 0));
+    MC_ASSERT_NULL(mc_aligned_malloc(24, 16));
+
+    for (size_t alignment = 1; alignment <= 4096; alignment *= 2) {
+        void *ptr = mc_aligned_malloc(alignment, 100);
+        MC_ASSERT_NOT_NULL(ptr);
+        MC_ASSERT_EQ_SIZE((uintptr_t)ptr % alignment, 0);
+        mc_aligned_free(ptr);
+    }
+    mc_aligned_free(NULL);
+}
+
+MC_TEST_IN_SUITE(aligned_malloc, realloc_preserves_contents)
+{
+    for (size_t alignment = 1; alignment <= 256; alignment *= 4) {
+        unsigned char *ptr = mc_aligned_realloc(NULL, alignment, 0, 10);
+        MC_ASSERT_NOT_NULL(ptr);
+        fill_pattern(ptr, 10);
+
+        size_t size = 10;
+        for (size_t new_size = 37; new_size < 100000; new_size *= 3) {
+            ptr = mc_aligned_realloc(ptr, alignment, size, new_size);
+            MC_ASSERT_NOT_NULL(ptr);
+            MC_ASSERT_EQ_SIZE((uintptr_t)ptr % alignment, 0);
+            MC_ASSERT_TRUE(check_pattern(ptr, size));
+            fill_pattern(ptr, new_size);
+            size = new_size;
+        }
+
+        ptr = mc_aligned_realloc(ptr, alignment, size, 5);
+        MC_ASSERT_TRUE(check_pattern(ptr, 5));
+        MC_ASSERT_NULL(mc_aligned_realloc(ptr, alignment, 5, 0));
+    }
+}
+
+MC_TEST_IN_SUITE(aligned_malloc, large_alloc_policy)
+{
+    struct mc_large_alloc_policy saved;
+    mc_get_large_alloc_policy(&saved);
+
+    struct mc_large_alloc_policy policy = MC_LARGE_ALLOC_POLICY_DEFAULT();
+    policy.threshold = 64 * 1024;
+    policy.numa_node = 0;
+    mc_set_large_alloc_policy(&policy);
+
+    struct mc_large_alloc_policy current;
+    mc_get_large_alloc_policy(&current);
+    MC_ASSERT_EQ_SIZE(current.threshold, 64 * 1024);
+    MC_ASSERT_EQ_INT(current.numa_node, 0);
+
+    unsigned char *big = mc_aligned_malloc(64, 1 << 20);
+    MC_ASSERT_NOT_NULL(big);
+    MC_ASSERT_EQ_SIZE((uintptr_t)big % 64, 0);
+    fill_pattern(big, 1 << 20);
+
+    /* Crossing the threshold in both directions keeps the contents. */
+    unsigned char *small = mc_aligned_malloc(8, 1000);
+    fill_pattern(small, 1000);
+    small = mc_aligned_realloc(small, 8, 1000, 200 * 1024);
+    MC_ASSERT_TRUE(check_pattern(small, 1000));
+    fill_pattern(small, 200 * 1024);
+    small = mc_aligned_realloc(small, 8, 200 * 1024, 100);
+    MC_ASSERT_TRUE(check_pattern(small, 100));
+    mc_aligned_free(small);
+
+    MC_ASSERT_TRUE(check_pattern(big, 1 << 20));
+    mc_aligned_free(big);
+
+    struct mc_array array;
+    mc_array_init(&array, size_get_mc_type());
+    for (size_t i = 0; i < 100000; i++)
+        mc_array_push(&array, &i);
+    for (size_t i = 0; i < 100000; i++)
+        MC_ASSERT_EQ_SIZE(*(size_t *)mc_array_get(&array, i), i);
+    mc_array_truncate(&array, 10);
+    mc_array_shrink_to_fit(&array);
+    MC_ASSERT_EQ_SIZE(*(size_t *)mc_array_get(&array, 9), 9);
+    mc_array_cleanup(&array);
+
+    struct mc_string str;
+    mc_string_init(&str);
+    for (size_t i = 0; i < 20000; i++)
+        mc_string_append(&str, "abcd");
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), 80000);
+    MC_ASSERT_TRUE(mc_string_ends_with(&str, "abcdabcd"));
+    mc_string_cleanup(&str);
+
+    mc_set_large_alloc_policy(&saved);
+}
+
+MC_TEST_IN_SUITE(aligned_malloc, size_class_backend)
+{
+    enum mc_aligned_malloc_backend saved = mc_get_aligned_malloc_backend();
+
+    /* Allocated before the switch and freed after it. */
+    unsigned char *before = mc_aligned_malloc(16, 300);
+    fill_pattern(before, 300);
+
+    mc_set_aligned_malloc_backend(MC_ALIGNED_MALLOC_BACKEND_SIZE_CLASS);
+    MC_ASSERT_EQ_INT(mc_get_aligned_malloc_backend(),
+                     MC_ALIGNED_MALLOC_BACKEND_SIZE_CLASS);
+
+    void *blocks[64];
+    for (size_t alignment = 1; alignment <= 8192; alignment *= 2) {
+        for (size_t i = 0; i < 64; i++) {
+            size_t size = 1 + i * 517 % MC_SIZE_CLASS_MAX;
+            blocks[i] = mc_aligned_malloc(alignment, size);
+            MC_ASSERT_NOT_NULL(blocks[i]);
+            MC_ASSERT_EQ_SIZE((uintptr_t)blocks[i] % alignment, 0);
+            fill_pattern(blocks[i], size);
+        }
+        for (size_t i = 0; i < 64; i++) {
+            size_t size = 1 + i * 517 % MC_SIZE_CLASS_MAX;
+            MC_ASSERT_TRUE(check_pattern(blocks[i], size));
+            mc_aligned_free(blocks[i]);
+        }
+    }
+
+    /* Freed blocks are reused by the same thread. */
+    void *a = mc_aligned_malloc(8, 40);
+    mc_aligned_free(a);
+    MC_ASSERT_EQ_PTR(mc_aligned_malloc(8, 48), a);
+
+    /* Growing within a class keeps the block; leaving it moves the data. */
+    unsigned char *ptr = mc_aligned_realloc(a, 8, 48, 44);
+    MC_ASSERT_EQ_PTR(ptr, a);
+    fill_pattern(ptr, 44);
+    ptr = mc_aligned_realloc(ptr, 8, 44, 5000);
+    MC_ASSERT_TRUE(check_pattern(ptr, 44));
+    fill_pattern(ptr, 5000);
+    ptr = mc_aligned_realloc(ptr, 8, 5000, 100000);
+    MC_ASSERT_TRUE(check_pattern(ptr, 5000));
+    ptr = mc_aligned_realloc(ptr, 8, 100000, 20);
+    MC_ASSERT_TRUE(check_pattern(ptr, 20));
+    mc_aligned_free(ptr);
+
+    MC_ASSERT_TRUE(check_pattern(before, 300));
+    mc_aligned_free(before);
+
+    struct mc_array array;
+    mc_array_init(&array, size_get_mc_type());
+    for (size_t i = 0; i < 100000; i++)
+        mc_array_push(&array, &i);
+    for (size_t i = 0; i < 100000; i++)
+        MC_ASSERT_EQ_SIZE(*(size_t *)mc_array_get(&array, i), i);
+    mc_array_cleanup(&array);
+
+    struct mc_string str;
+    mc_string_init(&str);
+    for (size_t i = 0; i < 2000; i++)
+        mc_string_append(&str, "abcd");
+    MC_ASSERT_TRUE(mc_string_ends_with(&str, "abcdabcd"));
+
+    /* Blocks from the size classes may outlive the switch back. */
+    mc_set_aligned_malloc_backend(saved);
+    mc_string_append(&str, "efgh");
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), 8004);
+    mc_string_cleanup(&str);
+}
+
+#if defined(__linux__)
+enum { EXIT_THREADS = 100, EXIT_BLOCKS = 64 };
+
+static void *size_class_exit_worker(void *arg)
+{
+    void **blocks = arg;
+    for (size_t i = 0; i < EXIT_BLOCKS; i++) {
+        blocks[i] = mc_aligned_malloc(8, 1000);
+        memset(blocks[i], 0x5a, 1000);
+    }
+    for (size_t i = 0; i < EXIT_BLOCKS; i++)
+        mc_aligned_free(blocks[i]);
+    return NULL;
+}
+
+static int compare_ptr(void const *a, void const *b)
+{
+    uintptr_t const x = *(uintptr_t const *)a, y = *(uintptr_t const *)b;
+    return (x > y) - (x < y);
+}
+
+/* Blocks parked in the cache of a thread that exits go back to the shared
+ * classes, so short-lived threads keep reusing the same few blocks. */
+MC_TEST_IN_SUITE(aligned_malloc, size_class_thread_exit)
+{
+    enum mc_aligned_malloc_backend saved = mc_get_aligned_malloc_backend();
+    mc_set_aligned_malloc_backend(MC_ALIGNED_MALLOC_BACKEND_SIZE_CLASS);
+
+    void **blocks = malloc(EXIT_THREADS * EXIT_BLOCKS * sizeof(*blocks));
+    for (size_t t = 0; t < EXIT_THREADS; t++) {
+        pthread_t thread;
+        MC_ASSERT_EQ_INT(pthread_create(&thread, NULL, size_class_exit_worker,
+                                        blocks + t * EXIT_BLOCKS),
+                         0);
+        pthread_join(thread, NULL);
+    }
+
+    qsort(blocks, EXIT_THREADS * EXIT_BLOCKS, sizeof(*blocks), compare_ptr);
+    size_t distinct = 1;
+    for (size_t i = 1; i < EXIT_THREADS * EXIT_BLOCKS; i++)
+        distinct += blocks[i] != blocks[i - 1];
+    /* Without the spill every thread would carve EXIT_BLOCKS new ones */
+    MC_ASSERT_TRUE(distinct <= 4 * EXIT_BLOCKS);
+
+    free(blocks);
+    mc_set_aligned_malloc_backend(saved);
+}
+
+enum { CONSUMER_BLOCKS = 32 };
+
+static void *size_class_consumer(void *arg)
+{
+    void **blocks = arg;
+    for (size_t i = 0; i < CONSUMER_BLOCKS; i++)
+        mc_aligned_free(blocks[i]);
+    return NULL;
+}
+
+static void *size_class_producer(void *arg)
+{
+    void **blocks = arg;
+    for (size_t i = 0; i < CONSUMER_BLOCKS; i++)
+        blocks[i] = mc_aligned_malloc(8, 2000);
+    return NULL;
+}
+
+/* A thread that only frees blocks allocated elsewhere still hands its
+ * cache back when it exits. */
+MC_TEST_IN_SUITE(aligned_malloc, size_class_free_only_thread)
+{
+    enum mc_aligned_malloc_backend saved = mc_get_aligned_malloc_backend();
+    mc_set_aligned_malloc_backend(MC_ALIGNED_MALLOC_BACKEND_SIZE_CLASS);
+
+    void *freed[CONSUMER_BLOCKS], *reused[CONSUMER_BLOCKS];
+    pthread_t thread;
+    MC_ASSERT_EQ_INT(
+        pthread_create(&thread, NULL, size_class_producer, freed), 0);
+    pthread_join(thread, NULL);
+    MC_ASSERT_EQ_INT(
+        pthread_create(&thread, NULL, size_class_consumer, freed), 0);
+    pthread_join(thread, NULL);
+
+    /* The consumer's blocks sit at the head of the shared list */
+    MC_ASSERT_EQ_INT(
+        pthread_create(&thread, NULL, size_class_producer, reused), 0);
+    pthread_join(thread, NULL);
+    qsort(freed, CONSUMER_BLOCKS, sizeof(*freed), compare_ptr);
+    for (size_t i = 0; i < CONSUMER_BLOCKS; i++)
+        MC_ASSERT_NOT_NULL(bsearch(&reused[i], freed, CONSUMER_BLOCKS,
+                                   sizeof(*freed), compare_ptr));
+    for (size_t i = 0; i < CONSUMER_BLOCKS; i++)
+        mc_aligned_free(reused[i]);
+
+    mc_set_aligned_malloc_backend(saved);
+}
+#endif
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_aligned_malloc();
+    register_test_aligned_malloc_alignment();
+    register_test_aligned_malloc_realloc_preserves_contents();
+    register_test_aligned_malloc_large_alloc_policy();
+    register_test_aligned_malloc_size_class_backend();
+#if defined(__linux__)
+    register_test_aligned_malloc_size_class_thread_exit();
+    register_test_aligned_malloc_size_class_free_only_thread();
+#endif
+#endif
+    return mc_run_all_tests();
+}
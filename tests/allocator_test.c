@@ -0,0 +1,165 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/aligned_malloc.h"
+#include "myclib/allocator.h"
+#include "myclib/array.h"
+#include "myclib/list.h"
+#include "myclib/map.h"
+#include "myclib/string.h"
+#include "myclib/test.h"
+#include "myclib/type.h"
+
+MC_TEST_SUITE(allocator);
+
+/* Counts calls and live bytes; realloc is left out on purpose so the
+ * alloc/copy/free fallback is exercised. */
+struct counting_ctx {
+    size_t allocs;
+    size_t frees;
+    size_t live_bytes;
+};
+
+static void *counting_alloc(void *ctx, size_t alignment, size_t size)
+{
+    struct counting_ctx *counts = ctx;
+    void *ptr = mc_aligned_malloc(alignment, size);
+    if (ptr) {
+        counts->allocs++;
+        counts->live_bytes += size;
+    }
+    return ptr;
+}
+
+static void counting_free(void *ctx, void *ptr, size_t size)
+{
+    struct counting_ctx *counts = ctx;
+    counts->frees++;
+    counts->live_bytes -= size;
+    mc_aligned_free(ptr);
+}
+
+static struct mc_allocator counting_allocator(struct counting_ctx *counts)
+{
+    struct mc_allocator allocator = {
+        .alloc = counting_alloc,
+        .realloc = NULL,
+        .free = counting_free,
+        .ctx = counts,
+    };
+    return allocator;
+}
+
+MC_TEST_IN_SUITE(allocator, default_allocator)
+{
+    void *ptr = mc_allocator_alloc(&mc_default_allocator, 64, 100);
+    MC_ASSERT_NOT_NULL(ptr);
+    MC_ASSERT_EQ_SIZE((uintptr_t)ptr % 64, 0);
+    memset(ptr, 0xab, 100);
+
+    ptr = mc_allocator_realloc(&mc_default_allocator, ptr, 64, 100, 1000);
+    MC_ASSERT_NOT_NULL(ptr);
+    MC_ASSERT_EQ_INT(((unsigned char *)ptr)[99], 0xab);
+
+    mc_allocator_free(&mc_default_allocator, ptr, 1000);
+    mc_allocator_free(&mc_default_allocator, NULL, 0);
+
+    struct mc_array array = MC_ARRAY_INITIALIZER(int_get_mc_type());
+    mc_array_push(&array, &(int){1});
+    MC_ASSERT_EQ_PTR(array.allocator, &mc_default_allocator);
+    mc_array_cleanup(&array);
+}
+
+MC_TEST_IN_SUITE(allocator, array_and_string)
+{
+    struct counting_ctx counts = {0};
+    struct mc_allocator allocator = counting_allocator(&counts);
+
+    struct mc_array array;
+    mc_array_init_with_allocator(&array, int_get_mc_type(), &allocator);
+    for (int i = 0; i < 1000; i++)
+        mc_array_push(&array, &i);
+    MC_ASSERT_GT_SIZE(counts.allocs, 1);
+    MC_ASSERT_EQ_SIZE(counts.live_bytes,
+                      mc_array_capacity(&array) * sizeof(int));
+    for (size_t i = 0; i < 1000; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_array_get(&array, i), (int)i);
+
+    struct mc_array copy;
+    mc_array_copy(&copy, &array);
+    MC_ASSERT_EQ_PTR(copy.allocator, &allocator);
+    mc_array_cleanup(&copy);
+    mc_array_cleanup(&array);
+
+    struct mc_string str;
+    mc_string_init_with_allocator(&str, &allocator);
+    for (int i = 0; i < 100; i++)
+        mc_string_append(&str, "hello ");
+    mc_string_replace(&str, "hello", "hi");
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), 300);
+    MC_ASSERT_EQ_PTR(str.allocator, &allocator);
+
+    struct mc_string str_copy;
+    mc_string_copy(&str_copy, &str);
+    MC_ASSERT_EQ_PTR(str_copy.allocator, &allocator);
+    MC_ASSERT_TRUE(mc_string_equal(&str_copy, &str));
+    mc_string_cleanup(&str_copy);
+    mc_string_cleanup(&str);
+
+    MC_ASSERT_EQ_SIZE(counts.live_bytes, 0);
+    MC_ASSERT_EQ_SIZE(counts.allocs, counts.frees);
+}
+
+MC_TEST_IN_SUITE(allocator, list_and_map)
+{
+    struct counting_ctx counts = {0};
+    struct mc_allocator allocator = counting_allocator(&counts);
+
+    struct mc_list list;
+    mc_list_init_with_allocator(&list, int_get_mc_type(), &allocator);
+    for (int i = 0; i < 10; i++)
+        mc_list_push_back(&list, &i);
+    MC_ASSERT_EQ_SIZE(counts.allocs, 10);
+    mc_list_pop_front(&list, NULL);
+    MC_ASSERT_EQ_SIZE(counts.frees, 1);
+
+    struct mc_list list_copy;
+    mc_list_copy(&list_copy, &list);
+    MC_ASSERT_EQ_SIZE(counts.allocs, 19);
+    mc_list_cleanup(&list_copy);
+    mc_list_cleanup(&list);
+    MC_ASSERT_EQ_SIZE(counts.live_bytes, 0);
+
+    struct mc_map map;
+    mc_map_init_with_allocator(&map, int_get_mc_type(), int_get_mc_type(),
+                               &allocator);
+    for (int i = 0; i < 100; i++)
+        mc_map_insert(&map, &(int){i}, &(int){i * i});
+    MC_ASSERT_EQ_INT(*(int *)mc_map_get(&map, &(int){9}), 81);
+    mc_map_remove(&map, &(int){9}, NULL, NULL);
+
+    struct mc_map map_copy;
+    mc_map_copy(&map_copy, &map);
+    MC_ASSERT_EQ_INT(*(int *)mc_map_get(&map_copy, &(int){7}), 49);
+    mc_map_cleanup(&map_copy);
+
+    mc_map_shrink_to_fit(&map);
+    mc_map_cleanup(&map);
+
+    MC_ASSERT_EQ_SIZE(counts.live_bytes, 0);
+    MC_ASSERT_EQ_SIZE(counts.allocs, counts.frees);
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_allocator();
+    register_test_allocator_default_allocator();
+    register_test_allocator_array_and_string();
+    register_test_allocator_list_and_map();
+#endif
+    return mc_run_all_tests();
+}
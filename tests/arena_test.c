@@ -0,0 +1,148 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/arena.h"
+#include "myclib/array.h"
+#include "myclib/map.h"
+#include "myclib/string.h"
+#include "myclib/test.h"
+#include "myclib/type.h"
+
+MC_TEST_SUITE(arena);
+
+MC_TEST_IN_SUITE(arena, alloc_alignment)
+{
+    struct mc_arena arena;
+    mc_arena_init(&arena, 1024);
+    MC_ASSERT_EQ_SIZE(mc_arena_used(&arena), 0);
+
+    MC_ASSERT_NULL(mc_arena_alloc(&arena, 0, 16));
+    MC_ASSERT_NULL(mc_arena_alloc(&arena, 16, 0));
+    MC_ASSERT_NULL(mc_arena_alloc(&arena, 24, 16));
+
+    for (size_t alignment = 1; alignment <= 256; alignment *= 2) {
+        char *ptr = mc_arena_alloc(&arena, alignment, 3);
+        MC_ASSERT_NOT_NULL(ptr);
+        MC_ASSERT_EQ_SIZE((uintptr_t)ptr % alignment, 0);
+        memset(ptr, 0x5a, 3);
+    }
+
+    /* Requests larger than a chunk get a chunk of their own. */
+    char *big = mc_arena_alloc(&arena, 64, 100000);
+    MC_ASSERT_NOT_NULL(big);
+    MC_ASSERT_EQ_SIZE((uintptr_t)big % 64, 0);
+    memset(big, 1, 100000);
+    MC_ASSERT_GE_SIZE(mc_arena_used(&arena), 100000);
+
+    mc_arena_cleanup(&arena);
+}
+
+MC_TEST_IN_SUITE(arena, last_block_realloc_and_free)
+{
+    struct mc_arena arena;
+    mc_arena_init(&arena, 4096);
+
+    char *a = mc_arena_alloc(&arena, 8, 64);
+    size_t used = mc_arena_used(&arena);
+    char *b = mc_arena_realloc(&arena, a, 8, 64, 128);
+    MC_ASSERT_EQ_PTR(a, b);
+    MC_ASSERT_EQ_SIZE(mc_arena_used(&arena), used + 64);
+
+    mc_arena_free(&arena, b, 128);
+    MC_ASSERT_EQ_SIZE(mc_arena_used(&arena), used - 64);
+
+    a = mc_arena_alloc(&arena, 8, 32);
+    memset(a, 7, 32);
+    char *c = mc_arena_alloc(&arena, 8, 32);
+    char *moved = mc_arena_realloc(&arena, a, 8, 32, 64);
+    MC_ASSERT_TRUE(moved != a);
+    MC_ASSERT_EQ_INT(moved[31], 7);
+
+    /* Freeing anything but the last block is a no-op. */
+    used = mc_arena_used(&arena);
+    mc_arena_free(&arena, c, 32);
+    MC_ASSERT_EQ_SIZE(mc_arena_used(&arena), used);
+
+    mc_arena_cleanup(&arena);
+}
+
+MC_TEST_IN_SUITE(arena, mark_rewind_reset)
+{
+    struct mc_arena arena;
+    mc_arena_init(&arena, 256);
+
+    struct mc_arena_mark empty = mc_arena_mark(&arena);
+    mc_arena_alloc(&arena, 8, 100);
+    struct mc_arena_mark mark = mc_arena_mark(&arena);
+    size_t used = mc_arena_used(&arena);
+
+    for (int i = 0; i < 100; i++)
+        mc_arena_alloc(&arena, 8, 100);
+    MC_ASSERT_GT_SIZE(mc_arena_used(&arena), 10000);
+
+    mc_arena_rewind(&arena, mark);
+    MC_ASSERT_EQ_SIZE(mc_arena_used(&arena), used);
+
+    /* Chunks are reused after a rewind instead of allocating again. */
+    char *first = mc_arena_alloc(&arena, 8, 100);
+    mc_arena_rewind(&arena, mark);
+    MC_ASSERT_EQ_PTR(mc_arena_alloc(&arena, 8, 100), first);
+
+    mc_arena_reset(&arena);
+    MC_ASSERT_EQ_SIZE(mc_arena_used(&arena), 0);
+    for (int i = 0; i < 100; i++)
+        mc_arena_alloc(&arena, 8, 100);
+    mc_arena_rewind(&arena, empty);
+    MC_ASSERT_EQ_SIZE(mc_arena_used(&arena), 0);
+
+    mc_arena_cleanup(&arena);
+}
+
+MC_TEST_IN_SUITE(arena, backing_containers)
+{
+    struct mc_arena arena;
+    mc_arena_init(&arena, 0);
+    struct mc_allocator const *allocator = mc_arena_allocator(&arena);
+
+    for (int round = 0; round < 3; round++) {
+        struct mc_array array;
+        mc_array_init_with_allocator(&array, int_get_mc_type(), allocator);
+        for (int i = 0; i < 10000; i++)
+            mc_array_push(&array, &i);
+        for (size_t i = 0; i < 10000; i++)
+            MC_ASSERT_EQ_INT(*(int *)mc_array_get(&array, i), (int)i);
+
+        struct mc_string str;
+        mc_string_init_with_allocator(&str, allocator);
+        for (int i = 0; i < 1000; i++)
+            mc_string_append(&str, "xy");
+        MC_ASSERT_EQ_SIZE(mc_string_len(&str), 2000);
+
+        struct mc_map map;
+        mc_map_init_with_allocator(&map, int_get_mc_type(), int_get_mc_type(),
+                                   allocator);
+        for (int i = 0; i < 500; i++)
+            mc_map_insert(&map, &(int){i}, &(int){-i});
+        MC_ASSERT_EQ_INT(*(int *)mc_map_get(&map, &(int){321}), -321);
+
+        /* Plain data needs no per-container cleanup before a reset. */
+        mc_arena_reset(&arena);
+    }
+
+    mc_arena_cleanup(&arena);
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_arena();
+    register_test_arena_alloc_alignment();
+    register_test_arena_last_block_realloc_and_free();
+    register_test_arena_mark_rewind_reset();
+    register_test_arena_backing_containers();
+#endif
+    return mc_run_all_tests();
+}
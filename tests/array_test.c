@@ -156,6 +156,66 @@ MC_TEST_IN_SUITE(array, search_functions)
     mc_array_cleanup(&array);
 }
 
+MC_TEST_IN_SUITE(array, search_integer_types)
+{
+    struct mc_array array;
+
+    /* Long enough to take the vectorized path, with a scalar tail. */
+    size_t const n = 1000 + 7;
+
+    MC_ASSERT_TRUE(mc_type_is_integer(int_get_mc_type()));
+    MC_ASSERT_TRUE(mc_type_is_integer(size_get_mc_type()));
+    MC_ASSERT_FALSE(mc_type_is_integer(double_get_mc_type()));
+    MC_ASSERT_FALSE(mc_type_is_integer(str_get_mc_type()));
+
+    mc_array_init(&array, uint8_get_mc_type());
+    for (size_t i = 0; i < n; i++) {
+        uint8_t v = (uint8_t)(i % 200);
+        mc_array_push(&array, &v);
+    }
+    uint8_t u8 = 199;
+    MC_ASSERT_EQ_PTR(mc_array_find(&array, &u8), mc_array_get(&array, 199));
+    u8 = 250;
+    MC_ASSERT_FALSE(mc_array_contains(&array, &u8));
+    mc_array_cleanup(&array);
+
+    mc_array_init(&array, short_get_mc_type());
+    for (size_t i = 0; i < n; i++) {
+        short v = (short)-(int)i;
+        mc_array_push(&array, &v);
+    }
+    short s16 = -(short)(n - 1);
+    MC_ASSERT_EQ_PTR(mc_array_find(&array, &s16), mc_array_get(&array, n - 1));
+    s16 = 1;
+    MC_ASSERT_NULL(mc_array_find(&array, &s16));
+    mc_array_cleanup(&array);
+
+    mc_array_init(&array, int_get_mc_type());
+    for (size_t i = 0; i < n; i++) {
+        int v = (int)i * 3;
+        mc_array_push(&array, &v);
+    }
+    for (size_t i = 0; i < n; i += 37) {
+        int v = (int)i * 3;
+        MC_ASSERT_EQ_PTR(mc_array_find(&array, &v), mc_array_get(&array, i));
+        v += 1;
+        MC_ASSERT_FALSE(mc_array_contains(&array, &v));
+    }
+    mc_array_cleanup(&array);
+
+    mc_array_init(&array, uint64_get_mc_type());
+    for (size_t i = 0; i < n; i++) {
+        /* Only the high halves differ, which checks 64-bit equality. */
+        uint64_t v = (uint64_t)i << 32 | 0xabcdu;
+        mc_array_push(&array, &v);
+    }
+    uint64_t u64 = (uint64_t)(n - 2) << 32 | 0xabcdu;
+    MC_ASSERT_EQ_PTR(mc_array_find(&array, &u64), mc_array_get(&array, n - 2));
+    u64 = 0xabcdu | (uint64_t)1 << 63;
+    MC_ASSERT_FALSE(mc_array_contains(&array, &u64));
+    mc_array_cleanup(&array);
+}
+
 static int desc_compare(void const *a, void const *b)
 {
     int val_a = *(int *)a;
@@ -190,6 +250,83 @@ MC_TEST_IN_SUITE(array, sort_functions)
     mc_array_cleanup(&array);
 }
 
+struct stable_record {
+    int key;
+    int seq;
+};
+
+static int stable_record_compare(void const *a, void const *b)
+{
+    struct stable_record const *ra = a;
+    struct stable_record const *rb = b;
+    return ra->key > rb->key ? 1 : (ra->key < rb->key ? -1 : 0);
+}
+
+static bool stable_record_equal(void const *a, void const *b)
+{
+    return stable_record_compare(a, b) == 0;
+}
+
+static size_t stable_record_hash(void const *data)
+{
+    struct stable_record const *r = data;
+    return (size_t)r->key;
+}
+
+MC_DEFINE_POD_TYPE(stable_record, struct stable_record, stable_record_compare,
+                   stable_record_equal, stable_record_hash)
+
+MC_TEST_IN_SUITE(array, stable_sort)
+{
+    struct mc_array array;
+    mc_array_init(&array, stable_record_get_mc_type());
+
+    /* Few distinct keys, long ascending and descending stretches and random
+     * noise so that run detection, insertion sort and merging all kick in. */
+    size_t const n = 5000;
+    unsigned int seed = 12345;
+    for (size_t i = 0; i < n; i++) {
+        struct stable_record r;
+        seed = seed * 1103515245 + 12345;
+        if (i < 1500)
+            r.key = (int)(i / 10) % 16;
+        else if (i < 3000)
+            r.key = (int)(3000 - i) % 16;
+        else
+            r.key = (int)((seed >> 16) % 16);
+        r.seq = (int)i;
+        mc_array_push(&array, &r);
+    }
+
+    mc_array_stable_sort(&array);
+
+    MC_ASSERT_EQ_SIZE(mc_array_len(&array), n);
+    for (size_t i = 1; i < n; i++) {
+        struct stable_record *prev = mc_array_get(&array, i - 1);
+        struct stable_record *curr = mc_array_get(&array, i);
+        MC_ASSERT_LE_INT(prev->key, curr->key);
+        if (prev->key == curr->key)
+            MC_ASSERT_LT_INT(prev->seq, curr->seq);
+    }
+
+    mc_array_cleanup(&array);
+
+    int values[] = {5, 4, 3, 2, 1, 9, 8, 7, 6, 0};
+    mc_array_from(&array, int_get_mc_type(), values, 10);
+
+    mc_array_stable_sort(&array);
+    for (size_t i = 0; i < 10; i++) {
+        MC_ASSERT_EQ_INT(*(int *)mc_array_get(&array, i), (int)i);
+    }
+
+    mc_array_stable_sort_with(&array, desc_compare);
+    for (size_t i = 0; i < 10; i++) {
+        MC_ASSERT_EQ_INT(*(int *)mc_array_get(&array, i), 9 - (int)i);
+    }
+
+    mc_array_cleanup(&array);
+}
+
 MC_TEST_IN_SUITE(array, binary_search)
 {
     struct mc_array array;
@@ -219,6 +356,49 @@ MC_TEST_IN_SUITE(array, binary_search)
     mc_array_cleanup(&array);
 }
 
+MC_TEST_IN_SUITE(array, binary_search_branchless)
+{
+    struct mc_array array;
+    mc_array_init(&array, int_get_mc_type());
+
+    size_t index;
+    int search_val = 1;
+    MC_ASSERT_FALSE(
+        mc_array_binary_search_branchless(&array, &search_val, &index));
+
+    for (size_t n = 1; n <= 33; n++) {
+        mc_array_clear(&array);
+        for (size_t i = 0; i < n; i++)
+            mc_array_push(&array, &(int){(int)i * 10});
+
+        for (size_t i = 0; i < n; i++) {
+            search_val = (int)i * 10;
+            MC_ASSERT_TRUE(
+                mc_array_binary_search_branchless(&array, &search_val, &index));
+            MC_ASSERT_EQ_SIZE(index, i);
+
+            search_val += 5;
+            MC_ASSERT_FALSE(
+                mc_array_binary_search_branchless(&array, &search_val, NULL));
+        }
+
+        search_val = -5;
+        MC_ASSERT_FALSE(
+            mc_array_binary_search_branchless(&array, &search_val, NULL));
+    }
+
+    /* Duplicates resolve to the first matching element. */
+    int values[] = {1, 2, 2, 2, 2, 3};
+    mc_array_clear(&array);
+    mc_array_append_range(&array, values, 6);
+    search_val = 2;
+    MC_ASSERT_TRUE(
+        mc_array_binary_search_branchless(&array, &search_val, &index));
+    MC_ASSERT_EQ_SIZE(index, 1);
+
+    mc_array_cleanup(&array);
+}
+
 MC_TEST_IN_SUITE(array, copy_and_move)
 {
     struct mc_array src, dst;
@@ -598,6 +778,140 @@ MC_TEST_IN_SUITE(array, insert_remove)
     mc_array_cleanup(&array);
 }
 
+MC_TEST_IN_SUITE(array, emplace)
+{
+    struct mc_array array;
+    mc_array_init(&array, test_object_get_mc_type());
+
+    struct test_object *obj = mc_array_emplace_back(&array);
+    test_object_init(obj, 1, "one");
+    obj = mc_array_emplace_back(&array);
+    test_object_init(obj, 3, "three");
+    obj = mc_array_emplace_at(&array, 1);
+    test_object_init(obj, 2, "two");
+    obj = mc_array_emplace_at(&array, 0);
+    test_object_init(obj, 0, "zero");
+
+    MC_ASSERT_EQ_SIZE(mc_array_len(&array), 4);
+    char const *names[] = {"zero", "one", "two", "three"};
+    for (size_t i = 0; i < 4; i++) {
+        obj = mc_array_get(&array, i);
+        MC_ASSERT_EQ_INT(obj->id, (int)i);
+        MC_ASSERT_EQ_STR(obj->name, names[i]);
+    }
+
+    mc_array_cleanup(&array);
+
+    mc_array_init(&array, int_get_mc_type());
+    mc_array_push(&array, &(int){-1});
+
+    int *slots = mc_array_extend_uninit(&array, 100);
+    MC_ASSERT_EQ_SIZE(mc_array_len(&array), 101);
+    MC_ASSERT_GE_SIZE(mc_array_capacity(&array), 101);
+    for (int i = 0; i < 100; i++)
+        slots[i] = i;
+
+    MC_ASSERT_EQ_INT(*(int *)mc_array_get(&array, 0), -1);
+    for (size_t i = 1; i < 101; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_array_get(&array, i), (int)i - 1);
+
+    slots = mc_array_extend_uninit(&array, 0);
+    MC_ASSERT_EQ_PTR(slots, mc_array_get_unchecked(&array, 101));
+    MC_ASSERT_EQ_SIZE(mc_array_len(&array), 101);
+
+    mc_array_cleanup(&array);
+}
+
+static bool test_object_id_below(void const *elem, void const *user_data)
+{
+    return ((struct test_object const *)elem)->id < *(int const *)user_data;
+}
+
+MC_TEST_IN_SUITE(array, swap_remove)
+{
+    int elems[] = {10, 20, 30, 40, 50};
+    struct mc_array array;
+    mc_array_from(&array, int_get_mc_type(), elems, 5);
+
+    int removed;
+    mc_array_swap_remove(&array, 1, &removed);
+    MC_ASSERT_EQ_INT(removed, 20);
+    MC_ASSERT_EQ_SIZE(mc_array_len(&array), 4);
+    MC_ASSERT_EQ_INT(*(int *)mc_array_get(&array, 1), 50);
+
+    mc_array_swap_remove(&array, 3, &removed);
+    MC_ASSERT_EQ_INT(removed, 40);
+    MC_ASSERT_EQ_SIZE(mc_array_len(&array), 3);
+
+    int expected[] = {10, 50, 30};
+    for (size_t i = 0; i < 3; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_array_get(&array, i), expected[i]);
+
+    mc_array_cleanup(&array);
+
+    mc_array_init(&array, test_object_get_mc_type());
+    for (int i = 0; i < 3; i++)
+        test_object_init(mc_array_emplace_back(&array), i, "obj");
+
+    mc_array_swap_remove(&array, 0, NULL);
+    MC_ASSERT_EQ_SIZE(mc_array_len(&array), 2);
+    MC_ASSERT_EQ_INT(((struct test_object *)mc_array_get(&array, 0))->id, 2);
+
+    mc_array_cleanup(&array);
+}
+
+MC_TEST_IN_SUITE(array, retain_and_dedup)
+{
+    struct mc_array array;
+    mc_array_init(&array, int_get_mc_type());
+    for (int i = 0; i < 100; i++)
+        mc_array_push(&array, &i);
+
+    mc_array_retain(&array, is_even, NULL);
+    MC_ASSERT_EQ_SIZE(mc_array_len(&array), 50);
+    for (size_t i = 0; i < 50; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_array_get(&array, i), (int)i * 2);
+
+    mc_array_retain(&array, is_even, NULL);
+    MC_ASSERT_EQ_SIZE(mc_array_len(&array), 50);
+
+    mc_array_clear(&array);
+    int dups[] = {1, 1, 2, 3, 3, 3, 1, 4, 4};
+    mc_array_append_range(&array, dups, 9);
+    mc_array_dedup(&array);
+
+    int expected[] = {1, 2, 3, 1, 4};
+    MC_ASSERT_EQ_SIZE(mc_array_len(&array), 5);
+    for (size_t i = 0; i < 5; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_array_get(&array, i), expected[i]);
+
+    mc_array_clear(&array);
+    mc_array_dedup(&array);
+    MC_ASSERT_TRUE(mc_array_is_empty(&array));
+
+    mc_array_cleanup(&array);
+
+    /* Removed owning elements must be cleaned up exactly once. */
+    mc_array_init(&array, test_object_get_mc_type());
+    int ids[] = {0, 7, 1, 8, 9, 2, 3, 3, 9};
+    for (size_t i = 0; i < 9; i++)
+        test_object_init(mc_array_emplace_back(&array), ids[i], "obj");
+
+    int limit = 5;
+    mc_array_retain(&array, test_object_id_below, &limit);
+    mc_array_dedup(&array);
+
+    int kept[] = {0, 1, 2, 3};
+    MC_ASSERT_EQ_SIZE(mc_array_len(&array), 4);
+    for (size_t i = 0; i < 4; i++) {
+        struct test_object *obj = mc_array_get(&array, i);
+        MC_ASSERT_EQ_INT(obj->id, kept[i]);
+        MC_ASSERT_EQ_STR(obj->name, "obj");
+    }
+
+    mc_array_cleanup(&array);
+}
+
 MC_TEST_IN_SUITE(array, range_operations)
 {
     struct mc_array array;
@@ -750,14 +1064,20 @@ int main(void)
     register_test_suite_array();
     register_test_array_init();
     register_test_array_search_functions();
+    register_test_array_search_integer_types();
     register_test_array_sort_functions();
+    register_test_array_stable_sort();
     register_test_array_binary_search();
+    register_test_array_binary_search_branchless();
     register_test_array_copy_and_move();
     register_test_array_compare_and_equal();
     register_test_array_hash_function();
     register_test_array_capacity_management();
     register_test_array_boundary_conditions();
     register_test_array_insert_remove();
+    register_test_array_emplace();
+    register_test_array_swap_remove();
+    register_test_array_retain_and_dedup();
     register_test_array_range_operations();
     register_test_array_custom_type();
     register_test_array_init_with_capacity();
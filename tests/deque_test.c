@@ -0,0 +1,163 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/deque.h"
+#include "myclib/string.h"
+#include "myclib/test.h"
+#include "myclib/type.h"
+
+MC_TEST_SUITE(deque);
+
+MC_TEST_IN_SUITE(deque, init)
+{
+    struct mc_deque deque;
+    mc_deque_init(&deque, int_get_mc_type());
+    MC_ASSERT_EQ_SIZE(mc_deque_len(&deque), 0);
+    MC_ASSERT_EQ_SIZE(mc_deque_capacity(&deque), 0);
+    MC_ASSERT_TRUE(mc_deque_is_empty(&deque));
+    MC_ASSERT_NULL(mc_deque_get_front(&deque));
+    MC_ASSERT_NULL(mc_deque_get_back(&deque));
+    MC_ASSERT_FALSE(mc_deque_pop_front(&deque, NULL));
+    MC_ASSERT_FALSE(mc_deque_pop_back(&deque, NULL));
+    mc_deque_cleanup(&deque);
+
+    mc_deque_with_capacity(&deque, int_get_mc_type(), 5);
+    MC_ASSERT_EQ_SIZE(mc_deque_capacity(&deque), 8);
+    mc_deque_cleanup(&deque);
+}
+
+MC_TEST_IN_SUITE(deque, push_pop_both_ends)
+{
+    struct mc_deque deque;
+    mc_deque_init(&deque, int_get_mc_type());
+
+    for (int i = 0; i < 5; i++) {
+        mc_deque_push_back(&deque, &(int){i});
+        mc_deque_push_front(&deque, &(int){-i - 1});
+    }
+
+    MC_ASSERT_EQ_SIZE(mc_deque_len(&deque), 10);
+    MC_ASSERT_TRUE(mc_is_pow_of_two(mc_deque_capacity(&deque)));
+    for (size_t i = 0; i < 10; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_deque_get(&deque, i), (int)i - 5);
+    MC_ASSERT_NULL(mc_deque_get(&deque, 10));
+
+    int out;
+    MC_ASSERT_TRUE(mc_deque_pop_front(&deque, &out));
+    MC_ASSERT_EQ_INT(out, -5);
+    MC_ASSERT_TRUE(mc_deque_pop_back(&deque, &out));
+    MC_ASSERT_EQ_INT(out, 4);
+    MC_ASSERT_EQ_INT(*(int *)mc_deque_get_front(&deque), -4);
+    MC_ASSERT_EQ_INT(*(int *)mc_deque_get_back(&deque), 3);
+
+    mc_deque_cleanup(&deque);
+}
+
+MC_TEST_IN_SUITE(deque, wrap_around_growth)
+{
+    struct mc_deque deque;
+    mc_deque_with_capacity(&deque, int_get_mc_type(), 8);
+
+    /* Rotate the head so the contents wrap before the buffer grows. */
+    for (int i = 0; i < 6; i++)
+        mc_deque_push_back(&deque, &(int){i});
+    for (int i = 0; i < 5; i++)
+        MC_ASSERT_TRUE(mc_deque_pop_front(&deque, NULL));
+    for (int i = 6; i < 13; i++)
+        mc_deque_push_back(&deque, &(int){i});
+    MC_ASSERT_EQ_SIZE(mc_deque_capacity(&deque), 8);
+
+    for (int i = 13; i < 40; i++)
+        mc_deque_push_back(&deque, &(int){i});
+    MC_ASSERT_EQ_SIZE(mc_deque_len(&deque), 35);
+    for (size_t i = 0; i < 35; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_deque_get(&deque, i), (int)i + 5);
+
+    for (int i = 0; i < 30; i++)
+        MC_ASSERT_TRUE(mc_deque_pop_back(&deque, NULL));
+    mc_deque_shrink_to_fit(&deque);
+    MC_ASSERT_EQ_SIZE(mc_deque_capacity(&deque), 8);
+    for (size_t i = 0; i < 5; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_deque_get(&deque, i), (int)i + 5);
+
+    mc_deque_cleanup(&deque);
+}
+
+MC_TEST_IN_SUITE(deque, owning_elements)
+{
+    struct mc_deque deque;
+    mc_deque_init(&deque, mc_string_get_mc_type());
+
+    for (int i = 0; i < 20; i++) {
+        struct mc_string str;
+        mc_string_format(&str, "value %d", i);
+        if (i % 2)
+            mc_deque_push_back(&deque, &str);
+        else
+            mc_deque_push_front(&deque, &str);
+    }
+
+    struct mc_deque copy;
+    mc_deque_copy(&copy, &deque);
+    MC_ASSERT_TRUE(mc_deque_equal(&copy, &deque));
+    MC_ASSERT_EQ_INT(mc_deque_compare(&copy, &deque), 0);
+    MC_ASSERT_EQ_SIZE(mc_deque_hash(&copy), mc_deque_hash(&deque));
+
+    struct mc_string out;
+    MC_ASSERT_TRUE(mc_deque_pop_front(&copy, &out));
+    MC_ASSERT_EQ_STR(mc_string_c_str(&out), "value 18");
+    mc_string_cleanup(&out);
+    MC_ASSERT_FALSE(mc_deque_equal(&copy, &deque));
+
+    /* Popping without an output slot cleans the element up. */
+    MC_ASSERT_TRUE(mc_deque_pop_back(&copy, NULL));
+
+    struct mc_deque moved;
+    mc_deque_move(&moved, &copy);
+    MC_ASSERT_EQ_SIZE(mc_deque_len(&moved), 18);
+    MC_ASSERT_TRUE(mc_deque_is_empty(&copy));
+
+    mc_deque_cleanup(&copy);
+    mc_deque_cleanup(&moved);
+    mc_deque_cleanup(&deque);
+}
+
+MC_TEST_IN_SUITE(deque, iter)
+{
+    struct mc_deque deque;
+    mc_deque_with_capacity(&deque, int_get_mc_type(), 4);
+
+    struct mc_iter iter;
+    mc_deque_iter_init(&iter, &deque);
+    MC_ASSERT_FALSE(iter.next(&iter));
+
+    mc_deque_push_back(&deque, &(int){2});
+    mc_deque_push_back(&deque, &(int){3});
+    mc_deque_push_front(&deque, &(int){1});
+    mc_deque_push_front(&deque, &(int){0});
+
+    mc_deque_iter_init(&iter, &deque);
+    int expected = 0;
+    while (iter.next(&iter)) {
+        MC_ASSERT_EQ_INT(*(int *)iter.value, expected);
+        expected++;
+    }
+    MC_ASSERT_EQ_INT(expected, 4);
+
+    mc_deque_cleanup(&deque);
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_deque();
+    register_test_deque_init();
+    register_test_deque_push_pop_both_ends();
+    register_test_deque_wrap_around_growth();
+    register_test_deque_owning_elements();
+    register_test_deque_iter();
+#endif
+    return mc_run_all_tests();
+}
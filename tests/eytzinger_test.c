@@ -0,0 +1,130 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/eytzinger.h"
+#include "myclib/array.h"
+#include "myclib/string.h"
+#include "myclib/test.h"
+#include "myclib/type.h"
+
+MC_TEST_SUITE(eytzinger);
+
+MC_TEST_IN_SUITE(eytzinger, empty)
+{
+    struct mc_array array;
+    mc_array_init(&array, int_get_mc_type());
+
+    struct mc_eytzinger index;
+    mc_eytzinger_init(&index, &array);
+    MC_ASSERT_EQ_SIZE(mc_eytzinger_len(&index), 0);
+
+    int val = 1;
+    MC_ASSERT_NULL(mc_eytzinger_lower_bound(&index, &val));
+    MC_ASSERT_NULL(mc_eytzinger_find(&index, &val));
+
+    mc_eytzinger_cleanup(&index);
+    mc_array_cleanup(&array);
+}
+
+MC_TEST_IN_SUITE(eytzinger, lower_bound_all_sizes)
+{
+    /* Every size up to a few full levels, including non-perfect trees. */
+    for (size_t n = 1; n <= 70; n++) {
+        struct mc_array array;
+        mc_array_init(&array, int_get_mc_type());
+        for (size_t i = 0; i < n; i++)
+            mc_array_push(&array, &(int){(int)i * 2});
+
+        struct mc_eytzinger index;
+        mc_eytzinger_init(&index, &array);
+        MC_ASSERT_EQ_SIZE(mc_eytzinger_len(&index), n);
+
+        for (int val = -1; val <= (int)n * 2; val++) {
+            int *lb = mc_eytzinger_lower_bound(&index, &val);
+            int *found = mc_eytzinger_find(&index, &val);
+            int expected = val < 0 ? 0 : (val + 1) / 2 * 2;
+
+            if (expected >= (int)n * 2) {
+                MC_ASSERT_NULL(lb);
+            } else {
+                MC_ASSERT_NOT_NULL(lb);
+                MC_ASSERT_EQ_INT(*lb, expected);
+            }
+
+            if (val >= 0 && val % 2 == 0 && val < (int)n * 2) {
+                MC_ASSERT_NOT_NULL(found);
+                MC_ASSERT_EQ_INT(*found, val);
+            } else {
+                MC_ASSERT_NULL(found);
+            }
+        }
+
+        mc_eytzinger_cleanup(&index);
+        mc_array_cleanup(&array);
+    }
+}
+
+MC_TEST_IN_SUITE(eytzinger, duplicates)
+{
+    int values[] = {1, 3, 3, 3, 5, 5, 9};
+    struct mc_array array;
+    mc_array_from(&array, int_get_mc_type(), values, 7);
+
+    struct mc_eytzinger index;
+    mc_eytzinger_init(&index, &array);
+
+    int val = 3;
+    MC_ASSERT_EQ_INT(*(int *)mc_eytzinger_find(&index, &val), 3);
+    val = 4;
+    MC_ASSERT_EQ_INT(*(int *)mc_eytzinger_lower_bound(&index, &val), 5);
+    MC_ASSERT_NULL(mc_eytzinger_find(&index, &val));
+
+    mc_eytzinger_cleanup(&index);
+    mc_array_cleanup(&array);
+}
+
+MC_TEST_IN_SUITE(eytzinger, owning_elements)
+{
+    char const *words[] = {"apple", "banana", "cherry", "grape", "melon"};
+    struct mc_array array;
+    mc_array_init(&array, mc_string_get_mc_type());
+    for (size_t i = 0; i < 5; i++) {
+        struct mc_string str;
+        mc_string_from(&str, words[i]);
+        mc_array_push(&array, &str);
+    }
+    mc_array_sort(&array);
+
+    struct mc_eytzinger index;
+    mc_eytzinger_init(&index, &array);
+
+    /* The index keeps its own copies. */
+    mc_array_cleanup(&array);
+
+    struct mc_string key;
+    mc_string_from(&key, "cherry");
+    struct mc_string *found = mc_eytzinger_find(&index, &key);
+    MC_ASSERT_NOT_NULL(found);
+    MC_ASSERT_EQ_STR(mc_string_c_str(found), "cherry");
+    mc_string_cleanup(&key);
+
+    mc_string_from(&key, "kiwi");
+    MC_ASSERT_NULL(mc_eytzinger_find(&index, &key));
+    mc_string_cleanup(&key);
+
+    mc_eytzinger_cleanup(&index);
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_eytzinger();
+    register_test_eytzinger_empty();
+    register_test_eytzinger_lower_bound_all_sizes();
+    register_test_eytzinger_duplicates();
+    register_test_eytzinger_owning_elements();
+#endif
+    return mc_run_all_tests();
+}
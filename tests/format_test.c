@@ -0,0 +1,143 @@
+#include <float.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/format.h"
+#include "myclib/test.h"
+
+MC_TEST_SUITE(format);
+
+static uint64_t state = 88172645463325252ull;
+
+static uint64_t next_random(void)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static bool f64_is(double value, char const *expected)
+{
+    char buf[MC_FORMAT_F64_MAX + 1];
+    buf[mc_format_f64(buf, value)] = '\0';
+    return strcmp(buf, expected) == 0;
+}
+
+MC_TEST_IN_SUITE(format, integers)
+{
+    char buf[32], expected[32];
+    buf[mc_format_u64(buf, 0)] = '\0';
+    MC_ASSERT_EQ_STR(buf, "0");
+    buf[mc_format_u64(buf, UINT64_MAX)] = '\0';
+    MC_ASSERT_EQ_STR(buf, "18446744073709551615");
+    buf[mc_format_i64(buf, INT64_MIN)] = '\0';
+    MC_ASSERT_EQ_STR(buf, "-9223372036854775808");
+    buf[mc_format_i64(buf, -7)] = '\0';
+    MC_ASSERT_EQ_STR(buf, "-7");
+    buf[mc_format_hex(buf, 0)] = '\0';
+    MC_ASSERT_EQ_STR(buf, "0");
+    buf[mc_format_hex(buf, UINT64_MAX)] = '\0';
+    MC_ASSERT_EQ_STR(buf, "ffffffffffffffff");
+
+    /* Every digit count, for both parities of the pair loop */
+    for (size_t i = 0; i < 100000; i++) {
+        uint64_t const value = next_random() >> (i % 64);
+        int64_t const signed_value = (int64_t)next_random() >> (i % 64);
+
+        buf[mc_format_u64(buf, value)] = '\0';
+        snprintf(expected, sizeof(expected), "%" PRIu64, value);
+        MC_ASSERT_EQ_STR(buf, expected);
+        buf[mc_format_i64(buf, signed_value)] = '\0';
+        snprintf(expected, sizeof(expected), "%" PRId64, signed_value);
+        MC_ASSERT_EQ_STR(buf, expected);
+        buf[mc_format_hex(buf, value)] = '\0';
+        snprintf(expected, sizeof(expected), "%" PRIx64, value);
+        MC_ASSERT_EQ_STR(buf, expected);
+    }
+}
+
+MC_TEST_IN_SUITE(format, f64_layout)
+{
+    MC_ASSERT_TRUE(f64_is(0.0, "0"));
+    MC_ASSERT_TRUE(f64_is(-0.0, "-0"));
+    MC_ASSERT_TRUE(f64_is(1.0, "1"));
+    MC_ASSERT_TRUE(f64_is(-1.5, "-1.5"));
+    MC_ASSERT_TRUE(f64_is(0.1, "0.1"));
+    MC_ASSERT_TRUE(f64_is(0.3, "0.3"));
+    MC_ASSERT_TRUE(f64_is(2.0 / 3.0, "0.6666666666666666"));
+    MC_ASSERT_TRUE(f64_is(123.456, "123.456"));
+    MC_ASSERT_TRUE(f64_is(1e20, "100000000000000000000"));
+    MC_ASSERT_TRUE(f64_is(1e21, "1e+21"));
+    MC_ASSERT_TRUE(f64_is(1.5e300, "1.5e+300"));
+    MC_ASSERT_TRUE(f64_is(1e-6, "0.000001"));
+    MC_ASSERT_TRUE(f64_is(-1.25e-6, "-0.00000125"));
+    MC_ASSERT_TRUE(f64_is(1e-7, "1e-7"));
+    MC_ASSERT_TRUE(f64_is(5e-324, "5e-324"));
+    MC_ASSERT_TRUE(f64_is(DBL_MIN, "2.2250738585072014e-308"));
+    MC_ASSERT_TRUE(f64_is(DBL_MAX, "1.7976931348623157e+308"));
+    MC_ASSERT_TRUE(f64_is(9007199254740993.0, "9007199254740992"));
+    MC_ASSERT_TRUE(f64_is(NAN, "nan"));
+    MC_ASSERT_TRUE(f64_is(INFINITY, "inf"));
+    MC_ASSERT_TRUE(f64_is(-INFINITY, "-inf"));
+}
+
+/* Significant digits in a formatted double. */
+static size_t significant_digits(char const *text)
+{
+    size_t count = 0, zeros = 0;
+    for (char const *p = text; *p && *p != 'e'; ++p) {
+        if (*p == '0' && count == 0)
+            continue;
+        if (*p < '0' || *p > '9')
+            continue;
+        ++count;
+        zeros = *p == '0' ? zeros + 1 : 0;
+    }
+    return count - zeros;
+}
+
+MC_TEST_IN_SUITE(format, f64_round_trip)
+{
+    char buf[MC_FORMAT_F64_MAX + 1];
+
+    /* Any bit pattern, so subnormals and every exponent come up */
+    for (size_t i = 0; i < 200000; i++) {
+        uint64_t bits = next_random();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (isnan(value) || isinf(value))
+            continue;
+        size_t const len = mc_format_f64(buf, value);
+        MC_ASSERT_TRUE(len <= MC_FORMAT_F64_MAX);
+        buf[len] = '\0';
+        double const back = strtod(buf, NULL);
+        MC_ASSERT_TRUE(memcmp(&back, &value, sizeof(value)) == 0);
+        MC_ASSERT_TRUE(significant_digits(buf) <= 17);
+    }
+
+    /* Short decimals, as in prices and measurements, come back as typed */
+    for (int64_t i = -100000; i <= 100000; i += 7) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "%" PRId64 ".%03d",
+                 i / 1000, (int)(i < 0 ? -i : i) % 1000);
+        double const value = strtod(expected, NULL);
+        buf[mc_format_f64(buf, value)] = '\0';
+        MC_ASSERT_TRUE(strtod(buf, NULL) == value);
+        MC_ASSERT_TRUE(strlen(buf) <= strlen(expected));
+    }
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_format();
+    register_test_format_integers();
+    register_test_format_f64_layout();
+    register_test_format_f64_round_trip();
+#endif
+    return mc_run_all_tests();
+}
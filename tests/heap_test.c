@@ -0,0 +1,201 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/heap.h"
+#include "myclib/string.h"
+#include "myclib/test.h"
+#include "myclib/type.h"
+
+MC_TEST_SUITE(heap);
+
+static int int_compare_desc(void const *a, void const *b)
+{
+    int ia = *(int const *)a;
+    int ib = *(int const *)b;
+    return (ib > ia) - (ib < ia);
+}
+
+MC_TEST_IN_SUITE(heap, init)
+{
+    struct mc_heap heap;
+    mc_heap_init(&heap, int_get_mc_type());
+    MC_ASSERT_EQ_SIZE(mc_heap_len(&heap), 0);
+    MC_ASSERT_TRUE(mc_heap_is_empty(&heap));
+    MC_ASSERT_NULL(mc_heap_peek(&heap));
+    MC_ASSERT_FALSE(mc_heap_pop(&heap, NULL));
+    MC_ASSERT_NULL(mc_heap_get(&heap, 0));
+    MC_ASSERT_FALSE(mc_heap_contains(&heap, 0));
+    mc_heap_cleanup(&heap);
+}
+
+MC_TEST_IN_SUITE(heap, push_pop_arities)
+{
+    size_t arities[] = {2, 3, 4, 8};
+    for (size_t a = 0; a < sizeof(arities) / sizeof(arities[0]); a++) {
+        struct mc_heap heap;
+        mc_heap_init_with(&heap, int_get_mc_type(), arities[a],
+                          int_get_mc_type()->compare);
+
+        srand(42);
+        for (int i = 0; i < 1000; i++)
+            mc_heap_push(&heap, &(int){rand() % 500});
+        MC_ASSERT_EQ_SIZE(mc_heap_len(&heap), 1000);
+
+        int prev = -1;
+        int out;
+        while (mc_heap_pop(&heap, &out)) {
+            MC_ASSERT_GE_INT(out, prev);
+            prev = out;
+        }
+        MC_ASSERT_TRUE(mc_heap_is_empty(&heap));
+
+        mc_heap_cleanup(&heap);
+    }
+
+    struct mc_heap max_heap;
+    mc_heap_init_with(&max_heap, int_get_mc_type(), 2, int_compare_desc);
+    for (int i = 0; i < 10; i++)
+        mc_heap_push(&max_heap, &i);
+    MC_ASSERT_EQ_INT(*(int *)mc_heap_peek(&max_heap), 9);
+    mc_heap_cleanup(&max_heap);
+}
+
+MC_TEST_IN_SUITE(heap, from_array)
+{
+    struct mc_array array;
+    mc_array_init(&array, int_get_mc_type());
+    for (int i = 0; i < 500; i++)
+        mc_array_push(&array, &(int){(i * 7919) % 500});
+
+    struct mc_heap heap;
+    mc_heap_from_array(&heap, &array, 4, int_get_mc_type()->compare);
+    MC_ASSERT_EQ_SIZE(mc_array_len(&array), 0);
+    MC_ASSERT_EQ_SIZE(mc_heap_len(&heap), 500);
+
+    for (size_t i = 0; i < 500; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_heap_get(&heap, i), (int)(i * 7919 % 500));
+
+    for (int i = 0; i < 500; i++) {
+        int out;
+        MC_ASSERT_TRUE(mc_heap_pop(&heap, &out));
+        MC_ASSERT_EQ_INT(out, i);
+    }
+
+    mc_heap_cleanup(&heap);
+    mc_array_cleanup(&array);
+}
+
+MC_TEST_IN_SUITE(heap, handles)
+{
+    struct mc_heap heap;
+    mc_heap_init(&heap, int_get_mc_type());
+
+    size_t handles[100];
+    for (int i = 0; i < 100; i++)
+        handles[i] = mc_heap_push(&heap, &(int){1000 + i});
+
+    mc_heap_decrease_key(&heap, handles[50], &(int){1});
+    MC_ASSERT_EQ_INT(*(int *)mc_heap_peek(&heap), 1);
+    MC_ASSERT_EQ_INT(*(int *)mc_heap_get(&heap, handles[50]), 1);
+
+    *(int *)mc_heap_get(&heap, handles[50]) = 5000;
+    mc_heap_update(&heap, handles[50]);
+    MC_ASSERT_EQ_INT(*(int *)mc_heap_peek(&heap), 1000);
+
+    *(int *)mc_heap_get(&heap, handles[99]) = 0;
+    mc_heap_update(&heap, handles[99]);
+    MC_ASSERT_EQ_INT(*(int *)mc_heap_peek(&heap), 0);
+
+    int out;
+    mc_heap_remove(&heap, handles[10], &out);
+    MC_ASSERT_EQ_INT(out, 1010);
+    MC_ASSERT_FALSE(mc_heap_contains(&heap, handles[10]));
+    MC_ASSERT_NULL(mc_heap_get(&heap, handles[10]));
+
+    size_t reused = mc_heap_push(&heap, &(int){2});
+    MC_ASSERT_EQ_SIZE(reused, handles[10]);
+    MC_ASSERT_EQ_INT(*(int *)mc_heap_get(&heap, reused), 2);
+
+    for (int i = 0; i < 100; i++) {
+        if (i % 3 == 0 && i != 10)
+            mc_heap_remove(&heap, handles[i], NULL);
+    }
+
+    int prev = -1;
+    size_t count = 0;
+    while (mc_heap_pop(&heap, &out)) {
+        MC_ASSERT_GE_INT(out, prev);
+        MC_ASSERT_TRUE(out == 2 || out == 5000 ||
+                       (out - 1000) % 3 != 0);
+        prev = out;
+        count++;
+    }
+    MC_ASSERT_EQ_SIZE(count, 66);
+
+    mc_heap_cleanup(&heap);
+}
+
+MC_TEST_IN_SUITE(heap, reserve)
+{
+    struct mc_heap heap;
+    mc_heap_init(&heap, int_get_mc_type());
+    for (int i = 0; i < 10; i++)
+        mc_heap_push(&heap, &i);
+    for (int i = 0; i < 4; i++)
+        mc_heap_pop(&heap, NULL);
+
+    /* Four pushes reuse released handles, the rest need new ones */
+    mc_heap_reserve(&heap, 100);
+    void const *elems = heap.elems.data;
+    void const *handles = heap.handles.data;
+    void const *positions = heap.positions.data;
+    for (int i = 0; i < 100; i++)
+        mc_heap_push(&heap, &i);
+    MC_ASSERT_EQ_PTR(heap.elems.data, elems);
+    MC_ASSERT_EQ_PTR(heap.handles.data, handles);
+    MC_ASSERT_EQ_PTR(heap.positions.data, positions);
+    MC_ASSERT_EQ_SIZE(mc_heap_len(&heap), 106);
+
+    mc_heap_cleanup(&heap);
+}
+
+MC_TEST_IN_SUITE(heap, owning_elements)
+{
+    struct mc_heap heap;
+    mc_heap_init(&heap, mc_string_get_mc_type());
+
+    char const *words[] = {"pear", "fig", "banana", "kiwi", "apple"};
+    size_t handles[5];
+    for (size_t i = 0; i < 5; i++) {
+        struct mc_string str;
+        mc_string_from(&str, words[i]);
+        handles[i] = mc_heap_push(&heap, &str);
+    }
+
+    struct mc_string str;
+    mc_string_from(&str, "a");
+    mc_heap_decrease_key(&heap, handles[2], &str);
+    mc_heap_remove(&heap, handles[4], NULL);
+
+    MC_ASSERT_TRUE(mc_heap_pop(&heap, &str));
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "a");
+    mc_string_cleanup(&str);
+
+    mc_heap_cleanup(&heap);
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_heap();
+    register_test_heap_init();
+    register_test_heap_push_pop_arities();
+    register_test_heap_from_array();
+    register_test_heap_handles();
+    register_test_heap_reserve();
+    register_test_heap_owning_elements();
+#endif
+    return mc_run_all_tests();
+}
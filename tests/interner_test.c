@@ -0,0 +1,159 @@
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "myclib/interner.h"
+#include "myclib/test.h"
+
+MC_TEST_SUITE(interner);
+
+static struct mc_str_view word(char *buf, size_t size, unsigned i)
+{
+    int const len = snprintf(buf, size, "word-%u", i);
+    return mc_str_view_make(buf, (size_t)len);
+}
+
+MC_TEST_IN_SUITE(interner, intern_find_get)
+{
+    struct mc_interner interner;
+    mc_interner_init(&interner);
+    MC_ASSERT_EQ_SIZE(mc_interner_len(&interner), 0);
+
+    uint32_t const hello =
+        mc_interner_intern(&interner, mc_str_view_from_cstr("hello"));
+    uint32_t const world =
+        mc_interner_intern(&interner, mc_str_view_from_cstr("world"));
+    uint32_t const binary =
+        mc_interner_intern(&interner, mc_str_view_make("a\0b", 3));
+    uint32_t const empty =
+        mc_interner_intern(&interner, mc_str_view_make(NULL, 0));
+    MC_ASSERT_EQ_SIZE(hello, 0);
+    MC_ASSERT_EQ_SIZE(world, 1);
+    MC_ASSERT_EQ_SIZE(binary, 2);
+    MC_ASSERT_EQ_SIZE(empty, 3);
+    MC_ASSERT_EQ_SIZE(mc_interner_len(&interner), 4);
+
+    /* The same bytes give the same ID, without a new copy */
+    size_t const memory = mc_interner_memory(&interner);
+    MC_ASSERT_EQ_SIZE(
+        mc_interner_intern(&interner, mc_str_view_from_cstr("hello")), hello);
+    MC_ASSERT_EQ_SIZE(
+        mc_interner_intern(&interner, mc_str_view_from_cstr("")), empty);
+    MC_ASSERT_EQ_SIZE(mc_interner_memory(&interner), memory);
+    MC_ASSERT_EQ_SIZE(mc_interner_len(&interner), 4);
+
+    uint32_t id = 0;
+    MC_ASSERT_TRUE(
+        mc_interner_find(&interner, mc_str_view_make("a\0b", 3), &id));
+    MC_ASSERT_EQ_SIZE(id, binary);
+    MC_ASSERT_FALSE(
+        mc_interner_find(&interner, mc_str_view_make("a\0c", 3), &id));
+    MC_ASSERT_FALSE(
+        mc_interner_find(&interner, mc_str_view_from_cstr("hell"), &id));
+
+    struct mc_str_view view = mc_interner_get(&interner, binary);
+    MC_ASSERT_EQ_SIZE(view.len, 3);
+    MC_ASSERT_TRUE(memcmp(view.data, "a\0b", 4) == 0);
+    MC_ASSERT_EQ_STR(mc_interner_get(&interner, world).data, "world");
+    MC_ASSERT_EQ_SIZE(mc_interner_get(&interner, empty).len, 0);
+
+    mc_interner_cleanup(&interner);
+}
+
+MC_TEST_IN_SUITE(interner, many)
+{
+    struct mc_interner interner;
+    mc_interner_init(&interner);
+    char buf[32];
+    enum { COUNT = 100000 };
+
+    /* IDs stay dense and stable while the table grows under them */
+    for (unsigned i = 0; i < COUNT; i++)
+        MC_ASSERT_EQ_SIZE(
+            mc_interner_intern(&interner, word(buf, sizeof(buf), i)), i);
+    MC_ASSERT_EQ_SIZE(mc_interner_len(&interner), COUNT);
+    for (unsigned i = 0; i < COUNT; i++) {
+        uint32_t id;
+        struct mc_str_view const expected = word(buf, sizeof(buf), i);
+        MC_ASSERT_TRUE(mc_interner_find(&interner, expected, &id));
+        MC_ASSERT_EQ_SIZE(id, i);
+        MC_ASSERT_TRUE(
+            mc_str_view_equal(mc_interner_get(&interner, i), expected));
+    }
+
+    mc_interner_cleanup(&interner);
+}
+
+enum { THREADS = 4, PER_THREAD = 20000 };
+
+struct worker {
+    struct mc_interner *interner;
+    unsigned first;
+    uint32_t ids[PER_THREAD];
+    size_t misses;
+};
+
+/* Workers intern overlapping ranges while looking up the first words */
+static void *intern_worker_run(void *arg)
+{
+    struct worker *worker = arg;
+    char buf[32];
+    for (unsigned i = 0; i < PER_THREAD; i++) {
+        worker->ids[i] = mc_interner_intern(
+            worker->interner, word(buf, sizeof(buf), worker->first + i));
+        uint32_t id;
+        if (!mc_interner_find(worker->interner,
+                              word(buf, sizeof(buf), i % 100), &id) ||
+            !mc_str_view_equal(mc_interner_get(worker->interner, id),
+                               word(buf, sizeof(buf), i % 100)))
+            ++worker->misses;
+    }
+    return NULL;
+}
+
+MC_TEST_IN_SUITE(interner, threads)
+{
+    static struct worker workers[THREADS];
+    struct mc_interner interner;
+    mc_interner_init(&interner);
+    char buf[32];
+    for (unsigned i = 0; i < 100; i++)
+        mc_interner_intern(&interner, word(buf, sizeof(buf), i));
+
+    pthread_t threads[THREADS];
+    for (unsigned t = 0; t < THREADS; t++) {
+        workers[t].interner = &interner;
+        workers[t].first = t * PER_THREAD / 2;
+        workers[t].misses = 0;
+        MC_ASSERT_TRUE(pthread_create(&threads[t], NULL, intern_worker_run,
+                                      &workers[t]) == 0);
+    }
+    for (unsigned t = 0; t < THREADS; t++)
+        pthread_join(threads[t], NULL);
+
+    /* Each word got one ID, whichever thread came first */
+    size_t const distinct = (THREADS + 1) * PER_THREAD / 2;
+    MC_ASSERT_EQ_SIZE(mc_interner_len(&interner), distinct);
+    for (unsigned t = 0; t < THREADS; t++) {
+        MC_ASSERT_EQ_SIZE(workers[t].misses, 0);
+        for (unsigned i = 0; i < PER_THREAD; i++) {
+            struct mc_str_view const expected =
+                word(buf, sizeof(buf), workers[t].first + i);
+            MC_ASSERT_TRUE(mc_str_view_equal(
+                mc_interner_get(&interner, workers[t].ids[i]), expected));
+        }
+    }
+
+    mc_interner_cleanup(&interner);
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_interner();
+    register_test_interner_intern_find_get();
+    register_test_interner_many();
+    register_test_interner_threads();
+#endif
+    return mc_run_all_tests();
+}
@@ -0,0 +1,252 @@
+#include <stddef.h>
+#include <string.h>
+#include "myclib/array.h"
+#include "myclib/multi_search.h"
+#include "myclib/string.h"
+#include "myclib/test.h"
+
+MC_TEST_SUITE(multi_search);
+
+static void make_patterns(struct mc_array *patterns, char const *const *words,
+                          size_t count)
+{
+    mc_array_init(patterns, mc_string_get_mc_type());
+    for (size_t i = 0; i < count; i++) {
+        struct mc_string word;
+        mc_string_from(&word, words[i]);
+        mc_array_push(patterns, &word);
+    }
+}
+
+static void check_match(struct mc_array const *matches, size_t index,
+                        size_t pattern, size_t start, size_t len)
+{
+    struct mc_multi_search_match const *match =
+        mc_array_get_unchecked(matches, index);
+    MC_ASSERT_EQ_SIZE(match->pattern, pattern);
+    MC_ASSERT_EQ_SIZE(match->start, start);
+    MC_ASSERT_EQ_SIZE(match->len, len);
+}
+
+MC_TEST_IN_SUITE(multi_search, classic)
+{
+    char const *const words[] = {"he", "she", "his", "hers"};
+    struct mc_array patterns;
+    make_patterns(&patterns, words, 4);
+
+    struct mc_multi_search search;
+    mc_multi_search_init(&search, &patterns);
+    MC_ASSERT_EQ_SIZE(mc_multi_search_pattern_count(&search), 4);
+
+    struct mc_multi_search_match match;
+    MC_ASSERT_TRUE(mc_multi_search_find_first(
+        &search, mc_str_view_from_cstr("ushers"), &match));
+    MC_ASSERT_EQ_SIZE(match.pattern, 1);
+    MC_ASSERT_EQ_SIZE(match.start, 1);
+    MC_ASSERT_EQ_SIZE(match.len, 3);
+
+    struct mc_array matches;
+    mc_multi_search_find_all(&search, mc_str_view_from_cstr("ushers"),
+                             &matches);
+    MC_ASSERT_EQ_SIZE(mc_array_len(&matches), 3);
+    check_match(&matches, 0, 1, 1, 3);
+    check_match(&matches, 1, 0, 2, 2);
+    check_match(&matches, 2, 3, 2, 4);
+    mc_array_cleanup(&matches);
+
+    MC_ASSERT_TRUE(
+        mc_multi_search_contains(&search, mc_str_view_from_cstr("this")));
+    MC_ASSERT_FALSE(
+        mc_multi_search_contains(&search, mc_str_view_from_cstr("hxs")));
+    MC_ASSERT_FALSE(
+        mc_multi_search_contains(&search, mc_str_view_from_cstr("")));
+
+    mc_multi_search_cleanup(&search);
+    mc_array_cleanup(&patterns);
+}
+
+MC_TEST_IN_SUITE(multi_search, duplicates_and_binary)
+{
+    struct mc_array patterns;
+    mc_array_init(&patterns, mc_string_get_mc_type());
+    struct mc_string word;
+    mc_string_from_bytes(&word, "a\0b", 3);
+    mc_array_push(&patterns, &word);
+    mc_string_from_bytes(&word, "a\0b", 3);
+    mc_array_push(&patterns, &word);
+    mc_string_from(&word, "b");
+    mc_array_push(&patterns, &word);
+
+    struct mc_multi_search search;
+    mc_multi_search_init(&search, &patterns);
+
+    struct mc_array matches;
+    mc_multi_search_find_all(&search, mc_str_view_make("xa\0bb", 5),
+                             &matches);
+    MC_ASSERT_EQ_SIZE(mc_array_len(&matches), 4);
+    check_match(&matches, 0, 0, 1, 3);
+    check_match(&matches, 1, 1, 1, 3);
+    check_match(&matches, 2, 2, 3, 1);
+    check_match(&matches, 3, 2, 4, 1);
+    mc_array_cleanup(&matches);
+    mc_multi_search_cleanup(&search);
+    mc_array_cleanup(&patterns);
+
+    /* Every byte value in some pattern leaves no class for the rest */
+    mc_array_init(&patterns, mc_string_get_mc_type());
+    char text[256];
+    for (size_t b = 0; b < 256; b++) {
+        text[b] = (char)(255 - b);
+        mc_string_from_bytes(&word, &(char){(char)b}, 1);
+        mc_array_push(&patterns, &word);
+    }
+    mc_multi_search_init(&search, &patterns);
+    mc_multi_search_find_all(&search, mc_str_view_make(text, 256), &matches);
+    MC_ASSERT_EQ_SIZE(mc_array_len(&matches), 256);
+    for (size_t i = 0; i < 256; i++)
+        check_match(&matches, i, 255 - i, i, 1);
+    mc_array_cleanup(&matches);
+    mc_multi_search_cleanup(&search);
+    mc_array_cleanup(&patterns);
+
+    /* No patterns never match */
+    mc_array_init(&patterns, mc_string_get_mc_type());
+    mc_multi_search_init(&search, &patterns);
+    MC_ASSERT_FALSE(
+        mc_multi_search_contains(&search, mc_str_view_from_cstr("abc")));
+    mc_multi_search_cleanup(&search);
+    mc_array_cleanup(&patterns);
+}
+
+MC_TEST_IN_SUITE(multi_search, leftmost)
+{
+    char const *const words[] = {"bcd", "abcdef", "c", "ab"};
+    struct mc_array patterns;
+    make_patterns(&patterns, words, 4);
+    struct mc_multi_search search;
+    mc_multi_search_init(&search, &patterns);
+
+    /* "c" ends first, but "abcdef" starts first and is the longest */
+    struct mc_multi_search_match match;
+    MC_ASSERT_TRUE(mc_multi_search_find_leftmost(
+        &search, mc_str_view_from_cstr("xabcdefg"), &match));
+    MC_ASSERT_EQ_SIZE(match.pattern, 1);
+    MC_ASSERT_EQ_SIZE(match.start, 1);
+    MC_ASSERT_EQ_SIZE(match.len, 6);
+
+    /* Without the full "abcdef", "ab" still starts before "bcd" */
+    MC_ASSERT_TRUE(mc_multi_search_find_leftmost(
+        &search, mc_str_view_from_cstr("xabcde"), &match));
+    MC_ASSERT_EQ_SIZE(match.pattern, 3);
+    MC_ASSERT_EQ_SIZE(match.start, 1);
+    MC_ASSERT_EQ_SIZE(match.len, 2);
+
+    MC_ASSERT_TRUE(mc_multi_search_find_leftmost(
+        &search, mc_str_view_from_cstr("bbcc"), &match));
+    MC_ASSERT_EQ_SIZE(match.pattern, 2);
+    MC_ASSERT_EQ_SIZE(match.start, 2);
+    MC_ASSERT_FALSE(mc_multi_search_find_leftmost(
+        &search, mc_str_view_from_cstr("axbdx"), &match));
+
+    mc_multi_search_cleanup(&search);
+    mc_array_cleanup(&patterns);
+}
+
+MC_TEST_IN_SUITE(multi_search, matches_naive)
+{
+    unsigned state = 7;
+    for (size_t round = 0; round < 50; round++) {
+        struct mc_array patterns;
+        mc_array_init(&patterns, mc_string_get_mc_type());
+        size_t const count = 1 + round % 20;
+        for (size_t p = 0; p < count; p++) {
+            struct mc_string word;
+            mc_string_init(&word);
+            size_t const len = 1 + p % 5;
+            for (size_t i = 0; i < len; i++) {
+                state = state * 1103515245u + 12345u;
+                char const c = (char)('a' + (state >> 16) % 3);
+                mc_string_append_bytes(&word, &c, 1);
+            }
+            mc_array_push(&patterns, &word);
+        }
+
+        char text[200];
+        for (size_t i = 0; i < sizeof(text); i++) {
+            state = state * 1103515245u + 12345u;
+            text[i] = (char)('a' + (state >> 16) % 3);
+        }
+        struct mc_str_view const view = mc_str_view_make(text, sizeof(text));
+
+        /* Brute force, in the documented order: by end, longest first */
+        struct mc_array expected;
+        mc_array_init(&expected, mc_multi_search_match_get_mc_type());
+        for (size_t end = 1; end <= sizeof(text); end++) {
+            for (size_t len = 5; len > 0; len--) {
+                for (size_t p = 0; p < count && len <= end; p++) {
+                    struct mc_string *word = mc_array_get(&patterns, p);
+                    char const *start = text + end - len;
+                    if (mc_string_len(word) == len &&
+                        memcmp(start, mc_string_c_str(word), len) == 0) {
+                        struct mc_multi_search_match match = {p, end - len,
+                                                              len};
+                        mc_array_push(&expected, &match);
+                    }
+                }
+            }
+        }
+
+        struct mc_multi_search search;
+        mc_multi_search_init(&search, &patterns);
+        struct mc_array matches;
+        mc_multi_search_find_all(&search, view, &matches);
+        MC_ASSERT_EQ_SIZE(mc_array_len(&matches), mc_array_len(&expected));
+        for (size_t i = 0; i < mc_array_len(&matches); i++) {
+            struct mc_multi_search_match *match = mc_array_get(&expected, i);
+            check_match(&matches, i, match->pattern, match->start,
+                        match->len);
+        }
+
+        struct mc_multi_search_match first;
+        bool const found = mc_multi_search_find_first(&search, view, &first);
+        MC_ASSERT_TRUE(found == (mc_array_len(&expected) > 0));
+        if (found) {
+            struct mc_multi_search_match *match = mc_array_get(&expected, 0);
+            MC_ASSERT_EQ_SIZE(first.pattern, match->pattern);
+            MC_ASSERT_EQ_SIZE(first.start, match->start);
+        }
+
+        /* Leftmost: the smallest start, then the longest */
+        struct mc_multi_search_match leftmost;
+        struct mc_multi_search_match const *best = NULL;
+        for (size_t i = 0; i < mc_array_len(&expected); i++) {
+            struct mc_multi_search_match *match = mc_array_get(&expected, i);
+            if (!best || match->start < best->start ||
+                (match->start == best->start && match->len > best->len))
+                best = match;
+        }
+        MC_ASSERT_TRUE(mc_multi_search_find_leftmost(&search, view,
+                                                     &leftmost) == !!best);
+        if (best) {
+            MC_ASSERT_EQ_SIZE(leftmost.start, best->start);
+            MC_ASSERT_EQ_SIZE(leftmost.len, best->len);
+        }
+
+        mc_array_cleanup(&matches);
+        mc_array_cleanup(&expected);
+        mc_multi_search_cleanup(&search);
+        mc_array_cleanup(&patterns);
+    }
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_multi_search();
+    register_test_multi_search_classic();
+    register_test_multi_search_duplicates_and_binary();
+    register_test_multi_search_leftmost();
+    register_test_multi_search_matches_naive();
+#endif
+    return mc_run_all_tests();
+}
@@ -0,0 +1,330 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/list.h"
+#include "myclib/map.h"
+#include "myclib/pool.h"
+#include "myclib/test.h"
+#include "myclib/type.h"
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+MC_TEST_SUITE(pool);
+
+MC_TEST_IN_SUITE(pool, alloc_and_reuse)
+{
+    struct mc_pool pool;
+    mc_pool_init(&pool, 3, 1, 0);
+    MC_ASSERT_EQ_SIZE(mc_pool_obj_size(&pool), sizeof(void *));
+    mc_pool_cleanup(&pool);
+
+    mc_pool_init(&pool, 40, 32, 0);
+    MC_ASSERT_EQ_SIZE(mc_pool_obj_size(&pool), 64);
+    MC_ASSERT_EQ_SIZE(mc_pool_alignment(&pool), 32);
+
+    enum { COUNT = 5000 };
+    char **blocks = malloc(COUNT * sizeof(*blocks));
+    for (size_t i = 0; i < COUNT; i++) {
+        blocks[i] = mc_pool_alloc(&pool);
+        MC_ASSERT_NOT_NULL(blocks[i]);
+        MC_ASSERT_EQ_SIZE((uintptr_t)blocks[i] % 32, 0);
+        memset(blocks[i], (int)(i & 0xff), 40);
+    }
+    for (size_t i = 0; i < COUNT; i++)
+        MC_ASSERT_EQ_INT(blocks[i][39], (char)(i & 0xff));
+
+    /* Freed blocks come back most recent first. */
+    mc_pool_free(&pool, blocks[10]);
+    mc_pool_free(&pool, blocks[20]);
+    MC_ASSERT_EQ_PTR(mc_pool_alloc(&pool), blocks[20]);
+    MC_ASSERT_EQ_PTR(mc_pool_alloc(&pool), blocks[10]);
+    mc_pool_free(&pool, NULL);
+
+    free(blocks);
+    mc_pool_cleanup(&pool);
+}
+
+MC_TEST_IN_SUITE(pool, thread_cache_single_thread)
+{
+    struct mc_pool pool;
+    mc_pool_init(&pool, 24, 8, MC_POOL_OPTION_THREAD_CACHE);
+
+    enum { COUNT = 1000 };
+    void *blocks[COUNT];
+    for (size_t i = 0; i < COUNT; i++) {
+        blocks[i] = mc_pool_alloc(&pool);
+        MC_ASSERT_NOT_NULL(blocks[i]);
+        memset(blocks[i], 1, 24);
+    }
+    for (size_t i = 0; i < COUNT; i++)
+        mc_pool_free(&pool, blocks[i]);
+
+    /* Everything handed out again is distinct. */
+    for (size_t i = 0; i < COUNT; i++)
+        blocks[i] = mc_pool_alloc(&pool);
+    for (size_t i = 1; i < COUNT; i++)
+        MC_ASSERT_NE_PTR(blocks[i], blocks[i - 1]);
+
+    /* Pools sharing a cache slot evict each other without losing blocks. */
+    struct mc_pool others[8];
+    for (size_t i = 0; i < 8; i++) {
+        mc_pool_init(&others[i], 16, 8, MC_POOL_OPTION_THREAD_CACHE);
+        mc_pool_free(&others[i], mc_pool_alloc(&others[i]));
+    }
+    for (size_t i = 0; i < COUNT; i++)
+        mc_pool_free(&pool, blocks[i]);
+    for (size_t i = 0; i < 8; i++)
+        mc_pool_cleanup(&others[i]);
+
+    mc_pool_cleanup(&pool);
+}
+
+/* Pools cleaned up with blocks still in a thread cache must not leave that
+ * cache pointing into their freed slabs. */
+MC_TEST_IN_SUITE(pool, thread_cache_cleanup)
+{
+    struct mc_pool pool;
+    mc_pool_init(&pool, 32, 8, MC_POOL_OPTION_THREAD_CACHE);
+    mc_pool_free(&pool, mc_pool_alloc(&pool));
+    mc_pool_cleanup(&pool);
+
+    /* Enough pools to land on every cache slot more than once */
+    for (size_t i = 0; i < 32; i++) {
+        mc_pool_init(&pool, 32, 8, MC_POOL_OPTION_THREAD_CACHE);
+        void *block = mc_pool_alloc(&pool);
+        MC_ASSERT_NOT_NULL(block);
+        memset(block, 0xab, 32);
+        mc_pool_free(&pool, block);
+        mc_pool_cleanup(&pool);
+    }
+}
+
+#if !defined(_WIN32)
+struct pool_cleanup_worker {
+    struct mc_pool *pool;
+    pthread_barrier_t *barrier;
+};
+
+static void *pool_cleanup_worker_run(void *arg)
+{
+    struct pool_cleanup_worker *worker = arg;
+
+    mc_pool_free(worker->pool, mc_pool_alloc(worker->pool));
+    /* The main thread cleans the pool up between these two */
+    pthread_barrier_wait(worker->barrier);
+    pthread_barrier_wait(worker->barrier);
+
+    for (size_t i = 0; i < 32; i++) {
+        struct mc_pool other;
+        mc_pool_init(&other, 32, 8, MC_POOL_OPTION_THREAD_CACHE);
+        mc_pool_free(&other, mc_pool_alloc(&other));
+        mc_pool_cleanup(&other);
+    }
+    return NULL;
+}
+
+/* The same, for a cache held by another thread than the one cleaning up. */
+MC_TEST_IN_SUITE(pool, thread_cache_cleanup_other_thread)
+{
+    struct mc_pool pool;
+    mc_pool_init(&pool, 32, 8, MC_POOL_OPTION_THREAD_CACHE);
+
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, 2);
+    struct pool_cleanup_worker worker = {.pool = &pool, .barrier = &barrier};
+    pthread_t thread;
+    MC_ASSERT_EQ_INT(
+        pthread_create(&thread, NULL, pool_cleanup_worker_run, &worker), 0);
+    pthread_barrier_wait(&barrier);
+    mc_pool_cleanup(&pool);
+    pthread_barrier_wait(&barrier);
+    pthread_join(thread, NULL);
+    pthread_barrier_destroy(&barrier);
+}
+
+struct pool_worker {
+    struct mc_pool *pool;
+    size_t rounds;
+    size_t corrupted;
+};
+
+static void *pool_worker_run(void *arg)
+{
+    struct pool_worker *worker = arg;
+    uintptr_t blocks[64];
+
+    for (size_t round = 0; round < worker->rounds; round++) {
+        for (size_t i = 0; i < 64; i++) {
+            uintptr_t *block = mc_pool_alloc(worker->pool);
+            block[0] = (uintptr_t)block ^ (uintptr_t)worker;
+            block[1] = round;
+            blocks[i] = (uintptr_t)block;
+        }
+        for (size_t i = 0; i < 64; i++) {
+            uintptr_t *block = (uintptr_t *)blocks[i];
+            if (block[0] != ((uintptr_t)block ^ (uintptr_t)worker) ||
+                block[1] != round)
+                worker->corrupted++;
+            mc_pool_free(worker->pool, block);
+        }
+    }
+    return NULL;
+}
+
+MC_TEST_IN_SUITE(pool, thread_cache_many_threads)
+{
+    struct mc_pool pool;
+    mc_pool_init(&pool, 2 * sizeof(uintptr_t), alignof(uintptr_t),
+                 MC_POOL_OPTION_THREAD_CACHE);
+
+    enum { THREADS = 4 };
+    pthread_t threads[THREADS];
+    struct pool_worker workers[THREADS];
+    for (size_t i = 0; i < THREADS; i++) {
+        workers[i] = (struct pool_worker){
+            .pool = &pool, .rounds = 2000, .corrupted = 0};
+        MC_ASSERT_EQ_INT(
+            pthread_create(&threads[i], NULL, pool_worker_run, &workers[i]),
+            0);
+    }
+    for (size_t i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        MC_ASSERT_EQ_SIZE(workers[i].corrupted, 0);
+    }
+
+    mc_pool_cleanup(&pool);
+}
+#endif
+
+MC_TEST_IN_SUITE(pool, list_with_pool)
+{
+    struct mc_list list;
+    mc_list_init(&list, int_get_mc_type());
+    mc_list_use_pool(&list, NULL);
+    MC_ASSERT_TRUE(list.owns_pool);
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 1000; i++)
+            mc_list_push_back(&list, &i);
+        for (int i = 0; i < 500; i++) {
+            int out;
+            MC_ASSERT_TRUE(mc_list_pop_front(&list, &out));
+            MC_ASSERT_EQ_INT(out, i);
+        }
+        mc_list_clear(&list);
+    }
+
+    for (int i = 0; i < 10; i++)
+        mc_list_push_back(&list, &i);
+
+    struct mc_list copy;
+    mc_list_copy(&copy, &list);
+    MC_ASSERT_TRUE(copy.owns_pool);
+    MC_ASSERT_NE_PTR(copy.pool, list.pool);
+    MC_ASSERT_TRUE(mc_list_equal(&copy, &list));
+
+    struct mc_list moved;
+    mc_list_move(&moved, &copy);
+    MC_ASSERT_NULL(copy.pool);
+    MC_ASSERT_TRUE(mc_list_equal(&moved, &list));
+
+    mc_list_cleanup(&copy);
+    mc_list_cleanup(&moved);
+    mc_list_cleanup(&list);
+}
+
+MC_TEST_IN_SUITE(pool, shared_pool_across_containers)
+{
+    struct mc_pool pool;
+    mc_pool_init(&pool, 64, 16, 0);
+
+    struct mc_list lists[4];
+    for (size_t i = 0; i < 4; i++) {
+        mc_list_init(&lists[i], int_get_mc_type());
+        mc_list_use_pool(&lists[i], &pool);
+        for (int j = 0; j < 100; j++)
+            mc_list_push_back(&lists[i], &j);
+    }
+
+    struct mc_list copy;
+    mc_list_copy(&copy, &lists[0]);
+    MC_ASSERT_FALSE(copy.owns_pool);
+    MC_ASSERT_EQ_PTR(copy.pool, &pool);
+
+    struct mc_map map;
+    mc_map_init(&map, int_get_mc_type(), int_get_mc_type());
+    mc_map_use_pool(&map, &pool);
+    for (int i = 0; i < 1000; i++)
+        mc_map_insert(&map, &i, &(int){i * 3});
+    for (int i = 0; i < 1000; i += 2)
+        MC_ASSERT_TRUE(mc_map_remove(&map, &i, NULL, NULL));
+    for (int i = 1; i < 1000; i += 2)
+        MC_ASSERT_EQ_INT(*(int *)mc_map_get(&map, &i), i * 3);
+    MC_ASSERT_EQ_SIZE(mc_map_len(&map), 500);
+
+    mc_map_cleanup(&map);
+    mc_list_cleanup(&copy);
+    for (size_t i = 0; i < 4; i++)
+        mc_list_cleanup(&lists[i]);
+    mc_pool_cleanup(&pool);
+}
+
+MC_TEST_IN_SUITE(pool, map_with_pool)
+{
+    struct mc_map map;
+    mc_map_init(&map, int_get_mc_type(), int_get_mc_type());
+    mc_map_use_pool(&map, NULL);
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 2000; i++)
+            mc_map_insert(&map, &i, &(int){-i});
+        for (int i = 0; i < 2000; i++) {
+            int value;
+            MC_ASSERT_TRUE(mc_map_remove(&map, &i, NULL, &value));
+            MC_ASSERT_EQ_INT(value, -i);
+        }
+        MC_ASSERT_TRUE(mc_map_is_empty(&map));
+    }
+
+    for (int i = 0; i < 100; i++)
+        mc_map_insert(&map, &i, &i);
+    mc_map_shrink_to_fit(&map);
+
+    struct mc_map copy;
+    mc_map_copy(&copy, &map);
+    MC_ASSERT_TRUE(copy.table.owns_pool);
+    MC_ASSERT_EQ_SIZE(mc_map_len(&copy), 100);
+    MC_ASSERT_EQ_INT(*(int *)mc_map_get(&copy, &(int){42}), 42);
+
+    struct mc_map moved;
+    mc_map_move(&moved, &copy);
+    MC_ASSERT_NULL(copy.table.pool);
+    MC_ASSERT_EQ_INT(*(int *)mc_map_get(&moved, &(int){7}), 7);
+
+    mc_map_cleanup(&copy);
+    mc_map_cleanup(&moved);
+    mc_map_cleanup(&map);
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_pool();
+    register_test_pool_alloc_and_reuse();
+    register_test_pool_thread_cache_single_thread();
+    register_test_pool_thread_cache_cleanup();
+#if !defined(_WIN32)
+    register_test_pool_thread_cache_cleanup_other_thread();
+    register_test_pool_thread_cache_many_threads();
+#endif
+    register_test_pool_list_with_pool();
+    register_test_pool_shared_pool_across_containers();
+    register_test_pool_map_with_pool();
+#endif
+    return mc_run_all_tests();
+}
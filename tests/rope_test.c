@@ -0,0 +1,228 @@
+#include <stddef.h>
+#include <string.h>
+#include "myclib/rope.h"
+#include "myclib/string.h"
+#include "myclib/test.h"
+
+MC_TEST_SUITE(rope);
+
+static bool rope_is(struct mc_rope const *rope, struct mc_str_view expected)
+{
+    struct mc_string flat;
+    mc_string_init(&flat);
+    mc_rope_flatten(rope, &flat);
+    bool const same = mc_str_view_equal(mc_string_view(&flat), expected);
+    mc_string_cleanup(&flat);
+    return same;
+}
+
+/* Checks the cached lengths and the heap order of the priorities, and
+ * counts the nodes. */
+static void check_tree(struct mc_rope_node const *node, size_t *nodes)
+{
+    if (!node)
+        return;
+    size_t const left_len = node->left ? node->left->len : 0;
+    size_t const right_len = node->right ? node->right->len : 0;
+    MC_ASSERT_TRUE(node->chunk_len > 0);
+    MC_ASSERT_TRUE(node->chunk_len <= MC_ROPE_CHUNK_CAPACITY);
+    MC_ASSERT_EQ_SIZE(node->len, left_len + node->chunk_len + right_len);
+    MC_ASSERT_TRUE(!node->left || node->left->priority <= node->priority);
+    MC_ASSERT_TRUE(!node->right || node->right->priority <= node->priority);
+    ++*nodes;
+    check_tree(node->left, nodes);
+    check_tree(node->right, nodes);
+}
+
+MC_TEST_IN_SUITE(rope, insert_remove)
+{
+    struct mc_rope rope;
+    mc_rope_init(&rope);
+    MC_ASSERT_TRUE(mc_rope_is_empty(&rope));
+    MC_ASSERT_EQ_SIZE(mc_rope_len(&rope), 0);
+    MC_ASSERT_TRUE(rope_is(&rope, mc_str_view_from_cstr("")));
+
+    mc_rope_append(&rope, mc_str_view_from_cstr("world"));
+    mc_rope_insert(&rope, 0, mc_str_view_from_cstr("hello "));
+    mc_rope_append(&rope, mc_str_view_make("!\0", 2));
+    MC_ASSERT_EQ_SIZE(mc_rope_len(&rope), 13);
+    MC_ASSERT_TRUE(rope_is(&rope, mc_str_view_make("hello world!\0", 13)));
+    MC_ASSERT_TRUE(mc_rope_get(&rope, 6) == 'w');
+    MC_ASSERT_TRUE(mc_rope_get(&rope, 12) == '\0');
+
+    mc_rope_remove(&rope, 5, 6);
+    MC_ASSERT_TRUE(rope_is(&rope, mc_str_view_make("hello!\0", 7)));
+    /* len is clamped */
+    mc_rope_remove(&rope, 5, 100);
+    MC_ASSERT_TRUE(rope_is(&rope, mc_str_view_from_cstr("hello")));
+    mc_rope_remove(&rope, 0, 5);
+    MC_ASSERT_TRUE(mc_rope_is_empty(&rope));
+
+    mc_rope_cleanup(&rope);
+}
+
+MC_TEST_IN_SUITE(rope, large_edits)
+{
+    /* Several chunks, so edits cross and split them */
+    static char text[5 * MC_ROPE_CHUNK_CAPACITY + 17];
+    for (size_t i = 0; i < sizeof(text); i++)
+        text[i] = (char)('a' + i % 26);
+    struct mc_str_view const all = mc_str_view_make(text, sizeof(text));
+
+    struct mc_rope rope;
+    mc_rope_from_view(&rope, all);
+    MC_ASSERT_EQ_SIZE(mc_rope_len(&rope), sizeof(text));
+    size_t nodes = 0;
+    check_tree(rope.root, &nodes);
+    MC_ASSERT_EQ_SIZE(nodes, 6);
+    MC_ASSERT_TRUE(rope_is(&rope, all));
+
+    struct mc_string part;
+    mc_string_init(&part);
+    mc_rope_substr(&rope, MC_ROPE_CHUNK_CAPACITY - 3, 10, &part);
+    MC_ASSERT_TRUE(mc_str_view_equal(
+        mc_string_view(&part),
+        mc_str_view_substr(all, MC_ROPE_CHUNK_CAPACITY - 3, 10)));
+    mc_string_cleanup(&part);
+
+    /* The chunks cover the range exactly */
+    struct mc_rope_chunks chunks;
+    struct mc_str_view chunk;
+    size_t pos = 100;
+    mc_rope_chunks_init(&chunks, &rope, pos, 3 * MC_ROPE_CHUNK_CAPACITY);
+    while (mc_rope_chunks_next(&chunks, &chunk)) {
+        MC_ASSERT_TRUE(chunk.len > 0);
+        MC_ASSERT_TRUE(
+            mc_str_view_equal(chunk, mc_str_view_substr(all, pos, chunk.len)));
+        pos += chunk.len;
+    }
+    MC_ASSERT_EQ_SIZE(pos, 100 + 3 * MC_ROPE_CHUNK_CAPACITY);
+
+    /* Removing the middle and putting it back refills the cut chunks */
+    size_t const cut = 2 * MC_ROPE_CHUNK_CAPACITY + 5;
+    mc_rope_remove(&rope, 10, cut);
+    MC_ASSERT_EQ_SIZE(mc_rope_len(&rope), sizeof(text) - cut);
+    mc_rope_insert(&rope, 10, mc_str_view_substr(all, 10, cut));
+    MC_ASSERT_TRUE(rope_is(&rope, all));
+    nodes = 0;
+    check_tree(rope.root, &nodes);
+    MC_ASSERT_EQ_SIZE(nodes, 6);
+
+    mc_rope_cleanup(&rope);
+}
+
+/* What mc_rope_remove and then mc_rope_insert at pos do, on a string. */
+static void splice(struct mc_string *str, size_t pos, size_t len,
+                   struct mc_str_view text)
+{
+    struct mc_str_view const view = mc_string_view(str);
+    size_t const end = len < view.len - pos ? pos + len : view.len;
+    struct mc_string result;
+    mc_string_init(&result);
+    mc_string_append_view(&result, mc_str_view_substr(view, 0, pos));
+    mc_string_append_view(&result, text);
+    mc_string_append_view(&result, mc_str_view_substr(view, end, view.len));
+    mc_string_cleanup(str);
+    mc_string_move(str, &result);
+}
+
+MC_TEST_IN_SUITE(rope, matches_string)
+{
+    struct mc_rope rope;
+    struct mc_string model;
+    mc_rope_init(&rope);
+    mc_string_init(&model);
+    char bytes[3 * MC_ROPE_CHUNK_CAPACITY];
+    unsigned state = 1;
+
+    for (size_t round = 0; round < 2000; round++) {
+        state = state * 1103515245u + 12345u;
+        size_t const len = mc_string_len(&model);
+        size_t const pos = len ? (state >> 8) % (len + 1) : 0;
+        state = state * 1103515245u + 12345u;
+        /* Mostly short edits, now and then one longer than a chunk */
+        size_t const size = (state >> 8) % 8 == 0
+                                ? (state >> 12) % sizeof(bytes)
+                                : (state >> 12) % 40;
+
+        if ((state >> 4) % 5 < 3 || len < 1000) {
+            for (size_t i = 0; i < size; i++)
+                bytes[i] = (char)(round + i);
+            mc_rope_insert(&rope, pos, mc_str_view_make(bytes, size));
+            splice(&model, pos, 0, mc_str_view_make(bytes, size));
+        } else {
+            mc_rope_remove(&rope, pos, size);
+            splice(&model, pos, size, mc_str_view_make(NULL, 0));
+        }
+
+        MC_ASSERT_EQ_SIZE(mc_rope_len(&rope), mc_string_len(&model));
+        if (round % 100 == 0) {
+            size_t nodes = 0;
+            check_tree(rope.root, &nodes);
+            /* Joined seams keep chunks from fragmenting */
+            MC_ASSERT_TRUE(nodes <= 4 + 4 * mc_rope_len(&rope) /
+                                            MC_ROPE_CHUNK_CAPACITY);
+            MC_ASSERT_TRUE(rope_is(&rope, mc_string_view(&model)));
+        }
+    }
+
+    MC_ASSERT_TRUE(rope_is(&rope, mc_string_view(&model)));
+    MC_ASSERT_EQ_SIZE(mc_rope_hash(&rope), mc_string_hash(&model));
+    for (size_t i = 0; i < mc_string_len(&model); i += 97)
+        MC_ASSERT_TRUE(mc_rope_get(&rope, i) == mc_string_data(&model)[i]);
+
+    mc_string_cleanup(&model);
+    mc_rope_cleanup(&rope);
+}
+
+MC_TEST_IN_SUITE(rope, move_copy_compare)
+{
+    char text[3 * MC_ROPE_CHUNK_CAPACITY];
+    for (size_t i = 0; i < sizeof(text); i++)
+        text[i] = (char)(i * 7);
+
+    /* Same bytes in differently cut chunks */
+    struct mc_rope rope1;
+    struct mc_rope rope2;
+    mc_rope_from_view(&rope1, mc_str_view_make(text, sizeof(text)));
+    mc_rope_init(&rope2);
+    for (size_t pos = 0; pos < sizeof(text); pos += 1000) {
+        size_t const len = sizeof(text) - pos < 1000 ? sizeof(text) - pos
+                                                     : 1000;
+        mc_rope_insert(&rope2, 0,
+                       mc_str_view_make(text + sizeof(text) - pos - len, len));
+    }
+    MC_ASSERT_TRUE(mc_rope_equal(&rope1, &rope2));
+    MC_ASSERT_EQ_SIZE(mc_rope_hash(&rope1), mc_rope_hash(&rope2));
+
+    struct mc_rope copy;
+    mc_rope_copy(&copy, &rope2);
+    MC_ASSERT_TRUE(mc_rope_equal(&copy, &rope1));
+    mc_rope_remove(&copy, 2500, 1);
+    MC_ASSERT_TRUE(mc_rope_compare(&copy, &rope1) < 0);
+    mc_rope_insert(&copy, 2500, mc_str_view_make("\xff", 1));
+    MC_ASSERT_TRUE(mc_rope_compare(&copy, &rope1) > 0);
+    MC_ASSERT_TRUE(mc_rope_compare(&rope1, &copy) < 0);
+
+    struct mc_rope moved;
+    mc_rope_move(&moved, &copy);
+    MC_ASSERT_TRUE(mc_rope_is_empty(&copy));
+    MC_ASSERT_EQ_SIZE(mc_rope_len(&moved), sizeof(text));
+
+    mc_rope_cleanup(&moved);
+    mc_rope_cleanup(&copy);
+    mc_rope_cleanup(&rope2);
+    mc_rope_cleanup(&rope1);
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_rope();
+    register_test_rope_insert_remove();
+    register_test_rope_large_edits();
+    register_test_rope_matches_string();
+    register_test_rope_move_copy_compare();
+#endif
+    return mc_run_all_tests();
+}
@@ -0,0 +1,165 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/segmented_array.h"
+#include "myclib/string.h"
+#include "myclib/test.h"
+#include "myclib/type.h"
+
+MC_TEST_SUITE(segmented_array);
+
+MC_TEST_IN_SUITE(segmented_array, init)
+{
+    struct mc_segmented_array array;
+    mc_segmented_array_init(&array, int_get_mc_type());
+    MC_ASSERT_EQ_SIZE(mc_segmented_array_len(&array), 0);
+    MC_ASSERT_EQ_SIZE(mc_segmented_array_capacity(&array), 0);
+    MC_ASSERT_TRUE(mc_segmented_array_is_empty(&array));
+    MC_ASSERT_NULL(mc_segmented_array_get(&array, 0));
+    MC_ASSERT_NULL(mc_segmented_array_get_first(&array));
+    MC_ASSERT_NULL(mc_segmented_array_get_last(&array));
+    MC_ASSERT_FALSE(mc_segmented_array_pop(&array, NULL));
+    mc_segmented_array_cleanup(&array);
+}
+
+MC_TEST_IN_SUITE(segmented_array, push_get_stable_addresses)
+{
+    struct mc_segmented_array array;
+    mc_segmented_array_init(&array, int_get_mc_type());
+
+    int *first = NULL;
+    int *boundary = NULL;
+    for (int i = 0; i < 10000; i++) {
+        mc_segmented_array_push(&array, &i);
+        if (i == 0)
+            first = mc_segmented_array_get(&array, 0);
+        if (i == MC_SEGMENTED_ARRAY_FIRST_SEGMENT)
+            boundary = mc_segmented_array_get(&array, (size_t)i);
+    }
+
+    MC_ASSERT_EQ_SIZE(mc_segmented_array_len(&array), 10000);
+    MC_ASSERT_GE_SIZE(mc_segmented_array_capacity(&array), 10000);
+    MC_ASSERT_EQ_PTR(first, mc_segmented_array_get_first(&array));
+    MC_ASSERT_EQ_PTR(boundary, mc_segmented_array_get(
+                                   &array, MC_SEGMENTED_ARRAY_FIRST_SEGMENT));
+    for (size_t i = 0; i < 10000; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_segmented_array_get(&array, i), (int)i);
+    MC_ASSERT_NULL(mc_segmented_array_get(&array, 10000));
+    MC_ASSERT_EQ_INT(*(int *)mc_segmented_array_get_last(&array), 9999);
+
+    int out;
+    MC_ASSERT_TRUE(mc_segmented_array_pop(&array, &out));
+    MC_ASSERT_EQ_INT(out, 9999);
+
+    size_t capacity = mc_segmented_array_capacity(&array);
+    while (mc_segmented_array_len(&array) > 20)
+        mc_segmented_array_pop(&array, NULL);
+    MC_ASSERT_EQ_SIZE(mc_segmented_array_capacity(&array), capacity);
+
+    mc_segmented_array_shrink_to_fit(&array);
+    MC_ASSERT_EQ_SIZE(mc_segmented_array_capacity(&array),
+                      3 * MC_SEGMENTED_ARRAY_FIRST_SEGMENT);
+    MC_ASSERT_EQ_PTR(first, mc_segmented_array_get_first(&array));
+    MC_ASSERT_EQ_INT(*(int *)mc_segmented_array_get_last(&array), 19);
+
+    mc_segmented_array_clear(&array);
+    mc_segmented_array_shrink_to_fit(&array);
+    MC_ASSERT_EQ_SIZE(mc_segmented_array_capacity(&array), 0);
+
+    mc_segmented_array_reserve(&array, 100);
+    MC_ASSERT_GE_SIZE(mc_segmented_array_capacity(&array), 100);
+    int *slot = mc_segmented_array_emplace_back(&array);
+    *slot = 7;
+    MC_ASSERT_EQ_INT(*(int *)mc_segmented_array_get(&array, 0), 7);
+
+    mc_segmented_array_cleanup(&array);
+}
+
+MC_TEST_IN_SUITE(segmented_array, owning_elements)
+{
+    struct mc_segmented_array array;
+    mc_segmented_array_init(&array, mc_string_get_mc_type());
+
+    char buf[16];
+    for (int i = 0; i < 100; i++) {
+        struct mc_string str;
+        snprintf(buf, sizeof(buf), "s%d", i);
+        mc_string_from(&str, buf);
+        mc_segmented_array_push(&array, &str);
+    }
+
+    struct mc_segmented_array copy;
+    mc_segmented_array_copy(&copy, &array);
+    MC_ASSERT_TRUE(mc_segmented_array_equal(&copy, &array));
+    MC_ASSERT_EQ_INT(mc_segmented_array_compare(&copy, &array), 0);
+    MC_ASSERT_EQ_SIZE(mc_segmented_array_hash(&copy),
+                      mc_segmented_array_hash(&array));
+
+    struct mc_string out;
+    mc_segmented_array_pop(&copy, &out);
+    MC_ASSERT_EQ_STR(mc_string_c_str(&out), "s99");
+    mc_string_cleanup(&out);
+    MC_ASSERT_FALSE(mc_segmented_array_equal(&copy, &array));
+    MC_ASSERT_TRUE(mc_segmented_array_compare(&copy, &array) < 0);
+
+    struct mc_segmented_array moved;
+    mc_segmented_array_move(&moved, &array);
+    MC_ASSERT_EQ_SIZE(mc_segmented_array_len(&array), 0);
+    MC_ASSERT_EQ_STR(
+        mc_string_c_str(mc_segmented_array_get(&moved, 57)), "s57");
+
+    mc_segmented_array_cleanup(&array);
+    mc_segmented_array_cleanup(&moved);
+    mc_segmented_array_cleanup(&copy);
+}
+
+static void sum_elem(void *elem, void *user_data)
+{
+    *(long *)user_data += *(int *)elem;
+}
+
+MC_TEST_IN_SUITE(segmented_array, iteration)
+{
+    struct mc_segmented_array array;
+    mc_segmented_array_init(&array, int_get_mc_type());
+
+    struct mc_iter iter;
+    mc_segmented_array_iter_init(&iter, &array);
+    MC_ASSERT_FALSE(iter.next(&iter));
+
+    size_t sizes[] = {1, 16, 17, 48, 49, 1000};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        mc_segmented_array_clear(&array);
+        for (size_t i = 0; i < sizes[s]; i++)
+            mc_segmented_array_push(&array, &(int){(int)i});
+
+        size_t i = 0;
+        mc_segmented_array_iter_init(&iter, &array);
+        while (iter.next(&iter)) {
+            MC_ASSERT_EQ_PTR(iter.value, mc_segmented_array_get(&array, i));
+            MC_ASSERT_NULL(iter.key);
+            i++;
+        }
+        MC_ASSERT_EQ_SIZE(i, sizes[s]);
+
+        long sum = 0;
+        mc_segmented_array_for_each(&array, sum_elem, &sum);
+        MC_ASSERT_EQ_INT(sum, (long)(sizes[s] * (sizes[s] - 1) / 2));
+    }
+
+    mc_segmented_array_cleanup(&array);
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_segmented_array();
+    register_test_segmented_array_init();
+    register_test_segmented_array_push_get_stable_addresses();
+    register_test_segmented_array_owning_elements();
+    register_test_segmented_array_iteration();
+#endif
+    return mc_run_all_tests();
+}
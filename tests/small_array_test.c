@@ -0,0 +1,317 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/small_array.h"
+#include "myclib/string.h"
+#include "myclib/test.h"
+#include "myclib/type.h"
+
+MC_TEST_SUITE(small_array);
+
+MC_TEST_IN_SUITE(small_array, init)
+{
+    struct mc_small_array array;
+    mc_small_array_init(&array, int64_get_mc_type());
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&array), 0);
+    MC_ASSERT_EQ_SIZE(mc_small_array_capacity(&array),
+                      MC_SMALL_ARRAY_INLINE_SIZE / sizeof(int64_t));
+    MC_ASSERT_TRUE(mc_small_array_is_empty(&array));
+    MC_ASSERT_TRUE(mc_small_array_is_inline(&array));
+    MC_ASSERT_NULL(mc_small_array_get_first(&array));
+    MC_ASSERT_NULL(mc_small_array_get_last(&array));
+    mc_small_array_cleanup(&array);
+}
+
+MC_TEST_IN_SUITE(small_array, spill_and_shrink)
+{
+    struct mc_small_array array;
+    mc_small_array_init(&array, int64_get_mc_type());
+    size_t const inline_capacity = mc_small_array_capacity(&array);
+
+    for (int64_t i = 0; i < (int64_t)inline_capacity; i++)
+        mc_small_array_push(&array, &i);
+    MC_ASSERT_TRUE(mc_small_array_is_inline(&array));
+    MC_ASSERT_EQ_PTR(mc_small_array_data(&array), array.storage.buf);
+
+    int64_t val = 100;
+    mc_small_array_push(&array, &val);
+    MC_ASSERT_FALSE(mc_small_array_is_inline(&array));
+    MC_ASSERT_GT_SIZE(mc_small_array_capacity(&array), inline_capacity);
+
+    for (size_t i = 0; i < inline_capacity; i++)
+        MC_ASSERT_EQ_INT((int)*(int64_t *)mc_small_array_get(&array, i),
+                         (int)i);
+    MC_ASSERT_EQ_INT((int)*(int64_t *)mc_small_array_get_last(&array), 100);
+
+    int64_t out;
+    MC_ASSERT_TRUE(mc_small_array_pop(&array, &out));
+    MC_ASSERT_EQ_INT((int)out, 100);
+
+    /* Shrinking brings the elements back into the struct. */
+    mc_small_array_shrink_to_fit(&array);
+    MC_ASSERT_TRUE(mc_small_array_is_inline(&array));
+    for (size_t i = 0; i < inline_capacity; i++)
+        MC_ASSERT_EQ_INT((int)*(int64_t *)mc_small_array_get(&array, i),
+                         (int)i);
+
+    mc_small_array_cleanup(&array);
+}
+
+MC_TEST_IN_SUITE(small_array, insert_remove)
+{
+    int values[] = {1, 2, 4, 5};
+    struct mc_small_array array;
+    mc_small_array_from(&array, int_get_mc_type(), values, 4);
+
+    mc_small_array_insert(&array, 2, &(int){3});
+    mc_small_array_insert(&array, 0, &(int){0});
+    mc_small_array_insert(&array, 6, &(int){6});
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&array), 7);
+    for (size_t i = 0; i < 7; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_small_array_get(&array, i), (int)i);
+
+    int out;
+    mc_small_array_remove(&array, 3, &out);
+    MC_ASSERT_EQ_INT(out, 3);
+    MC_ASSERT_EQ_INT(*(int *)mc_small_array_get(&array, 3), 4);
+
+    MC_ASSERT_TRUE(mc_small_array_contains(&array, &(int){6}));
+    MC_ASSERT_FALSE(mc_small_array_contains(&array, &(int){3}));
+    MC_ASSERT_EQ_PTR(mc_small_array_find(&array, &(int){5}),
+                     mc_small_array_get(&array, 4));
+
+    mc_small_array_cleanup(&array);
+}
+
+MC_TEST_IN_SUITE(small_array, ranges)
+{
+    int64_t values[] = {0, 1, 6, 7};
+    struct mc_small_array array;
+    mc_small_array_from(&array, int64_get_mc_type(), values, 4);
+    size_t const inline_capacity = mc_small_array_capacity(&array);
+
+    /* Filling the inline buffer exactly, then spilling mid-array */
+    int64_t middle[] = {2, 3, 4, 5};
+    mc_small_array_insert_range(&array, 2, middle, 4);
+    MC_ASSERT_TRUE(mc_small_array_is_inline(&array));
+    int64_t head[] = {-8, -7, -6, -5, -4, -3, -2, -1};
+    mc_small_array_insert_range(&array, 0, head, 8);
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&array), 16);
+    MC_ASSERT_FALSE(mc_small_array_is_inline(&array));
+    for (size_t i = 0; i < 16; i++)
+        MC_ASSERT_EQ_INT((int)*(int64_t *)mc_small_array_get(&array, i),
+                         (int)i - 8);
+
+    int64_t out[3];
+    mc_small_array_remove_range(&array, 12, 3, out, 3);
+    MC_ASSERT_EQ_INT((int)out[0], 4);
+    MC_ASSERT_EQ_INT((int)out[2], 6);
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&array), 13);
+    MC_ASSERT_EQ_INT((int)*(int64_t *)mc_small_array_get(&array, 12), 7);
+
+    int64_t removed;
+    mc_small_array_swap_remove(&array, 0, &removed);
+    MC_ASSERT_EQ_INT((int)removed, -8);
+    MC_ASSERT_EQ_INT((int)*(int64_t *)mc_small_array_get_first(&array), 7);
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&array), 12);
+
+    /* Removing everything keeps the heap buffer until asked to shrink */
+    mc_small_array_remove_range(&array, 0, 100, NULL, 0);
+    MC_ASSERT_TRUE(mc_small_array_is_empty(&array));
+    MC_ASSERT_FALSE(mc_small_array_is_inline(&array));
+    mc_small_array_shrink_to(&array, inline_capacity);
+    MC_ASSERT_TRUE(mc_small_array_is_inline(&array));
+
+    *(int64_t *)mc_small_array_emplace_back(&array) = 3;
+    *(int64_t *)mc_small_array_emplace_at(&array, 0) = 1;
+    int64_t *slots = mc_small_array_extend_uninit(&array, inline_capacity);
+    for (size_t i = 0; i < inline_capacity; i++)
+        slots[i] = 5;
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&array), inline_capacity + 2);
+    MC_ASSERT_EQ_INT((int)*(int64_t *)mc_small_array_get(&array, 1), 3);
+    MC_ASSERT_EQ_INT((int)*(int64_t *)mc_small_array_get_last(&array), 5);
+
+    mc_small_array_cleanup(&array);
+}
+
+static bool is_even(void const *elem, void const *user_data)
+{
+    (void)user_data;
+    return *(int const *)elem % 2 == 0;
+}
+
+static bool is_greater(void const *elem, void const *user_data)
+{
+    return *(int const *)elem > *(int const *)user_data;
+}
+
+MC_TEST_IN_SUITE(small_array, retain_dedup_resize)
+{
+    struct mc_small_array array;
+    mc_small_array_with_capacity(&array, mc_string_get_mc_type(), 2);
+    MC_ASSERT_TRUE(mc_small_array_is_inline(&array));
+    mc_small_array_reserve_exact(&array, 40);
+    MC_ASSERT_EQ_SIZE(mc_small_array_capacity(&array), 40);
+
+    char const *const words[] = {"a", "a", "b", "b", "b", "a", "c", "c"};
+    for (size_t i = 0; i < 8; i++) {
+        struct mc_string str;
+        mc_string_from(&str, words[i]);
+        mc_small_array_push(&array, &str);
+    }
+    mc_small_array_dedup(&array);
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&array), 4);
+    MC_ASSERT_EQ_STR(mc_string_c_str(mc_small_array_get(&array, 2)), "a");
+
+    struct mc_string fill;
+    mc_string_from(&fill, "fill-long-enough-to-live-on-the-heap");
+    mc_small_array_resize(&array, 6, &fill);
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&array), 6);
+    MC_ASSERT_EQ_STR(mc_string_c_str(mc_small_array_get(&array, 4)),
+                     "fill-long-enough-to-live-on-the-heap");
+    mc_string_from(&fill, "dropped");
+    mc_small_array_resize(&array, 1, &fill);
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&array), 1);
+    mc_small_array_cleanup(&array);
+
+    int values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    mc_small_array_from(&array, int_get_mc_type(), values, 12);
+    mc_small_array_retain(&array, is_even, NULL);
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&array), 6);
+    for (size_t i = 0; i < 6; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_small_array_get(&array, i),
+                         2 * (int)i + 2);
+    MC_ASSERT_EQ_PTR(mc_small_array_find_if(&array, is_greater, &(int){7}),
+                     mc_small_array_get(&array, 3));
+    mc_small_array_cleanup(&array);
+}
+
+static int compare_by_tens(void const *a, void const *b)
+{
+    return *(int const *)a / 10 - *(int const *)b / 10;
+}
+
+MC_TEST_IN_SUITE(small_array, sort_search)
+{
+    int values[] = {42, 7, 19, 3, 11, 28, 15, 1, 36, 24, 9, 30};
+    struct mc_small_array array;
+
+    /* Both inline and on the heap */
+    for (size_t n = 6; n <= 12; n += 6) {
+        mc_small_array_from(&array, int_get_mc_type(), values, n);
+        mc_small_array_sort(&array);
+        for (size_t i = 1; i < n; i++)
+            MC_ASSERT_LT_INT(*(int *)mc_small_array_get(&array, i - 1),
+                             *(int *)mc_small_array_get(&array, i));
+        for (size_t i = 0; i < n; i++) {
+            size_t index, branchless_index;
+            MC_ASSERT_TRUE(mc_small_array_binary_search(&array, &values[i],
+                                                        &index));
+            MC_ASSERT_TRUE(mc_small_array_binary_search_branchless(
+                &array, &values[i], &branchless_index));
+            MC_ASSERT_EQ_SIZE(index, branchless_index);
+            MC_ASSERT_EQ_INT(*(int *)mc_small_array_get(&array, index),
+                             values[i]);
+        }
+        MC_ASSERT_FALSE(
+            mc_small_array_binary_search(&array, &(int){10}, NULL));
+        mc_small_array_cleanup(&array);
+    }
+
+    /* Stable: equal tens keep their order */
+    mc_small_array_from(&array, int_get_mc_type(), values, 12);
+    mc_small_array_stable_sort_with(&array, compare_by_tens);
+    int const expected[] = {7, 3, 1, 9, 19, 11, 15, 28, 24, 36, 30, 42};
+    for (size_t i = 0; i < 12; i++)
+        MC_ASSERT_EQ_INT(*(int *)mc_small_array_get(&array, i), expected[i]);
+    mc_small_array_sort_with(&array, compare_by_tens);
+    mc_small_array_stable_sort(&array);
+    MC_ASSERT_EQ_INT(*(int *)mc_small_array_get_first(&array), 1);
+    mc_small_array_cleanup(&array);
+}
+
+MC_TEST_IN_SUITE(small_array, owning_elements)
+{
+    struct mc_small_array array;
+    mc_small_array_init(&array, mc_string_get_mc_type());
+
+    for (int i = 0; i < 10; i++) {
+        struct mc_string str;
+        mc_string_format(&str, "item %d", i);
+        mc_small_array_push(&array, &str);
+    }
+    MC_ASSERT_FALSE(mc_small_array_is_inline(&array));
+
+    struct mc_small_array copy;
+    mc_small_array_copy(&copy, &array);
+    MC_ASSERT_TRUE(mc_small_array_equal(&copy, &array));
+    MC_ASSERT_EQ_SIZE(mc_small_array_hash(&copy), mc_small_array_hash(&array));
+
+    mc_small_array_truncate(&copy, 1);
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&copy), 1);
+    MC_ASSERT_EQ_STR(
+        mc_string_c_str(mc_small_array_get_first(&copy)), "item 0");
+
+    struct mc_small_array moved;
+    mc_small_array_move(&moved, &copy);
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&copy), 0);
+    MC_ASSERT_EQ_SIZE(mc_small_array_len(&moved), 1);
+
+    mc_small_array_cleanup(&copy);
+    mc_small_array_cleanup(&moved);
+    mc_small_array_cleanup(&array);
+}
+
+MC_TEST_IN_SUITE(small_array, inline_move)
+{
+    struct mc_small_array src, dst;
+    mc_small_array_init(&src, int_get_mc_type());
+    mc_small_array_push(&src, &(int){7});
+    mc_small_array_push(&src, &(int){8});
+
+    mc_small_array_move(&dst, &src);
+    MC_ASSERT_TRUE(mc_small_array_is_inline(&dst));
+    MC_ASSERT_EQ_INT(*(int *)mc_small_array_get(&dst, 0), 7);
+    MC_ASSERT_EQ_INT(*(int *)mc_small_array_get(&dst, 1), 8);
+    MC_ASSERT_TRUE(mc_small_array_is_empty(&src));
+
+    mc_small_array_cleanup(&src);
+    mc_small_array_cleanup(&dst);
+}
+
+MC_TEST_IN_SUITE(small_array, iter)
+{
+    int values[] = {3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5, 8, 9, 7, 9, 3, 2, 3};
+    struct mc_small_array array;
+    mc_small_array_from(&array, int_get_mc_type(), values, 18);
+
+    struct mc_iter iter;
+    mc_small_array_iter_init(&iter, &array);
+    size_t i = 0;
+    while (iter.next(&iter)) {
+        MC_ASSERT_EQ_INT(*(int *)iter.value, values[i]);
+        i++;
+    }
+    MC_ASSERT_EQ_SIZE(i, 18);
+
+    mc_small_array_cleanup(&array);
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_small_array();
+    register_test_small_array_init();
+    register_test_small_array_spill_and_shrink();
+    register_test_small_array_insert_remove();
+    register_test_small_array_ranges();
+    register_test_small_array_retain_dedup_resize();
+    register_test_small_array_sort_search();
+    register_test_small_array_owning_elements();
+    register_test_small_array_inline_move();
+    register_test_small_array_iter();
+#endif
+    return mc_run_all_tests();
+}
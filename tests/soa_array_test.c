@@ -0,0 +1,184 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "myclib/soa_array.h"
+#include "myclib/string.h"
+#include "myclib/test.h"
+#include "myclib/type.h"
+
+MC_TEST_SUITE(soa_array);
+
+enum { FIELD_ID, FIELD_SCORE, FIELD_NAME, FIELD_COUNT };
+
+static void init_records(struct mc_soa_array *soa)
+{
+    struct mc_type const *types[FIELD_COUNT] = {
+        int_get_mc_type(), double_get_mc_type(), mc_string_get_mc_type()};
+    mc_soa_array_init(soa, types, FIELD_COUNT);
+}
+
+static void push_record(struct mc_soa_array *soa, int id, double score,
+                        char const *name)
+{
+    struct mc_string str;
+    mc_string_from(&str, name);
+    void *fields[FIELD_COUNT] = {&id, &score, &str};
+    mc_soa_array_push(soa, fields);
+}
+
+MC_TEST_IN_SUITE(soa_array, init)
+{
+    struct mc_soa_array soa;
+    init_records(&soa);
+    MC_ASSERT_EQ_SIZE(mc_soa_array_len(&soa), 0);
+    MC_ASSERT_EQ_SIZE(mc_soa_array_capacity(&soa), 0);
+    MC_ASSERT_EQ_SIZE(mc_soa_array_field_count(&soa), FIELD_COUNT);
+    MC_ASSERT_TRUE(mc_soa_array_is_empty(&soa));
+    MC_ASSERT_EQ_PTR(mc_soa_array_field_type(&soa, FIELD_SCORE),
+                     double_get_mc_type());
+    MC_ASSERT_NULL(mc_soa_array_get(&soa, 0, FIELD_ID));
+    MC_ASSERT_FALSE(mc_soa_array_pop(&soa, NULL));
+    mc_soa_array_cleanup(&soa);
+
+    struct mc_type const *types[] = {int_get_mc_type()};
+    mc_soa_array_with_capacity(&soa, types, 1, 10);
+    MC_ASSERT_GE_SIZE(mc_soa_array_capacity(&soa), 10);
+    mc_soa_array_cleanup(&soa);
+}
+
+MC_TEST_IN_SUITE(soa_array, push_get_pop)
+{
+    struct mc_soa_array soa;
+    init_records(&soa);
+
+    char name[16];
+    for (int i = 0; i < 100; i++) {
+        snprintf(name, sizeof(name), "rec%d", i);
+        push_record(&soa, i, i * 0.5, name);
+    }
+    MC_ASSERT_EQ_SIZE(mc_soa_array_len(&soa), 100);
+
+    for (size_t i = 0; i < 100; i++) {
+        snprintf(name, sizeof(name), "rec%zu", i);
+        MC_ASSERT_EQ_INT(*(int *)mc_soa_array_get(&soa, i, FIELD_ID), (int)i);
+        MC_ASSERT_TRUE(*(double *)mc_soa_array_get(&soa, i, FIELD_SCORE) ==
+                       i * 0.5);
+        MC_ASSERT_EQ_STR(
+            mc_string_c_str(mc_soa_array_get(&soa, i, FIELD_NAME)), name);
+    }
+    MC_ASSERT_NULL(mc_soa_array_get(&soa, 100, FIELD_ID));
+
+    void *row[FIELD_COUNT];
+    MC_ASSERT_TRUE(mc_soa_array_get_row(&soa, 42, row));
+    MC_ASSERT_EQ_INT(*(int *)row[FIELD_ID], 42);
+    MC_ASSERT_FALSE(mc_soa_array_get_row(&soa, 100, row));
+
+    int id;
+    struct mc_string str;
+    void *out[FIELD_COUNT] = {&id, NULL, &str};
+    MC_ASSERT_TRUE(mc_soa_array_pop(&soa, out));
+    MC_ASSERT_EQ_INT(id, 99);
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "rec99");
+    mc_string_cleanup(&str);
+
+    MC_ASSERT_TRUE(mc_soa_array_pop(&soa, NULL));
+    MC_ASSERT_EQ_SIZE(mc_soa_array_len(&soa), 98);
+
+    mc_soa_array_shrink_to_fit(&soa);
+    MC_ASSERT_EQ_SIZE(mc_soa_array_capacity(&soa), 98);
+    MC_ASSERT_EQ_STR(
+        mc_string_c_str(mc_soa_array_get(&soa, 97, FIELD_NAME)), "rec97");
+
+    mc_soa_array_clear(&soa);
+    MC_ASSERT_TRUE(mc_soa_array_is_empty(&soa));
+
+    mc_soa_array_cleanup(&soa);
+}
+
+MC_TEST_IN_SUITE(soa_array, columns)
+{
+    struct mc_soa_array soa;
+    init_records(&soa);
+
+    for (int i = 0; i < 1000; i++)
+        push_record(&soa, i, 1.0, "x");
+
+    for (size_t f = 0; f < FIELD_COUNT; f++) {
+        void *column = mc_soa_array_column(&soa, f);
+        MC_ASSERT_EQ_SIZE((uintptr_t)column % MC_SOA_ARRAY_COLUMN_ALIGNMENT,
+                          0);
+        MC_ASSERT_EQ_PTR(column, mc_soa_array_get(&soa, 0, f));
+    }
+
+    int const *ids = mc_soa_array_column(&soa, FIELD_ID);
+    double const *scores = mc_soa_array_column(&soa, FIELD_SCORE);
+    long id_sum = 0;
+    double score_sum = 0;
+    for (size_t i = 0; i < mc_soa_array_len(&soa); i++) {
+        id_sum += ids[i];
+        score_sum += scores[i];
+    }
+    MC_ASSERT_EQ_INT(id_sum, 999 * 1000 / 2);
+    MC_ASSERT_TRUE(score_sum == 1000.0);
+
+    mc_soa_array_cleanup(&soa);
+}
+
+MC_TEST_IN_SUITE(soa_array, copy_move_iter)
+{
+    struct mc_soa_array soa;
+    init_records(&soa);
+    push_record(&soa, 1, 1.5, "one");
+    push_record(&soa, 2, 2.5, "two");
+    push_record(&soa, 3, 3.5, "three");
+
+    struct mc_soa_array copy;
+    mc_soa_array_copy(&copy, &soa);
+    MC_ASSERT_EQ_SIZE(mc_soa_array_len(&copy), 3);
+    MC_ASSERT_TRUE(mc_soa_array_get(&copy, 1, FIELD_NAME) !=
+                   mc_soa_array_get(&soa, 1, FIELD_NAME));
+    MC_ASSERT_EQ_STR(
+        mc_string_c_str(mc_soa_array_get(&copy, 1, FIELD_NAME)), "two");
+
+    struct mc_soa_array moved;
+    mc_soa_array_move(&moved, &soa);
+    MC_ASSERT_EQ_SIZE(mc_soa_array_len(&soa), 0);
+    MC_ASSERT_EQ_SIZE(mc_soa_array_len(&moved), 3);
+    mc_soa_array_cleanup(&soa);
+
+    char const *names[] = {"one", "two", "three"};
+    void *row[FIELD_COUNT];
+    struct mc_iter iter;
+    mc_soa_array_iter_init(&iter, &moved, row);
+
+    size_t i = 0;
+    while (iter.next(&iter)) {
+        void **fields = iter.value;
+        MC_ASSERT_EQ_INT(*(int *)fields[FIELD_ID], (int)i + 1);
+        MC_ASSERT_EQ_STR(mc_string_c_str(fields[FIELD_NAME]), names[i]);
+        i++;
+    }
+    MC_ASSERT_EQ_SIZE(i, 3);
+
+    mc_soa_array_clear(&moved);
+    mc_soa_array_iter_init(&iter, &moved, row);
+    MC_ASSERT_FALSE(iter.next(&iter));
+
+    mc_soa_array_cleanup(&moved);
+    mc_soa_array_cleanup(&copy);
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_soa_array();
+    register_test_soa_array_init();
+    register_test_soa_array_push_get_pop();
+    register_test_soa_array_columns();
+    register_test_soa_array_copy_move_iter();
+#endif
+    return mc_run_all_tests();
+}
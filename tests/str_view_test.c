@@ -0,0 +1,332 @@
+#include <stddef.h>
+#include <string.h>
+#include "myclib/array.h"
+#include "myclib/str_view.h"
+#include "myclib/string.h"
+#include "myclib/test.h"
+
+MC_TEST_SUITE(str_view);
+
+static bool view_is(struct mc_str_view view, char const *expected)
+{
+    return mc_str_view_equal(view, mc_str_view_from_cstr(expected));
+}
+
+MC_TEST_IN_SUITE(str_view, make_substr)
+{
+    struct mc_str_view view = mc_str_view_from_cstr("hello world");
+    MC_ASSERT_EQ_SIZE(view.len, 11);
+    MC_ASSERT_FALSE(mc_str_view_is_empty(view));
+    MC_ASSERT_TRUE(mc_str_view_is_empty(mc_str_view_from_cstr("")));
+    MC_ASSERT_TRUE(mc_str_view_is_empty(mc_str_view_from_cstr(NULL)));
+
+    struct mc_str_view sub = mc_str_view_substr(view, 6, 5);
+    MC_ASSERT_TRUE(view_is(sub, "world"));
+    MC_ASSERT_EQ_PTR(sub.data, view.data + 6);
+
+    /* len is clamped */
+    MC_ASSERT_TRUE(view_is(mc_str_view_substr(view, 6, 100), "world"));
+    MC_ASSERT_TRUE(mc_str_view_is_empty(mc_str_view_substr(view, 11, 3)));
+
+    struct mc_str_view left, right;
+    mc_str_view_split_at(view, 5, &left, &right);
+    MC_ASSERT_TRUE(view_is(left, "hello"));
+    MC_ASSERT_TRUE(view_is(right, " world"));
+}
+
+MC_TEST_IN_SUITE(str_view, find)
+{
+    struct mc_str_view view = mc_str_view_from_cstr("abcabcab");
+    size_t index = 0;
+
+    MC_ASSERT_TRUE(mc_str_view_find(view, mc_str_view_from_cstr("cab"),
+                                    &index));
+    MC_ASSERT_EQ_SIZE(index, 2);
+    MC_ASSERT_TRUE(mc_str_view_rfind(view, mc_str_view_from_cstr("cab"),
+                                     &index));
+    MC_ASSERT_EQ_SIZE(index, 5);
+    MC_ASSERT_FALSE(mc_str_view_find(view, mc_str_view_from_cstr("abd"),
+                                     &index));
+    MC_ASSERT_FALSE(mc_str_view_find(view, mc_str_view_from_cstr("abcabcabc"),
+                                     &index));
+
+    MC_ASSERT_TRUE(mc_str_view_find(view, mc_str_view_from_cstr(""), &index));
+    MC_ASSERT_EQ_SIZE(index, 0);
+    MC_ASSERT_TRUE(mc_str_view_rfind(view, mc_str_view_from_cstr(""), &index));
+    MC_ASSERT_EQ_SIZE(index, 8);
+
+    MC_ASSERT_TRUE(mc_str_view_find_ch(view, 'c', &index));
+    MC_ASSERT_EQ_SIZE(index, 2);
+    MC_ASSERT_TRUE(mc_str_view_rfind_ch(view, 'c', &index));
+    MC_ASSERT_EQ_SIZE(index, 5);
+    MC_ASSERT_FALSE(mc_str_view_find_ch(view, 'z', NULL));
+
+    MC_ASSERT_TRUE(mc_str_view_contains(view, mc_str_view_from_cstr("bca")));
+    MC_ASSERT_TRUE(mc_str_view_starts_with(view, mc_str_view_from_cstr("abc")));
+    MC_ASSERT_FALSE(mc_str_view_starts_with(view, mc_str_view_from_cstr("b")));
+    MC_ASSERT_TRUE(mc_str_view_ends_with(view, mc_str_view_from_cstr("cab")));
+    MC_ASSERT_FALSE(mc_str_view_ends_with(view, mc_str_view_from_cstr("abc")));
+
+    /* Bytes past len are never looked at, and embedded NULs are data */
+    char const bytes[] = {'x', '\0', 'y', 'z', 'q'};
+    struct mc_str_view binary = mc_str_view_make(bytes, 4);
+    MC_ASSERT_TRUE(mc_str_view_find(binary, mc_str_view_make("\0y", 2),
+                                    &index));
+    MC_ASSERT_EQ_SIZE(index, 1);
+    MC_ASSERT_FALSE(mc_str_view_find_ch(binary, 'q', NULL));
+    MC_ASSERT_FALSE(mc_str_view_rfind(binary, mc_str_view_from_cstr("zq"),
+                                      NULL));
+}
+
+MC_TEST_IN_SUITE(str_view, trim_compare_hash)
+{
+    struct mc_str_view view = mc_str_view_from_cstr(" \t hi there \n");
+    MC_ASSERT_TRUE(view_is(mc_str_view_trim(view), "hi there"));
+    MC_ASSERT_TRUE(view_is(mc_str_view_trim_left(view), "hi there \n"));
+    MC_ASSERT_TRUE(view_is(mc_str_view_trim_right(view), " \t hi there"));
+    MC_ASSERT_TRUE(mc_str_view_is_empty(
+        mc_str_view_trim(mc_str_view_from_cstr("   "))));
+    /* Runs longer than a vector, with the edge inside one */
+    view = mc_str_view_from_cstr("\r\n\t\v\f                               x"
+                                 "  y                                 \n");
+    MC_ASSERT_TRUE(view_is(mc_str_view_trim(view), "x  y"));
+
+    struct mc_str_view a = mc_str_view_from_cstr("abc");
+    struct mc_str_view b = mc_str_view_from_cstr("abd");
+    struct mc_str_view ab = mc_str_view_from_cstr("ab");
+    MC_ASSERT_LT_INT(mc_str_view_compare(a, b), 0);
+    MC_ASSERT_GT_INT(mc_str_view_compare(b, a), 0);
+    MC_ASSERT_LT_INT(mc_str_view_compare(ab, a), 0);
+    MC_ASSERT_EQ_INT(mc_str_view_compare(a, mc_str_view_from_cstr("abc")), 0);
+
+    struct mc_string str;
+    mc_string_from(&str, "hello world");
+    struct mc_string other;
+    mc_string_from(&other, "hello");
+    MC_ASSERT_EQ_SIZE(mc_str_view_hash(mc_string_view(&str)),
+                      mc_string_hash(&str));
+    MC_ASSERT_EQ_SIZE(mc_str_view_hash(mc_string_substr(&str, 0, 5)),
+                      mc_string_hash(&other));
+    MC_ASSERT_EQ_INT(mc_str_view_compare(mc_string_view(&str),
+                                         mc_string_view(&other)),
+                     mc_string_compare(&str, &other));
+    mc_string_cleanup(&other);
+    mc_string_cleanup(&str);
+}
+
+MC_TEST_IN_SUITE(str_view, split_iterator)
+{
+    struct mc_str_split split;
+    struct mc_str_view token;
+
+    mc_str_split_init(&split, mc_str_view_from_cstr(",,a,bc,,d,"), ",");
+    MC_ASSERT_TRUE(mc_str_split_next(&split, &token));
+    MC_ASSERT_TRUE(view_is(token, "a"));
+    MC_ASSERT_TRUE(mc_str_split_next(&split, &token));
+    MC_ASSERT_TRUE(view_is(token, "bc"));
+    MC_ASSERT_TRUE(mc_str_split_next(&split, &token));
+    MC_ASSERT_TRUE(view_is(token, "d"));
+    MC_ASSERT_FALSE(mc_str_split_next(&split, &token));
+    MC_ASSERT_FALSE(mc_str_split_next(&split, &token));
+
+    mc_str_split_init(&split, mc_str_view_from_cstr("x y\tz\n"), " \t\n");
+    char const *expected[] = {"x", "y", "z"};
+    size_t count = 0;
+    while (mc_str_split_next(&split, &token)) {
+        MC_ASSERT_TRUE(count < 3);
+        MC_ASSERT_TRUE(view_is(token, expected[count]));
+        ++count;
+    }
+    MC_ASSERT_EQ_SIZE(count, 3);
+
+    mc_str_split_init(&split, mc_str_view_from_cstr(""), ",");
+    MC_ASSERT_FALSE(mc_str_split_next(&split, &token));
+    mc_str_split_init(&split, mc_str_view_from_cstr("abc"), "");
+    MC_ASSERT_TRUE(mc_str_split_next(&split, &token));
+    MC_ASSERT_TRUE(view_is(token, "abc"));
+    MC_ASSERT_FALSE(mc_str_split_next(&split, &token));
+
+    /* Tokens may contain NUL bytes */
+    mc_str_split_init(&split, mc_str_view_make("a\0b,c", 5), ",");
+    MC_ASSERT_TRUE(mc_str_split_next(&split, &token));
+    MC_ASSERT_TRUE(mc_str_view_equal(token, mc_str_view_make("a\0b", 3)));
+    MC_ASSERT_TRUE(mc_str_split_next(&split, &token));
+    MC_ASSERT_TRUE(view_is(token, "c"));
+}
+
+MC_TEST_IN_SUITE(str_view, string_views)
+{
+    struct mc_string str;
+    mc_string_from_view(&str, mc_str_view_from_cstr("one two  three"));
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "one two  three");
+
+    struct mc_array parts;
+    mc_string_split_views(&str, " ", &parts);
+    MC_ASSERT_EQ_SIZE(mc_array_len(&parts), 3);
+    struct mc_str_view *part = mc_array_get(&parts, 2);
+    MC_ASSERT_TRUE(view_is(*part, "three"));
+    MC_ASSERT_EQ_PTR(part->data, mc_string_c_str(&str) + 9);
+
+    struct mc_string joined;
+    mc_string_init(&joined);
+    for (size_t i = 0; i < mc_array_len(&parts); i++) {
+        part = mc_array_get(&parts, i);
+        mc_string_append_view(&joined, *part);
+    }
+    MC_ASSERT_EQ_STR(mc_string_c_str(&joined), "onetwothree");
+    mc_array_cleanup(&parts);
+
+    /* mc_string_split keeps working on strings with embedded NULs */
+    mc_string_append_bytes(&joined, "\0x y", 4);
+    mc_string_split(&joined, " ", &parts);
+    MC_ASSERT_EQ_SIZE(mc_array_len(&parts), 2);
+    MC_ASSERT_EQ_SIZE(mc_string_len(mc_array_get(&parts, 0)), 13);
+    mc_array_cleanup(&parts);
+
+    struct mc_str_split split;
+    struct mc_str_view token;
+    mc_string_split_iter(&split, &str, " ");
+    size_t count = 0;
+    while (mc_str_split_next(&split, &token))
+        ++count;
+    MC_ASSERT_EQ_SIZE(count, 3);
+
+    MC_ASSERT_TRUE(view_is(mc_string_substr(&str, 4, 3), "two"));
+    MC_ASSERT_TRUE(view_is(mc_string_substr(&str, 9, 100), "three"));
+
+    mc_string_cleanup(&joined);
+    mc_string_cleanup(&str);
+}
+
+/* Decodes by the definition: value, then its range and shortest form. */
+static size_t reference_sequence(unsigned char const *p, size_t len,
+                                 uint32_t *value)
+{
+    size_t size = p[0] < 0x80   ? 1
+                  : p[0] < 0xc0 ? 0
+                  : p[0] < 0xe0 ? 2
+                  : p[0] < 0xf0 ? 3
+                  : p[0] < 0xf8 ? 4
+                                : 0;
+    if (size == 0 || size > len)
+        return 0;
+    uint32_t v = size == 1 ? p[0] : p[0] & (0x7fu >> size);
+    for (size_t i = 1; i < size; i++) {
+        if ((p[i] & 0xc0) != 0x80)
+            return 0;
+        v = v << 6 | (p[i] & 0x3fu);
+    }
+    static uint32_t const min[] = {0, 0, 0x80, 0x800, 0x10000};
+    if (v < min[size] || v > 0x10ffff || (v >= 0xd800 && v <= 0xdfff))
+        return 0;
+    *value = v;
+    return size;
+}
+
+MC_TEST_IN_SUITE(str_view, utf8_matches_reference)
+{
+    static char const *const pieces[] = {
+        "a", "Z", " ", "\xc3\xa9", "\xd0\x96", "\xe2\x82\xac", "\xe4\xb8\xad",
+        "\xef\xbf\xbf", "\xf0\x9f\x98\x80", "\xf4\x8f\xbf\xbf",
+        /* Overlong, surrogate, too large, stray and cut short */
+        "\xc0\xaf", "\xc1\xbf", "\xe0\x9f\xbf", "\xed\xa0\x80",
+        "\xf0\x8f\xbf\xbf", "\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\x80",
+        "\xbf", "\xff", "\xe2\x82", "\xf0\x9f\x98"};
+    enum { VALID = 10, PIECES = sizeof(pieces) / sizeof(pieces[0]) };
+
+    unsigned state = 777;
+    char buf[300];
+    for (size_t round = 0; round < 3000; round++) {
+        /* Long ASCII runs, so whole vectors take the fast path too */
+        size_t len = 0;
+        size_t const target = round % 260;
+        while (len < target) {
+            state = state * 1103515245u + 12345u;
+            unsigned const r = state >> 16;
+            char const *piece =
+                r % 3 == 0 ? pieces[r / 3 % VALID] : pieces[r % 2];
+            if (round % 4 != 0 && r % 97 == 0)
+                piece = pieces[VALID + r / 97 % (PIECES - VALID)];
+            size_t const n = strlen(piece);
+            memcpy(buf + len, piece, n);
+            len += n;
+        }
+
+        unsigned char const *const bytes = (unsigned char const *)buf;
+        size_t expected_error = len, count = 0;
+        uint32_t expected[300];
+        for (size_t i = 0; i < len;) {
+            size_t const size =
+                reference_sequence(bytes + i, len - i, &expected[count]);
+            if (size == 0) {
+                expected_error = i;
+                break;
+            }
+            ++count;
+            i += size;
+        }
+
+        struct mc_str_view const view = mc_str_view_make(buf, len);
+        size_t error = len;
+        MC_ASSERT_TRUE(mc_str_view_utf8_validate(view, &error) ==
+                       (expected_error == len));
+        MC_ASSERT_EQ_SIZE(error, expected_error);
+
+        /* Up to the first error, the iterator decodes the same values */
+        struct mc_str_code_points code_points;
+        mc_str_code_points_init(&code_points, view);
+        uint32_t code_point = 0;
+        for (size_t k = 0; k < count; k++) {
+            MC_ASSERT_TRUE(mc_str_code_points_next(&code_points, &code_point));
+            MC_ASSERT_EQ_SIZE(code_point, expected[k]);
+        }
+        if (expected_error == len) {
+            MC_ASSERT_EQ_SIZE(mc_str_view_utf8_len(view), count);
+            MC_ASSERT_FALSE(mc_str_code_points_next(&code_points, &code_point));
+        } else {
+            MC_ASSERT_EQ_SIZE(code_points.rest.len, len - expected_error);
+            MC_ASSERT_TRUE(mc_str_code_points_next(&code_points, &code_point));
+            MC_ASSERT_EQ_SIZE(code_point, 0xfffd);
+        }
+    }
+}
+
+MC_TEST_IN_SUITE(str_view, utf8_replacement)
+{
+    /* The example of Unicode 15, table 3-8: one U+FFFD per maximal subpart */
+    struct mc_str_view const view =
+        mc_str_view_from_cstr("a\xf1\x80\x80\xe1\x80\xc2" "b\x80" "c\x80\xbf"
+                              "d\xf0\x80\x80\xed\xa0\x80\xe2\x82");
+    static uint32_t const expected[] = {
+        'a',    0xfffd, 0xfffd, 0xfffd, 'b',    0xfffd, 'c',
+        0xfffd, 0xfffd, 'd',    0xfffd, 0xfffd, 0xfffd, 0xfffd,
+        0xfffd, 0xfffd, 0xfffd};
+    struct mc_str_code_points code_points;
+    mc_str_code_points_init(&code_points, view);
+    uint32_t code_point;
+    for (size_t k = 0; k < sizeof(expected) / sizeof(expected[0]); k++) {
+        MC_ASSERT_TRUE(mc_str_code_points_next(&code_points, &code_point));
+        MC_ASSERT_EQ_SIZE(code_point, expected[k]);
+    }
+    MC_ASSERT_FALSE(mc_str_code_points_next(&code_points, &code_point));
+
+    size_t error = 0;
+    MC_ASSERT_FALSE(mc_str_view_utf8_validate(view, &error));
+    MC_ASSERT_EQ_SIZE(error, 1);
+    MC_ASSERT_TRUE(mc_str_view_utf8_validate(mc_str_view_make(NULL, 0), NULL));
+}
+
+int main(void)
+{
+#if !MC_COMPILER_SUPPORTS_ATTRIBUTE
+    register_test_suite_str_view();
+    register_test_str_view_make_substr();
+    register_test_str_view_find();
+    register_test_str_view_trim_compare_hash();
+    register_test_str_view_split_iterator();
+    register_test_str_view_string_views();
+    register_test_str_view_utf8_matches_reference();
+    register_test_str_view_utf8_replacement();
+#endif
+    return mc_run_all_tests();
+}
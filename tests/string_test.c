@@ -6,6 +6,8 @@
 #include "myclib/string.h"
 #include "myclib/test.h"
 #include "myclib/array.h"
+#include "myclib/map.h"
+#include "myclib/multi_search.h"
 
 MC_TEST_SUITE(string);
 
@@ -15,7 +17,8 @@ MC_TEST_IN_SUITE(string, init_cleanup)
     struct mc_string str;
     mc_string_init(&str);
     MC_ASSERT_EQ_SIZE(mc_string_len(&str), 0);
-    MC_ASSERT_EQ_SIZE(mc_string_capacity(&str), 0);
+    MC_ASSERT_EQ_SIZE(mc_string_capacity(&str), MC_STRING_INLINE_CAPACITY);
+    MC_ASSERT_TRUE(mc_string_is_inline(&str));
     MC_ASSERT_TRUE(mc_string_is_empty(&str));
     mc_string_cleanup(&str);
 
@@ -112,6 +115,49 @@ MC_TEST_IN_SUITE(string, append)
     mc_string_cleanup(&str);
 }
 
+MC_TEST_IN_SUITE(string, append_numbers)
+{
+    struct mc_string str;
+    mc_string_init(&str);
+
+    mc_string_append_i64(&str, -42);
+    mc_string_append(&str, ",");
+    mc_string_append_u64(&str, 18446744073709551615ull);
+    mc_string_append(&str, ",");
+    mc_string_append_hex(&str, 0xdeadbeef);
+    mc_string_append(&str, ",");
+    mc_string_append_f64(&str, 0.1);
+    mc_string_append(&str, ",");
+    mc_string_append_f64(&str, -1e21);
+    char const *const expected = "-42,18446744073709551615,deadbeef,0.1,-1e+21";
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), strlen(expected));
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), expected);
+    mc_string_cleanup(&str);
+
+    /* A number filling the inline buffer exactly, then one past it */
+    mc_string_from(&str, "xxx");
+    mc_string_append_u64(&str, 18446744073709551615ull);
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), MC_STRING_INLINE_CAPACITY);
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "xxx18446744073709551615");
+    mc_string_append_u64(&str, 7);
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "xxx184467440737095516157");
+    mc_string_cleanup(&str);
+
+    /* append_format that fits the spare capacity, just fits, then spills */
+    mc_string_init(&str);
+    mc_string_append_format(&str, "%s", "0123456789");
+    mc_string_append_format(&str, "%d", 1234567890);
+    mc_string_append_format(&str, "%c%c%c", 'a', 'b', 'c');
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), MC_STRING_INLINE_CAPACITY);
+    mc_string_append_format(&str, "%s|%d", "spill", 99);
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "01234567891234567890abcspill|99");
+    for (int i = 0; i < 1000; i++)
+        mc_string_append_format(&str, "%04d", i);
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), 31 + 4000);
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str) + 31 + 3996, "0999");
+    mc_string_cleanup(&str);
+}
+
 MC_TEST_IN_SUITE(string, capacity)
 {
     struct mc_string str;
@@ -230,6 +276,93 @@ MC_TEST_IN_SUITE(string, search)
     mc_string_cleanup(&str);
 }
 
+static bool naive_find(struct mc_str_view hay, struct mc_str_view needle,
+                       bool reverse, size_t *index)
+{
+    if (needle.len > hay.len)
+        return false;
+    for (size_t k = 0; k <= hay.len - needle.len; k++) {
+        size_t const i = reverse ? hay.len - needle.len - k : k;
+        if (memcmp(hay.data + i, needle.data, needle.len) == 0) {
+            *index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+MC_TEST_IN_SUITE(string, search_matches_naive)
+{
+    /* Embedded NULs are part of the haystack */
+    struct mc_string str;
+    mc_string_from_bytes(&str, "ab\0cd\0cd", 8);
+    size_t index = 0;
+    MC_ASSERT_TRUE(mc_string_find(&str, "cd", &index));
+    MC_ASSERT_EQ_SIZE(index, 3);
+    MC_ASSERT_TRUE(mc_string_rfind(&str, "cd", &index));
+    MC_ASSERT_EQ_SIZE(index, 6);
+    MC_ASSERT_TRUE(mc_string_find_ch(&str, 'd', &index));
+    MC_ASSERT_EQ_SIZE(index, 4);
+    MC_ASSERT_TRUE(mc_string_rfind_ch(&str, '\0', &index));
+    MC_ASSERT_EQ_SIZE(index, 5);
+    MC_ASSERT_TRUE(mc_string_contains(&str, "d"));
+    MC_ASSERT_TRUE(mc_string_contains_ch(&str, 'c'));
+    mc_string_remove(&str, "cd");
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), 6);
+    MC_ASSERT_TRUE(mc_string_find_ch(&str, 'c', &index));
+    MC_ASSERT_EQ_SIZE(index, 4);
+    mc_string_cleanup(&str);
+
+    /*
+     * Small alphabets give many partial matches; needles run past the
+     * short-needle limit so both the vector filter and Two-Way are used,
+     * and periodic needles exercise the Two-Way memory.
+     */
+    unsigned state = 12345;
+    for (size_t round = 0; round < 300; round++) {
+        size_t const len = round * 7 % 400;
+        size_t const n_len = 1 + round % 70;
+        char const alphabet = round % 3 == 0 ? 2 : 4;
+
+        mc_string_init(&str);
+        for (size_t i = 0; i < len; i++) {
+            state = state * 1103515245u + 12345u;
+            char c = (char)('a' + (state >> 16) % (unsigned)alphabet);
+            mc_string_append_bytes(&str, &c, 1);
+        }
+
+        struct mc_string needle;
+        mc_string_init(&needle);
+        if (len >= n_len && round % 2 == 0) {
+            size_t const at = (round * 13) % (len - n_len + 1);
+            mc_string_append_bytes(&needle, mc_string_c_str(&str) + at, n_len);
+        } else {
+            for (size_t i = 0; i < n_len; i++) {
+                char c = (char)('a' + i % (size_t)alphabet);
+                mc_string_append_bytes(&needle, &c, 1);
+            }
+        }
+
+        for (int reverse = 0; reverse < 2; reverse++) {
+            size_t expected = 0;
+            bool const found = naive_find(mc_string_view(&str),
+                                          mc_string_view(&needle), reverse,
+                                          &expected);
+            bool const got =
+                reverse ? mc_string_rfind(&str, mc_string_c_str(&needle),
+                                          &index)
+                        : mc_string_find(&str, mc_string_c_str(&needle),
+                                         &index);
+            MC_ASSERT_TRUE(got == found);
+            if (found)
+                MC_ASSERT_EQ_SIZE(index, expected);
+        }
+
+        mc_string_cleanup(&needle);
+        mc_string_cleanup(&str);
+    }
+}
+
 MC_TEST_IN_SUITE(string, transform)
 {
     struct mc_string str;
@@ -325,6 +458,82 @@ MC_TEST_IN_SUITE(string, transform)
     mc_string_cleanup(&str);
 }
 
+MC_TEST_IN_SUITE(string, replace)
+{
+    struct mc_string str;
+
+    /* Overlapping candidates are taken left to right */
+    mc_string_from(&str, "aaaaa");
+    mc_string_replace(&str, "aa", "b");
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "bba");
+    mc_string_cleanup(&str);
+
+    /* Growing allocates once, past the inline buffer */
+    mc_string_from(&str, "a-b-c-d-e-f-g-h-i-j");
+    mc_string_replace(&str, "-", " <-> ");
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str),
+                     "a <-> b <-> c <-> d <-> e <-> f <-> g <-> h <-> i <-> j");
+    MC_ASSERT_FALSE(mc_string_is_inline(&str));
+    mc_string_replace(&str, " <-> ", "");
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "abcdefghij");
+    mc_string_replace(&str, "xyz", "123456");
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "abcdefghij");
+    mc_string_cleanup(&str);
+
+    /* More matches than the offsets kept on the stack */
+    mc_string_init(&str);
+    for (size_t i = 0; i < 1000; i++)
+        mc_string_append(&str, "x.");
+    mc_string_replace(&str, ".", "<>");
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), 3000);
+    for (size_t i = 0; i < 3000; i += 3)
+        MC_ASSERT_TRUE(memcmp(mc_string_c_str(&str) + i, "x<>", 3) == 0);
+    mc_string_cleanup(&str);
+
+    /* Views may hold NUL bytes */
+    mc_string_from_bytes(&str, "a\0b\0c", 5);
+    mc_string_replace_view(&str, mc_str_view_make("\0", 1),
+                           mc_str_view_make("\0\0", 2));
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), 7);
+    MC_ASSERT_TRUE(memcmp(mc_string_c_str(&str), "a\0\0b\0\0c", 8) == 0);
+    mc_string_replace_view(&str, mc_str_view_make("\0\0", 2),
+                           mc_str_view_make("", 0));
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "abc");
+    mc_string_cleanup(&str);
+
+    /* Many patterns at once, leftmost and then longest */
+    struct mc_array patterns;
+    struct mc_array replacements;
+    char const *const pairs[][2] = {
+        {"he", "HE"}, {"hello", "X"}, {"lo", "LO"}, {"p", "PPPPPPPPPPPP"}};
+    mc_array_init(&patterns, mc_string_get_mc_type());
+    mc_array_init(&replacements, mc_string_get_mc_type());
+    for (size_t i = 0; i < 4; i++) {
+        struct mc_string word;
+        mc_string_from(&word, pairs[i][0]);
+        mc_array_push(&patterns, &word);
+        mc_string_from(&word, pairs[i][1]);
+        mc_array_push(&replacements, &word);
+    }
+    struct mc_multi_search search;
+    mc_multi_search_init(&search, &patterns);
+
+    mc_string_from(&str, "hello hello help");
+    mc_string_replace_many(&str, &search, &replacements);
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "X X HElPPPPPPPPPPPP");
+    mc_string_cleanup(&str);
+
+    /* Without the growing pair it runs in place */
+    mc_string_from(&str, "hello hello hel");
+    mc_string_replace_many(&str, &search, &replacements);
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "X X HEl");
+    mc_string_cleanup(&str);
+
+    mc_multi_search_cleanup(&search);
+    mc_array_cleanup(&replacements);
+    mc_array_cleanup(&patterns);
+}
+
 MC_TEST_IN_SUITE(string, repeat)
 {
     struct mc_string str;
@@ -454,6 +663,165 @@ MC_TEST_IN_SUITE(string, compare)
     mc_string_cleanup(&str3);
 }
 
+MC_TEST_IN_SUITE(string, compare_ignore_case)
+{
+    struct mc_string str1, str2;
+    mc_string_from(&str1, "Content-Length");
+    mc_string_from(&str2, "content-LENGTH");
+    MC_ASSERT_TRUE(mc_string_equal_ignore_case(&str1, &str2));
+    MC_ASSERT_EQ_SIZE(mc_string_hash_ignore_case(&str1),
+                      mc_string_hash_ignore_case(&str2));
+    mc_string_to_lower(&str1);
+    MC_ASSERT_EQ_SIZE(mc_string_hash_ignore_case(&str2),
+                      mc_string_hash(&str1));
+
+    /* '[' sits between 'Z' and 'a', so folding decides the order */
+    mc_string_cleanup(&str2);
+    mc_string_from(&str2, "content-[ength");
+    MC_ASSERT_GT_INT(mc_string_compare_ignore_case(&str1, &str2), 0);
+    MC_ASSERT_LT_INT(mc_string_compare_ignore_case(&str2, &str1), 0);
+    mc_string_cleanup(&str2);
+    mc_string_from(&str2, "content-length-");
+    MC_ASSERT_LT_INT(mc_string_compare_ignore_case(&str1, &str2), 0);
+
+    /* Bytes past ASCII only match themselves in the C locale */
+    mc_string_cleanup(&str1);
+    mc_string_cleanup(&str2);
+    mc_string_from(&str1, "caf\xc3\xa9 CAF\xc3\xa9 caf\xc3\xa9 CAF\xc3\xa9 "
+                          "\xc3\x89");
+    mc_string_from(&str2, "CAF\xc3\xa9 caf\xc3\xa9 CAF\xc3\xa9 caf\xc3\xa9 "
+                          "\xc3\x89");
+    MC_ASSERT_TRUE(mc_string_equal_ignore_case(&str1, &str2));
+    mc_string_cleanup(&str2);
+    mc_string_from(&str2, "CAF\xc3\xa9 caf\xc3\xa9 CAF\xc3\xa9 caf\xc3\xa9 "
+                          "\xc3\xa9");
+    MC_ASSERT_FALSE(mc_string_equal_ignore_case(&str1, &str2));
+
+    /* As map keys */
+    struct mc_map map;
+    mc_map_init(&map, mc_string_ignore_case_get_mc_type(), int_get_mc_type());
+    int value = 1;
+    mc_map_insert(&map, &str1, &value);
+    mc_string_from(&str1, "Accept");
+    value = 2;
+    mc_map_insert(&map, &str1, &value);
+    mc_string_from(&str1, "ACCEPT");
+    MC_ASSERT_EQ_INT(*(int *)mc_map_get(&map, &str1), 2);
+    mc_string_to_upper(&str2);
+    MC_ASSERT_TRUE(mc_map_get(&map, &str2) == NULL);
+    mc_string_cleanup(&str1);
+    mc_string_cleanup(&str2);
+    mc_map_cleanup(&map);
+}
+
+static char ascii_fold(char c, char first)
+{
+    return c >= first && c < first + 26 ? (char)(c ^ 0x20) : c;
+}
+
+static bool ascii_space(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+MC_TEST_IN_SUITE(string, ascii_matches_scalar)
+{
+    /*
+     * Letters of both cases, the bytes around them, every ASCII space and
+     * some bytes past ASCII, at lengths around the vector widths so both
+     * the vector loops and the tails are covered.
+     */
+    static char const pool[] = "aAzZ@[`{09 \t\n\v\f\r_\x80\xc3\xa9\xff";
+    unsigned state = 4321;
+    char buf[200];
+    for (size_t round = 0; round < 1000; round++) {
+        size_t const len = round % 150;
+        for (size_t i = 0; i < len; i++) {
+            state = state * 1103515245u + 12345u;
+            /* Only spaces near the ends, for the trims */
+            bool const edge = i < round % 40 || len - i <= round % 37;
+            buf[i] = edge ? pool[10 + (state >> 16) % 6]
+                          : pool[(state >> 16) % (sizeof(pool) - 1)];
+        }
+
+        struct mc_string str;
+        mc_string_from_bytes(&str, buf, len);
+        mc_string_to_upper(&str);
+        for (size_t i = 0; i < len; i++)
+            MC_ASSERT_EQ_INT(mc_string_c_str(&str)[i],
+                             ascii_fold(buf[i], 'a'));
+        mc_string_to_lower(&str);
+        for (size_t i = 0; i < len; i++)
+            MC_ASSERT_EQ_INT(mc_string_c_str(&str)[i],
+                             ascii_fold(ascii_fold(buf[i], 'a'), 'A'));
+
+        struct mc_string copy;
+        mc_string_from_bytes(&copy, buf, len);
+        MC_ASSERT_TRUE(mc_string_equal_ignore_case(&str, &copy));
+        MC_ASSERT_EQ_SIZE(mc_string_hash_ignore_case(&copy),
+                          mc_string_hash(&str));
+        if (len > 0) {
+            /* The first folded difference decides, wherever it falls */
+            size_t const at = round * 31 % len;
+            char *const data = mc_string_data(&copy);
+            char const old = data[at];
+            data[at] = old == '@' ? '[' : '@';
+            int const expected = (unsigned char)ascii_fold(old, 'A') -
+                                 (unsigned char)ascii_fold(data[at], 'A');
+            int const got = mc_string_compare_ignore_case(&str, &copy);
+            MC_ASSERT_TRUE((got < 0) == (expected < 0) && got != 0);
+            data[at] = old;
+        }
+
+        size_t begin = 0, end = len;
+        while (begin < len && ascii_space(buf[begin]))
+            ++begin;
+        while (end > begin && ascii_space(buf[end - 1]))
+            --end;
+        mc_string_trim(&copy);
+        MC_ASSERT_EQ_SIZE(mc_string_len(&copy), end - begin);
+        MC_ASSERT_TRUE(memcmp(mc_string_c_str(&copy), buf + begin,
+                              end - begin) == 0);
+
+        mc_string_cleanup(&copy);
+        mc_string_cleanup(&str);
+    }
+}
+
+MC_TEST_IN_SUITE(string, utf8)
+{
+    /* Both ends of each encoded length, around the surrogates */
+    static uint32_t const code_points[] = {
+        0x24,   0x7f,   0x80,   0xe9,    0x7ff,   0x800,   0x20ac,
+        0xd7ff, 0xe000, 0xfffd, 0xffff, 0x10000, 0x1f600, 0x10ffff};
+    enum { COUNT = sizeof(code_points) / sizeof(code_points[0]) };
+    struct mc_string str;
+    mc_string_init(&str);
+    for (size_t k = 0; k < COUNT; k++)
+        mc_string_append_code_point(&str, code_points[k]);
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), 1 + 1 + 2 + 2 + 2 + 3 * 6 + 4 * 3);
+    MC_ASSERT_TRUE(mc_string_utf8_validate(&str, NULL));
+    MC_ASSERT_EQ_SIZE(mc_string_utf8_len(&str), COUNT);
+    MC_ASSERT_TRUE(memcmp(mc_string_c_str(&str) + 4, "\xc3\xa9", 2) == 0);
+
+    struct mc_str_code_points iter;
+    mc_str_code_points_init(&iter, mc_string_view(&str));
+    uint32_t code_point;
+    for (size_t k = 0; k < COUNT; k++) {
+        MC_ASSERT_TRUE(mc_str_code_points_next(&iter, &code_point));
+        MC_ASSERT_EQ_SIZE(code_point, code_points[k]);
+    }
+    MC_ASSERT_FALSE(mc_str_code_points_next(&iter, &code_point));
+
+    /* A truncated sequence is reported at its lead byte */
+    size_t const len = mc_string_len(&str);
+    mc_string_append_bytes(&str, "\xf0\x9f\x98", 3);
+    size_t error = 0;
+    MC_ASSERT_FALSE(mc_string_utf8_validate(&str, &error));
+    MC_ASSERT_EQ_SIZE(error, len);
+    mc_string_cleanup(&str);
+}
+
 MC_TEST_IN_SUITE(string, move_copy)
 {
     struct mc_string src, dst;
@@ -465,8 +833,9 @@ MC_TEST_IN_SUITE(string, move_copy)
     size_t const expected_len = strlen(expected);
     MC_ASSERT_EQ_SIZE(mc_string_len(&dst), expected_len);
     MC_ASSERT_EQ_STR(mc_string_c_str(&dst), expected);
-    MC_ASSERT_NULL(src.data);
-    MC_ASSERT_EQ_SIZE(src.len, 0);
+    MC_ASSERT_TRUE(mc_string_is_inline(&src));
+    MC_ASSERT_EQ_STR(mc_string_c_str(&src), "");
+    MC_ASSERT_EQ_SIZE(mc_string_len(&src), 0);
 
     /* Test copy */
     struct mc_string copy;
@@ -525,6 +894,91 @@ MC_TEST_IN_SUITE(string, edge_cases)
     mc_string_cleanup(&str);
 }
 
+MC_TEST_IN_SUITE(string, small_string_optimization)
+{
+    struct mc_string str;
+    mc_string_init(&str);
+
+    /* Up to the inline capacity the string stays in the struct. */
+    for (size_t i = 0; i < MC_STRING_INLINE_CAPACITY; i++)
+        mc_string_append(&str, "a");
+    MC_ASSERT_TRUE(mc_string_is_inline(&str));
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), MC_STRING_INLINE_CAPACITY);
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "aaaaaaaaaaaaaaaaaaaaaaa");
+
+    mc_string_append(&str, "b");
+    MC_ASSERT_FALSE(mc_string_is_inline(&str));
+    MC_ASSERT_GT_SIZE(mc_string_capacity(&str), MC_STRING_INLINE_CAPACITY);
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "aaaaaaaaaaaaaaaaaaaaaaab");
+
+    /* Shrinking a short heap string brings it back inline. */
+    mc_string_strip_prefix(&str, "aaaaaaaaaaaaaaaaaaaa");
+    mc_string_shrink_to_fit(&str);
+    MC_ASSERT_TRUE(mc_string_is_inline(&str));
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "aaab");
+
+    mc_string_to_upper(&str);
+    mc_string_insert(&str, 2, "-inserted-across-the-boundary-");
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str),
+                     "AA-inserted-across-the-boundary-AB");
+    mc_string_cleanup(&str);
+
+    /* The inline length lives in the last byte of the buffer. */
+    MC_ASSERT_EQ_SIZE(sizeof(struct mc_string), 4 * sizeof(void *));
+    mc_string_init(&str);
+    for (size_t i = 0; i <= MC_STRING_INLINE_CAPACITY; i++) {
+        MC_ASSERT_EQ_SIZE(mc_string_len(&str), i);
+        MC_ASSERT_EQ_SIZE(strlen(mc_string_c_str(&str)), i);
+        mc_string_append(&str, "z");
+    }
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), MC_STRING_INLINE_CAPACITY + 1);
+    mc_string_cleanup(&str);
+
+    /* A format that overruns the inline spare writes its NUL over the
+     * length byte; the string must still grow by what it holds. */
+    mc_string_from(&str, "12345");
+    mc_string_append_format(&str, "%s-%s", "a-format-much-longer-than",
+                            "the-spare-and-twice-the-buffer");
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "12345a-format-much-longer-than-"
+                                            "the-spare-and-twice-the-buffer");
+    MC_ASSERT_EQ_SIZE(mc_string_capacity(&str), mc_string_len(&str));
+    mc_string_cleanup(&str);
+
+    /* Heap capacities come back exactly despite the tag bit. */
+    mc_string_init(&str);
+    mc_string_reserve_exact(&str, (1u << 20) + 5);
+    MC_ASSERT_EQ_SIZE(mc_string_capacity(&str), (1u << 20) + 5);
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), 0);
+    mc_string_append(&str, "abc");
+    MC_ASSERT_EQ_SIZE(mc_string_len(&str), 3);
+    mc_string_shrink_to_fit(&str);
+    MC_ASSERT_TRUE(mc_string_is_inline(&str));
+    MC_ASSERT_EQ_STR(mc_string_c_str(&str), "abc");
+    mc_string_cleanup(&str);
+
+    /* Arrays and maps relocate strings bytewise. */
+    struct mc_array array;
+    mc_array_init(&array, mc_string_get_mc_type());
+    struct mc_map map;
+    mc_map_init(&map, mc_string_get_mc_type(), size_get_mc_type());
+    for (size_t i = 0; i < 1000; i++) {
+        struct mc_string key;
+        mc_string_format(&key, i % 2 ? "k%zu" : "key-long-enough-for-heap-%zu",
+                         i);
+        struct mc_string copy;
+        mc_string_copy(&copy, &key);
+        mc_array_push(&array, &copy);
+        mc_map_insert(&map, &key, &i);
+    }
+    for (size_t i = 0; i < 1000; i++) {
+        struct mc_string *key = mc_array_get(&array, i);
+        MC_ASSERT_EQ_SIZE(*(size_t *)mc_map_get(&map, key), i);
+        MC_ASSERT_TRUE(mc_string_is_inline(key) == (i % 2 == 1));
+    }
+    mc_map_cleanup(&map);
+    mc_array_cleanup(&array);
+}
+
 int main(void)
 {
 #if !MC_COMPILER_SUPPORTS_ATTRIBUTE
@@ -532,17 +986,24 @@ int main(void)
     register_test_string_init_cleanup();
     register_test_string_format();
     register_test_string_append();
+    register_test_string_append_numbers();
     register_test_string_capacity();
     register_test_string_insert_remove();
     register_test_string_search();
+    register_test_string_search_matches_naive();
     register_test_string_transform();
+    register_test_string_replace();
     register_test_string_repeat();
     register_test_string_split();
     register_test_string_join();
     register_test_string_compare();
+    register_test_string_compare_ignore_case();
+    register_test_string_ascii_matches_scalar();
+    register_test_string_utf8();
     register_test_string_move_copy();
     register_test_string_hash();
     register_test_string_edge_cases();
+    register_test_string_small_string_optimization();
 #endif
     return mc_run_all_tests();
 }